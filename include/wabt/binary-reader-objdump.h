@@ -65,10 +65,24 @@ struct ObjdumpNames {
 };
 
 struct ObjdumpLocalNames {
-  std::string_view Get(Index function_index, Index local_index) const;
+  // Decodes the function's deferred names, if any, on first use.
+  std::string_view Get(Index function_index, Index local_index);
   void Set(Index function_index, Index local_index, std::string_view name);
+  // Records the |num_locals| undecoded name entries of a function, which
+  // start at |data| in the name section. The module data must outlive this.
+  void SetDeferred(Index function_index,
+                   Index num_locals,
+                   const uint8_t* data,
+                   const uint8_t* end);
+
+  struct Deferred {
+    Index num_locals;
+    const uint8_t* data;
+    const uint8_t* end;
+  };
 
   std::map<std::pair<Index, Index>, std::string> names;
+  std::map<Index, Deferred> deferred;
 };
 
 // read_binary_objdump uses this state to store information from previous runs
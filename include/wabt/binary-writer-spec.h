@@ -55,6 +55,54 @@ Result WriteBinarySpecScript(
     std::vector<FilenameMemoryStreamPair>* out_module_streams,
     Stream* log_stream = nullptr);
 
+// Spec bundles are an alternative to the JSON output: a single file holding
+// every command and every module they reference, which spectest-interp can
+// map and run without parsing JSON or opening one file per module.
+//
+//   magic, version                      u32 each
+//   source filename                     string
+//   module count, then for each module  filename, offset, size
+//   command count, then for each        type (u8), line, operands
+//   module data
+//
+// Strings are a LEB128 length followed by the bytes, all other integers are
+// LEB128, and module offsets are relative to the start of the module data.
+// Module filenames are the basenames the JSON output would have used.
+//
+// Command operands, by type (modules are referenced by index):
+//
+//   module                    name, module
+//   action                    action
+//   register                  name, as
+//   assert_malformed,         module, text, module type (u8)
+//   assert_invalid,
+//   assert_unlinkable,
+//   assert_uninstantiable
+//   assert_return             action, either (u8), const count, consts
+//   assert_trap,              action, text
+//   assert_exhaustion
+//   assert_exception          action
+//
+// An action is its type (u8), module name, field name and, for invokes, the
+// arg count and consts. A const is its type (s32), the lane type (s32) for
+// v128, then for each lane an ExpectedNan (u8, float lanes only) and the bits
+// (u64). References are stored as 0 for null, or the value plus one.
+static constexpr uint32_t kSpecBundleMagic = 0x62737700;  // "\0wsb"
+static constexpr uint32_t kSpecBundleVersion = 1;
+
+// Encoding of a spec bundle command's module operand.
+enum class SpecBundleModuleType : uint8_t {
+  Binary,
+  Text,
+};
+
+Result WriteBinarySpecBundle(Stream* stream,
+                             Script*,
+                             std::string_view source_filename,
+                             std::string_view module_filename_noext,
+                             const WriteBinaryOptions&,
+                             Stream* log_stream = nullptr);
+
 }  // namespace wabt
 
 #endif /* WABT_BINARY_WRITER_SPEC_H_ */
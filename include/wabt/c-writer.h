@@ -24,12 +24,29 @@
 
 namespace wabt {
 
+class MemoryStats;
 struct Module;
+class PassTimer;
 class Stream;
 
 struct WriteCOptions {
   std::string_view module_name;
   Features features;
+  /*
+   * Emit a per-instance entry counter for every defined function, and with
+   * profile_loops also a counter for every loop header. The counters are read
+   * through the generated wasm2c_<module>_get_profile function; see
+   * wasm2c/wasm-rt-profile.h.
+   */
+  bool profile = false;
+  bool profile_loops = false;
+  /* If set, the major phases of code generation are recorded here. */
+  PassTimer* timer = nullptr;
+  /*
+   * If set, the writer's symbol tables and the peak size of its per-function
+   * buffers are added here, in "cwriter." categories, when it finishes.
+   */
+  MemoryStats* mem_stats = nullptr;
   /*
    * name_to_output_file_index takes const iterators to begin and end of a list
    * of all functions in the module, number of imported functions, and number of
@@ -23,6 +23,8 @@
 #include "wabt/ir.h"
 
 #include <map>
+#include <set>
+#include <string_view>
 
 namespace wabt {
 
@@ -107,13 +109,10 @@ struct AST {
 
   template <ExprType T>
   void PreDecl(const VarExpr<T>& ve) {
-    // FIXME: this is slow, and would be better to avoid in callers.
     // See https://github.com/WebAssembly/wabt/issues/1565
     // And https://github.com/WebAssembly/wabt/issues/1665
-    for (auto& n : predecls) {
-      if (n.u.var->name() == ve.var.name()) {
-        return;
-      }
+    if (!predecl_names.insert(ve.var.name()).second) {
+      return;
     }
     predecls.emplace_back(NodeType::Decl, ExprType::Nop, nullptr, &ve.var);
   }
@@ -373,6 +372,7 @@ struct AST {
       std::rotate(exp_stack.begin(), exp_stack.end() - predecls.size(),
                   exp_stack.end());
       predecls.clear();
+      predecl_names.clear();
     }
     end = exp_stack.size();
     assert(end >= start);
@@ -388,6 +388,8 @@ struct AST {
   ModuleContext& mc;
   std::vector<Node> exp_stack;
   std::vector<Node> predecls;
+  // Names in predecls; they point into the IR, which outlives the AST.
+  std::set<std::string_view> predecl_names;
   const Func* f;
   int value_stack_depth = 0;
   struct Variable {
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_FUNC_TYPE_TABLE_H_
+#define WABT_FUNC_TYPE_TABLE_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "wabt/common.h"
+#include "wabt/type.h"
+
+namespace wabt {
+
+// A hash-consed table of function signatures. Each distinct (params, results)
+// pair is stored once and gets a small integer id, so two signatures in the
+// same table are equal exactly when their ids are.
+//
+// Id 0 is always the empty signature, so a default id is a valid signature to
+// fall back to after an error.
+class FuncTypeTable {
+ public:
+  using Id = Index;
+  static constexpr Id kEmptyId = 0;
+
+  FuncTypeTable();
+  WABT_DISALLOW_COPY_AND_ASSIGN(FuncTypeTable);
+
+  // Returns the id of the signature, adding it if it isn't in the table yet.
+  Id Intern(const TypeVector& params, const TypeVector& results);
+  // Returns kInvalidIndex if the signature isn't in the table.
+  Id Find(const TypeVector& params, const TypeVector& results) const;
+
+  const TypeVector& params(Id id) const { return entries_[id].params; }
+  const TypeVector& results(Id id) const { return entries_[id].results; }
+  Index size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    TypeVector params;
+    TypeVector results;
+  };
+
+  static size_t Hash(const TypeVector& params, const TypeVector& results);
+
+  std::vector<Entry> entries_;
+  // Keyed by Hash(); collisions are resolved by comparing entries.
+  std::unordered_multimap<size_t, Id> ids_;
+};
+
+}  // namespace wabt
+
+#endif  // WABT_FUNC_TYPE_TABLE_H_
@@ -17,19 +17,38 @@
 #ifndef WABT_GENERATE_NAMES_H_
 #define WABT_GENERATE_NAMES_H_
 
+#include <string>
+#include <unordered_map>
+
 #include "wabt/common.h"
 
 namespace wabt {
 
+struct Block;
+struct Func;
 struct Module;
 
 enum NameOpts {
   None = 0,
   AlphaNames = 1 << 0,
+  // Only name module-level entities. Unnamed params, locals and labels stay
+  // unnamed, so ApplyNames leaves their uses as indexes, and writers call
+  // GenerateLocalName/GenerateLabelNames when they print them; no name is
+  // stored per local or block. Can't be combined with AlphaNames.
+  LocalNamesOnDemand = 1 << 1,
 };
 
 Result GenerateNames(struct Module*, NameOpts opts = NameOpts::None);
 
+// The name GenerateNames gives the param or local |index| of |func| when it
+// has none, e.g. "$p0" or "$l3", disambiguated against the names it has.
+std::string GenerateLocalName(const Func& func, Index index);
+
+// The names GenerateNames gives the unnamed labels of a function, keyed by
+// their Block (an if's true_ block).
+using LabelNameMap = std::unordered_map<const Block*, std::string>;
+void GenerateLabelNames(const Func& func, LabelNameMap* out);
+
 inline std::string IndexToAlphaName(Index index) {
   std::string s;
   do {
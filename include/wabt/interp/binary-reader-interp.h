@@ -27,12 +27,20 @@ struct ReadBinaryOptions;
 
 namespace interp {
 
+// Rewrites of each function's code after it is read; see
+// istream-optimizer.h.
+struct IstreamOptions {
+  bool optimize = false;            // OptimizeFunc
+  bool cache_top_of_stack = false;  // CacheTopOfStack
+};
+
 Result ReadBinaryInterp(std::string_view filename,
                         const void* data,
                         size_t size,
                         const ReadBinaryOptions& options,
                         Errors*,
-                        ModuleDesc* out_module);
+                        ModuleDesc* out_module,
+                        const IstreamOptions& = {});
 
 }  // namespace interp
 }  // namespace wabt
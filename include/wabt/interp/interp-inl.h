@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 #include <string>
@@ -140,61 +141,96 @@ inline Frame::Frame(Ref func,
 
 //// FreeList ////
 template <>
-inline bool FreeList<Ref>::IsUsed(Index index) const {
-  return (list_[index].index & refFreeBit) == 0;
+inline Ref FreeList<Ref>::MakeFree(Index next) {
+  return Ref(next | refFreeBit);
 }
 
 template <>
-inline FreeList<Ref>::~FreeList() {}
+inline auto FreeList<Ref>::GetNextFree(const Ref& ref) -> Index {
+  return ref.index & (refFreeBit - 1);
+}
 
 template <>
-template <typename... Args>
-auto FreeList<Ref>::New(Args&&... args) -> Index {
-  if (free_head_ == 0) {
-    list_.push_back(Ref(std::forward<Args>(args)...));
-    return list_.size() - 1;
-  }
+inline void FreeList<Ref>::Destroy(Ref&) {}
 
-  Index index = free_head_ - 1;
+template <typename T>
+T FreeList<T>::MakeFree(Index next) {
+  return reinterpret_cast<T>((next << ptrFreeShift) | ptrFreeBit);
+}
 
-  assert(!IsUsed(index));
-  assert(free_items_ > 0);
+template <typename T>
+auto FreeList<T>::GetNextFree(const T& ptr) -> Index {
+  return reinterpret_cast<uintptr_t>(ptr) >> ptrFreeShift;
+}
 
-  free_head_ = list_[index].index & (refFreeBit - 1);
-  list_[index] = Ref(std::forward<Args>(args)...);
-  free_items_--;
-  return index;
+template <typename T>
+void FreeList<T>::Destroy(T& ptr) {
+  delete ptr;
 }
 
 template <>
-inline void FreeList<Ref>::Delete(Index index) {
-  assert(IsUsed(index));
-
-  list_[index].index = free_head_ | refFreeBit;
-  free_head_ = index + 1;
-  free_items_++;
+inline bool FreeList<Ref>::IsUsed(Index index) const {
+  return (At(index).index & refFreeBit) == 0;
 }
 
 template <typename T>
 bool FreeList<T>::IsUsed(Index index) const {
-  return (reinterpret_cast<uintptr_t>(list_[index]) & ptrFreeBit) == 0;
+  return (reinterpret_cast<uintptr_t>(At(index)) & ptrFreeBit) == 0;
+}
+
+// static
+template <typename T>
+auto FreeList<T>::GetChunkStart(int chunk) -> Index {
+  return ((Index(1) << chunk) - 1) << kFirstChunkShift;
+}
+
+template <typename T>
+T& FreeList<T>::At(Index index) const {
+  if (WABT_LIKELY(!concurrent_)) {
+    return list_[index];
+  }
+  int chunk = sizeof(Index) * 8 - 1 - Clz((index >> kFirstChunkShift) + 1);
+  T* elements = chunks_[chunk].load(std::memory_order_acquire);
+  return elements[index - GetChunkStart(chunk)];
+}
+
+template <typename T>
+void FreeList<T>::AllocateChunks(Index size) {
+  for (int chunk = 0; GetChunkStart(chunk) < size; ++chunk) {
+    if (chunks_[chunk].load(std::memory_order_acquire)) {
+      continue;
+    }
+    Index chunk_size = Index(1) << (kFirstChunkShift + chunk);
+    T* elements = new T[chunk_size];
+    std::fill(elements, elements + chunk_size, MakeFree(0));
+    // Another thread may have allocated it in the meantime.
+    T* expected = nullptr;
+    if (!chunks_[chunk].compare_exchange_strong(expected, elements,
+                                                std::memory_order_acq_rel)) {
+      delete[] elements;
+    }
+  }
 }
 
 template <typename T>
 FreeList<T>::~FreeList() {
-  for (auto object : list_) {
-    if ((reinterpret_cast<uintptr_t>(object) & ptrFreeBit) == 0) {
-      delete object;
+  for (Index i = 0; i < size(); ++i) {
+    if (IsUsed(i)) {
+      Destroy(At(i));
     }
   }
+  for (auto& chunk : chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
 }
 
 template <typename T>
 template <typename... Args>
 auto FreeList<T>::New(Args&&... args) -> Index {
   if (free_head_ == 0) {
-    list_.push_back(T(std::forward<Args>(args)...));
-    return list_.size() - 1;
+    Index index = Reserve(1);
+    At(index) = T(std::forward<Args>(args)...);
+    return index;
   }
 
   Index index = free_head_ - 1;
@@ -202,8 +238,8 @@ auto FreeList<T>::New(Args&&... args) -> Index {
   assert(!IsUsed(index));
   assert(free_items_ > 0);
 
-  free_head_ = reinterpret_cast<uintptr_t>(list_[index]) >> ptrFreeShift;
-  list_[index] = T(std::forward<Args>(args)...);
+  free_head_ = GetNextFree(At(index));
+  At(index) = T(std::forward<Args>(args)...);
   free_items_--;
   return index;
 }
@@ -212,32 +248,74 @@ template <typename T>
 void FreeList<T>::Delete(Index index) {
   assert(IsUsed(index));
 
-  delete list_[index];
-  list_[index] = reinterpret_cast<T>((free_head_ << ptrFreeShift) | ptrFreeBit);
+  Destroy(At(index));
+  At(index) = MakeFree(free_head_);
   free_head_ = index + 1;
   free_items_++;
 }
 
+template <typename T>
+auto FreeList<T>::Reserve(Index count) -> Index {
+  if (!concurrent_) {
+    Index first = list_.size();
+    list_.resize(first + count, MakeFree(0));
+    return first;
+  }
+  Index first = size_.fetch_add(count, std::memory_order_relaxed);
+  AllocateChunks(first + count);
+  return first;
+}
+
+template <typename T>
+void FreeList<T>::Put(Index index, T value) {
+  assert(!IsUsed(index));
+  At(index) = value;
+}
+
+template <typename T>
+void FreeList<T>::Clear(Index index) {
+  assert(IsUsed(index));
+  Destroy(At(index));
+  At(index) = MakeFree(0);
+}
+
 template <typename T>
 const T& FreeList<T>::Get(Index index) const {
   assert(IsUsed(index));
-  return list_[index];
+  return At(index);
 }
 
 template <typename T>
 T& FreeList<T>::Get(Index index) {
   assert(IsUsed(index));
-  return list_[index];
+  return At(index);
 }
 
 template <typename T>
 auto FreeList<T>::size() const -> Index {
-  return list_.size();
+  if (!concurrent_) {
+    return list_.size();
+  }
+  return size_.load(std::memory_order_relaxed);
 }
 
 template <typename T>
 auto FreeList<T>::count() const -> Index {
-  return list_.size() - free_items_;
+  return size() - free_items_;
+}
+
+template <typename T>
+auto FreeList<T>::capacity() const -> Index {
+  if (!concurrent_) {
+    return list_.capacity();
+  }
+  Index capacity = 0;
+  for (int chunk = 0; chunk < kMaxChunks; ++chunk) {
+    if (chunks_[chunk].load(std::memory_order_relaxed)) {
+      capacity = GetChunkStart(chunk + 1);
+    }
+  }
+  return capacity;
 }
 
 //// RefPtr ////
@@ -503,14 +581,16 @@ RefPtr<T> Store::UnsafeGet(Ref ref) {
 
 template <typename T, typename... Args>
 RefPtr<T> Store::Alloc(Args&&... args) {
-  Ref ref{objects_.New(new T(std::forward<Args>(args)...))};
+  Ref ref = NewObject(new T(std::forward<Args>(args)...));
   RefPtr<T> ptr{*this, ref};
   ptr->self_ = ref;
   return ptr;
 }
 
-inline Store::ObjectList::Index Store::object_count() const {
-  return objects_.count();
+inline void Store::Safepoint() {
+  if (WABT_UNLIKELY(safepoint_requested_.load(std::memory_order_relaxed))) {
+    SafepointSlow();
+  }
 }
 
 inline const Features& Store::features() const {
@@ -963,6 +1043,10 @@ inline const RefVec& Instance::memories() const {
   return memories_;
 }
 
+inline Memory* Instance::memory0() const {
+  return memory0_;
+}
+
 inline const RefVec& Instance::globals() const {
   return globals_;
 }
@@ -991,10 +1075,24 @@ inline std::vector<DataSegment>& Instance::datas() {
   return datas_;
 }
 
+//// Continuation ////
+// static
+inline bool Continuation::classof(const Object* obj) {
+  return obj->kind() == skind;
+}
+
 //// Thread ////
 inline Store& Thread::store() {
   return store_;
 }
 
+inline u64 Thread::instruction_count() const {
+  return instruction_count_;
+}
+
+inline u64 Thread::tos_hit_count() const {
+  return tos_hit_count_;
+}
+
 }  // namespace interp
 }  // namespace wabt
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INTERP_JIT_H_
+#define WABT_INTERP_JIT_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "wabt/common.h"
+#include "wabt/interp/interp.h"
+
+namespace wabt {
+
+class Stream;
+
+namespace interp {
+
+struct JitOptions {
+  // If set, functions that are left to the interpreter, and why, are logged
+  // here.
+  Stream* log_stream = nullptr;
+};
+
+// A baseline JIT that translates a function's istream into x86-64 machine
+// code, without a C compiler.
+//
+// Attach a Jit to a Store with Store::set_jit before creating any Threads.
+// Each function is compiled the first time it is called, by stitching
+// together a fixed machine code template for each instruction. The code works
+// on the Thread's own value stack and leaves everything that touches frames
+// to the interpreter: calls, returns, traps and any instruction without a
+// template exit to the interpreter, which runs that one instruction and
+// re-enters the native code at the next branch target or call return. Both
+// tiers therefore see the same frames, value stack and trap messages, and a
+// function can switch between them at any instruction boundary.
+//
+// Functions with reference-typed locals, parameters or results, or that touch
+// references in any other way, including catching exceptions that carry them,
+// are left to the interpreter entirely, since the native code doesn't keep the
+// value stack's reference map up to date. Native code doesn't run while a
+// Thread is tracing.
+//
+// Threads of a concurrent Store may share a Jit; functions are compiled under
+// a lock, and the code is then used by every thread.
+class Jit {
+ public:
+  Jit(Store&, const JitOptions&);
+  ~Jit();
+  WABT_DISALLOW_COPY_AND_ASSIGN(Jit);
+
+  // Whether native code can be generated on this platform.
+  static bool IsSupported();
+
+  // The number of functions that have been compiled, and that have been left
+  // to the interpreter.
+  Index compiled_func_count() const { return compiled_func_count_; }
+  Index rejected_func_count() const { return rejected_func_count_; }
+
+ private:
+  friend Thread;
+
+  // Runs the top frame of |thread| in native code for as long as it can, if
+  // its function is at an entry point. Returns with the frame's offset at the
+  // next instruction for the interpreter.
+  void Run(Thread& thread);
+  // Returns |func|'s code, compiling it if no other thread has.
+  const JitCode& Compile(DefinedFunc& func);
+
+  Store& store_;
+  JitOptions options_;
+  // Guards everything below.
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<JitCode>> code_;
+  std::atomic<Index> compiled_func_count_{0};
+  std::atomic<Index> rejected_func_count_{0};
+};
+
+}  // namespace interp
+}  // namespace wabt
+
+#endif  // WABT_INTERP_JIT_H_
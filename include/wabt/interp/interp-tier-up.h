@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INTERP_TIER_UP_H_
+#define WABT_INTERP_TIER_UP_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "wabt/common.h"
+#include "wabt/interp/interp.h"
+
+namespace wabt {
+
+class Stream;
+
+namespace interp {
+
+struct TierUpOptions {
+  // Calls plus loop back-edges after which a function is considered hot.
+  u32 threshold = 10000;
+  // The C compiler command, run through the shell with gcc-style flags
+  // appended. Anything else the wasm2c output needs, such as the include path
+  // of the ggt headers, belongs here too.
+  std::string cc = "cc -O2";
+  // A C expression of type ggt_thread_t* for the ggt thread that native code
+  // runs on, such as a call into a library that |cc| links in. The generated
+  // glue evaluates it each time the interpreter calls native code. wasm2c
+  // output can't run without a ggt thread, so nothing is compiled if this is
+  // empty.
+  std::string ggt_thread;
+  // The directory containing wasm-rt.h and the wasm2c runtime sources.
+  std::string runtime_dir = WABT_WASM2C_RUNTIME_DIR;
+  // If set, compiler output and the reason a module stays interpreted are
+  // written here.
+  Stream* log_stream = nullptr;
+};
+
+// Opt-in tiering from the interpreter to wasm2c output.
+//
+// Attach a TierUp to a Store with Store::set_tier_up before creating any
+// Threads, and register each module's binary with AddModule. Threads then
+// count calls and loop back-edges per function. When a function gets hot,
+// its module is translated with WriteC, compiled into a shared object by the
+// system C compiler on a background thread, and loaded with dlopen. After
+// that, calls to hot functions of the module run the native code, which uses
+// the instance's memories and globals in place and calls its imports through
+// the interpreter. A function that is already running keeps running in the
+// interpreter until it returns.
+//
+// Only modules whose state the native code can share are compiled; modules
+// that use exceptions, SIMD, threads, tail calls, reference values, multiple
+// results, table instructions, imported or exported tables, memory.init or
+// data.drop stay interpreted. Tables are not shared; since none of those
+// modules can change a table, the native module's own copy always matches.
+//
+// Threads of a concurrent Store may share a TierUp. Native code then runs on
+// several OS threads at once, so |ggt_thread| must give each of them a ggt
+// thread of its own, and, as in the interpreter, only shared memories may be
+// used by one thread while another grows them.
+//
+// The TierUp must outlive the Threads of its Store, and keeps every instance
+// it compiles code for alive.
+class TierUp {
+ public:
+  TierUp(Store&, const TierUpOptions&);
+  ~TierUp();
+  WABT_DISALLOW_COPY_AND_ASSIGN(TierUp);
+
+  // Whether native code can be loaded on this platform.
+  static bool IsSupported();
+
+  // Registers the binary |data| that |module| was read from, so that it can be
+  // translated once one of its functions gets hot.
+  void AddModule(const Module::Ptr& module, std::vector<u8> data);
+
+  u32 threshold() const { return options_.threshold; }
+
+  // The number of functions that have been switched to native code.
+  Index native_func_count() const { return native_func_count_; }
+
+ private:
+  friend Thread;
+  friend NativeFunc;
+  struct NativeModule;
+  struct NativeInstance;
+
+  // Called when |func|'s counter passes the threshold. Starts or checks on
+  // the compilation of its module, and switches |func| to native code if it
+  // is ready.
+  void OnHot(DefinedFunc& func);
+  bool IsReady(NativeModule*);
+  void Compile(NativeModule*);
+
+  // Runs |func|'s native code. |params| and |results| hold one value per
+  // parameter and result of its type.
+  Result Call(Thread&,
+              const DefinedFunc& func,
+              const Value* params,
+              Value* results,
+              Trap::Ptr* out_trap);
+
+  Store& store_;
+  TierUpOptions options_;
+  // Guards the maps, and the state of the modules and instances in them.
+  std::mutex mutex_;
+  // Both keyed by the index of the Module or Instance Ref.
+  std::unordered_map<size_t, std::unique_ptr<NativeModule>> modules_;
+  std::unordered_map<size_t, std::unique_ptr<NativeInstance>> instances_;
+  std::atomic<Index> native_func_count_{0};
+};
+
+}  // namespace interp
+}  // namespace wabt
+
+#endif  // WABT_INTERP_TIER_UP_H_
@@ -17,9 +17,12 @@
 #ifndef WABT_INTERP_H_
 #define WABT_INTERP_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <string_view>
@@ -30,22 +33,31 @@
 #include "wabt/config.h"
 #include "wabt/common.h"
 #include "wabt/feature.h"
+#include "wabt/func-type-table.h"
 #include "wabt/opcode.h"
 #include "wabt/result.h"
 
 #include "wabt/interp/istream.h"
 
 namespace wabt {
+
+class MemoryStats;
+
 namespace interp {
 
 class Store;
 class Object;
 class Trap;
+class Exception;
 class DataSegment;
 class ElemSegment;
 class Module;
 class Instance;
 class Thread;
+class TierUp;
+struct NativeFunc;
+class Jit;
+struct JitCode;
 template <typename T>
 class RefPtr;
 
@@ -91,9 +103,10 @@ enum class ObjectKind {
   Tag,
   Module,
   Instance,
+  Continuation,
 
   First = Null,
-  Last = Instance,
+  Last = Continuation,
 };
 
 constexpr int kCommandTypeCount = WABT_ENUM_COUNT(ObjectKind);
@@ -184,6 +197,10 @@ struct FuncType : ExternType {
 
   ValueTypes params;
   ValueTypes results;
+  // The signature's id in the Store's func type table, set when a function or
+  // module using this type is created in the Store. Interned types match
+  // exactly when their ids are equal.
+  FuncTypeTable::Id id = kInvalidIndex;
 };
 
 struct TableType : ExternType {
@@ -333,9 +350,23 @@ struct MemoryDesc {
   MemoryType type;
 };
 
+// A constant expression that initializes a global or a segment, in postfix
+// order. Expressions that don't read any globals or functions are folded to a
+// single constant when the module is read (see FoldInitExpr), so they are just
+// copied when the module is instantiated; the rest are evaluated there without
+// running the interpreter.
+struct InitExpr {
+  struct Instr {
+    Opcode op;
+    v128 imm;  // The constant's bits, or the global or function index.
+  };
+
+  std::vector<Instr> instrs;
+};
+
 struct GlobalDesc {
   GlobalType type;
-  FuncDesc init_func;
+  InitExpr init;
 };
 
 struct TagDesc {
@@ -355,15 +386,15 @@ struct DataDesc {
   Buffer data;
   SegmentMode mode;
   Index memory_index;
-  FuncDesc init_func;
+  InitExpr offset;
 };
 
 struct ElemDesc {
-  std::vector<FuncDesc> elements;
+  std::vector<InitExpr> elements;
   ValueType type;
   SegmentMode mode;
   Index table_index;
-  FuncDesc init_func;
+  InitExpr offset;
 };
 
 struct ModuleDesc {
@@ -381,6 +412,13 @@ struct ModuleDesc {
   Istream istream;
 };
 
+// Adds |desc| to |stats|; the istream is counted separately from the rest.
+void AccountMemory(const ModuleDesc& desc, MemoryStats* stats);
+
+// Replaces |init| with the constant it evaluates to, if it doesn't read any
+// globals or functions.
+void FoldInitExpr(InitExpr* init);
+
 //// Runtime ////
 
 struct Frame {
@@ -403,17 +441,36 @@ struct Frame {
   Module* mod;
 };
 
+// A list of T with stable indices, where freed slots are reused.
+//
+// A concurrent list stores the elements in chunks that never move once
+// allocated, so an element can be read while another thread reserves new
+// slots; otherwise they are kept in a vector, which is cheaper to index. New
+// and Delete aren't thread-safe; a concurrent Store hands out the slots
+// itself, using Reserve, Put and Clear instead.
 template <typename T>
 class FreeList {
  public:
   using Index = size_t;
 
+  explicit FreeList(bool concurrent = false) : concurrent_(concurrent) {}
   ~FreeList();
+  FreeList(const FreeList&) = delete;
+  FreeList& operator=(const FreeList&) = delete;
 
   template <typename... Args>
   Index New(Args&&...);
   void Delete(Index);
 
+  // Adds |count| free slots to the end of the list, and returns the index of
+  // the first. Unlike the slots freed by Delete, New doesn't use them; fill
+  // them with Put instead. Thread-safe if the list is concurrent.
+  Index Reserve(Index count);
+  // Fills the free slot |index|, which must not be one that New can use.
+  void Put(Index, T);
+  // Frees the slot |index| like Delete, but without letting New use it.
+  void Clear(Index);
+
   bool IsUsed(Index) const;
 
   const T& Get(Index) const;
@@ -421,6 +478,7 @@ class FreeList {
 
   Index size() const;   // 1 greater than the maximum index.
   Index count() const;  // The number of used elements.
+  Index capacity() const;
 
  private:
   // As for Refs, the free bit is 0x80..0. This bit is never
@@ -434,8 +492,27 @@ class FreeList {
   static const Index ptrFreeBit = 1;
   static const int ptrFreeShift = 1;
 
-  std::vector<T> list_;
-  // If free_head_ is zero, there is no free slots in list_,
+  // Chunk i holds 2^(kFirstChunkShift + i) elements, so there are never more
+  // than a few dozen chunks.
+  static const int kFirstChunkShift = 8;
+  static const int kMaxChunks = sizeof(Index) * 8 - kFirstChunkShift;
+
+  // A free slot, linked to the next free slot |next| - 1, if any.
+  static T MakeFree(Index next);
+  static Index GetNextFree(const T&);
+  static void Destroy(T&);
+
+  static Index GetChunkStart(int chunk);
+  T& At(Index) const;
+  void AllocateChunks(Index size);
+
+  const bool concurrent_;
+  // Only used if the list isn't concurrent.
+  mutable std::vector<T> list_;
+  // Only used if the list is concurrent.
+  std::atomic<T*> chunks_[kMaxChunks]{};
+  std::atomic<Index> size_{0};
+  // If free_head_ is zero, there is no free slots in the list,
   // otherwise free_head_ - 1 represents the first free slot.
   Index free_head_ = 0;
   Index free_items_ = 0;
@@ -446,7 +523,43 @@ class Store {
   using ObjectList = FreeList<Object*>;
   using RootList = FreeList<Ref>;
 
+  struct Options {
+    // Whether several OS threads may use the Store at the same time; see
+    // Mutator.
+    bool concurrent = false;
+  };
+
+  // Attaches the calling OS thread to a concurrent Store, for as long as the
+  // Mutator exists.
+  //
+  // An attached thread allocates objects and roots from buffers of its own,
+  // without taking the Store's lock. In exchange, it must reach a safepoint
+  // regularly, so that a Collect on another thread can stop it: Threads reach
+  // one between batches of instructions, and host code can call Safepoint.
+  // Destroy the Mutator before blocking for a long time.
+  //
+  // Threads that aren't attached can still create objects and RefPtrs, under
+  // the Store's lock, but must not run Threads, since a Collect wouldn't wait
+  // for them. Only one Mutator per Store may exist on each OS thread, and
+  // Mutators must be destroyed in the reverse order of their creation.
+  class Mutator {
+   public:
+    explicit Mutator(Store&);
+    ~Mutator();
+    Mutator(const Mutator&) = delete;
+    Mutator& operator=(const Mutator&) = delete;
+
+   private:
+    friend Store;
+
+    Store& store_;
+    Mutator* prev_;
+    std::vector<ObjectList::Index> free_objects_;
+    std::vector<RootList::Index> free_roots_;
+  };
+
   explicit Store(const Features& = Features{});
+  Store(const Features&, const Options&);
 
   Store(const Store&) = delete;
   Store& operator=(const Store&) = delete;
@@ -468,10 +581,21 @@ class Store {
   RootList::Index CopyRoot(RootList::Index);
   void DeleteRoot(RootList::Index);
 
+  // Deletes all objects that aren't reachable from a root or a Thread. In a
+  // concurrent Store, this first waits for every other attached thread to
+  // reach a safepoint, and they stay there until it is done.
   void Collect();
   void Mark(Ref);
   void Mark(const RefVec&);
 
+  bool concurrent() const { return concurrent_; }
+  // Waits here while another OS thread collects a concurrent Store. Attached
+  // threads that run for a long time without running a Thread should call this
+  // regularly.
+  void Safepoint();
+
+  // For a concurrent Store, this is only exact while no other thread is using
+  // it.
   ObjectList::Index object_count() const;
 
   const Features& features() const;
@@ -479,9 +603,33 @@ class Store {
 
   std::set<Thread*>& threads();
 
+  // Sets |type|'s id, so it can be compared against other types in this Store
+  // by id alone.
+  void InternFuncType(FuncType* type);
+
+  // Adds every live object and thread to |stats|, in "interp." categories.
+  void AccountMemory(MemoryStats* stats) const;
+
+  // The TierUp used by Threads created from now on, if any; see
+  // interp-tier-up.h. Not owned.
+  TierUp* tier_up() const { return tier_up_; }
+  void set_tier_up(TierUp* tier_up) { tier_up_ = tier_up; }
+
+  // The Jit used by Threads created from now on, if any; see interp-jit.h.
+  // Not owned.
+  Jit* jit() const { return jit_; }
+  void set_jit(Jit* jit) { jit_ = jit; }
+
  private:
   template <typename T>
   friend class RefPtr;
+  friend Jit;
+  friend Thread;
+  friend Exception;
+
+  // The number of slots moved between a Mutator's buffers and the Store's at
+  // a time.
+  static constexpr size_t kMutatorBufferSize = 256;
 
   struct GCContext {
     int call_depth = 0;
@@ -491,12 +639,43 @@ class Store {
 
   static const int max_call_depth = 10;
 
+  Ref NewObject(Object*);
+  RootList::Index NewRootConcurrent(Ref);
+  void DeleteRootConcurrent(RootList::Index);
+  void AddThread(Thread*);
+  void RemoveThread(Thread*);
+  void MarkAndSweep();
+
+  // Only used by concurrent Stores.
+  Mutator* GetMutator() const;
+  void RefillObjects(Mutator*);
+  void SafepointSlow();
+  void WaitForCollection(std::unique_lock<std::mutex>&, bool attached);
+
   Features features_;
   GCContext gc_context_;
   // This set contains the currently active Thread objects.
   std::set<Thread*> threads_;
   ObjectList objects_;
   RootList roots_;
+  FuncTypeTable func_types_;
+
+  bool concurrent_ = false;
+  std::atomic<bool> safepoint_requested_{false};
+  // Guards everything below, and the lists above for threads that aren't
+  // attached.
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool collecting_ = false;
+  int attached_count_ = 0;
+  int stopped_count_ = 0;
+  // Slots freed by Collect, and by threads that aren't attached.
+  std::vector<ObjectList::Index> free_objects_;
+  std::vector<RootList::Index> free_roots_;
+  // free_roots_.size(), so Mutators can skip the lock when it is empty.
+  std::atomic<size_t> free_root_count_{0};
+  TierUp* tier_up_ = nullptr;
+  Jit* jit_ = nullptr;
 };
 
 template <typename T>
@@ -624,6 +803,8 @@ class Object {
   friend Store;
   explicit Object(ObjectKind);
   virtual void Mark(Store&) {}
+  // Adds the memory the object owns, not counting the object itself.
+  virtual void AccountMemory(MemoryStats*) const {}
 
   ObjectKind kind_;
   Finalizer finalizer_ = nullptr;
@@ -668,6 +849,7 @@ class Trap : public Object {
                 const std::string& msg,
                 const std::vector<Frame>& trace = std::vector<Frame>());
   void Mark(Store&) override;
+  void AccountMemory(MemoryStats*) const override;
 
   std::string message_;
   std::vector<Frame> trace_;
@@ -689,6 +871,7 @@ class Exception : public Object {
   friend Store;
   explicit Exception(Store&, Ref, Values&);
   void Mark(Store&) override;
+  void AccountMemory(MemoryStats*) const override;
 
   Ref tag_;
   Values args_;
@@ -766,11 +949,23 @@ class DefinedFunc : public Func {
 
  private:
   friend Store;
+  friend Thread;
+  friend TierUp;
+  friend Jit;
   explicit DefinedFunc(Store&, Ref instance, FuncDesc);
   void Mark(Store&) override;
 
   Ref instance_;
   FuncDesc desc_;
+
+  // Calls and loop back-edges counted since the last check by the TierUp.
+  // Threads of a concurrent Store may lose each other's counts, which only
+  // delays the check.
+  std::atomic<u32> hotness_{0};
+  // Set once the TierUp has switched this function to native code.
+  std::atomic<const NativeFunc*> native_{nullptr};
+  // Set by the Jit the first time this function is called.
+  std::atomic<const JitCode*> jit_code_{nullptr};
 };
 
 class HostFunc : public Func {
@@ -845,6 +1040,7 @@ class Table : public Extern {
   friend Store;
   explicit Table(Store&, TableType);
   void Mark(Store&) override;
+  void AccountMemory(MemoryStats*) const override;
 
   TableType type_;
   RefVec elements_;
@@ -901,6 +1097,7 @@ class Memory : public Extern {
  private:
   friend class Store;
   explicit Memory(class Store&, MemoryType);
+  void AccountMemory(MemoryStats*) const override;
   void Mark(class Store&) override;
 
   MemoryType type_;
@@ -935,6 +1132,8 @@ class Global : public Extern {
 
  private:
   friend Store;
+  friend TierUp;
+  friend Jit;
   explicit Global(Store&, GlobalType, Value);
   void Mark(Store&) override;
 
@@ -1016,6 +1215,7 @@ class Module : public Object {
   friend Instance;
   explicit Module(Store&, ModuleDesc);
   void Mark(Store&) override;
+  void AccountMemory(MemoryStats*) const override;
 
   ModuleDesc desc_;
   std::vector<ImportType> import_types_;
@@ -1039,6 +1239,8 @@ class Instance : public Object {
   const RefVec& funcs() const;
   const RefVec& tables() const;
   const RefVec& memories() const;
+  // memories()[0], if there is one; it lives as long as the instance.
+  Memory* memory0() const;
   const RefVec& globals() const;
   const RefVec& tags() const;
   const RefVec& exports() const;
@@ -1053,17 +1255,17 @@ class Instance : public Object {
   friend DataSegment;
   explicit Instance(Store&, Ref module);
   void Mark(Store&) override;
+  void AccountMemory(MemoryStats*) const override;
 
-  Result CallInitFunc(Store&,
-                      const Ref func_ref,
-                      Value* result,
-                      Trap::Ptr* out_trap);
+  // Constant expressions can't trap, so this always succeeds.
+  Value EvalInitExpr(Store&, const InitExpr&) const;
 
   Ref module_;
   RefVec imports_;
   RefVec funcs_;
   RefVec tables_;
   RefVec memories_;
+  Memory* memory0_ = nullptr;
   RefVec globals_;
   RefVec tags_;
   RefVec exports_;
@@ -1071,11 +1273,46 @@ class Instance : public Object {
   std::vector<DataSegment> datas_;
 };
 
+// A call suspended by a host function, detached from its Thread with
+// Thread::Capture so that any Thread can resume it later.
+//
+// A continuation only holds the frames, values and caught exceptions of the
+// call itself, so it takes as much memory as the call is deep, rather than a
+// whole Thread's stacks. This lets an embedder run many green threads on a
+// few Threads, switching between them whenever one waits in a host function,
+// the same way it schedules wasm2c output. It can only be resumed once.
+class Continuation : public Object {
+ public:
+  static bool classof(const Object* obj);
+  static const ObjectKind skind = ObjectKind::Continuation;
+  static const char* GetTypeName() { return "Continuation"; }
+  using Ptr = RefPtr<Continuation>;
+
+  // Whether it was resumed already.
+  bool empty() const { return frames_.empty(); }
+
+ private:
+  friend Store;
+  friend Thread;
+  explicit Continuation(Store&);
+  void Mark(Store&) override;
+  void AccountMemory(MemoryStats*) const override;
+
+  // The stack heights in the frames and in refs_ are relative to the start of
+  // values_ and exceptions_.
+  std::vector<Frame> frames_;
+  Values values_;
+  std::vector<u32> refs_;  // Index into values_.
+  RefVec exceptions_;
+  ValueTypes result_types_;  // Of the function called by CallAsync.
+};
+
 enum class RunResult {
   Ok,
   Return,
   Trap,
   Exception,
+  Suspend,  // A host function suspended the thread; see Thread::Suspend.
 };
 
 class Thread {
@@ -1083,6 +1320,9 @@ class Thread {
   struct Options {
     static constexpr u32 kDefaultValueStackSize = 64 * 1024 / sizeof(Value);
     static constexpr u32 kDefaultCallStackSize = 64 * 1024 / sizeof(Frame);
+    // The call stack starts with room for this many frames, and grows as
+    // needed up to call_stack_size.
+    static constexpr u32 kInitialCallStackSize = 64;
 
     u32 value_stack_size = kDefaultValueStackSize;
     u32 call_stack_size = kDefaultCallStackSize;
@@ -1101,19 +1341,90 @@ class Thread {
 
   Instance* GetCallerInstance();
 
+  // Async host functions.
+  //
+  // A call started with CallAsync can be suspended by a host function that
+  // has to wait, for example for I/O: instead of filling in its results, the
+  // callback calls Suspend and returns Result::Ok. CallAsync then returns
+  // RunResult::Suspend, leaving the thread stopped at the call site, and the
+  // OS thread is free to run other Threads. Once the results are ready, Resume
+  // continues from the call site, until the thread finishes or suspends
+  // again.
+  //
+  // CallAsync and Resume return RunResult::Return with |results| filled in
+  // when |func| returns, RunResult::Suspend, or RunResult::Trap with
+  // |out_trap| set; an uncaught exception is reported as a trap, as by
+  // Func::Call.
+  RunResult CallAsync(const Func::Ptr& func,
+                      const Values& params,
+                      Values& results,
+                      Trap::Ptr* out_trap);
+  RunResult Resume(const Values& host_results,
+                   Values& results,
+                   Trap::Ptr* out_trap);
+  // Ends a suspended call with |trap|, as if the host function had failed
+  // with it.
+  RunResult ResumeWithTrap(Trap::Ptr trap, Trap::Ptr* out_trap);
+  // Called by a host function to suspend the thread when it returns. Fails if
+  // the thread can't be suspended: if it isn't running a CallAsync, or is
+  // inside a synchronous call, such as a Func::Call from another host function
+  // or native code.
+  Result Suspend();
+  bool suspended() const { return suspended_; }
+
+  // Green threads.
+  //
+  // Capture detaches the suspended call from this thread and returns it as a
+  // continuation, after which the thread can run other calls. Resuming the
+  // continuation, on this thread or another idle one, moves it back onto the
+  // thread's stacks and then continues as Resume above; it traps without
+  // consuming |cont| if the call stack would grow too deep for it.
+  Continuation::Ptr Capture();
+  RunResult Resume(const Continuation::Ptr& cont,
+                   const Values& host_results,
+                   Values& results,
+                   Trap::Ptr* out_trap);
+
+  // The number of istream instructions this thread has executed.
+  u64 instruction_count() const;
+  // The number of those that took their top operand from the TOS register
+  // (see Istream::kTosIn); each one saves a push and a pop of the value stack.
+  u64 tos_hit_count() const;
+
+  // Adds the value, call and exception stacks to |stats|.
+  void AccountMemory(MemoryStats* stats) const;
+
  private:
   friend Store;
   friend DefinedFunc;
+  friend TierUp;
+  friend Jit;
 
   struct TraceSource;
 
+  // Back-edges are counted in batches, and charged to whichever function is
+  // running when a batch fills up.
+  static const u32 kBackEdgeBatch = 64;
+
   RunResult PushCall(Ref func, u32 offset, Trap::Ptr* out_trap);
   RunResult PushCall(const DefinedFunc&, Trap::Ptr* out_trap);
   RunResult PushCall(const HostFunc&, Trap::Ptr* out_trap);
+  // Makes room for |count| more frames. Returns false if the call stack would
+  // be deeper than call_stack_size_.
+  bool GrowCallStack(size_t count = 1);
   RunResult PopCall();
   RunResult DoCall(const Func::Ptr&, Trap::Ptr* out_trap);
   RunResult DoReturnCall(const Func::Ptr&, Trap::Ptr* out_trap);
 
+  // Tier-up support; only used if tier_up_ is set.
+  void CountCall(DefinedFunc&);
+  void CountBackEdge();
+  RunResult DoNativeCall(const DefinedFunc&, Trap::Ptr* out_trap);
+  RunResult CallNative(const DefinedFunc&,
+                       const Value* params,
+                       Value* results,
+                       Trap::Ptr* out_trap);
+
   void PushValues(const ValueTypes&, const Values&);
   void PopValues(const ValueTypes&, Values*);
 
@@ -1155,11 +1466,16 @@ class Thread {
   template <typename R, typename T>
   RunResult DoReinterpret();
 
-  template <typename T>
+  // Pops the address operand of the load or store |instr|, and returns the
+  // memory that it accesses. A is void to look the memory up by index, or
+  // the address type of memory 0 for the interpreter's own opcodes.
+  template <typename A>
+  Memory* PopAddress(Instr, u64* out_offset);
+  template <typename T, typename A = void>
   RunResult Load(Instr, T* out, Trap::Ptr* out_trap);
-  template <typename T, typename V = T>
+  template <typename T, typename V = T, typename A = void>
   RunResult DoLoad(Instr, Trap::Ptr* out_trap);
-  template <typename T, typename V = T>
+  template <typename T, typename V = T, typename A = void>
   RunResult DoStore(Instr, Trap::Ptr* out_trap);
 
   RunResult DoMemoryInit(Instr, Trap::Ptr* out_trap);
@@ -1197,13 +1513,13 @@ class Thread {
   RunResult DoSimdBitmask();
   template <typename R, typename T>
   RunResult DoSimdShift(BinopFunc<R, T>);
-  template <typename S>
+  template <typename S, typename A = void>
   RunResult DoSimdLoadSplat(Instr, Trap::Ptr* out_trap);
   template <typename S>
   RunResult DoSimdLoadLane(Instr, Trap::Ptr* out_trap);
   template <typename S>
   RunResult DoSimdStoreLane(Instr, Trap::Ptr* out_trap);
-  template <typename S, typename T>
+  template <typename S, typename T, typename A = void>
   RunResult DoSimdLoadZero(Instr, Trap::Ptr* out_trap);
   RunResult DoSimdSwizzle();
   RunResult DoSimdShuffle(Instr);
@@ -1219,7 +1535,7 @@ class Thread {
   RunResult DoSimdRelaxedMadd();
   template <typename S>
   RunResult DoSimdRelaxedNmadd();
-  template <typename S, typename T>
+  template <typename S, typename T, typename A = void>
   RunResult DoSimdLoadExtend(Instr, Trap::Ptr* out_trap);
   template <typename S, typename T>
   RunResult DoSimdExtaddPairwise();
@@ -1238,8 +1554,24 @@ class Thread {
   RunResult DoThrow(Exception::Ptr exn_ref);
 
   RunResult StepInternal(Trap::Ptr* out_trap);
+  RunResult Execute(Instr, Trap::Ptr* out_trap);
 
+  // Runs an instruction with a tos_state. None of them trap.
+  void StepTos(Instr, Value* tos);
+  template <typename R, typename T>
+  void DoTosUnop(UnopFunc<R, T>, Instr, Value* tos);
+  template <typename R, typename T>
+  void DoTosBinop(BinopFunc<R, T>, Instr, Value* tos);
+  void SetTosResult(Value, Instr, Value* tos);
+  // Like Run, but runs as much as possible in native code; only used if jit_
+  // is set.
+  RunResult RunJit(int num_instructions, Trap::Ptr* out_trap);
+
+  // Only grown by GrowCallStack, so that its capacity never exceeds
+  // call_stack_size_. Growing moves the frames, so no reference to a frame
+  // may be kept across a PushCall.
   std::vector<Frame> frames_;
+  u32 call_stack_size_;
   std::vector<Value> values_;
   std::vector<u32> refs_;  // Index into values_.
 
@@ -1252,6 +1584,31 @@ class Thread {
   Instance* inst_ = nullptr;
   Module* mod_ = nullptr;
 
+  u64 instruction_count_ = 0;
+  u64 tos_hit_count_ = 0;
+
+  // The TOS register, while the batch loop in Run isn't holding it.
+  Value tos_;
+
+  TierUp* tier_up_;
+  u32 back_edges_ = 0;
+
+  Jit* jit_;
+
+  // Async host functions.
+  RunResult FinishAsync(RunResult, Values& results, Trap::Ptr* out_trap);
+  // Drops whatever the async call left above its stack heights.
+  void UnwindAsync();
+  bool async_ = false;
+  bool suspended_ = false;
+  // The number of synchronous calls in progress, which can't be suspended.
+  u32 sync_call_depth_ = 0;
+  ValueTypes async_result_types_;
+  // The stack heights when the async call started.
+  u32 async_frames_ = 0;
+  u32 async_values_ = 0;
+  u32 async_exceptions_ = 0;
+
   // Tracing.
   Stream* trace_stream_;
   std::unique_ptr<TraceSource> trace_source_;
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INTERP_ISTREAM_CACHE_H_
+#define WABT_INTERP_ISTREAM_CACHE_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "wabt/common.h"
+#include "wabt/feature.h"
+#include "wabt/interp/binary-reader-interp.h"
+#include "wabt/interp/interp.h"
+
+namespace wabt {
+namespace interp {
+
+// A directory of compiled ModuleDescs, so that a module that was read before
+// doesn't need to be validated and compiled again.
+//
+// Each entry is a file named by its key: the SHA-256 of the module's bytes,
+// the enabled features and the IstreamOptions. Entries start with a version
+// stamp that changes whenever the istream format or opcode numbering might
+// have, so entries written by another build of wabt are treated as misses
+// and overwritten. The stamp is followed by the SHA-256 of the rest of the
+// entry: the istream is run without being validated again, so an entry that
+// was damaged on disk is a miss too.
+class IstreamCache {
+ public:
+  explicit IstreamCache(std::string dir);
+
+  static std::string GetKey(const void* data,
+                            size_t size,
+                            const Features&,
+                            const IstreamOptions&);
+
+  // Reads the entry for |key| into |out_desc|, which must be empty. Fails if
+  // there is no valid entry.
+  Result Load(std::string_view key, ModuleDesc* out_desc) const;
+
+  // Writes |desc| as the entry for |key|, creating the directory if needed.
+  // The entry is written to a uniquely named temporary file and renamed into
+  // place, so concurrent readers never see a partial one.
+  Result Save(std::string_view key, const ModuleDesc& desc) const;
+
+ private:
+  std::string GetPath(std::string_view key) const;
+
+  std::string dir_;
+};
+
+// The entry format, without the version stamp and digest.
+void SerializeModuleDesc(const ModuleDesc&, std::vector<u8>* out_data);
+Result DeserializeModuleDesc(const u8* data, size_t size, ModuleDesc*);
+
+}  // namespace interp
+}  // namespace wabt
+
+#endif  // WABT_INTERP_ISTREAM_CACHE_H_
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INTERP_ISTREAM_OPTIMIZER_H_
+#define WABT_INTERP_ISTREAM_OPTIMIZER_H_
+
+#include <utility>
+#include <vector>
+
+#include "wabt/common.h"
+#include "wabt/interp/interp.h"
+#include "wabt/interp/istream.h"
+
+namespace wabt {
+namespace interp {
+
+// Maps the offsets of the instructions that OptimizeFunc kept to their new
+// offsets.
+class IstreamOffsetMap {
+ public:
+  Istream::Offset Map(Istream::Offset) const;
+
+ private:
+  friend void OptimizeFunc(Istream*, FuncDesc*, IstreamOffsetMap*);
+
+  // Sorted by the old offset.
+  std::vector<std::pair<Istream::Offset, Istream::Offset>> offsets_;
+};
+
+// Rewrites the code of |func|, which must be the last thing in |istream|, so
+// that it executes fewer instructions:
+//
+// - Integer operations on constants are folded, unless they trap.
+// - `local.set x; local.get x` becomes `local.tee x`, `local.tee x; drop`
+//   becomes `local.set x`, and `local.get x; local.set y` becomes a single
+//   `local_copy`.
+// - Constants, local.get and global.get that are dropped right away are
+//   removed, and consecutive drops and drop_keeps are merged.
+// - Conditional branches on constants become `br` or nothing, and `br` to the
+//   next instruction is removed.
+// - Code after an unconditional branch that isn't a branch target is removed.
+//
+// Nothing is moved across a branch target or exception handler boundary, so
+// the value stack heights there are unchanged. Branches and |func|'s handlers
+// are updated to the new offsets; other references into the function's code,
+// such as pending fixups, can be updated with |out_map|. Branches that aren't
+// resolved yet are always kept.
+void OptimizeFunc(Istream*, FuncDesc*, IstreamOffsetMap* out_map);
+
+// Sets the top-of-stack caching state (see Istream::kTosIn) of the
+// instructions of |func|, which must be the last thing in |istream|.
+//
+// Within a run of integer arithmetic, constants and local accesses that no
+// branch lands in the middle of, each instruction leaves its result in the
+// TOS register for the next one instead of pushing it. Every other
+// instruction, and every branch target, sees the whole stack in memory, so
+// only the states of the run need to agree with each other. Only the opcodes'
+// state bits change, so no offsets move; run this after OptimizeFunc.
+void CacheTopOfStack(Istream*, FuncDesc*);
+
+}  // namespace interp
+}  // namespace wabt
+
+#endif  // WABT_INTERP_ISTREAM_OPTIMIZER_H_
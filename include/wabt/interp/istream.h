@@ -74,6 +74,7 @@ enum class InstrKind {
 struct Instr {
   Opcode op;
   InstrKind kind;
+  u8 tos_state = 0;  // Istream::kTosIn and kTosOut.
   union {
     u8 imm_u8;
     u32 imm_u32;
@@ -105,6 +106,13 @@ class Istream {
   // Each opcode is a SerializedOpcode, and each immediate is a u32.
   static constexpr Offset kBrTableEntrySize =
       sizeof(SerializedOpcode) * 3 + 4 * sizeof(u32);
+  // Top-of-stack caching state, kept in the upper half of a SerializedOpcode;
+  // see CacheTopOfStack. kTosIn means the instruction's top operand is in the
+  // Thread's TOS register instead of on the value stack, and kTosOut that it
+  // leaves its result there.
+  static constexpr u32 kTosIn = 1;
+  static constexpr u32 kTosOut = 2;
+  static constexpr u32 kTosStateShift = 16;
 
   // Emit API.
   void Emit(u32);
@@ -121,7 +129,14 @@ class Istream {
   Offset EmitFixupU32();
   void ResolveFixupU32(Offset);
 
+  // Rewrite API, used to replace the code at the end of the istream.
+  Buffer Slice(Offset from, Offset to) const;
+  void Truncate(Offset);
+  void EmitBytes(const u8* data, size_t size);
+  void PatchU32(Offset, u32);
+
   Offset end() const;
+  size_t capacity() const;
 
   // Read API.
   Instr Read(Offset*) const;
@@ -52,6 +52,10 @@ struct ModuleContext {
   Index GetFuncResultCount(const Var& var) const;
 
   void BeginBlock(LabelType label_type, const Block& block);
+  // Like above, but labels the block |name| instead of block.label.
+  void BeginBlock(LabelType label_type,
+                  const Block& block,
+                  const std::string& name);
   void EndBlock();
   void BeginFunc(const Func& func);
   void EndFunc();
@@ -33,6 +33,7 @@
 
 namespace wabt {
 
+class MemoryStats;
 struct Module;
 
 enum class VarType {
@@ -841,10 +842,11 @@ class LocalTypes {
   void AppendDecl(Type type, Index count) {
     if (count != 0) {
       decls_.emplace_back(type, count);
+      decl_ends_.push_back(size() + count);
     }
   }
 
-  Index size() const;
+  Index size() const { return decl_ends_.empty() ? 0 : decl_ends_.back(); }
   Type operator[](Index) const;
 
   const_iterator begin() const { return {decls_.begin(), 0}; }
@@ -852,6 +854,9 @@ class LocalTypes {
 
  private:
   Decls decls_;
+  // decl_ends_[i] is the local index one past the end of decls_[i], so
+  // operator[] can binary search instead of walking every decl.
+  std::vector<Index> decl_ends_;
 };
 
 inline LocalTypes::const_iterator& LocalTypes::const_iterator::operator++() {
@@ -1513,6 +1518,10 @@ void MakeTypeBindingReverseMapping(
     const BindingHash& bindings,
     std::vector<std::string>* out_reverse_mapping);
 
+// Adds the IR owned by |module| to |stats|, in "ir." categories. Defined in
+// memory-stats.cc.
+void AccountMemory(const Module&, MemoryStats*);
+
 }  // namespace wabt
 
 #endif /* WABT_IR_H_ */
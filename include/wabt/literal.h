@@ -46,6 +46,10 @@ enum class ParseIntType {
 /* Size of char buffer required to hold hex representation of a float/double */
 #define WABT_MAX_FLOAT_HEX 20
 #define WABT_MAX_DOUBLE_HEX 40
+/* Size of char buffer required to hold the shortest decimal representation
+ * of a float/double */
+#define WABT_MAX_FLOAT_DECIMAL 24
+#define WABT_MAX_DOUBLE_DECIMAL 32
 
 Result ParseHexdigit(char c, uint32_t* out);
 Result ParseInt8(const char* s,
@@ -122,6 +126,9 @@ inline Result ParseDouble(LiteralType literal_type,
 
 void WriteFloatHex(char* buffer, size_t size, uint32_t bits);
 void WriteDoubleHex(char* buffer, size_t size, uint64_t bits);
+// Writes the shortest decimal literal that parses back to exactly |bits|.
+void WriteFloatDecimal(char* buffer, size_t size, uint32_t bits);
+void WriteDoubleDecimal(char* buffer, size_t size, uint64_t bits);
 void WriteUint128(char* buffer, size_t size, v128 bits);
 
 }  // namespace wabt
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_MAPPED_FILE_H_
+#define WABT_MAPPED_FILE_H_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "wabt/common.h"
+
+namespace wabt {
+
+// A read-only view of a whole file, memory-mapped where the platform supports
+// it and read into memory otherwise.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  WABT_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+  ~MappedFile();
+
+  Result Open(std::string_view filename);
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<uint8_t> buffer_;
+};
+
+}  // namespace wabt
+
+#endif  // WABT_MAPPED_FILE_H_
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_MEMORY_STATS_H_
+#define WABT_MEMORY_STATS_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "wabt/common.h"
+
+namespace wabt {
+
+class Stream;
+
+// Approximate heap usage broken down by subsystem, for options such as
+// --mem-stats.
+//
+// The numbers come from walking the data structures, so they include object
+// sizes and container capacity but not allocator overhead or fragmentation.
+// Category names are dotted, e.g. "ir.exprs" or "interp.memories".
+class MemoryStats {
+ public:
+  struct Category {
+    std::string name;
+    uint64_t bytes = 0;
+    uint64_t count = 0;
+  };
+
+  MemoryStats() = default;
+  WABT_DISALLOW_COPY_AND_ASSIGN(MemoryStats);
+
+  // Adds to the category |name|, creating it if needed.
+  void Add(std::string_view name, uint64_t bytes, uint64_t count = 1);
+
+  // Categories in the order they were first added.
+  const std::vector<Category>& categories() const { return categories_; }
+
+  // Returns null if nothing was ever added to |name|.
+  const Category* Find(std::string_view name) const;
+
+  uint64_t total_bytes() const;
+
+  // Writes one line per category, followed by the total.
+  void Print(Stream*) const;
+
+  // Heap bytes owned by a container, not counting the container itself.
+  static uint64_t HeapBytes(const std::string&);
+  template <typename T>
+  static uint64_t HeapBytes(const std::vector<T>& vec) {
+    return vec.capacity() * sizeof(T);
+  }
+  template <typename K, typename V, typename H, typename E, typename A>
+  static uint64_t HeapBytes(const std::unordered_map<K, V, H, E, A>& map) {
+    return HashHeapBytes(map.size(), map.bucket_count(),
+                         sizeof(typename std::unordered_map<K, V>::value_type));
+  }
+  template <typename K, typename V, typename C, typename A>
+  static uint64_t HeapBytes(const std::map<K, V, C, A>& map) {
+    return TreeHeapBytes(map.size(),
+                         sizeof(typename std::map<K, V>::value_type));
+  }
+  template <typename K, typename C, typename A>
+  static uint64_t HeapBytes(const std::set<K, C, A>& set) {
+    return TreeHeapBytes(set.size(), sizeof(K));
+  }
+
+  // Estimates a node-based hash table: one node per element, each with a next
+  // pointer and a cached hash, plus the bucket array.
+  static uint64_t HashHeapBytes(size_t size,
+                                size_t bucket_count,
+                                size_t value_size);
+  // Estimates a red-black tree: one node per element, each with three
+  // pointers and a color.
+  static uint64_t TreeHeapBytes(size_t size, size_t value_size);
+
+ private:
+  std::vector<Category> categories_;
+};
+
+}  // namespace wabt
+
+#endif  // WABT_MEMORY_STATS_H_
@@ -94,6 +94,8 @@ struct Opcode {
   static constexpr uint32_t kMathPrefix = 0xfc;
   static constexpr uint32_t kThreadsPrefix = 0xfe;
   static constexpr uint32_t kSimdPrefix = 0xfd;
+  // Only used by the interpreter's own opcodes, never in a binary module.
+  static constexpr uint32_t kInterpPrefix = 0xe0;
 
   struct Info {
     const char* name;
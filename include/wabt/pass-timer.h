@@ -0,0 +1,84 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_PASS_TIMER_H_
+#define WABT_PASS_TIMER_H_
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "wabt/common.h"
+
+namespace wabt {
+
+class Stream;
+
+// Records wall-clock time, CPU time and peak resident set size for the
+// phases of a tool's pipeline, for options such as --time-passes.
+//
+// Phases are timed with PassTimer::Scope, which may be nested; a null timer
+// makes the scope a no-op, so library code can take an optional PassTimer*.
+class PassTimer {
+ public:
+  struct Record {
+    std::string name;
+    int depth = 0;
+    double wall_seconds = 0;
+    double cpu_seconds = 0;
+    // Peak RSS of the process when the phase finished, or 0 if unknown.
+    uint64_t peak_rss_bytes = 0;
+  };
+
+  class Scope {
+   public:
+    WABT_DISALLOW_COPY_AND_ASSIGN(Scope);
+    Scope(PassTimer* timer, std::string_view name);
+    ~Scope() { Stop(); }
+
+    // Ends the phase before the scope does; later calls have no effect.
+    void Stop();
+
+   private:
+    PassTimer* timer_;
+    size_t index_ = 0;
+    std::chrono::steady_clock::time_point wall_start_;
+    std::clock_t cpu_start_ = 0;
+  };
+
+  PassTimer() = default;
+  WABT_DISALLOW_COPY_AND_ASSIGN(PassTimer);
+
+  // Records in the order their phases started.
+  const std::vector<Record>& records() const { return records_; }
+
+  // Writes one line per record, indented by nesting depth.
+  void Print(Stream*) const;
+
+  // The process's peak resident set size so far, or 0 if it can't be
+  // determined on this platform.
+  static uint64_t GetPeakRss();
+
+ private:
+  std::vector<Record> records_;
+  int depth_ = 0;
+};
+
+}  // namespace wabt
+
+#endif  // WABT_PASS_TIMER_H_
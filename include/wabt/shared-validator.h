@@ -25,6 +25,7 @@
 #include "wabt/common.h"
 #include "wabt/error.h"
 #include "wabt/feature.h"
+#include "wabt/func-type-table.h"
 #include "wabt/ir.h"
 #include "wabt/opcode.h"
 #include "wabt/type-checker.h"
@@ -216,16 +217,14 @@ class SharedValidator {
   Result OnUnreachable(const Location&);
 
  private:
+  // The signature itself lives in func_type_table_, so this is cheap to copy.
   struct FuncType {
     FuncType() = default;
-    FuncType(const TypeVector& params,
-             const TypeVector& results,
-             Index type_index)
-        : params(params), results(results), type_index(type_index) {}
+    FuncType(FuncTypeTable::Id id, Index type_index)
+        : id(id), type_index(type_index) {}
 
-    TypeVector params;
-    TypeVector results;
-    Index type_index;
+    FuncTypeTable::Id id = FuncTypeTable::kEmptyId;
+    Index type_index = kInvalidIndex;
   };
 
   struct StructType {
@@ -329,6 +328,12 @@ class SharedValidator {
   Index GetFunctionTypeIndex(Index func_index) const;
 
   TypeVector ToTypeVector(Index count, const Type* types);
+  const TypeVector& GetParams(const FuncType& func_type) const {
+    return func_type_table_.params(func_type.id);
+  }
+  const TypeVector& GetResults(const FuncType& func_type) const {
+    return func_type_table_.results(func_type.id);
+  }
 
   ValidateOptions options_;
   Errors* errors_;
@@ -338,6 +343,7 @@ class SharedValidator {
   bool in_init_expr_ = false;
 
   Index num_types_ = 0;
+  FuncTypeTable func_type_table_;
   std::map<Index, FuncType> func_types_;
   std::map<Index, StructType> struct_types_;
   std::map<Index, ArrayType> array_types_;
@@ -45,6 +45,9 @@ class TypeChecker {
     TypeVector param_types;
     TypeVector result_types;
     size_t type_stack_limit;
+    // The number of Catch labels from the bottom of the label stack up to and
+    // including this one, so GetCatchCount doesn't have to walk the stack.
+    Index catch_count = 0;
     bool unreachable;
   };
 
@@ -32,6 +32,9 @@ struct WriteWatOptions {
   bool fold_exprs = false;  // Write folded expressions.
   bool inline_export = false;
   bool inline_import = false;
+  // Name unnamed params, locals and labels the way GenerateNames does, for
+  // modules named with NameOpts::LocalNamesOnDemand.
+  bool generate_local_names = false;
 };
 
 Result WriteWat(Stream*, const Module*, const WriteWatOptions&);
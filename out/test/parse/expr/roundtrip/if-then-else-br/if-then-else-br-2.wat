@@ -0,0 +1,11 @@
+(module
+  (type (;0;) (func (result i32)))
+  (func (;0;) (type 0) (result i32)
+    i32.const 1
+    if (result i32)  ;; label = @1
+      i32.const 1
+      br 0 (;@1;)
+    else
+      i32.const 1
+      br 0 (;@1;)
+    end))
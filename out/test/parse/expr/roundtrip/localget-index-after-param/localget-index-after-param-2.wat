@@ -0,0 +1,6 @@
+(module
+  (type (;0;) (func (param i32)))
+  (func (;0;) (type 0) (param i32)
+    (local i32)
+    local.get 1
+    drop))
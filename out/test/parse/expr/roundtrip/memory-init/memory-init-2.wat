@@ -0,0 +1,9 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    i32.const 0
+    i32.const 0
+    i32.const 0
+    memory.init 0)
+  (memory (;0;) 0)
+  (data (;0;) "hi"))
@@ -0,0 +1,23 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    i32.const 2
+    i32.const 3
+    i32.const 1
+    select
+    drop
+    i64.const 2
+    i64.const 3
+    i32.const 1
+    select
+    drop
+    f32.const 0x1p+1 (;=2;)
+    f32.const 0x1.8p+1 (;=3;)
+    i32.const 1
+    select
+    drop
+    f64.const 0x1p+1 (;=2;)
+    f64.const 0x1.8p+1 (;=3;)
+    i32.const 1
+    select
+    drop))
@@ -0,0 +1,25 @@
+(module
+  (type (;0;) (func (param i32)))
+  (type (;1;) (func))
+  (type (;2;) (func (result f32 f32)))
+  (type (;3;) (func (param i32) (result i32)))
+  (func (;0;) (type 1)
+    try (result f32 f32)  ;; label = @1
+      f32.const 0x0p+0 (;=0;)
+      f32.const 0x1p+0 (;=1;)
+    catch 0
+      drop
+      f32.const 0x1p+1 (;=2;)
+      f32.const 0x1.8p+1 (;=3;)
+    end
+    return)
+  (func (;1;) (type 1)
+    i32.const 0
+    try (param i32) (result i32)  ;; label = @1
+      i32.eqz
+    catch 0
+      drop
+      i32.const 0
+    end
+    return)
+  (tag (;0;) (type 0) (param i32)))
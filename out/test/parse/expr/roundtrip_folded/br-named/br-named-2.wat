@@ -0,0 +1,5 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (block  ;; label = @1
+      (br 0 (;@1;)))))
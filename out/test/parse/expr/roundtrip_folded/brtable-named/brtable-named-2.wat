@@ -0,0 +1,10 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (block  ;; label = @1
+      (block  ;; label = @2
+        (block  ;; label = @3
+          (br_table 0 (;@3;) 1 (;@2;) 2 (;@1;)
+            (i32.const 0)))
+        (nop))
+      (nop))))
@@ -0,0 +1,8 @@
+(module
+  (type (;0;) (func))
+  (type (;1;) (func (param i32)))
+  (func (;0;) (type 0)
+    (call 1
+      (i32.const 0)))
+  (func (;1;) (type 1) (param i32)
+    (nop)))
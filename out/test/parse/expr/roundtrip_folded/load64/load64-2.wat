@@ -0,0 +1,46 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (drop
+      (i32.load
+        (i64.const 0)))
+    (drop
+      (i32.load8_s
+        (i64.const 0)))
+    (drop
+      (i32.load16_s
+        (i64.const 0)))
+    (drop
+      (i32.load8_u
+        (i64.const 0)))
+    (drop
+      (i32.load16_u
+        (i64.const 0)))
+    (drop
+      (i64.load
+        (i64.const 0)))
+    (drop
+      (i64.load8_s
+        (i64.const 0)))
+    (drop
+      (i64.load16_s
+        (i64.const 0)))
+    (drop
+      (i64.load32_s
+        (i64.const 0)))
+    (drop
+      (i64.load8_u
+        (i64.const 0)))
+    (drop
+      (i64.load16_u
+        (i64.const 0)))
+    (drop
+      (i64.load32_u
+        (i64.const 0)))
+    (drop
+      (f32.load
+        (i64.const 0)))
+    (drop
+      (f64.load
+        (i64.const 0))))
+  (memory (;0;) i64 1))
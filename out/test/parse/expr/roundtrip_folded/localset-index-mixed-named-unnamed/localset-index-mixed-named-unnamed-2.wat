@@ -0,0 +1,18 @@
+(module
+  (type (;0;) (func (param i32 f32)))
+  (func (;0;) (type 0) (param i32 f32)
+    (local i32 i64 f64)
+    (local.set 0
+      (i32.const 0))
+    (local.set 1
+      (f32.const 0x0p+0 (;=0;)))
+    (local.set 1
+      (f32.const 0x0p+0 (;=0;)))
+    (local.set 2
+      (i32.const 0))
+    (local.set 3
+      (i64.const 0))
+    (local.set 4
+      (f64.const 0x0p+0 (;=0;)))
+    (local.set 4
+      (f64.const 0x0p+0 (;=0;)))))
@@ -0,0 +1,15 @@
+(module
+  (type (;0;) (func))
+  (type (;1;) (func (result i32 i64)))
+  (type (;2;) (func (param i64) (result i32)))
+  (func (;0;) (type 0)
+    (loop (result i32 i64)  ;; label = @1
+      (i32.const 0)
+      (i64.const 0))
+    (return))
+  (func (;1;) (type 0)
+    (i64.const 0)
+    (loop (param i64) (result i32)  ;; label = @1
+      (drop)
+      (i32.const 1))
+    (return)))
@@ -0,0 +1,7 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (drop
+      (memory.grow
+        (i64.const 100))))
+  (memory (;0;) i64 1))
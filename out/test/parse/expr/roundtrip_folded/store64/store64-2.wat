@@ -0,0 +1,31 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (i32.store8
+      (i64.const 0)
+      (i32.const 0))
+    (i32.store16
+      (i64.const 0)
+      (i32.const 0))
+    (i32.store
+      (i64.const 0)
+      (i32.const 0))
+    (i64.store
+      (i64.const 0)
+      (i64.const 0))
+    (i64.store8
+      (i64.const 0)
+      (i64.const 0))
+    (i64.store16
+      (i64.const 0)
+      (i64.const 0))
+    (i64.store32
+      (i64.const 0)
+      (i64.const 0))
+    (f32.store
+      (i64.const 0)
+      (f32.const 0x0p+0 (;=0;)))
+    (f64.store
+      (i64.const 0)
+      (f64.const 0x0p+0 (;=0;))))
+  (memory (;0;) i64 1))
@@ -0,0 +1,9 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (return_call 0))
+  (func (;1;) (type 0)
+    (return_call_indirect (type 0)
+      (i32.const 0)))
+  (table (;0;) 1 funcref)
+  (elem (;0;) (i32.const 0) func 0))
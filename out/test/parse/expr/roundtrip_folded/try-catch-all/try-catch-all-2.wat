@@ -0,0 +1,16 @@
+(module
+  (type (;0;) (func (param i32)))
+  (type (;1;) (func (param i32 i32)))
+  (type (;2;) (func))
+  (func (;0;) (type 2)
+    (try  ;; label = @1
+      (do
+        (nop))
+      (catch 0
+        (drop))
+      (catch 1
+        (drop)
+        (drop))
+      (catch_all)))
+  (tag (;0;) (type 0) (param i32))
+  (tag (;1;) (type 1) (param i32 i32)))
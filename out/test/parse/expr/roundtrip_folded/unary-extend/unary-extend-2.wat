@@ -0,0 +1,18 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (drop
+      (i32.extend8_s
+        (i32.const 0)))
+    (drop
+      (i32.extend16_s
+        (i32.const 0)))
+    (drop
+      (i64.extend8_s
+        (i64.const 0)))
+    (drop
+      (i64.extend16_s
+        (i64.const 0)))
+    (drop
+      (i64.extend32_s
+        (i64.const 0)))))
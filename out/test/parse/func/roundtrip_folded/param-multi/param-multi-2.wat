@@ -0,0 +1,3 @@
+(module
+  (type (;0;) (func (param i32 f64)))
+  (func (;0;) (type 0) (param i32 f64)))
@@ -0,0 +1,2 @@
+(module
+  (import "foo" "2" (memory (;0;) 0 2 shared)))
@@ -0,0 +1,7 @@
+(module
+  (type (;0;) (func (param i32)))
+  (func (;0;) (type 0) (param i32))
+  (table (;0;) 1 1 funcref)
+  (table (;1;) 1 1 funcref)
+  (elem (;0;) (i32.const 0) func 0)
+  (elem (;1;) (table 1) (i32.const 0) func 0))
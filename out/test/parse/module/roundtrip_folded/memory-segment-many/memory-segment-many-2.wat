@@ -0,0 +1,6 @@
+(module
+  (memory (;0;) 1)
+  (data (;0;) (i32.const 0) "hi")
+  (data (;1;) (i32.const 4) "hello")
+  (data (;2;) (i32.const 10) "goodbye")
+  (data (;3;) (i32.const 20) "adios"))
@@ -0,0 +1,8 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (table.set 0
+      (i32.const 0)
+      (table.get 0
+        (i32.const 0))))
+  (table (;0;) 1 externref))
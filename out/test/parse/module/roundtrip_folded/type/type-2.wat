@@ -0,0 +1,2 @@
+(module
+  (type (;0;) (func (param i32) (result i32))))
@@ -0,0 +1,3 @@
+(module
+  (global (;0;) (mut f32) (f32.const 0x1.8p+0 (;=1.5;)))
+  (export "g" (global 0)))
@@ -0,0 +1,4 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0))
+  (export "tab:\09 newline:\0a slash:\5c quote:' double:\22" (func 0)))
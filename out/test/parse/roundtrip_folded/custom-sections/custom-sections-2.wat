@@ -0,0 +1,3 @@
+(module
+  (@custom "custom" "contents")
+  (@custom "custom2" "stuff"))
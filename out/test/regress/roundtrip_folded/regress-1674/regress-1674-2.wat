@@ -0,0 +1,8 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (drop
+      (v128.load32_lane align=1 0
+        (i32.const 0)
+        (v128.const i32x4 0x00000000 0x00000000 0x00000000 0x00000000))))
+  (memory (;0;) 1))
@@ -0,0 +1,17 @@
+(module
+  (type (;0;) (func (param i32 i32) (result i32)))
+  (type (;1;) (func))
+  (func (;0;) (type 0) (param i32 i32) (result i32)
+    (return
+      (i32.add
+        (local.get 0)
+        (local.get 1))))
+  (func (;1;) (type 1)
+    (drop
+      (call_indirect (type 0)
+        (i32.const 4444)
+        (i32.const 5555)
+        (i32.const 0))))
+  (table (;0;) 1 funcref)
+  (export "run" (func 1))
+  (elem (;0;) (i32.const 0) func 0))
@@ -0,0 +1,2 @@
+(module
+  (data (;0;) "hello"))
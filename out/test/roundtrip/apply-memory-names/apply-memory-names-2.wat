@@ -0,0 +1,9 @@
+(module
+  (type $t0 (func))
+  (func $f0 (type $t0)
+    i32.const 0
+    i32.const 0
+    i32.const 0
+    memory.copy $M0 $M1)
+  (memory $M0 1)
+  (memory $M1 1))
@@ -0,0 +1,31 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    i64.const 0
+    i32.const 0
+    i32.const 0
+    memory.init 0
+    data.drop 0
+    i64.const 0
+    i64.const 0
+    i64.const 0
+    memory.copy
+    i64.const 0
+    i32.const 0
+    i64.const 0
+    memory.fill
+    i32.const 0
+    i32.const 0
+    i32.const 0
+    table.init 0
+    elem.drop 0
+    i32.const 0
+    i32.const 0
+    i32.const 0
+    table.copy)
+  (func (;1;) (type 0))
+  (table (;0;) 0 funcref)
+  (memory (;0;) i64 0)
+  (elem (;0;) funcref (ref.func 0) (ref.null func))
+  (elem (;1;) func 1)
+  (data (;0;) "hi"))
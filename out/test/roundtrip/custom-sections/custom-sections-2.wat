@@ -0,0 +1,5 @@
+(module
+  (type (;0;) (func (result i32)))
+  (import "a" "b" (func (;0;) (type 0)))
+  (@custom "stuff" "hello")
+  (@custom "section" "nice"))
@@ -0,0 +1,3 @@
+(module
+  (type (;0;) (func))
+  (import "bar" "foo" (func $foo (type 0))))
@@ -0,0 +1,37 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (block  ;; label = @1
+      (br 0 (;@1;)))
+    (block  ;; label = @1
+      (br 0 (;@1;))))
+  (func (;1;) (type 0)
+    (block  ;; label = @1
+      (br 0 (;@1;))
+      (block  ;; label = @2
+        (br 0 (;@2;))))
+    (block  ;; label = @1
+      (br 0 (;@1;))))
+  (func (;2;) (type 0)
+    (if  ;; label = @1
+      (i32.const 0)
+      (then
+        (br 0 (;@1;))))
+    (if  ;; label = @1
+      (i32.const 0)
+      (then
+        (br 0 (;@1;)))))
+  (func (;3;) (type 0)
+    (loop  ;; label = @1
+      (br 0 (;@1;)))
+    (loop  ;; label = @1
+      (br 0 (;@1;))))
+  (func (;4;) (type 0)
+    (try  ;; label = @1
+      (do
+        (br 0 (;@1;)))
+      (catch_all))
+    (try  ;; label = @1
+      (do
+        (br 0 (;@1;)))
+      (catch_all))))
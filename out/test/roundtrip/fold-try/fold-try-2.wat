@@ -0,0 +1,13 @@
+(module
+  (type (;0;) (func (result i32)))
+  (func (;0;) (type 0) (result i32)
+    (drop
+      (try (result i32)  ;; label = @1
+        (do
+          (i32.const 6))))
+    (try (result i32)  ;; label = @1
+      (do
+        (nop)
+        (i32.const 7))
+      (catch_all
+        (i32.const 8)))))
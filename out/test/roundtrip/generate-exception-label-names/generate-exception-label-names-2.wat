@@ -0,0 +1,25 @@
+(module
+  (type $t0 (func))
+  (type $t1 (func (param i32)))
+  (func $f0 (type $t1) (param $p0 i32)
+    block $B0
+      local.get $p0
+      if $I1
+        try $T2
+          throw $e0
+        delegate $B0
+      end
+      try $T3
+        nop
+      delegate 1
+      try $T4
+        throw $e0
+      catch $e0
+        rethrow $T4
+      end
+      br $B0
+      block $B5
+        br $B0
+      end
+    end)
+  (tag $e0 (type $t0)))
@@ -0,0 +1,6 @@
+(module
+  (type $t0 (func))
+  (func $f0_1 (type $t0))
+  (func $f0 (type $t0))
+  (func $f2 (type $t0)
+    (local $l0_1 i32) (local $l0 i32)))
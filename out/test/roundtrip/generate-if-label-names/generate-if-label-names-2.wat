@@ -0,0 +1,13 @@
+(module
+  (type $t0 (func))
+  (func $f0 (type $t0)
+    i32.const 1
+    if $I0
+      br $I0
+    end
+    i32.const 2
+    if $I1
+      br $I1
+    else
+      br $I1
+    end))
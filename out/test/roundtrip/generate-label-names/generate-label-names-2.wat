@@ -0,0 +1,17 @@
+(module
+  (type $t0 (func))
+  (func $f0 (type $t0)
+    block $B0
+      loop $L1
+        br $L1
+        br $B0
+        br 2 (;@0;)
+        i32.const 0
+        br_table $L1 $B0 2 (;@0;)
+        i32.const 1
+        br_if 2 (;@0;)
+      end
+    end
+    block $B2
+      br $B2
+    end))
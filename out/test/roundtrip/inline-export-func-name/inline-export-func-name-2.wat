@@ -0,0 +1,4 @@
+(module
+  (type (;0;) (func))
+  (func $foo (export "foo") (type 0)
+    nop))
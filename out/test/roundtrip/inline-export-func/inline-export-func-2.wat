@@ -0,0 +1,4 @@
+(module
+  (type (;0;) (func (param i32)))
+  (func (;0;) (export "foo") (type 0) (param i32)
+    nop))
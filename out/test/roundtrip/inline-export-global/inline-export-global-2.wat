@@ -0,0 +1,2 @@
+(module
+  (global (;0;) (export "foo") i32 (i32.const 0)))
@@ -0,0 +1,6 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0))
+  (func (;1;) (type 0))
+  (table (;0;) (export "foo") 2 2 funcref)
+  (elem (;0;) (i32.const 0) func 0 1))
@@ -0,0 +1,3 @@
+(module
+  (type (;0;) (func (param i32)))
+  (tag (;0;) (export "foo") (type 0) (param i32)))
@@ -0,0 +1,5 @@
+(module
+  (global (;0;) (import "mod" "g1") i32)
+  (global (;1;) (import "mod" "g2") f32)
+  (global (;2;) (import "mod" "g3") i64)
+  (global (;3;) (import "mod" "g4") f64))
@@ -0,0 +1,2 @@
+(module
+  (memory (;0;) (import "mod" "m1") 2 3))
@@ -0,0 +1,2 @@
+(module
+  (table (;0;) (import "mod" "t1") 1 funcref))
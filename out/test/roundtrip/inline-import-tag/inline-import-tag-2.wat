@@ -0,0 +1,3 @@
+(module
+  (type (;0;) (func (param i32 f32)))
+  (tag (;0;) (import "mod" "e1") (type 0) (param i32 f32)))
@@ -0,0 +1,2 @@
+(module
+  (import "a" "b" (memory (;0;) i64 1)))
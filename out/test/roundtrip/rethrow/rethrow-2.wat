@@ -0,0 +1,9 @@
+(module
+  (type (;0;) (func (param i32)))
+  (type (;1;) (func))
+  (func (;0;) (type 1)
+    try  ;; label = @1
+    catch 0
+      rethrow 0 (;@1;)
+    end)
+  (tag (;0;) (type 0) (param i32)))
@@ -0,0 +1,3 @@
+(module
+  (import "m" "func" (table (;0;) 1 funcref))
+  (import "m" "extern" (table (;1;) 1 externref)))
@@ -0,0 +1,2 @@
+(module
+  (import "a" "b" (table (;0;) 2 funcref)))
@@ -0,0 +1,9 @@
+(module
+  (type (;0;) (func (param externref) (result externref)))
+  (func (;0;) (type 0) (param externref) (result externref)
+    i32.const 0
+    if (result externref)  ;; label = @1
+      local.get 0
+    else
+      local.get 0
+    end))
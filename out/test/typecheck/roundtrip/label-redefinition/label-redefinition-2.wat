@@ -0,0 +1,13 @@
+(module
+  (type (;0;) (func (result i32)))
+  (func (;0;) (type 0) (result i32)
+    block (result i32)  ;; label = @1
+      block (result i32)  ;; label = @2
+        i32.const 2
+      end
+      block (result i32)  ;; label = @2
+        i32.const 3
+        br 0 (;@2;)
+      end
+      i32.add
+    end))
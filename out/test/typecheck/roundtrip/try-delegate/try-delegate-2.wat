@@ -0,0 +1,32 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    try  ;; label = @1
+      try  ;; label = @2
+      delegate 0
+    catch 0
+    end)
+  (func (;1;) (type 0)
+    try  ;; label = @1
+      try  ;; label = @2
+        try  ;; label = @3
+        delegate 1
+      catch 0
+      end
+    catch 0
+    end)
+  (func (;2;) (type 0)
+    block  ;; label = @1
+      try  ;; label = @2
+      delegate 0
+    end)
+  (func (;3;) (type 0)
+    try  ;; label = @1
+    catch_all
+      try  ;; label = @2
+      delegate 0
+    end)
+  (func (;4;) (type 0)
+    try  ;; label = @1
+    delegate 0)
+  (tag (;0;) (type 0)))
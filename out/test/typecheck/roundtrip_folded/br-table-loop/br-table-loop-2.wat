@@ -0,0 +1,12 @@
+(module
+  (type (;0;) (func (param i32) (result i32)))
+  (func (;0;) (type 0) (param i32) (result i32)
+    (loop (result i32)  ;; label = @1
+      (block  ;; label = @2
+        (br_table 1 (;@1;) 0 (;@2;) 0 (;@2;)
+          (local.get 0))
+        (return
+          (i32.const 0)))
+      (i32.const 1)))
+  (table (;0;) 0 funcref)
+  (memory (;0;) 17))
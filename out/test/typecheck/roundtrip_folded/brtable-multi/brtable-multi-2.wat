@@ -0,0 +1,37 @@
+(module
+  (type (;0;) (func))
+  (type (;1;) (func (result f32 f32)))
+  (type (;2;) (func (param i32)))
+  (func (;0;) (type 0)
+    (block (result f32 f32)  ;; label = @1
+      (block  ;; label = @2
+        (block (result f32 f32)  ;; label = @3
+          (br_table 0 (;@3;) 2 (;@1;)
+            (f32.const 0x1p+0 (;=1;))
+            (f32.const 0x1p+1 (;=2;))
+            (i32.const 0)))
+        (drop)
+        (drop))
+      (f32.const 0x1.8p+1 (;=3;))
+      (f32.const 0x1p+2 (;=4;)))
+    (return))
+  (func (;1;) (type 0)
+    (loop (result f32 f32)  ;; label = @1
+      (loop  ;; label = @2
+        (loop (result f32 f32)  ;; label = @3
+          (br_table 0 (;@3;) 2 (;@1;)
+            (i32.const 0)))
+        (drop)
+        (drop))
+      (f32.const 0x1.8p+1 (;=3;))
+      (f32.const 0x1p+2 (;=4;)))
+    (return))
+  (func (;2;) (type 0)
+    (i32.const 1)
+    (loop (param i32)  ;; label = @1
+      (drop)
+      (loop  ;; label = @2
+        (i32.const 2)
+        (loop (param i32)  ;; label = @3
+          (i32.const 0)
+          (br_table 0 (;@3;) 2 (;@1;)))))))
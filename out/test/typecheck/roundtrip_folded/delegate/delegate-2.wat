@@ -0,0 +1,32 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (try  ;; label = @1
+      (do
+        (try  ;; label = @2
+          (do
+            (try  ;; label = @3
+              (do
+                (throw 0))
+              (delegate 0)))
+          (catch 0)))
+      (catch 0)))
+  (func (;1;) (type 0)
+    (try  ;; label = @1
+      (do
+        (block  ;; label = @2
+          (try  ;; label = @3
+            (do
+              (throw 0))
+            (delegate 1))))
+      (catch 0)))
+  (func (;2;) (type 0)
+    (try  ;; label = @1
+      (do
+        (block  ;; label = @2
+          (try  ;; label = @3
+            (do
+              (throw 0))
+            (delegate 2))))
+      (catch 0)))
+  (tag (;0;) (type 0)))
@@ -0,0 +1,9 @@
+(module
+  (type (;0;) (func (param externref) (result externref)))
+  (func (;0;) (type 0) (param externref) (result externref)
+    (if (result externref)  ;; label = @1
+      (i32.const 0)
+      (then
+        (local.get 0))
+      (else
+        (local.get 0)))))
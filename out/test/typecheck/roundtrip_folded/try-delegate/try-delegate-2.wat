@@ -0,0 +1,36 @@
+(module
+  (type (;0;) (func))
+  (func (;0;) (type 0)
+    (try  ;; label = @1
+      (do
+        (try  ;; label = @2
+          (do)
+          (delegate 0)))
+      (catch 0)))
+  (func (;1;) (type 0)
+    (try  ;; label = @1
+      (do
+        (try  ;; label = @2
+          (do
+            (try  ;; label = @3
+              (do)
+              (delegate 1)))
+          (catch 0)))
+      (catch 0)))
+  (func (;2;) (type 0)
+    (block  ;; label = @1
+      (try  ;; label = @2
+        (do)
+        (delegate 0))))
+  (func (;3;) (type 0)
+    (try  ;; label = @1
+      (do)
+      (catch_all
+        (try  ;; label = @2
+          (do)
+          (delegate 0)))))
+  (func (;4;) (type 0)
+    (try  ;; label = @1
+      (do)
+      (delegate 0)))
+  (tag (;0;) (type 0)))
@@ -0,0 +1,19 @@
+#include <stdio.h>
+
+#include "test.h"
+
+int main(void) {
+  w2c_test instance;
+  wasm_rt_profile_t profile;
+  u32 result;
+
+  wasm_rt_init();
+  wasm2c_test_instantiate(&instance);
+  w2c_test_run(&ggt_stub_thread, &result, &instance);
+  w2c_test_run(&ggt_stub_thread, &result, &instance);
+  wasm2c_test_get_profile(&instance, &profile);
+  wasm_rt_profile_dump_collapsed(&profile, stdout);
+  wasm2c_test_free(&instance);
+  wasm_rt_free();
+  return 0;
+}
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Generates src/prebuilt/float-pow5-table.cc.
+
+kPow5Table holds 128-bit approximations of 5**q for
+kPow5TableMinExp <= q <= kPow5TableMaxExp, normalized so the most significant
+bit is set, as used by the Eisel-Lemire decimal-to-binary conversion in
+src/literal.cc. Positive powers are truncated and negative powers are rounded
+up, which is what the algorithm's error analysis assumes.
+
+The kRyu* tables hold the fixed-width powers of five and their inverses used
+by the Ryu binary-to-decimal conversion in the same file, as described in
+"Ryu: Fast Float-to-String Conversion" (Adams, PLDI 2018).
+"""
+
+import argparse
+import os
+import sys
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+REPO_ROOT_DIR = os.path.dirname(SCRIPT_DIR)
+DEFAULT_OUTPUT = os.path.join(REPO_ROOT_DIR, 'src', 'prebuilt',
+                              'float-pow5-table.cc')
+
+MIN_EXP = -342
+MAX_EXP = 308
+
+
+def Pow5(q):
+    if q >= 0:
+        value = 5 ** q
+        while value < (1 << 127):
+            value <<= 1
+        while value >= (1 << 128):
+            value >>= 1
+        return value
+
+    power5 = 5 ** -q
+    z = power5.bit_length()
+    if (1 << (z - 1)) == power5:
+        z -= 1
+    b = z + 127 if q >= -27 else 2 * z + 2 * 64
+    value = (1 << b) // power5 + 1
+    while value >= (1 << 128):
+        value >>= 1
+    return value
+
+
+# Bit widths of the Ryu tables.
+RYU_DOUBLE_POW5_BITCOUNT = 125
+RYU_DOUBLE_POW5_INV_BITCOUNT = 125
+RYU_DOUBLE_POW5_TABLE_SIZE = 326
+RYU_DOUBLE_POW5_INV_TABLE_SIZE = 342
+RYU_FLOAT_POW5_BITCOUNT = 61
+RYU_FLOAT_POW5_INV_BITCOUNT = 59
+RYU_FLOAT_POW5_TABLE_SIZE = 47
+RYU_FLOAT_POW5_INV_TABLE_SIZE = 31
+
+
+def RyuPow5(i, bitcount):
+    """5**i, truncated to its top `bitcount` bits."""
+    value = 5 ** i
+    shift = value.bit_length() - bitcount
+    return value >> shift if shift >= 0 else value << -shift
+
+
+def RyuPow5Inv(i, bitcount):
+    """2**(bitlength(5**i) - 1 + bitcount) / 5**i, rounded up."""
+    value = 5 ** i
+    return (1 << (value.bit_length() - 1 + bitcount)) // value + 1
+
+
+def Split128(name, values):
+    lines = ['/* {low, high} 64-bit halves. */',
+             'static const uint64_t %s[][2] = {' % name]
+    for i, value in enumerate(values):
+        lines.append('    {0x%016xull, 0x%016xull},  // %d' %
+                     (value & ((1 << 64) - 1), value >> 64, i))
+    lines.append('};')
+    return lines
+
+
+def Table64(name, values):
+    lines = ['static const uint64_t %s[] = {' % name]
+    for i, value in enumerate(values):
+        lines.append('    0x%016xull,  // %d' % (value, i))
+    lines.append('};')
+    return lines
+
+
+def main(args):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-o', '--output', default=DEFAULT_OUTPUT)
+    options = parser.parse_args(args)
+
+    lines = [
+        '/* Generated by scripts/gen-float-pow5-table.py; do not edit. */',
+        '',
+        'static constexpr int kPow5TableMinExp = %d;' % MIN_EXP,
+        'static constexpr int kPow5TableMaxExp = %d;' % MAX_EXP,
+        '',
+        '/* {high, low} 64-bit halves of the normalized 128-bit value of 5^q. */',
+        'static const uint64_t kPow5Table[][2] = {',
+    ]
+    for q in range(MIN_EXP, MAX_EXP + 1):
+        value = Pow5(q)
+        lines.append('    {0x%016xull, 0x%016xull},  // 5^%d' %
+                     (value >> 64, value & ((1 << 64) - 1), q))
+    lines.append('};')
+
+    lines += [
+        '',
+        'static constexpr int kRyuDoublePow5BitCount = %d;' %
+        RYU_DOUBLE_POW5_BITCOUNT,
+        'static constexpr int kRyuDoublePow5InvBitCount = %d;' %
+        RYU_DOUBLE_POW5_INV_BITCOUNT,
+        'static constexpr int kRyuFloatPow5BitCount = %d;' %
+        RYU_FLOAT_POW5_BITCOUNT,
+        'static constexpr int kRyuFloatPow5InvBitCount = %d;' %
+        RYU_FLOAT_POW5_INV_BITCOUNT,
+        '',
+    ]
+    lines += Split128('kRyuDoublePow5Split',
+                      [RyuPow5(i, RYU_DOUBLE_POW5_BITCOUNT)
+                       for i in range(RYU_DOUBLE_POW5_TABLE_SIZE)])
+    lines.append('')
+    lines += Split128('kRyuDoublePow5InvSplit',
+                      [RyuPow5Inv(i, RYU_DOUBLE_POW5_INV_BITCOUNT)
+                       for i in range(RYU_DOUBLE_POW5_INV_TABLE_SIZE)])
+    lines.append('')
+    lines += Table64('kRyuFloatPow5Split',
+                     [RyuPow5(i, RYU_FLOAT_POW5_BITCOUNT)
+                      for i in range(RYU_FLOAT_POW5_TABLE_SIZE)])
+    lines.append('')
+    lines += Table64('kRyuFloatPow5InvSplit',
+                     [RyuPow5Inv(i, RYU_FLOAT_POW5_INV_BITCOUNT)
+                      for i in range(RYU_FLOAT_POW5_INV_TABLE_SIZE)])
+
+    with open(options.output, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
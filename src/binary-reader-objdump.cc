@@ -29,8 +29,10 @@
 
 #include "wabt/binary-reader-nop.h"
 #include "wabt/filenames.h"
+#include "wabt/leb128.h"
 #include "wabt/literal.h"
 #include "wabt/string-util.h"
+#include "wabt/utf8.h"
 
 namespace wabt {
 
@@ -302,10 +304,20 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
     return Result::Ok;
   }
 
-  Result OnLocalName(Index function_index,
-                     Index local_index,
-                     std::string_view local_name) override {
-    SetLocalName(function_index, local_index, local_name);
+  Result OnLocalNameSubsection(Index index,
+                               uint32_t name_type,
+                               Offset subsection_size) override {
+    local_names_end_ = data_ + state->offset + subsection_size;
+    return Result::Ok;
+  }
+
+  Result OnLocalNameLocalCount(Index function_index,
+                               Index num_locals) override {
+    // The names themselves are only needed by disassembly, so they're decoded
+    // when first looked up; the reader has already validated them.
+    objdump_state_->local_names.SetDeferred(function_index, num_locals,
+                                            data_ + state->offset,
+                                            local_names_end_);
     return Result::Ok;
   }
 
@@ -456,12 +468,11 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
   void SetTypeName(Index index, std::string_view name);
   void SetFunctionName(Index index, std::string_view name);
   void SetGlobalName(Index index, std::string_view name);
-  void SetLocalName(Index function_index,
-                    Index local_index,
-                    std::string_view name);
   void SetTagName(Index index, std::string_view name);
   void SetTableName(Index index, std::string_view name);
   void SetSegmentName(Index index, std::string_view name);
+
+  const uint8_t* local_names_end_ = nullptr;
 };
 
 void BinaryReaderObjdumpPrepass::SetTypeName(Index index,
@@ -479,12 +490,6 @@ void BinaryReaderObjdumpPrepass::SetGlobalName(Index index,
   objdump_state_->global_names.Set(index, name);
 }
 
-void BinaryReaderObjdumpPrepass::SetLocalName(Index function_index,
-                                              Index local_index,
-                                              std::string_view name) {
-  objdump_state_->local_names.Set(function_index, local_index, name);
-}
-
 void BinaryReaderObjdumpPrepass::SetTagName(Index index,
                                             std::string_view name) {
   objdump_state_->tag_names.Set(index, name);
@@ -2417,7 +2422,38 @@ void ObjdumpNames::Set(Index index, std::string_view name) {
 }
 
 std::string_view ObjdumpLocalNames::Get(Index function_index,
-                                        Index local_index) const {
+                                        Index local_index) {
+  auto deferred_iter = deferred.find(function_index);
+  if (deferred_iter != deferred.end()) {
+    Deferred entries = deferred_iter->second;
+    deferred.erase(deferred_iter);
+    // Stop where the reader stopped (and reported an error) in the prepass.
+    const uint8_t* p = entries.data;
+    Index last_index = kInvalidIndex;
+    for (Index i = 0; i < entries.num_locals; ++i) {
+      uint32_t index;
+      uint32_t length;
+      size_t bytes = ReadU32Leb128(p, entries.end, &index);
+      if (bytes == 0 ||
+          (last_index != kInvalidIndex && index <= last_index)) {
+        break;
+      }
+      last_index = index;
+      p += bytes;
+      bytes = ReadU32Leb128(p, entries.end, &length);
+      if (bytes == 0 || length > static_cast<size_t>(entries.end - p - bytes)) {
+        break;
+      }
+      p += bytes;
+      const char* name = reinterpret_cast<const char*>(p);
+      p += length;
+      if (!IsValidUtf8(name, length)) {
+        break;
+      }
+      Set(function_index, index, std::string_view(name, length));
+    }
+  }
+
   auto iter = names.find(std::pair<Index, Index>(function_index, local_index));
   if (iter == names.end())
     return std::string_view();
@@ -2431,6 +2467,13 @@ void ObjdumpLocalNames::Set(Index function_index,
       std::string(name);
 }
 
+void ObjdumpLocalNames::SetDeferred(Index function_index,
+                                    Index num_locals,
+                                    const uint8_t* data,
+                                    const uint8_t* end) {
+  deferred[function_index] = {num_locals, data, end};
+}
+
 Result ReadBinaryObjdump(const uint8_t* data,
                          size_t size,
                          ObjdumpOptions* options,
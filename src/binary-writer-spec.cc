@@ -27,6 +27,7 @@
 #include "wabt/cast.h"
 #include "wabt/filenames.h"
 #include "wabt/ir.h"
+#include "wabt/leb128.h"
 #include "wabt/literal.h"
 #include "wabt/stream.h"
 
@@ -634,6 +635,339 @@ Result BinaryWriterSpec::WriteScript(const Script& script) {
   return result_;
 }
 
+
+class SpecBundleWriter {
+ public:
+  SpecBundleWriter(Stream* stream,
+                   std::string_view source_filename,
+                   std::string_view module_filename_noext,
+                   const WriteBinaryOptions& options,
+                   Stream* log_stream);
+
+  Result WriteScript(const Script& script);
+
+ private:
+  struct ModuleEntry {
+    std::string filename;
+    std::unique_ptr<MemoryStream> stream;
+  };
+
+  void WriteString(std::string_view);
+  void WriteLane(Type lane_type, uint64_t bits, ExpectedNan);
+  void WriteConst(const Const& const_);
+  void WriteConstVector(const ConstVector& consts);
+  void WriteAction(const Action& action);
+  Stream* AddModule(const char* extension);
+  void WriteScriptModule(const ScriptModule& script_module);
+  void WriteInvalidModule(const ScriptModule& module, std::string_view text);
+  void WriteCommand(const Command& command);
+
+  Stream* stream_;
+  std::string source_filename_;
+  std::string module_filename_noext_;
+  const WriteBinaryOptions& options_;
+  Stream* log_stream_;
+  MemoryStream commands_;
+  std::vector<ModuleEntry> modules_;
+  Result result_ = Result::Ok;
+};
+
+SpecBundleWriter::SpecBundleWriter(Stream* stream,
+                                   std::string_view source_filename,
+                                   std::string_view module_filename_noext,
+                                   const WriteBinaryOptions& options,
+                                   Stream* log_stream)
+    : stream_(stream),
+      source_filename_(source_filename),
+      module_filename_noext_(module_filename_noext),
+      options_(options),
+      log_stream_(log_stream) {}
+
+void SpecBundleWriter::WriteString(std::string_view s) {
+  WriteU32Leb128(&commands_, s.size(), "string length");
+  commands_.WriteData(s.data(), s.size(), "string");
+}
+
+void SpecBundleWriter::WriteLane(Type lane_type,
+                                 uint64_t bits,
+                                 ExpectedNan expected) {
+  if (lane_type == Type::F32 || lane_type == Type::F64) {
+    commands_.WriteU8Enum(expected, "expected nan");
+  }
+  WriteU64Leb128(&commands_, bits, "bits");
+}
+
+void SpecBundleWriter::WriteConst(const Const& const_) {
+  WriteS32Leb128(&commands_, const_.type(), "type");
+
+  switch (const_.type()) {
+    case Type::I32:
+      WriteLane(Type::I32, const_.u32(), ExpectedNan::None);
+      break;
+
+    case Type::I64:
+      WriteLane(Type::I64, const_.u64(), ExpectedNan::None);
+      break;
+
+    case Type::F32:
+      WriteLane(Type::F32, const_.f32_bits(), const_.expected_nan());
+      break;
+
+    case Type::F64:
+      WriteLane(Type::F64, const_.f64_bits(), const_.expected_nan());
+      break;
+
+    case Type::FuncRef:
+    case Type::ExternRef: {
+      uint64_t bits = const_.ref_bits() == Const::kRefNullBits
+                          ? 0
+                          : uint64_t(const_.ref_bits()) + 1;
+      WriteU64Leb128(&commands_, bits, "ref");
+      break;
+    }
+
+    case Type::V128: {
+      Type lane_type = const_.lane_type();
+      WriteS32Leb128(&commands_, lane_type, "lane type");
+      for (int lane = 0; lane < const_.lane_count(); ++lane) {
+        switch (lane_type) {
+          case Type::I8:
+            WriteLane(lane_type, const_.v128_lane<uint8_t>(lane),
+                      ExpectedNan::None);
+            break;
+
+          case Type::I16:
+            WriteLane(lane_type, const_.v128_lane<uint16_t>(lane),
+                      ExpectedNan::None);
+            break;
+
+          case Type::I32:
+          case Type::F32:
+            WriteLane(lane_type, const_.v128_lane<uint32_t>(lane),
+                      const_.expected_nan(lane));
+            break;
+
+          case Type::I64:
+          case Type::F64:
+            WriteLane(lane_type, const_.v128_lane<uint64_t>(lane),
+                      const_.expected_nan(lane));
+            break;
+
+          default:
+            WABT_UNREACHABLE;
+        }
+      }
+      break;
+    }
+
+    default:
+      WABT_UNREACHABLE;
+  }
+}
+
+void SpecBundleWriter::WriteConstVector(const ConstVector& consts) {
+  WriteU32Leb128(&commands_, consts.size(), "const count");
+  for (const Const& const_ : consts) {
+    WriteConst(const_);
+  }
+}
+
+void SpecBundleWriter::WriteAction(const Action& action) {
+  commands_.WriteU8Enum(action.type(), "action type");
+  WriteString(action.module_var.is_name() ? action.module_var.name() : "");
+  WriteString(action.name);
+  if (action.type() == ActionType::Invoke) {
+    WriteConstVector(cast<InvokeAction>(&action)->args);
+  }
+}
+
+Stream* SpecBundleWriter::AddModule(const char* extension) {
+  std::string filename = module_filename_noext_;
+  filename += '.';
+  filename += std::to_string(modules_.size());
+  filename += extension;
+  ConvertBackslashToSlash(&filename);
+
+  WriteU32Leb128(&commands_, modules_.size(), "module index");
+  modules_.push_back({std::string(GetBasename(filename)),
+                      std::make_unique<MemoryStream>(log_stream_)});
+  return modules_.back().stream.get();
+}
+
+void SpecBundleWriter::WriteScriptModule(const ScriptModule& script_module) {
+  switch (script_module.type()) {
+    case ScriptModuleType::Text:
+      result_ |=
+          WriteBinaryModule(AddModule(kWasmExtension),
+                            &cast<TextScriptModule>(&script_module)->module,
+                            options_);
+      break;
+
+    case ScriptModuleType::Binary:
+      AddModule(kWasmExtension)
+          ->WriteData(cast<BinaryScriptModule>(&script_module)->data, "");
+      break;
+
+    case ScriptModuleType::Quoted:
+      AddModule(kWatExtension)
+          ->WriteData(cast<QuotedScriptModule>(&script_module)->data, "");
+      break;
+  }
+}
+
+void SpecBundleWriter::WriteInvalidModule(const ScriptModule& module,
+                                          std::string_view text) {
+  WriteU32Leb128(&commands_, module.location().line, "line");
+  WriteScriptModule(module);
+  WriteString(text);
+  commands_.WriteU8Enum(module.type() == ScriptModuleType::Quoted
+                            ? SpecBundleModuleType::Text
+                            : SpecBundleModuleType::Binary,
+                        "module type");
+}
+
+void SpecBundleWriter::WriteCommand(const Command& command) {
+  // Script modules are written as plain modules, as in the JSON output.
+  CommandType type = command.type == CommandType::ScriptModule
+                         ? CommandType::Module
+                         : command.type;
+  commands_.WriteU8Enum(type, "command type");
+
+  switch (command.type) {
+    case CommandType::Module: {
+      const Module& module = cast<ModuleCommand>(&command)->module;
+      WriteU32Leb128(&commands_, module.loc.line, "line");
+      WriteString(module.name);
+      result_ |=
+          WriteBinaryModule(AddModule(kWasmExtension), &module, options_);
+      break;
+    }
+
+    case CommandType::ScriptModule: {
+      auto* script_module_command = cast<ScriptModuleCommand>(&command);
+      const Module& module = script_module_command->module;
+      WriteU32Leb128(&commands_, module.loc.line, "line");
+      WriteString(module.name);
+      WriteScriptModule(*script_module_command->script_module);
+      break;
+    }
+
+    case CommandType::Action: {
+      const Action& action = *cast<ActionCommand>(&command)->action;
+      WriteU32Leb128(&commands_, action.loc.line, "line");
+      WriteAction(action);
+      break;
+    }
+
+    case CommandType::Register: {
+      auto* register_command = cast<RegisterCommand>(&command);
+      const Var& var = register_command->var;
+      WriteU32Leb128(&commands_, var.loc.line, "line");
+      WriteString(var.is_name() ? var.name() : "");
+      WriteString(register_command->module_name);
+      break;
+    }
+
+    case CommandType::AssertMalformed: {
+      auto* assert_command = cast<AssertMalformedCommand>(&command);
+      WriteInvalidModule(*assert_command->module, assert_command->text);
+      break;
+    }
+
+    case CommandType::AssertInvalid: {
+      auto* assert_command = cast<AssertInvalidCommand>(&command);
+      WriteInvalidModule(*assert_command->module, assert_command->text);
+      break;
+    }
+
+    case CommandType::AssertUnlinkable: {
+      auto* assert_command = cast<AssertUnlinkableCommand>(&command);
+      WriteInvalidModule(*assert_command->module, assert_command->text);
+      break;
+    }
+
+    case CommandType::AssertUninstantiable: {
+      auto* assert_command = cast<AssertUninstantiableCommand>(&command);
+      WriteInvalidModule(*assert_command->module, assert_command->text);
+      break;
+    }
+
+    case CommandType::AssertReturn: {
+      auto* assert_return_command = cast<AssertReturnCommand>(&command);
+      const Expectation* expectation = assert_return_command->expected.get();
+      WriteU32Leb128(&commands_, assert_return_command->action->loc.line,
+                     "line");
+      WriteAction(*assert_return_command->action);
+      commands_.WriteU8(expectation->type() == ExpectationType::Either,
+                        "either");
+      WriteConstVector(expectation->expected);
+      break;
+    }
+
+    case CommandType::AssertTrap: {
+      auto* assert_trap_command = cast<AssertTrapCommand>(&command);
+      WriteU32Leb128(&commands_, assert_trap_command->action->loc.line,
+                     "line");
+      WriteAction(*assert_trap_command->action);
+      WriteString(assert_trap_command->text);
+      break;
+    }
+
+    case CommandType::AssertExhaustion: {
+      auto* assert_exhaustion_command = cast<AssertExhaustionCommand>(&command);
+      WriteU32Leb128(&commands_, assert_exhaustion_command->action->loc.line,
+                     "line");
+      WriteAction(*assert_exhaustion_command->action);
+      WriteString(assert_exhaustion_command->text);
+      break;
+    }
+
+    case CommandType::AssertException: {
+      auto* assert_exception_command = cast<AssertExceptionCommand>(&command);
+      WriteU32Leb128(&commands_, assert_exception_command->action->loc.line,
+                     "line");
+      WriteAction(*assert_exception_command->action);
+      break;
+    }
+  }
+}
+
+Result SpecBundleWriter::WriteScript(const Script& script) {
+  WriteU32Leb128(&commands_, script.commands.size(), "command count");
+  for (const CommandPtr& command : script.commands) {
+    WriteCommand(*command);
+  }
+  if (Failed(result_)) {
+    return result_;
+  }
+
+  stream_->WriteU32(kSpecBundleMagic, "magic");
+  stream_->WriteU32(kSpecBundleVersion, "version");
+  WriteU32Leb128(stream_, source_filename_.size(), "string length");
+  stream_->WriteData(source_filename_.data(), source_filename_.size(),
+                     "source filename");
+
+  WriteU32Leb128(stream_, modules_.size(), "module count");
+  size_t offset = 0;
+  for (const ModuleEntry& module : modules_) {
+    size_t size = module.stream->output_buffer().size();
+    WriteU32Leb128(stream_, module.filename.size(), "string length");
+    stream_->WriteData(module.filename.data(), module.filename.size(),
+                       "module filename");
+    WriteU64Leb128(stream_, offset, "module offset");
+    WriteU64Leb128(stream_, size, "module size");
+    offset += size;
+  }
+
+  const OutputBuffer& commands = commands_.output_buffer();
+  stream_->WriteData(commands.data.data(), commands.size(), "commands");
+  for (const ModuleEntry& module : modules_) {
+    const OutputBuffer& data = module.stream->output_buffer();
+    stream_->WriteData(data.data.data(), data.size(), "module data");
+  }
+  return stream_->result();
+}
+
 }  // end anonymous namespace
 
 Result WriteBinarySpecScript(Stream* json_stream,
@@ -669,4 +1003,15 @@ Result WriteBinarySpecScript(
   return binary_writer_spec.WriteScript(*script);
 }
 
+Result WriteBinarySpecBundle(Stream* stream,
+                             Script* script,
+                             std::string_view source_filename,
+                             std::string_view module_filename_noext,
+                             const WriteBinaryOptions& options,
+                             Stream* log_stream) {
+  SpecBundleWriter writer(stream, source_filename, module_filename_noext,
+                          options, log_stream);
+  return writer.WriteScript(*script);
+}
+
 }  // namespace wabt
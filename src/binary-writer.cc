@@ -1603,13 +1603,22 @@ Result BinaryWriter::WriteModule() {
       Offset body_size_offset =
           WriteU32Leb128Space(leb_size_guess, "func body size (guess)");
       cur_func_start_offset_ = stream_->offset();
+      // Relocations are appended in offset order, so only the ones added
+      // while writing this function need to be shifted by the fixup below.
+      size_t first_func_reloc =
+          current_reloc_section_ &&
+                  current_reloc_section_->section_index == section_count_
+              ? current_reloc_section_->relocations.size()
+              : 0;
       WriteFunc(func);
       auto func_start_offset = body_size_offset - last_section_payload_offset_;
       auto func_end_offset = stream_->offset() - last_section_payload_offset_;
       auto delta = WriteFixupU32Leb128Size(body_size_offset, leb_size_guess,
                                            "FIXUP func body size");
       if (current_reloc_section_ && delta != 0) {
-        for (Reloc& reloc : current_reloc_section_->relocations) {
+        std::vector<Reloc>& relocs = current_reloc_section_->relocations;
+        for (size_t j = first_func_reloc; j < relocs.size(); ++j) {
+          Reloc& reloc = relocs[j];
           if (reloc.offset >= func_start_offset &&
               reloc.offset <= func_end_offset) {
             reloc.offset += delta;
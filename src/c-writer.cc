@@ -16,6 +16,7 @@
 
 #include "wabt/c-writer.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cinttypes>
 #include <iterator>
@@ -27,8 +28,12 @@
 
 #include "wabt/cast.h"
 #include "wabt/common.h"
+#include "wabt/func-type-table.h"
+#include "wabt/generate-names.h"
 #include "wabt/ir.h"
 #include "wabt/literal.h"
+#include "wabt/memory-stats.h"
+#include "wabt/pass-timer.h"
 #include "wabt/sha256.h"
 #include "wabt/stream.h"
 #include "wabt/string-util.h"
@@ -80,7 +85,6 @@ struct LocalName {
 
 struct ParamName : LocalName {
   using LocalName::LocalName;
-  ParamName(const Var& var) : LocalName(var.name()) {}
 };
 
 struct LabelName : LocalName {
@@ -304,6 +308,9 @@ class CWriter {
 
   std::string GetGlobalName(ModuleFieldType, const std::string&) const;
   std::string GetLocalName(const std::string&, bool is_label) const;
+  void MakeLocalNames(const Func&, std::vector<std::string>* out) const;
+  const std::string& GetLocalVarName(const Var&) const;
+  const std::string& GetBlockLabel(const Block&);
   std::string GetTailCallRef(const std::string&) const;
 
   void Indent(int size = INDENT_SIZE);
@@ -382,6 +389,8 @@ class CWriter {
   void WriteCallIndirectFuncDeclaration(const FuncDeclaration&,
                                         const std::string&);
   void ComputeSimdScope();
+  void ComputeLazyTables();
+  void ComputeProfileCounters();
   void WriteHeaderIncludes();
   void WriteV128Decl();
   void WriteModuleInstance();
@@ -403,6 +412,9 @@ class CWriter {
   void WriteElemInitializerDecls();
   void WriteElemInitializers();
   void WriteElemTableInit(bool, const ElemSegment*, const Table*);
+  bool IsLazyTable(const Table*) const;
+  std::string MaterializeTableName(const Table*) const;
+  void WriteEnsureTable(const Table*);
   bool IsSingleUnsharedMemory();
   void InstallSegueBase(Memory* memory, bool save_old_value);
   void RestoreSegueBase();
@@ -411,14 +423,23 @@ class CWriter {
   void WriteInitDecl();
   void WriteFreeDecl();
   void WriteGetFuncTypeDecl();
+  void WriteGetProfileDecl();
   void WriteInit();
   void WriteFree();
   void WriteGetFuncType();
+  void WriteGetProfile();
+  void WriteProfileInstances();
+  void WriteProfileLoopCounter();
+  void WriteFrameOffset(const Expr&);
+  void WriteGetFuncSymbolsDecl();
+  void WriteGetFuncSymbols();
+  void WriteCStringLiteral(std::string_view);
   void WriteInitInstanceImport();
   void WriteImportProperties(CWriterPhase);
   void WriteFuncs();
   void BeginFunction(const Func&);
   void FinishFunction();
+  void AccountMemory(MemoryStats*) const;
   void Write(const Func&);
   void WriteTailCallee(const Func&);
   void WriteParamsAndLocals();
@@ -452,6 +473,9 @@ class CWriter {
     Allowed,
   };
 
+  static bool GetConstLength(const Expr*, uint64_t* out_length);
+  void WriteMemoryOpLength(const Expr* prev_expr);
+
   void WriteSimpleUnaryExpr(Opcode, const char* op);
   void WriteInfixBinaryExpr(Opcode,
                             const char* op,
@@ -523,8 +547,15 @@ class CWriter {
 
   std::vector<std::pair<std::string, MemoryStream>> func_sections_;
   SymbolSet func_includes_;
+  // Names of the current function's params and locals, and of its unnamed
+  // labels, which GenerateNames leaves to us with LocalNamesOnDemand.
+  std::vector<std::string> local_names_;
+  LabelNameMap label_names_;
 
-  std::vector<std::string> unique_func_type_names_;
+  // Distinct signatures in the module, and the name of the first type with
+  // each signature, indexed by id.
+  FuncTypeTable func_type_table_;
+  std::vector<std::string> func_type_names_;
 
   std::function<std::vector<size_t>(std::vector<Func*>::const_iterator,
                                     std::vector<Func*>::const_iterator,
@@ -534,7 +565,22 @@ class CWriter {
 
   bool simd_used_in_header_;
 
+  // Module-private funcref tables whose active elem segments are copied in on
+  // first access rather than at instantiation.
+  std::set<const Table*> lazy_tables_;
+
+  // With options_.profile: the counter slot of each defined function, and
+  // for each loop counter the slot of its enclosing function. Loop counters
+  // of one function are contiguous, starting at profile_loop_base_.
+  std::map<const Func*, Index> profile_func_index_;
+  std::map<const Func*, Index> profile_loop_base_;
+  std::vector<Index> profile_loop_funcs_;
+  Index profile_loop_index_ = 0;
+
   bool in_tail_callee_;
+
+  // The largest total size of func_sections_ for any one function.
+  size_t peak_func_section_bytes_ = 0;
 };
 
 // TODO: if WABT begins supporting debug names for labels,
@@ -553,6 +599,8 @@ static constexpr char kAdminSymbolPrefix[] = "wasm2c_";
 static constexpr char kTailCallSymbolPrefix[] = "wasm_tailcall_";
 static constexpr char kTailCallFallbackPrefix[] = "wasm_fallback_";
 static constexpr unsigned int kTailCallStackSize = 1024;
+// Must match MEMORY_COPY_CONST_MAX in wasm2c.declarations.c.
+static constexpr uint64_t kMemoryCopyConstMax = 64;
 
 size_t CWriter::MarkTypeStack() const {
   return type_stack_.size();
@@ -599,11 +647,10 @@ const Label* CWriter::FindLabel(const Var& var, bool mark_used) {
   Label* label = nullptr;
 
   if (var.is_index()) {
-    // We've generated names for all labels, so we should only be using an
-    // index when branching to the implicit function label, which can't be
-    // named.
-    assert(var.index() + 1 == label_stack_.size());
-    label = &label_stack_[0];
+    // Either the implicit function label, which can't be named, or a label
+    // whose name is generated on demand (see GetBlockLabel).
+    assert(var.index() < label_stack_.size());
+    label = &label_stack_[label_stack_.size() - 1 - var.index()];
   } else {
     assert(var.is_name());
     for (Index i = label_stack_.size(); i > 0; --i) {
@@ -974,6 +1021,31 @@ std::string CWriter::GetLocalName(const std::string& name,
   return local_sym_map_.at(mangled);
 }
 
+void CWriter::MakeLocalNames(const Func& func,
+                             std::vector<std::string>* out) const {
+  MakeTypeBindingReverseMapping(func.GetNumParamsAndLocals(), func.bindings,
+                                out);
+  for (Index i = 0; i < out->size(); ++i) {
+    if ((*out)[i].empty()) {
+      (*out)[i] = GenerateLocalName(func, i);
+    }
+  }
+}
+
+const std::string& CWriter::GetLocalVarName(const Var& var) const {
+  return var.is_name() ? var.name() : local_names_.at(var.index());
+}
+
+const std::string& CWriter::GetBlockLabel(const Block& block) {
+  if (!block.label.empty()) {
+    return block.label;
+  }
+  if (label_names_.empty()) {
+    GenerateLabelNames(*func_, &label_names_);
+  }
+  return label_names_.at(&block);
+}
+
 std::string CWriter::GetTailCallRef(const std::string& name) const {
   return kTailCallSymbolPrefix + GetGlobalName(ModuleFieldType::Func, name);
 }
@@ -1162,12 +1234,9 @@ void CWriter::Write(const GotoLabel& goto_label) {
 
   WriteUnwindTryCatchStack(label);
 
-  if (goto_label.var.is_name()) {
-    Write("goto ", LabelName(goto_label.var.name()), ";");
+  if (label->label_type != LabelType::Func) {
+    Write("goto ", LabelName(label->name), ";");
   } else {
-    // We've generated names for all labels, so we should only be using an
-    // index when branching to the implicit function label, which can't be
-    // named.
     Write("goto ", LabelName(kImplicitFuncLabel), ";");
   }
 }
@@ -1288,7 +1357,15 @@ void CWriter::Write(const Const& const_) {
         // Negative zero. Special-cased so it isn't written as -0 below.
         Writef("-0.f");
       } else {
-        Writef("%.9g", Bitcast<float>(f32_bits));
+        char buf[WABT_MAX_FLOAT_DECIMAL + 3];
+        WriteFloatDecimal(buf, sizeof(buf), f32_bits);
+        // The shortest digits are only guaranteed to round-trip when parsed
+        // as a float, not as a double that is then narrowed, so add the f
+        // suffix (which needs a decimal point or exponent before it).
+        if (!strchr(buf, '.') && !strchr(buf, 'e')) {
+          strcat(buf, ".0");
+        }
+        Writef("%sf", buf);
       }
       break;
     }
@@ -1312,11 +1389,11 @@ void CWriter::Write(const Const& const_) {
         // Negative zero. Special-cased so it isn't written as -0 below.
         Writef("-0.0");
       } else {
-        char buf[128];
-        snprintf(buf, sizeof(buf), "%.17g", Bitcast<double>(f64_bits));
-        // Append .0 if sprint didn't include a decimal point or use the
-        // exponent ('e') form.  This is a workaround for an MSVC parsing
-        // issue: https://github.com/WebAssembly/wabt/issues/2422
+        char buf[WABT_MAX_DOUBLE_DECIMAL + 2];
+        WriteDoubleDecimal(buf, sizeof(buf), f64_bits);
+        // Append .0 if there is no decimal point or exponent ('e') form.
+        // This is a workaround for an MSVC parsing issue:
+        // https://github.com/WebAssembly/wabt/issues/2422
         if (!strchr(buf, '.') && !strchr(buf, 'e')) {
           strcat(buf, ".0");
         }
@@ -1352,6 +1429,15 @@ void CWriter::WriteFreeDecl() {
         ModuleInstanceTypeName(), "*);", Newline());
 }
 
+void CWriter::WriteGetProfileDecl() {
+  if (!options_.profile) {
+    return;
+  }
+
+  Write("void ", kAdminSymbolPrefix, module_prefix_, "_get_profile(",
+        ModuleInstanceTypeName(), "*, wasm_rt_profile_t*);", Newline());
+}
+
 void CWriter::WriteGetFuncTypeDecl() {
   Write("wasm_rt_func_type_t ", kAdminSymbolPrefix, module_prefix_,
         "_get_func_type(uint32_t param_count, uint32_t result_count, ...);",
@@ -1605,7 +1691,6 @@ void CWriter::WriteFuncTypeDecls() {
 
   Write(Newline());
 
-  std::string serialized_type;
   for (const TypeEntry* type : module_->types) {
     const std::string name =
         DefineGlobalScopeName(ModuleFieldType::Type, type->name);
@@ -1623,37 +1708,41 @@ void CWriter::WriteFuncTypes() {
 
   Write(Newline());
 
-  std::unordered_map<std::string, std::string> type_hash;
-
   std::string serialized_type;
   for (const TypeEntry* type : module_->types) {
-    const std::string name = GetGlobalName(ModuleFieldType::Type, type->name);
-    SerializeFuncType(*cast<FuncType>(type), serialized_type);
-
-    auto prior_type = type_hash.find(serialized_type);
-    if (prior_type != type_hash.end()) {
+    const FuncType* func_type = cast<FuncType>(type);
+    FuncTypeTable::Id id = func_type_table_.Intern(func_type->sig.param_types,
+                                                   func_type->sig.result_types);
+    if (id >= func_type_names_.size()) {
+      func_type_names_.resize(id + 1);
+    }
+    if (!func_type_names_[id].empty()) {
       /* duplicate function type */
-      unique_func_type_names_.push_back(prior_type->second);
+      continue;
+    }
+
+    // Only the first type with each signature is hashed and written.
+    const std::string name = GetGlobalName(ModuleFieldType::Type, type->name);
+    func_type_names_[id] = name;
+    SerializeFuncType(*func_type, serialized_type);
+    if (c_streams_.size() > 1) {
+      Write("FUNC_TYPE_EXTERN_T(");
     } else {
-      unique_func_type_names_.push_back(name);
-      type_hash.emplace(serialized_type, name);
-      if (c_streams_.size() > 1) {
-        Write("FUNC_TYPE_EXTERN_T(");
-      } else {
-        Write("FUNC_TYPE_T(");
-      }
-      Write(name, ") = \"");
-      for (uint8_t x : serialized_type) {
-        Writef("\\x%02x", x);
-      }
-      Write("\";", Newline());
+      Write("FUNC_TYPE_T(");
+    }
+    Write(name, ") = \"");
+    for (uint8_t x : serialized_type) {
+      Writef("\\x%02x", x);
     }
+    Write("\";", Newline());
   }
 }
 
 void CWriter::Write(const FuncTypeExpr& expr) {
-  Index func_type_index = module_->GetFuncTypeIndex(expr.func_type->sig);
-  Write(unique_func_type_names_.at(func_type_index));
+  const FuncSignature& sig = expr.func_type->sig;
+  FuncTypeTable::Id id =
+      func_type_table_.Find(sig.param_types, sig.result_types);
+  Write(func_type_names_.at(id));
 }
 
 // static
@@ -2001,6 +2090,96 @@ void CWriter::ComputeSimdScope() {
                    }));
 }
 
+void CWriter::ComputeLazyTables() {
+  // A table can only be observed before its first access if it is shared with
+  // another instance, so imported and exported tables are always initialized
+  // eagerly.
+  std::set<const Table*> exported;
+  for (const Export* export_ : module_->exports) {
+    if (export_->kind == ExternalKind::Table) {
+      exported.insert(module_->GetTable(export_->var));
+    }
+  }
+
+  for (const ElemSegment* elem_segment : module_->elem_segments) {
+    if (elem_segment->kind != SegmentKind::Active ||
+        elem_segment->elem_exprs.empty()) {
+      continue;
+    }
+    Index table_index = module_->GetTableIndex(elem_segment->table_var);
+    const Table* table = module_->tables[table_index];
+    if (table_index >= module_->num_table_imports &&
+        table->elem_type == Type::FuncRef && !exported.count(table)) {
+      lazy_tables_.insert(table);
+    }
+  }
+}
+
+// The name of a wasm-level entity as a user would write it, without the
+// text format's leading '$'.
+static std::string_view DisplayName(std::string_view name) {
+  if (!name.empty() && name[0] == '$') {
+    name.remove_prefix(1);
+  }
+  return name;
+}
+
+// Counts the loop counters that Write(const ExprList&) writes. Like it, this
+// stops at an instruction that makes the rest of the list unreachable, since
+// the writer doesn't emit the loops there.
+static Index CountLoops(const ExprList& exprs) {
+  Index count = 0;
+  for (const Expr& expr : exprs) {
+    switch (expr.type()) {
+      case ExprType::Br:
+      case ExprType::BrTable:
+      case ExprType::Return:
+      case ExprType::ReturnCall:
+      case ExprType::ReturnCallIndirect:
+      case ExprType::Unreachable:
+        return count;
+      case ExprType::Block:
+        count += CountLoops(cast<BlockExpr>(&expr)->block.exprs);
+        break;
+      case ExprType::Loop:
+        count += 1 + CountLoops(cast<LoopExpr>(&expr)->block.exprs);
+        break;
+      case ExprType::If: {
+        const auto* if_ = cast<IfExpr>(&expr);
+        count += CountLoops(if_->true_.exprs) + CountLoops(if_->false_);
+      } break;
+      case ExprType::Try: {
+        const auto* try_ = cast<TryExpr>(&expr);
+        count += CountLoops(try_->block.exprs);
+        for (const Catch& catch_ : try_->catches) {
+          count += CountLoops(catch_.exprs);
+        }
+      } break;
+      default:
+        break;
+    }
+  }
+  return count;
+}
+
+void CWriter::ComputeProfileCounters() {
+  if (!options_.profile) {
+    return;
+  }
+
+  Index func_index = 0;
+  for (Index i = module_->num_func_imports; i < module_->funcs.size(); ++i) {
+    const Func* func = module_->funcs[i];
+    profile_func_index_[func] = func_index;
+    if (options_.profile_loops) {
+      profile_loop_base_[func] = profile_loop_funcs_.size();
+      profile_loop_funcs_.insert(profile_loop_funcs_.end(),
+                                 CountLoops(func->exprs), func_index);
+    }
+    ++func_index;
+  }
+}
+
 void CWriter::WriteHeaderIncludes() {
   Write("#include \"wasm-rt.h\"", Newline());
 
@@ -2008,6 +2187,10 @@ void CWriter::WriteHeaderIncludes() {
     Write("#include \"wasm-rt-exceptions.h\"", Newline(), Newline());
   }
 
+  if (options_.profile) {
+    Write("#include \"wasm-rt-profile.h\"", Newline(), Newline());
+  }
+
   if (simd_used_in_header_) {
     WriteV128Decl();
   }
@@ -2030,6 +2213,7 @@ void CWriter::WriteModuleInstance() {
   WriteTables();
   WriteDataInstances();
   WriteElemInstances();
+  WriteProfileInstances();
 
   // C forbids an empty struct
   if (module_->globals.empty() && module_->memories.empty() &&
@@ -2269,6 +2453,14 @@ void CWriter::WriteElemInstances() {
       Write("bool ", "elem_segment_dropped_", name, " : 1;", Newline());
     }
   }
+
+  for (const Table* table : module_->tables) {
+    if (IsLazyTable(table)) {
+      Write("bool ", "table_pending_",
+            GlobalName(ModuleFieldType::Table, table->name), " : 1;",
+            Newline());
+    }
+  }
 }
 
 void CWriter::WriteElemInitializerDecls() {
@@ -2294,6 +2486,15 @@ void CWriter::WriteElemInitializerDecls() {
             Newline());
     }
   }
+
+  if (c_streams_.size() > 1) {
+    for (const Table* table : module_->tables) {
+      if (IsLazyTable(table)) {
+        Write(Newline(), "void ", MaterializeTableName(table), "(",
+              ModuleInstanceTypeName(), "* instance);", Newline());
+      }
+    }
+  }
 }
 
 void CWriter::WriteElemInitializers() {
@@ -2386,11 +2587,47 @@ void CWriter::WriteElemInitializers() {
 
     const Table* table = module_->GetTable(elem_segment->table_var);
 
-    WriteElemTableInit(true, elem_segment, table);
+    if (IsLazyTable(table)) {
+      // The copy is deferred to MaterializeTableName(); only trap here.
+      Write("table_init_check(",
+            ExternalInstanceRef(ModuleFieldType::Table, table->name),
+            ".size, ");
+      WriteInitExpr(elem_segment->offset);
+      Write(", ", elem_segment->elem_exprs.size(), ");", Newline());
+    } else {
+      WriteElemTableInit(true, elem_segment, table);
+    }
+  }
+
+  for (const Table* table : module_->tables) {
+    if (IsLazyTable(table)) {
+      Write("instance->table_pending_",
+            GlobalName(ModuleFieldType::Table, table->name), " = true;",
+            Newline());
+    }
   }
 
   Write(CloseBrace(), Newline());
 
+  for (const Table* table : module_->tables) {
+    if (!IsLazyTable(table)) {
+      continue;
+    }
+
+    Write(Newline(), InternalSymbolScope(), "void ",
+          MaterializeTableName(table), "(", ModuleInstanceTypeName(),
+          "* instance) ", OpenBrace());
+    for (const ElemSegment* elem_segment : module_->elem_segments) {
+      if (elem_segment->kind == SegmentKind::Active &&
+          module_->GetTable(elem_segment->table_var) == table) {
+        WriteElemTableInit(true, elem_segment, table);
+      }
+    }
+    Write("instance->table_pending_",
+          GlobalName(ModuleFieldType::Table, table->name), " = false;",
+          Newline(), CloseBrace(), Newline());
+  }
+
   if (!module_->elem_segments.empty()) {
     Write(Newline(), "static void init_elem_instances(",
           ModuleInstanceTypeName(), " *instance) ", OpenBrace());
@@ -2451,6 +2688,27 @@ void CWriter::WriteElemTableInit(bool active_initialization,
   Write(");", Newline());
 }
 
+std::string CWriter::MaterializeTableName(const Table* table) const {
+  return kAdminSymbolPrefix + module_prefix_ + "_materialize_" +
+         GetGlobalName(ModuleFieldType::Table, table->name);
+}
+
+bool CWriter::IsLazyTable(const Table* table) const {
+  return lazy_tables_.count(table) != 0;
+}
+
+// Accesses that read or overwrite existing elements must first copy in any
+// deferred active segments. table.size and table.grow never need to.
+void CWriter::WriteEnsureTable(const Table* table) {
+  if (!IsLazyTable(table)) {
+    return;
+  }
+
+  std::string name = GetGlobalName(ModuleFieldType::Table, table->name);
+  Write("if (UNLIKELY(l->instance->table_pending_", name, ")) ",
+        MaterializeTableName(table), "(l->instance);", Newline());
+}
+
 bool CWriter::IsSingleUnsharedMemory() {
   return module_->memories.size() == 1 &&
          !module_->memories[0]->page_limits.is_shared;
@@ -2493,13 +2751,12 @@ void CWriter::WriteExports(CWriterPhase kind) {
           WriteFuncDeclaration(func->decl, mangled_name);
         } else {
           func_ = func;
-          local_syms_ = global_syms_;
+          local_syms_.clear();
           local_sym_map_.clear();
           stack_var_sym_map_.clear();
           Write("ggt_ret_t ", mangled_name, "(ggt_thread_t *thr, ",
                 func_->decl.sig.result_types, " *ret, ");
-          MakeTypeBindingReverseMapping(func_->GetNumParamsAndLocals(),
-                                        func_->bindings, &index_to_name);
+          MakeLocalNames(*func_, &index_to_name);
           WriteParams(index_to_name);
         }
         break;
@@ -2687,6 +2944,19 @@ void CWriter::WriteInit() {
   if (!module_->memories.empty() && !module_->data_segments.empty()) {
     Write("init_data_instances(instance);", Newline());
   }
+  if (!profile_func_index_.empty()) {
+    Write("memset(instance->profile_func_counts, 0, "
+          "sizeof(instance->profile_func_counts));",
+          Newline());
+    Write("memset(&instance->profile_stacks, 0, "
+          "sizeof(instance->profile_stacks));",
+          Newline());
+  }
+  if (!profile_loop_funcs_.empty()) {
+    Write("memset(instance->profile_loop_counts, 0, "
+          "sizeof(instance->profile_loop_counts));",
+          Newline());
+  }
 
   for (Var* var : module_->starts) {
     Write(ExternalRef(ModuleFieldType::Func, module_->GetFunc(*var)->name));
@@ -2707,6 +2977,128 @@ void CWriter::WriteInit() {
   Write(CloseBrace(), Newline());
 }
 
+void CWriter::WriteProfileInstances() {
+  if (!profile_func_index_.empty()) {
+    Write("uint64_t profile_func_counts[", profile_func_index_.size(), "];",
+          Newline());
+    Write("wasm_rt_profile_stacks_t profile_stacks;", Newline());
+  }
+  if (!profile_loop_funcs_.empty()) {
+    Write("uint64_t profile_loop_counts[", profile_loop_funcs_.size(), "];",
+          Newline());
+  }
+}
+
+void CWriter::WriteCStringLiteral(std::string_view s) {
+  Write("\"");
+  for (char c : s) {
+    if (c == '"' || c == '\\' || c == '?' || !isprint(c)) {
+      Writef("\\%03o", static_cast<uint8_t>(c));
+    } else {
+      WriteData(&c, 1);
+    }
+  }
+  Write("\"");
+}
+
+void CWriter::WriteGetProfile() {
+  if (!options_.profile) {
+    return;
+  }
+
+  if (!profile_func_index_.empty()) {
+    Write(Newline(), "static const char* const profile_func_names[] = ",
+          OpenBrace());
+    for (Index i = module_->num_func_imports; i < module_->funcs.size(); ++i) {
+      WriteCStringLiteral(DisplayName(module_->funcs[i]->name));
+      Write(",", Newline());
+    }
+    Write(CloseBrace(), ";", Newline());
+  }
+
+  if (!profile_loop_funcs_.empty()) {
+    Write(Newline(), "static const uint32_t profile_loop_funcs[] = ",
+          OpenBrace());
+    for (Index func_index : profile_loop_funcs_) {
+      Write(func_index, ",", Newline());
+    }
+    Write(CloseBrace(), ";", Newline());
+  }
+
+  bool has_funcs = !profile_func_index_.empty();
+  bool has_loops = !profile_loop_funcs_.empty();
+  Write(Newline(), "void ", kAdminSymbolPrefix, module_prefix_,
+        "_get_profile(", ModuleInstanceTypeName(),
+        "* instance, wasm_rt_profile_t* profile) ", OpenBrace());
+  Write("profile->module_name = ");
+  WriteCStringLiteral(options_.module_name);
+  Write(";", Newline());
+  Write("profile->num_funcs = ", profile_func_index_.size(), ";", Newline());
+  Write("profile->func_names = ",
+        has_funcs ? "profile_func_names" : "NULL", ";", Newline());
+  Write("profile->func_counts = ",
+        has_funcs ? "instance->profile_func_counts" : "NULL", ";", Newline());
+  Write("profile->num_loops = ", profile_loop_funcs_.size(), ";", Newline());
+  Write("profile->loop_funcs = ",
+        has_loops ? "profile_loop_funcs" : "NULL", ";", Newline());
+  Write("profile->loop_counts = ",
+        has_loops ? "instance->profile_loop_counts" : "NULL", ";", Newline());
+  Write("profile->stacks = ",
+        has_funcs ? "&instance->profile_stacks" : "NULL", ";", Newline());
+  Write(CloseBrace(), Newline());
+}
+
+void CWriter::WriteFrameOffset(const Expr& expr) {
+  if (in_tail_callee_) {
+    return;
+  }
+
+  Write("FUNC_FRAME_AT(", static_cast<uint64_t>(expr.loc.offset), ");",
+        Newline());
+}
+
+void CWriter::WriteGetFuncSymbolsDecl() {
+  Write("#if WASM_RT_FRAME_CHAIN", Newline());
+  Write("size_t ", kAdminSymbolPrefix, module_prefix_,
+        "_get_func_symbols(const wasm_rt_func_symbol_t**);", Newline());
+  Write("#endif", Newline());
+}
+
+void CWriter::WriteGetFuncSymbols() {
+  Index num_defined = module_->funcs.size() - module_->num_func_imports;
+
+  Write(Newline(), "#if WASM_RT_FRAME_CHAIN", Newline());
+  if (num_defined) {
+    Write("static const wasm_rt_func_symbol_t func_symbols[] = ", OpenBrace());
+    for (Index i = module_->num_func_imports; i < module_->funcs.size(); ++i) {
+      const Func* func = module_->funcs[i];
+      Write("{(const void*)", ExternalRef(ModuleFieldType::Func, func->name),
+            ", ");
+      WriteCStringLiteral(options_.module_name);
+      Write(", ");
+      WriteCStringLiteral(DisplayName(func->name));
+      Write(", ", i, "},", Newline());
+    }
+    Write(CloseBrace(), ";", Newline());
+  }
+  Write(Newline(), "size_t ", kAdminSymbolPrefix, module_prefix_,
+        "_get_func_symbols(const wasm_rt_func_symbol_t** symbols) ",
+        OpenBrace());
+  Write("*symbols = ", num_defined ? "func_symbols" : "NULL", ";", Newline());
+  Write("return ", num_defined, ";", Newline());
+  Write(CloseBrace(), Newline());
+  Write("#endif", Newline());
+}
+
+void CWriter::WriteProfileLoopCounter() {
+  if (!options_.profile_loops) {
+    return;
+  }
+
+  Write(in_tail_callee_ ? "" : "l->", "instance->profile_loop_counts[",
+        profile_loop_index_++, "]++;", Newline());
+}
+
 void CWriter::WriteGetFuncType() {
   Write(Newline(), "wasm_rt_func_type_t ", kAdminSymbolPrefix, module_prefix_,
         "_get_func_type(uint32_t param_count, uint32_t result_count, "
@@ -2858,6 +3250,10 @@ void CWriter::WriteFree() {
     }
   }
 
+  if (!profile_func_index_.empty()) {
+    Write("PROFILE_FREE_STACKS();", Newline());
+  }
+
   Write(CloseBrace(), Newline());
 }
 
@@ -2986,6 +3382,7 @@ void CWriter::BeginFunction(const Func& func) {
   stack_var_sym_map_.clear();
   func_sections_.clear();
   func_includes_.clear();
+  label_names_.clear();
 
   /*
    * If offset of stream_ is 0, this is the first time some function is written
@@ -2998,9 +3395,11 @@ void CWriter::BeginFunction(const Func& func) {
 }
 
 void CWriter::FinishFunction() {
+  size_t section_bytes = 0;
   for (size_t i = 0; i < func_sections_.size(); ++i) {
     auto& [condition, stream] = func_sections_.at(i);
     std::unique_ptr<OutputBuffer> buf = stream.ReleaseOutputBuffer();
+    section_bytes += buf->data.capacity();
     if (condition.empty() || func_includes_.count(condition)) {
       stream_->WriteData(buf->data.data(), buf->data.size());
     }
@@ -3010,6 +3409,8 @@ void CWriter::FinishFunction() {
                                     // (return type/name/params/locals)
     }
   }
+  peak_func_section_bytes_ =
+      std::max(peak_func_section_bytes_, section_bytes);
 
   Write(CloseBrace(), Newline());
 
@@ -3027,6 +3428,22 @@ void CWriter::Write(const Func& func) {
   );
   WriteParamsAndLocals();
   Write("FUNC_PROLOGUE;", Newline());
+  if (options_.profile) {
+    Write("l->instance->profile_func_counts[", profile_func_index_.at(&func),
+          "]++;", Newline());
+  }
+  if (options_.profile_loops) {
+    profile_loop_index_ = profile_loop_base_.at(&func);
+  }
+  Write("FUNC_FRAME_ENTER(");
+  WriteCStringLiteral(options_.module_name);
+  Write(", ");
+  WriteCStringLiteral(DisplayName(func.name));
+  Write(", ", module_->GetFuncIndex(Var(func.name, func.loc)), ");", Newline());
+  if (options_.profile) {
+    Write("PROFILE_COUNT_STACK(", profile_func_index_.at(&func), ");",
+          Newline());
+  }
 
   PushFuncSection();
 
@@ -3038,6 +3455,7 @@ void CWriter::Write(const Func& func) {
   PopLabel();
   ResetTypeStack(0);
   PushTypes(func.decl.sig.result_types);
+  Write("FUNC_FRAME_EXIT();", Newline());
   Write("FUNC_EPILOGUE;", Newline());
 
   // Return the top of the stack implicitly.
@@ -3118,10 +3536,16 @@ void CWriter::WriteTailCallee(const Func& func) {
   Write(" ", OpenBrace());
   WriteTailCallAsserts(func.decl.sig);
   Write(ModuleInstanceTypeName(), "* instance = *instance_ptr;", Newline());
+  if (options_.profile) {
+    Write("instance->profile_func_counts[", profile_func_index_.at(&func),
+          "]++;", Newline());
+  }
+  if (options_.profile_loops) {
+    profile_loop_index_ = profile_loop_base_.at(&func);
+  }
 
-  std::vector<std::string> index_to_name;
-  MakeTypeBindingReverseMapping(func.GetNumParamsAndLocals(), func.bindings,
-                                &index_to_name);
+  std::vector<std::string>& index_to_name = local_names_;
+  MakeLocalNames(func, &index_to_name);
   if (func.GetNumParams()) {
     WriteVarsByType(
         func.decl.sig.param_types, [](auto x) { return x; },
@@ -3160,9 +3584,8 @@ void CWriter::WriteTailCallee(const Func& func) {
 }
 
 void CWriter::WriteParamsAndLocals() {
-  std::vector<std::string> index_to_name;
-  MakeTypeBindingReverseMapping(func_->GetNumParamsAndLocals(), func_->bindings,
-                                &index_to_name);
+  std::vector<std::string>& index_to_name = local_names_;
+  MakeLocalNames(*func_, &index_to_name);
   WriteParams(index_to_name);
   Write(", ", OpenBrace());
   WriteLocalsParams(index_to_name);
@@ -3217,6 +3640,7 @@ void CWriter::WriteParamTypes(const FuncDeclaration& decl) {
 void CWriter::WriteLocalsParams(const std::vector<std::string>& index_to_name) {
   Write(func_->decl.sig.result_types, " *ret;", Newline());
   Write(ModuleInstanceTypeName(), "* instance;", Newline());
+  Write("FUNC_FRAME_FIELD", Newline());
   for (Index i = 0; i < func_->GetNumParams(); ++i) {
     Write(func_->GetParamType(i), " ", GetLocalName(index_to_name[i], false),
           ";", Newline());
@@ -3262,10 +3686,11 @@ void CWriter::WriteStackVarDeclarations() {
 }
 
 void CWriter::Write(const Block& block) {
-  std::string label = DefineLabelName(block.label);
+  const std::string& name = GetBlockLabel(block);
+  std::string label = DefineLabelName(name);
   DropTypes(block.decl.GetNumParams());
   size_t mark = MarkTypeStack();
-  PushLabel(LabelType::Block, block.label, block.decl.sig);
+  PushLabel(LabelType::Block, name, block.decl.sig);
   PushTypes(block.decl.sig.param_types);
   Write(block.exprs, LabelDecl(label));
   ResetTypeStack(mark);
@@ -3275,7 +3700,8 @@ void CWriter::Write(const Block& block) {
 
 size_t CWriter::BeginTry(const TryExpr& tryexpr) {
   Write(OpenBrace()); /* beginning of try-catch */
-  const std::string tlabel = DefineLabelName(tryexpr.block.label);
+  const std::string& name = GetBlockLabel(tryexpr.block);
+  const std::string tlabel = DefineLabelName(name);
   Write("WASM_RT_UNWIND_TARGET *", tlabel,
         "_outer_target = wasm_rt_get_unwind_target();", Newline());
   Write("WASM_RT_UNWIND_TARGET ", tlabel, "_unwind_target;", Newline());
@@ -3283,7 +3709,7 @@ size_t CWriter::BeginTry(const TryExpr& tryexpr) {
   Write(OpenBrace()); /* beginning of try block */
   DropTypes(tryexpr.block.decl.GetNumParams());
   const size_t mark = MarkTypeStack();
-  PushLabel(LabelType::Try, tryexpr.block.label, tryexpr.block.decl.sig);
+  PushLabel(LabelType::Try, name, tryexpr.block.decl.sig);
   PushTypes(tryexpr.block.decl.sig.param_types);
   Write("wasm_rt_set_unwind_target(&", tlabel, "_unwind_target);", Newline());
   PushTryCatch(tlabel);
@@ -3292,7 +3718,11 @@ size_t CWriter::BeginTry(const TryExpr& tryexpr) {
   Write("wasm_rt_set_unwind_target(", tlabel, "_outer_target);", Newline());
   Write(CloseBrace());          /* end of try block */
   Write(" else ", OpenBrace()); /* beginning of catch blocks or delegate */
-  assert(label_stack_.back().name == tryexpr.block.label);
+  if (!in_tail_callee_) {
+    // Frames above this one were unwound by the exception.
+    Write("FUNC_FRAME_RESUME();", Newline());
+  }
+  assert(label_stack_.back().name == name);
   assert(label_stack_.back().label_type == LabelType::Try);
   label_stack_.back().label_type = LabelType::Catch;
   if (try_catch_stack_.back().used) {
@@ -3307,13 +3737,14 @@ void CWriter::WriteTryCatch(const TryExpr& tryexpr) {
 
   /* exception has been thrown -- do we catch it? */
 
-  const LabelName tlabel = LabelName(tryexpr.block.label);
+  const std::string& name = GetBlockLabel(tryexpr.block);
+  const LabelName tlabel = LabelName(name);
 
   Write("wasm_rt_set_unwind_target(", tlabel, "_outer_target);", Newline());
   PopTryCatch();
 
   /* save the thrown exception to the stack if it might be rethrown later */
-  PushFuncSection(tryexpr.block.label);
+  PushFuncSection(name);
   Write("/* save exception ", tlabel, " for rethrow */", Newline());
   Write("const wasm_rt_tag_t ", tlabel, "_tag = wasm_rt_exception_tag();",
         Newline());
@@ -3349,8 +3780,8 @@ void CWriter::WriteTryCatch(const TryExpr& tryexpr) {
 
   ResetTypeStack(mark);
   assert(!label_stack_.empty());
-  assert(label_stack_.back().name == tryexpr.block.label);
-  Write(LabelDecl(GetLocalName(tryexpr.block.label, true)));
+  assert(label_stack_.back().name == name);
+  Write(LabelDecl(GetLocalName(name, true)));
   PopLabel();
   PushTypes(tryexpr.block.decl.sig.result_types);
 }
@@ -3405,8 +3836,12 @@ void CWriter::WriteTryDelegate(const TryExpr& tryexpr) {
 
   /* exception has been thrown -- where do we delegate it? */
 
-  if (tryexpr.delegate_target.is_index()) {
-    /* must be the implicit function label */
+  /* an index doesn't count this try's own label, which is still pushed */
+  const Var& target = tryexpr.delegate_target;
+  const Label* label =
+      target.is_index() ? FindLabel(Var(target.index() + 1, target.loc), false)
+                        : FindLabel(target, false);
+  if (label->label_type == LabelType::Func) {
     assert(!try_catch_stack_.empty());
     const std::string& unwind_name = try_catch_stack_.at(0).name;
     Write("wasm_rt_set_unwind_target(", unwind_name, "_outer_target);",
@@ -3414,8 +3849,6 @@ void CWriter::WriteTryDelegate(const TryExpr& tryexpr) {
 
     Write("wasm_rt_throw();", Newline());
   } else {
-    const Label* label = FindLabel(tryexpr.delegate_target, false);
-
     assert(try_catch_stack_.size() >= label->try_catch_stack_size);
 
     if (label->label_type == LabelType::Try) {
@@ -3441,14 +3874,16 @@ void CWriter::WriteTryDelegate(const TryExpr& tryexpr) {
 
   PopTryCatch();
   ResetTypeStack(mark);
+  const std::string& name = GetBlockLabel(tryexpr.block);
   assert(!label_stack_.empty());
-  assert(label_stack_.back().name == tryexpr.block.label);
-  Write(LabelDecl(GetLocalName(tryexpr.block.label, true)));
+  assert(label_stack_.back().name == name);
+  Write(LabelDecl(GetLocalName(name, true)));
   PopLabel();
   PushTypes(tryexpr.block.decl.sig.result_types);
 }
 
 void CWriter::Write(const ExprList& exprs) {
+  const Expr* prev_expr = nullptr;
   for (const Expr& expr : exprs) {
     switch (expr.type()) {
       case ExprType::Binary:
@@ -3498,6 +3933,7 @@ void CWriter::Write(const ExprList& exprs) {
         }
 
         assert(var.is_name());
+        WriteFrameOffset(expr);
         Write("GGT_CALL(");
         Write(ExternalRef(ModuleFieldType::Func, var.name()), ", (thr, ");
         if (num_results > 1) {
@@ -3544,6 +3980,8 @@ void CWriter::Write(const ExprList& exprs) {
         assert(decl.has_func_type);
         const FuncType* func_type = module_->GetFuncType(decl.type_var);
 
+        WriteEnsureTable(table);
+        WriteFrameOffset(expr);
         Write("CALL_INDIRECT(",
               ExternalInstanceRef(ModuleFieldType::Table, table->name), ", ");
         WriteCallIndirectFuncDeclaration(decl, "(*)");
@@ -3610,10 +4048,11 @@ void CWriter::Write(const ExprList& exprs) {
         const IfExpr& if_ = *cast<IfExpr>(&expr);
         Write("if (", StackVar(0), ") ", OpenBrace());
         DropTypes(1);
-        std::string label = DefineLabelName(if_.true_.label);
+        const std::string& name = GetBlockLabel(if_.true_);
+        std::string label = DefineLabelName(name);
         DropTypes(if_.true_.decl.GetNumParams());
         size_t mark = MarkTypeStack();
-        PushLabel(LabelType::If, if_.true_.label, if_.true_.decl.sig);
+        PushLabel(LabelType::If, name, if_.true_.decl.sig);
         PushTypes(if_.true_.decl.sig.param_types);
         Write(if_.true_.exprs, CloseBrace());
         if (!if_.false_.empty()) {
@@ -3635,37 +4074,45 @@ void CWriter::Write(const ExprList& exprs) {
       case ExprType::LocalGet: {
         const Var& var = cast<LocalGetExpr>(&expr)->var;
         PushType(func_->GetLocalType(var));
-        Write(StackVar(0), " = ", var, ";", Newline());
+        Write(StackVar(0), " = ", ParamName(GetLocalVarName(var)), ";",
+              Newline());
         break;
       }
 
       case ExprType::LocalSet: {
         const Var& var = cast<LocalSetExpr>(&expr)->var;
-        Write(var, " = ", StackVar(0), ";", Newline());
+        Write(ParamName(GetLocalVarName(var)), " = ", StackVar(0), ";",
+              Newline());
         DropTypes(1);
         break;
       }
 
       case ExprType::LocalTee: {
         const Var& var = cast<LocalTeeExpr>(&expr)->var;
-        Write(var, " = ", StackVar(0), ";", Newline());
+        Write(ParamName(GetLocalVarName(var)), " = ", StackVar(0), ";",
+              Newline());
         break;
       }
 
       case ExprType::Loop: {
         const Block& block = cast<LoopExpr>(&expr)->block;
         if (!block.exprs.empty()) {
-          Write(DefineLabelName(block.label), ": ");
+          const std::string& name = GetBlockLabel(block);
+          Write(DefineLabelName(name), ": ");
           Indent();
+          WriteProfileLoopCounter();
           DropTypes(block.decl.GetNumParams());
           size_t mark = MarkTypeStack();
-          PushLabel(LabelType::Loop, block.label, block.decl.sig);
+          PushLabel(LabelType::Loop, name, block.decl.sig);
           PushTypes(block.decl.sig.param_types);
           Write(Newline(), block.exprs);
           ResetTypeStack(mark);
           PopLabel();
           PushTypes(block.decl.sig.result_types);
           Dedent();
+        } else if (options_.profile_loops) {
+          // Keep the slots of later loops in step with CountLoops().
+          ++profile_loop_index_;
         }
         break;
       }
@@ -3676,8 +4123,9 @@ void CWriter::Write(const ExprList& exprs) {
             module_->memories[module_->GetMemoryIndex(inst->memidx)];
         Write("memory_fill(",
               ExternalInstancePtr(ModuleFieldType::Memory, memory->name), ", ",
-              StackVar(2), ", ", StackVar(1), ", ", StackVar(0), ");",
-              Newline());
+              StackVar(2), ", ", StackVar(1), ", ");
+        WriteMemoryOpLength(prev_expr);
+        Write(");", Newline());
         DropTypes(3);
       } break;
 
@@ -3686,12 +4134,16 @@ void CWriter::Write(const ExprList& exprs) {
         Memory* dest_memory =
             module_->memories[module_->GetMemoryIndex(inst->destmemidx)];
         const Memory* src_memory = module_->GetMemory(inst->srcmemidx);
-        Write("memory_copy(",
+        uint64_t length;
+        bool is_small_const = GetConstLength(prev_expr, &length) &&
+                              length <= kMemoryCopyConstMax;
+        Write(is_small_const ? "memory_copy_const(" : "memory_copy(",
               ExternalInstancePtr(ModuleFieldType::Memory, dest_memory->name),
               ", ",
               ExternalInstancePtr(ModuleFieldType::Memory, src_memory->name),
-              ", ", StackVar(2), ", ", StackVar(1), ", ", StackVar(0), ");",
-              Newline());
+              ", ", StackVar(2), ", ", StackVar(1), ", ");
+        WriteMemoryOpLength(prev_expr);
+        Write(");", Newline());
         DropTypes(3);
       } break;
 
@@ -3729,6 +4181,7 @@ void CWriter::Write(const ExprList& exprs) {
         const ElemSegment* src_segment =
             module_->GetElemSegment(inst->segment_index);
 
+        WriteEnsureTable(dest_table);
         WriteElemTableInit(false, src_segment, dest_table);
         DropTypes(3);
       } break;
@@ -3762,6 +4215,10 @@ void CWriter::Write(const ExprList& exprs) {
           WABT_UNREACHABLE;
         }
 
+        WriteEnsureTable(dest_table);
+        if (src_table != dest_table) {
+          WriteEnsureTable(src_table);
+        }
         Write(
             GetReferenceTypeName(dest_table->elem_type), "_table_copy(",
             ExternalInstancePtr(ModuleFieldType::Table, dest_table->name), ", ",
@@ -3772,6 +4229,7 @@ void CWriter::Write(const ExprList& exprs) {
 
       case ExprType::TableGet: {
         const Table* table = module_->GetTable(cast<TableGetExpr>(&expr)->var);
+        WriteEnsureTable(table);
         Write(StackVar(0, table->elem_type), " = ",
               GetReferenceTypeName(table->elem_type), "_table_get(",
               ExternalInstancePtr(ModuleFieldType::Table, table->name), ", ",
@@ -3782,6 +4240,7 @@ void CWriter::Write(const ExprList& exprs) {
 
       case ExprType::TableSet: {
         const Table* table = module_->GetTable(cast<TableSetExpr>(&expr)->var);
+        WriteEnsureTable(table);
         Write(GetReferenceTypeName(table->elem_type), "_table_set(",
               ExternalInstancePtr(ModuleFieldType::Table, table->name), ", ",
               StackVar(1), ", ", StackVar(0), ");", Newline());
@@ -3809,6 +4268,7 @@ void CWriter::Write(const ExprList& exprs) {
 
       case ExprType::TableFill: {
         const Table* table = module_->GetTable(cast<TableFillExpr>(&expr)->var);
+        WriteEnsureTable(table);
         Write(GetReferenceTypeName(table->elem_type), "_table_fill(",
               ExternalInstancePtr(ModuleFieldType::Table, table->name), ", ",
               StackVar(2), ", ", StackVar(1), ", ", StackVar(0), ");",
@@ -3983,9 +4443,9 @@ void CWriter::Write(const ExprList& exprs) {
 
       case ExprType::Rethrow: {
         const RethrowExpr* rethrow = cast<RethrowExpr>(&expr);
-        assert(rethrow->var.is_name());
-        const LabelName ex{rethrow->var.name()};
-        func_includes_.insert(rethrow->var.name());
+        const std::string& name = FindLabel(rethrow->var, false)->name;
+        const LabelName ex{name};
+        func_includes_.insert(name);
         Write("wasm_rt_load_exception(", ex, "_tag, ", ex, "_size, ", ex, ");",
               Newline());
         WriteThrow();
@@ -4082,6 +4542,7 @@ void CWriter::Write(const ExprList& exprs) {
         WriteTailCallAsserts(decl.sig);
         WriteUnwindTryCatchStack(FindLabel(Var(label_stack_.size() - 1, {})));
         const Table* table = module_->GetTable(inst->table);
+        WriteEnsureTable(table);
         Write("CHECK_CALL_INDIRECT(",
               ExternalInstanceRef(ModuleFieldType::Table, table->name), ", ",
               FuncTypeExpr(module_->GetFuncType(decl.type_var)), ", ",
@@ -4133,6 +4594,44 @@ void CWriter::Write(const ExprList& exprs) {
         UNIMPLEMENTED("...");
         break;
     }
+    prev_expr = &expr;
+  }
+}
+
+// static
+bool CWriter::GetConstLength(const Expr* expr, uint64_t* out_length) {
+  if (!expr || expr->type() != ExprType::Const) {
+    return false;
+  }
+  const Const& const_ = cast<ConstExpr>(expr)->const_;
+  switch (const_.type()) {
+    case Type::I32:
+      *out_length = const_.u32();
+      return true;
+    case Type::I64:
+      // The memory helpers take a u32 length, so a larger memory64 length
+      // must stay a u64 variable; as a literal it would not compile.
+      if (const_.u64() > UINT32_MAX) {
+        return false;
+      }
+      *out_length = const_.u64();
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+ * Write the length operand of a bulk memory operation. If the length was pushed
+ * by the immediately preceding const, write it as a literal so the C compiler
+ * can specialize the copy or fill for that size.
+ */
+void CWriter::WriteMemoryOpLength(const Expr* prev_expr) {
+  uint64_t length;
+  if (GetConstLength(prev_expr, &length)) {
+    Write(length);
+  } else {
+    Write(StackVar(0));
   }
 }
 
@@ -5893,6 +6392,7 @@ void CWriter::ReserveExportNames() {
 }
 
 void CWriter::WriteCHeader() {
+  PassTimer::Scope scope(options_.timer, "WriteCHeader");
   ReserveExportNames();
 
   stream_ = h_stream_;
@@ -5902,6 +6402,8 @@ void CWriter::WriteCHeader() {
   Write("#define ", guard, Newline());
   Write(Newline());
   ComputeSimdScope();
+  ComputeLazyTables();
+  ComputeProfileCounters();
   WriteHeaderIncludes();
   Write(s_header_top);
   Write(Newline());
@@ -5909,6 +6411,8 @@ void CWriter::WriteCHeader() {
   WriteInitDecl();
   WriteFreeDecl();
   WriteGetFuncTypeDecl();
+  WriteGetProfileDecl();
+  WriteGetFuncSymbolsDecl();
   WriteMultivalueResultTypes();
   WriteImports();
   WriteImportProperties(CWriterPhase::Declarations);
@@ -5922,6 +6426,7 @@ void CWriter::WriteCHeader() {
 }
 
 void CWriter::WriteCSource() {
+  PassTimer::Scope scope(options_.timer, "WriteCSource");
   /* Write the "top" to h_impl stream */
   stream_ = h_impl_stream_;
   Write("/* Automatically generated by wasm2c */", Newline());
@@ -5941,7 +6446,10 @@ void CWriter::WriteCSource() {
   /* Write the module-wide material to the first output stream */
   stream_ = c_streams_.front();
   WriteMultiCTop();
-  WriteFuncTypes();
+  {
+    PassTimer::Scope types_scope(options_.timer, "WriteFuncTypes");
+    WriteFuncTypes();
+  }
   WriteTags();
   WriteGlobalInitializers();
   WriteDataInitializers();
@@ -5956,9 +6464,14 @@ void CWriter::WriteCSource() {
   WriteInit();
   WriteFree();
   WriteGetFuncType();
+  WriteGetProfile();
+  WriteGetFuncSymbols();
 
   /* Write function bodies across the different output streams */
-  WriteFuncs();
+  {
+    PassTimer::Scope funcs_scope(options_.timer, "WriteFuncs");
+    WriteFuncs();
+  }
 
   /* For any empty .c output, write a dummy typedef to avoid gcc warning */
   WriteMultiCTopEmpty();
@@ -5967,11 +6480,45 @@ void CWriter::WriteCSource() {
 Result CWriter::WriteModule(const Module& module) {
   WABT_USE(options_);
   module_ = &module;
+  PassTimer::Scope scope(options_.timer, "WriteC");
   WriteCHeader();
   WriteCSource();
+  if (options_.mem_stats) {
+    AccountMemory(options_.mem_stats);
+  }
   return result_;
 }
 
+void CWriter::AccountMemory(MemoryStats* stats) const {
+  uint64_t bytes = 0;
+  auto add_strings = [&](const auto& strings) {
+    bytes += MemoryStats::HeapBytes(strings);
+    for (const std::string& str : strings) {
+      bytes += MemoryStats::HeapBytes(str);
+    }
+  };
+  auto add_string_map = [&](const SymbolMap& map) {
+    bytes += MemoryStats::HeapBytes(map);
+    for (const auto& [key, value] : map) {
+      bytes += MemoryStats::HeapBytes(key) + MemoryStats::HeapBytes(value);
+    }
+  };
+  add_string_map(global_sym_map_);
+  add_string_map(import_module_sym_map_);
+  add_strings(global_syms_);
+  add_strings(typevector_structs_);
+  add_strings(import_module_set_);
+  add_strings(import_func_module_set_);
+  add_strings(func_type_names_);
+  bytes += MemoryStats::HeapBytes(unique_imports_) +
+           MemoryStats::HeapBytes(lazy_tables_) +
+           MemoryStats::HeapBytes(profile_func_index_) +
+           MemoryStats::HeapBytes(profile_loop_base_) +
+           MemoryStats::HeapBytes(profile_loop_funcs_);
+  stats->Add("cwriter.symbols", bytes, global_syms_.size());
+  stats->Add("cwriter.func_buffers", peak_func_section_bytes_);
+}
+
 // static
 const char* CWriter::GetReferenceTypeName(const Type& type) {
   switch (type) {
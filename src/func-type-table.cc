@@ -0,0 +1,70 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/func-type-table.h"
+
+#include <cassert>
+
+namespace wabt {
+
+FuncTypeTable::FuncTypeTable() {
+  Id id = Intern({}, {});
+  WABT_USE(id);
+  assert(id == kEmptyId);
+}
+
+// static
+size_t FuncTypeTable::Hash(const TypeVector& params,
+                           const TypeVector& results) {
+  // Types compare by their enum alone, so that is all that is hashed.
+  size_t hash = params.size();
+  auto combine = [&](Type type) {
+    hash = hash * 31 + static_cast<uint32_t>(static_cast<Type::Enum>(type));
+  };
+  for (Type type : params) {
+    combine(type);
+  }
+  combine(Type::Void);
+  for (Type type : results) {
+    combine(type);
+  }
+  return hash;
+}
+
+FuncTypeTable::Id FuncTypeTable::Intern(const TypeVector& params,
+                                        const TypeVector& results) {
+  Id id = Find(params, results);
+  if (id == kInvalidIndex) {
+    id = entries_.size();
+    entries_.push_back(Entry{params, results});
+    ids_.emplace(Hash(params, results), id);
+  }
+  return id;
+}
+
+FuncTypeTable::Id FuncTypeTable::Find(const TypeVector& params,
+                                      const TypeVector& results) const {
+  auto range = ids_.equal_range(Hash(params, results));
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    const Entry& entry = entries_[iter->second];
+    if (entry.params == params && entry.results == results) {
+      return iter->second;
+    }
+  }
+  return kInvalidIndex;
+}
+
+}  // namespace wabt
@@ -29,6 +29,25 @@ namespace wabt {
 
 namespace {
 
+const char* LocalPrefix(const Func& func, Index index) {
+  return index < func.GetNumParams() ? "p" : "l";
+}
+
+const char* LabelPrefix(LabelType label_type) {
+  switch (label_type) {
+    case LabelType::Block:
+      return "B";
+    case LabelType::Loop:
+      return "L";
+    case LabelType::If:
+      return "I";
+    case LabelType::Try:
+      return "T";
+    default:
+      WABT_UNREACHABLE;
+  }
+}
+
 class NameGenerator : public ExprVisitor::DelegateNop {
  public:
   NameGenerator(NameOpts opts);
@@ -201,36 +220,43 @@ void NameGenerator::GenerateAndBindLocalNames(Func* func) {
       continue;
     }
 
-    const char* prefix = i < func->GetNumParams() ? "p" : "l";
     std::string new_name;
-    GenerateAndBindName(&func->bindings, prefix, i, &new_name);
+    GenerateAndBindName(&func->bindings, LocalPrefix(*func, i), i, &new_name);
     index_to_name[i] = new_name;
   }
 }
 
 Result NameGenerator::BeginBlockExpr(BlockExpr* expr) {
-  MaybeGenerateName("B", label_count_++, &expr->block.label);
+  MaybeGenerateName(LabelPrefix(LabelType::Block), label_count_++,
+                    &expr->block.label);
   return Result::Ok;
 }
 
 Result NameGenerator::BeginTryExpr(TryExpr* expr) {
-  MaybeGenerateName("T", label_count_++, &expr->block.label);
+  MaybeGenerateName(LabelPrefix(LabelType::Try), label_count_++,
+                    &expr->block.label);
   return Result::Ok;
 }
 
 Result NameGenerator::BeginLoopExpr(LoopExpr* expr) {
-  MaybeGenerateName("L", label_count_++, &expr->block.label);
+  MaybeGenerateName(LabelPrefix(LabelType::Loop), label_count_++,
+                    &expr->block.label);
   return Result::Ok;
 }
 
 Result NameGenerator::BeginIfExpr(IfExpr* expr) {
-  MaybeGenerateName("I", label_count_++, &expr->true_.label);
+  MaybeGenerateName(LabelPrefix(LabelType::If), label_count_++,
+                    &expr->true_.label);
   return Result::Ok;
 }
 
 Result NameGenerator::VisitFunc(Index func_index, Func* func) {
   MaybeGenerateAndBindName(&module_->func_bindings, "f", func_index,
                            &func->name);
+  if (opts_ & NameOpts::LocalNamesOnDemand) {
+    return Result::Ok;
+  }
+
   GenerateAndBindLocalNames(func);
 
   label_count_ = 0;
@@ -423,11 +449,71 @@ Result NameGenerator::VisitModule(Module* module) {
   return Result::Ok;
 }
 
+// Counts labels like NameGenerator, but generates the names into a map instead
+// of storing them in the IR.
+class LabelNameGenerator : public ExprVisitor::DelegateNop {
+ public:
+  explicit LabelNameGenerator(LabelNameMap* names) : names_(names) {}
+
+  Result BeginBlockExpr(BlockExpr* expr) override {
+    MaybeGenerate(LabelType::Block, expr->block);
+    return Result::Ok;
+  }
+  Result BeginTryExpr(TryExpr* expr) override {
+    MaybeGenerate(LabelType::Try, expr->block);
+    return Result::Ok;
+  }
+  Result BeginLoopExpr(LoopExpr* expr) override {
+    MaybeGenerate(LabelType::Loop, expr->block);
+    return Result::Ok;
+  }
+  Result BeginIfExpr(IfExpr* expr) override {
+    MaybeGenerate(LabelType::If, expr->true_);
+    return Result::Ok;
+  }
+
+ private:
+  void MaybeGenerate(LabelType label_type, const Block& block) {
+    Index index = label_count_++;
+    if (block.label.empty()) {
+      std::string name = "$";
+      name += LabelPrefix(label_type);
+      name += std::to_string(index);
+      names_->emplace(&block, std::move(name));
+    }
+  }
+
+  LabelNameMap* names_;
+  Index label_count_ = 0;
+};
+
 }  // end anonymous namespace
 
 Result GenerateNames(Module* module, NameOpts opts) {
+  assert(!((opts & NameOpts::AlphaNames) &&
+           (opts & NameOpts::LocalNamesOnDemand)));
   NameGenerator generator(opts);
   return generator.VisitModule(module);
 }
 
+std::string GenerateLocalName(const Func& func, Index index) {
+  // Matches GenerateAndBindLocalNames: the other generated local names can't
+  // collide with this one, so only the func's own names need checking.
+  std::string base = "$";
+  base += LocalPrefix(func, index);
+  base += std::to_string(index);
+  std::string name = base;
+  for (unsigned disambiguator = 1; func.bindings.count(name);
+       ++disambiguator) {
+    name = base + '_' + std::to_string(disambiguator);
+  }
+  return name;
+}
+
+void GenerateLabelNames(const Func& func, LabelNameMap* out) {
+  LabelNameGenerator generator(out);
+  ExprVisitor visitor(&generator);
+  visitor.VisitFunc(const_cast<Func*>(&func));
+}
+
 }  // namespace wabt
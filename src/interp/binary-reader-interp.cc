@@ -22,6 +22,7 @@
 #include "wabt/binary-reader-nop.h"
 #include "wabt/feature.h"
 #include "wabt/interp/interp.h"
+#include "wabt/interp/istream-optimizer.h"
 #include "wabt/shared-validator.h"
 #include "wabt/stream.h"
 
@@ -67,6 +68,8 @@ struct FixupMap {
   void Clear();
   void Append(Index, Offset);
   void Resolve(Istream&, Index);
+  // Moves fixups to where OptimizeFunc put the Br that they belong to.
+  void Relocate(const IstreamOffsetMap&);
 
   std::map<Index, Fixups> map;
 };
@@ -76,7 +79,8 @@ class BinaryReaderInterp : public BinaryReaderNop {
   BinaryReaderInterp(ModuleDesc* module,
                      std::string_view filename,
                      Errors* errors,
-                     const Features& features);
+                     const Features& features,
+                     const IstreamOptions&);
 
   // Implement BinaryReader.
   bool OnError(const Error&) override;
@@ -306,7 +310,7 @@ class BinaryReaderInterp : public BinaryReaderNop {
                                     Index keep_extra,
                                     Index* out_drop_count,
                                     Index* out_keep_count);
-  Result BeginInitExpr(FuncDesc* init_func);
+  Result BeginInitExpr(ValueType type, InitExpr* init);
   Result EndInitExpr();
 
   void EmitBr(Index depth,
@@ -317,6 +321,9 @@ class BinaryReaderInterp : public BinaryReaderNop {
   u32 GetFuncOffset(Index func_index);
 
   Index TranslateLocalIndex(Index local_index);
+  // Returns the opcode to emit for the load or store |opcode| of memory
+  // |memidx|.
+  Opcode GetMemoryOpcode(Opcode opcode, Index memidx) const;
 
   Index num_func_imports() const;
 
@@ -327,6 +334,10 @@ class BinaryReaderInterp : public BinaryReaderNop {
   SharedValidator validator_;
 
   FuncDesc* func_;
+  // Init expressions are read into |init_func_|'s code like a function body,
+  // then moved to |init_expr_|.
+  FuncDesc init_func_{FuncType{{}, {}}, {}, Istream::kInvalidOffset, {}};
+  InitExpr* init_expr_ = nullptr;
   std::vector<Label> label_stack_;
   FixupMap depth_fixups_;
   FixupMap func_fixups_;
@@ -341,6 +352,7 @@ class BinaryReaderInterp : public BinaryReaderNop {
   std::vector<TagType> tag_types_;        // Includes imported and defined.
 
   std::string_view filename_;
+  IstreamOptions istream_options_;
 };
 
 Location BinaryReaderInterp::GetLocation() const {
@@ -369,15 +381,27 @@ void FixupMap::Resolve(Istream& istream, Index index) {
   map.erase(iter);
 }
 
+void FixupMap::Relocate(const IstreamOffsetMap& offset_map) {
+  // Each fixup is the immediate of a Br, right after its opcode.
+  const Offset kImmOffset = sizeof(Istream::SerializedOpcode);
+  for (auto& [index, fixups] : map) {
+    for (Offset& offset : fixups) {
+      offset = offset_map.Map(offset - kImmOffset) + kImmOffset;
+    }
+  }
+}
+
 BinaryReaderInterp::BinaryReaderInterp(ModuleDesc* module,
                                        std::string_view filename,
                                        Errors* errors,
-                                       const Features& features)
+                                       const Features& features,
+                                       const IstreamOptions& istream_options)
     : errors_(errors),
       module_(*module),
       istream_(module->istream),
       validator_(errors, ValidateOptions(features)),
-      filename_(filename) {}
+      filename_(filename),
+      istream_options_(istream_options) {}
 
 Label* BinaryReaderInterp::GetLabel(Index depth) {
   assert(depth < label_stack_.size());
@@ -623,30 +647,62 @@ Result BinaryReaderInterp::OnGlobalCount(Index count) {
 Result BinaryReaderInterp::BeginGlobal(Index index, Type type, bool mutable_) {
   CHECK_RESULT(validator_.OnGlobal(GetLocation(), type, mutable_));
   GlobalType global_type{type, ToMutability(mutable_)};
-  FuncDesc init_func{FuncType{{}, {type}}, {}, Istream::kInvalidOffset, {}};
-  module_.globals.push_back(GlobalDesc{global_type, init_func});
+  module_.globals.push_back(GlobalDesc{global_type, {}});
   global_types_.push_back(global_type);
   return Result::Ok;
 }
 
 Result BinaryReaderInterp::BeginGlobalInitExpr(Index index) {
   GlobalDesc& global = module_.globals.back();
-  return BeginInitExpr(&global.init_func);
+  return BeginInitExpr(global.type.type, &global.init);
 }
 
 Result BinaryReaderInterp::EndInitExpr() {
   FixupTopLabel();
   CHECK_RESULT(validator_.EndInitExpr());
-  istream_.Emit(Opcode::Return);
   PopLabel();
+
+  // The validator only allows constants, global.get, ref.func and integer
+  // arithmetic here, so each instruction has at most one immediate.
+  InitExpr* init = init_expr_;
+  Istream::Offset offset = func_->code_offset;
+  while (offset < istream_.end()) {
+    Instr instr = istream_.Read(&offset);
+    v128 imm{};
+    switch (instr.kind) {
+      case InstrKind::Imm_0_Op_0:
+      case InstrKind::Imm_0_Op_2:
+        break;
+      case InstrKind::Imm_Index_Op_0:
+      case InstrKind::Imm_I32_Op_0:
+      case InstrKind::Imm_F32_Op_0:
+        imm.set_u32(0, instr.imm_u32);
+        break;
+      case InstrKind::Imm_I64_Op_0:
+      case InstrKind::Imm_F64_Op_0:
+        imm.set_u64(0, instr.imm_u64);
+        break;
+      case InstrKind::Imm_V128_Op_0:
+        imm = instr.imm_v128;
+        break;
+      default:
+        WABT_UNREACHABLE;
+    }
+    init->instrs.push_back(InitExpr::Instr{instr.op, imm});
+  }
+  FoldInitExpr(init);
+
+  istream_.Truncate(func_->code_offset);
+  func_ = nullptr;
+  init_expr_ = nullptr;
   return Result::Ok;
 }
 
-Result BinaryReaderInterp::BeginInitExpr(FuncDesc* func) {
+Result BinaryReaderInterp::BeginInitExpr(ValueType type, InitExpr* init) {
   label_stack_.clear();
-  func_ = func;
-  func_->code_offset = istream_.end();
-  Type type = func->type.results[0];
+  init_func_ = FuncDesc{FuncType{{}, {type}}, {}, istream_.end(), {}};
+  func_ = &init_func_;
+  init_expr_ = init;
   CHECK_RESULT(validator_.BeginInitExpr(GetLocation(), type));
   // Push implicit init func label (equivalent to return).
   PushLabel(LabelKind::Try, Istream::kInvalidOffset, Istream::kInvalidOffset);
@@ -710,21 +766,19 @@ Result BinaryReaderInterp::BeginElemSegment(Index index,
   CHECK_RESULT(validator_.OnElemSegment(GetLocation(),
                                         Var(table_index, GetLocation()), mode));
 
-  ValueType offset_type = ValueType::I32;
-  if (table_index < table_types_.size() &&
-      table_types_[table_index].limits.is_64) {
-    offset_type = ValueType::I64;
-  }
-  FuncDesc init_func{
-      FuncType{{}, {offset_type}}, {}, Istream::kInvalidOffset, {}};
-  ElemDesc desc{{}, ValueType::Void, mode, table_index, init_func};
+  ElemDesc desc{{}, ValueType::Void, mode, table_index, {}};
   module_.elems.push_back(desc);
   return Result::Ok;
 }
 
 Result BinaryReaderInterp::BeginElemSegmentInitExpr(Index index) {
   ElemDesc& elem = module_.elems.back();
-  return BeginInitExpr(&elem.init_func);
+  ValueType offset_type = ValueType::I32;
+  if (elem.table_index < table_types_.size() &&
+      table_types_[elem.table_index].limits.is_64) {
+    offset_type = ValueType::I64;
+  }
+  return BeginInitExpr(offset_type, &elem.offset);
 }
 
 Result BinaryReaderInterp::EndElemSegmentInitExpr(Index index) {
@@ -747,10 +801,9 @@ Result BinaryReaderInterp::OnElemSegmentElemExprCount(Index index,
 Result BinaryReaderInterp::BeginElemExpr(Index elem_index, Index expr_index) {
   assert(elem_index == module_.elems.size() - 1);
   ElemDesc& elem = module_.elems.back();
-  elem.elements.push_back(
-      {FuncType{{}, {elem.type}}, {}, Istream::kInvalidOffset, {}});
+  elem.elements.emplace_back();
   assert(expr_index == elem.elements.size() - 1);
-  return BeginInitExpr(&elem.elements.back());
+  return BeginInitExpr(elem.type, &elem.elements.back());
 }
 
 Result BinaryReaderInterp::EndElemExpr(Index elem_index, Index expr_index) {
@@ -765,7 +818,12 @@ Result BinaryReaderInterp::OnDataCount(Index count) {
 
 Result BinaryReaderInterp::BeginDataSegmentInitExpr(Index index) {
   DataDesc& data = module_.datas.back();
-  return BeginInitExpr(&data.init_func);
+  ValueType offset_type = ValueType::I32;
+  if (data.memory_index < memory_types_.size() &&
+      memory_types_[data.memory_index].limits.is_64) {
+    offset_type = ValueType::I64;
+  }
+  return BeginInitExpr(offset_type, &data.offset);
 }
 
 Result BinaryReaderInterp::EndDataSegmentInitExpr(Index index) {
@@ -779,14 +837,7 @@ Result BinaryReaderInterp::BeginDataSegment(Index index,
   CHECK_RESULT(validator_.OnDataSegment(
       GetLocation(), Var(memory_index, GetLocation()), mode));
 
-  ValueType offset_type = ValueType::I32;
-  if (memory_index < memory_types_.size() &&
-      memory_types_[memory_index].limits.is_64) {
-    offset_type = ValueType::I64;
-  }
-  FuncDesc init_func{
-      FuncType{{}, {offset_type}}, {}, Istream::kInvalidOffset, {}};
-  DataDesc desc{{}, mode, memory_index, init_func};
+  DataDesc desc{{}, mode, memory_index, {}};
   module_.datas.push_back(desc);
   return Result::Ok;
 }
@@ -849,6 +900,14 @@ Result BinaryReaderInterp::EndFunctionBody(Index index) {
   istream_.EmitDropKeep(drop_count, keep_count);
   istream_.Emit(Opcode::Return);
   PopLabel();
+  if (istream_options_.optimize) {
+    IstreamOffsetMap offset_map;
+    OptimizeFunc(&istream_, func_, &offset_map);
+    func_fixups_.Relocate(offset_map);
+  }
+  if (istream_options_.cache_top_of_stack) {
+    CacheTopOfStack(&istream_, func_);
+  }
   func_ = nullptr;
   return Result::Ok;
 }
@@ -944,7 +1003,7 @@ Result BinaryReaderInterp::OnLoadSplatExpr(Opcode opcode,
   CHECK_RESULT(validator_.OnLoadSplat(GetLocation(), opcode,
                                       Var(memidx, GetLocation()),
                                       GetAlignment(align_log2), offset));
-  istream_.Emit(opcode, memidx, offset);
+  istream_.Emit(GetMemoryOpcode(opcode, memidx), memidx, offset);
   return Result::Ok;
 }
 
@@ -955,7 +1014,7 @@ Result BinaryReaderInterp::OnLoadZeroExpr(Opcode opcode,
   CHECK_RESULT(validator_.OnLoadZero(GetLocation(), opcode,
                                      Var(memidx, GetLocation()),
                                      GetAlignment(align_log2), offset));
-  istream_.Emit(opcode, memidx, offset);
+  istream_.Emit(GetMemoryOpcode(opcode, memidx), memidx, offset);
   return Result::Ok;
 }
 
@@ -1261,6 +1320,62 @@ Result BinaryReaderInterp::OnGlobalSetExpr(Index global_index) {
   return Result::Ok;
 }
 
+Opcode BinaryReaderInterp::GetMemoryOpcode(Opcode opcode,
+                                           Index memidx) const {
+  // Memory 0 has its own opcodes, which don't need to look the memory up or
+  // check its address type.
+  if (memidx != 0) {
+    return opcode;
+  }
+  bool is_64 = memory_types_[0].limits.is_64;
+  switch (opcode) {
+#define WABT_MEMORY0_OPCODE(Name) \
+  case Opcode::Name:              \
+    return is_64 ? Opcode::Interp##Name##M64 : Opcode::Interp##Name##M32;
+    WABT_MEMORY0_OPCODE(I32Load)
+    WABT_MEMORY0_OPCODE(I64Load)
+    WABT_MEMORY0_OPCODE(F32Load)
+    WABT_MEMORY0_OPCODE(F64Load)
+    WABT_MEMORY0_OPCODE(I32Load8S)
+    WABT_MEMORY0_OPCODE(I32Load8U)
+    WABT_MEMORY0_OPCODE(I32Load16S)
+    WABT_MEMORY0_OPCODE(I32Load16U)
+    WABT_MEMORY0_OPCODE(I64Load8S)
+    WABT_MEMORY0_OPCODE(I64Load8U)
+    WABT_MEMORY0_OPCODE(I64Load16S)
+    WABT_MEMORY0_OPCODE(I64Load16U)
+    WABT_MEMORY0_OPCODE(I64Load32S)
+    WABT_MEMORY0_OPCODE(I64Load32U)
+    WABT_MEMORY0_OPCODE(I32Store)
+    WABT_MEMORY0_OPCODE(I64Store)
+    WABT_MEMORY0_OPCODE(F32Store)
+    WABT_MEMORY0_OPCODE(F64Store)
+    WABT_MEMORY0_OPCODE(I32Store8)
+    WABT_MEMORY0_OPCODE(I32Store16)
+    WABT_MEMORY0_OPCODE(I64Store8)
+    WABT_MEMORY0_OPCODE(I64Store16)
+    WABT_MEMORY0_OPCODE(I64Store32)
+    WABT_MEMORY0_OPCODE(V128Load)
+    WABT_MEMORY0_OPCODE(V128Store)
+    WABT_MEMORY0_OPCODE(V128Load8X8S)
+    WABT_MEMORY0_OPCODE(V128Load8X8U)
+    WABT_MEMORY0_OPCODE(V128Load16X4S)
+    WABT_MEMORY0_OPCODE(V128Load16X4U)
+    WABT_MEMORY0_OPCODE(V128Load32X2S)
+    WABT_MEMORY0_OPCODE(V128Load32X2U)
+    WABT_MEMORY0_OPCODE(V128Load8Splat)
+    WABT_MEMORY0_OPCODE(V128Load16Splat)
+    WABT_MEMORY0_OPCODE(V128Load32Splat)
+    WABT_MEMORY0_OPCODE(V128Load64Splat)
+    WABT_MEMORY0_OPCODE(V128Load32Zero)
+    WABT_MEMORY0_OPCODE(V128Load64Zero)
+#undef WABT_MEMORY0_OPCODE
+
+    default:
+      WABT_UNREACHABLE;
+  }
+}
+
 Index BinaryReaderInterp::TranslateLocalIndex(Index local_index) {
   return validator_.type_stack_size() + validator_.GetLocalCount() -
          local_index;
@@ -1300,7 +1415,7 @@ Result BinaryReaderInterp::OnLoadExpr(Opcode opcode,
   CHECK_RESULT(validator_.OnLoad(GetLocation(), opcode,
                                  Var(memidx, GetLocation()),
                                  GetAlignment(align_log2), offset));
-  istream_.Emit(opcode, memidx, offset);
+  istream_.Emit(GetMemoryOpcode(opcode, memidx), memidx, offset);
   return Result::Ok;
 }
 
@@ -1311,7 +1426,7 @@ Result BinaryReaderInterp::OnStoreExpr(Opcode opcode,
   CHECK_RESULT(validator_.OnStore(GetLocation(), opcode,
                                   Var(memidx, GetLocation()),
                                   GetAlignment(align_log2), offset));
-  istream_.Emit(opcode, memidx, offset);
+  istream_.Emit(GetMemoryOpcode(opcode, memidx), memidx, offset);
   return Result::Ok;
 }
 
@@ -1609,8 +1724,10 @@ Result ReadBinaryInterp(std::string_view filename,
                         size_t size,
                         const ReadBinaryOptions& options,
                         Errors* errors,
-                        ModuleDesc* out_module) {
-  BinaryReaderInterp reader(out_module, filename, errors, options.features);
+                        ModuleDesc* out_module,
+                        const IstreamOptions& istream_options) {
+  BinaryReaderInterp reader(out_module, filename, errors, options.features,
+                            istream_options);
   return ReadBinary(data, size, &reader, options);
 }
 
@@ -0,0 +1,1691 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/interp/interp-jit.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "wabt/interp/interp-math.h"
+#include "wabt/stream.h"
+#include "wabt/string-format.h"
+
+// The generated code reads and writes Values in place, so it relies on their
+// layout in release builds; WABT_DEBUG builds tag each Value with its type.
+#if (defined(__x86_64__) || defined(_M_X64)) && HAVE_SYS_MMAN_H && \
+    !defined(_WIN32) && !defined(WABT_DEBUG)
+#define WABT_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#else
+#define WABT_JIT_SUPPORTED 0
+#endif
+
+namespace wabt {
+namespace interp {
+
+struct JitCode {
+  ~JitCode();
+
+  // Null if the function is left to the interpreter.
+  u8* code = nullptr;
+  size_t size = 0;
+  struct Entry {
+    Istream::Offset pc;
+    u32 code_offset;
+    // How many Values the value stack is grown by before entering here.
+    u32 stack_reserve;
+  };
+
+  // The istream offsets at which the code can be entered, sorted.
+  std::vector<Entry> entries;
+  // Memory 0 of the function's instance, if the code accesses it.
+  Memory* memory = nullptr;
+};
+
+JitCode::~JitCode() {
+#if WABT_JIT_SUPPORTED
+  if (code) {
+    munmap(code, size);
+  }
+#endif
+}
+
+#if WABT_JIT_SUPPORTED
+
+namespace {
+
+using O = Opcode;
+
+enum Reg : int {
+  RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+  R8, R9, R10, R11, R12, R13, R14, R15,
+};
+
+// These are all callee-saved, so they keep the state of the generated code
+// across calls to helpers.
+const Reg kCount = RBX;       // Instructions executed since the entry.
+const Reg kLimit = RBP;       // One past the last Value the stack can use.
+const Reg kSp = R12;          // One past the top of the value stack.
+const Reg kContext = R13;     // The Context.
+const Reg kMemory = R14;      // The data of memory 0.
+const Reg kMemorySize = R15;  // The size of memory 0 in bytes.
+
+// Condition codes, as encoded in jcc and setcc.
+enum Cond : u8 {
+  kBelow = 0x2,
+  kAboveEqual = 0x3,
+  kEqual = 0x4,
+  kNotEqual = 0x5,
+  kBelowEqual = 0x6,
+  kAbove = 0x7,
+  kLess = 0xc,
+  kGreaterEqual = 0xd,
+  kLessEqual = 0xe,
+  kGreater = 0xf,
+};
+
+// The /digit opcode extensions of the group 1 ALU instructions.
+enum Alu : int {
+  kAdd = 0,
+  kOr = 1,
+  kAnd = 4,
+  kSub = 5,
+  kXor = 6,
+  kCmp = 7,
+};
+
+// The /digit opcode extensions of the group 2 shift instructions.
+enum Shift : int {
+  kRol = 0,
+  kRor = 1,
+  kShl = 4,
+  kShr = 5,
+  kSar = 7,
+};
+
+// Shared by the generated code and Jit::Run.
+struct Context {
+  Value* sp;
+  Value* limit;
+  u8* memory;
+  u64 memory_size;
+  u64 instructions;
+  u32 pc;
+};
+
+// Why the generated code returned; the frame continues at Context::pc either
+// way.
+enum ExitKind : u32 {
+  // The interpreter runs the instruction at pc.
+  kExitInterpret,
+  // pc is the start of another function, after a return_call.
+  kExitJump,
+};
+
+using EntryFunc = u32 (*)(Context*, const u8* target);
+
+constexpr s32 kValueSize = sizeof(Value);
+static_assert(kValueSize == 16, "the generated code assumes 16-byte Values");
+
+// How far the value stack may grow beyond the block that the code is entered
+// at before it exits to the interpreter to make room.
+constexpr u32 kStackSlack = 16;
+
+// The fewest instructions the code must be able to run from an entry point
+// for entering there to be worth it, unless it reaches a branch first.
+constexpr u32 kMinEntryRun = 4;
+
+template <typename T>
+Value MakeValue(T val) {
+  return Value::Make(val);
+}
+
+template <>
+Value MakeValue<bool>(bool val) {
+  return Value::Make(static_cast<u32>(val ? 1 : 0));
+}
+
+// Helpers for the instructions without an inline template. Each takes the
+// top of the value stack and does what the interpreter does for the
+// instruction, using the same functions. Those that can trap return false
+// instead, and the interpreter runs the instruction again to report it.
+template <typename R, typename T, R WABT_VECTORCALL F(T)>
+void UnopHelper(Value* sp) {
+  sp[-1] = MakeValue<R>(F(sp[-1].Get<T>()));
+}
+
+template <typename R, typename T, R WABT_VECTORCALL F(T, T)>
+void BinopHelper(Value* sp) {
+  sp[-2] = MakeValue<R>(F(sp[-2].Get<T>(), sp[-1].Get<T>()));
+}
+
+template <typename R, typename T>
+bool ConvertHelper(Value* sp) {
+  T val = sp[-1].Get<T>();
+  if (std::is_integral<R>::value && std::is_floating_point<T>::value &&
+      IsNaN(val)) {
+    return false;
+  }
+  if (!CanConvert<R>(val)) {
+    return false;
+  }
+  sp[-1] = MakeValue<R>(Convert<R>(val));
+  return true;
+}
+
+void ZeroHelper(Value* sp, u32 count) {
+  std::fill(sp, sp + count, Value());
+}
+
+void DropKeepHelper(Value* sp, u32 drop, u32 keep) {
+  std::move(sp - keep, sp, sp - keep - drop);
+}
+
+struct Helper {
+  uintptr_t func = 0;
+  u32 pops = 0;
+  bool can_trap = false;
+};
+
+template <typename F>
+Helper MakeHelper(F* func, u32 pops, bool can_trap) {
+  return Helper{reinterpret_cast<uintptr_t>(func), pops, can_trap};
+}
+
+bool GetHelper(Opcode op, Helper* out) {
+#define UNOP(R, T, F) *out = MakeHelper(UnopHelper<R, T, F>, 1, false)
+#define BINOP(R, T, F) *out = MakeHelper(BinopHelper<R, T, F>, 2, false)
+#define CONVERT(R, T) *out = MakeHelper(ConvertHelper<R, T>, 1, true)
+  // clang-format off
+  switch (op) {
+    case O::I32Clz:    UNOP(u32, u32, IntClz<u32>); break;
+    case O::I32Ctz:    UNOP(u32, u32, IntCtz<u32>); break;
+    case O::I32Popcnt: UNOP(u32, u32, IntPopcnt<u32>); break;
+    case O::I64Clz:    UNOP(u64, u64, IntClz<u64>); break;
+    case O::I64Ctz:    UNOP(u64, u64, IntCtz<u64>); break;
+    case O::I64Popcnt: UNOP(u64, u64, IntPopcnt<u64>); break;
+
+    case O::F32Eq: BINOP(bool, f32, Eq<f32>); break;
+    case O::F32Ne: BINOP(bool, f32, Ne<f32>); break;
+    case O::F32Lt: BINOP(bool, f32, Lt<f32>); break;
+    case O::F32Gt: BINOP(bool, f32, Gt<f32>); break;
+    case O::F32Le: BINOP(bool, f32, Le<f32>); break;
+    case O::F32Ge: BINOP(bool, f32, Ge<f32>); break;
+    case O::F64Eq: BINOP(bool, f64, Eq<f64>); break;
+    case O::F64Ne: BINOP(bool, f64, Ne<f64>); break;
+    case O::F64Lt: BINOP(bool, f64, Lt<f64>); break;
+    case O::F64Gt: BINOP(bool, f64, Gt<f64>); break;
+    case O::F64Le: BINOP(bool, f64, Le<f64>); break;
+    case O::F64Ge: BINOP(bool, f64, Ge<f64>); break;
+
+    case O::F32Abs:      UNOP(f32, f32, FloatAbs<f32>); break;
+    case O::F32Neg:      UNOP(f32, f32, FloatNeg<f32>); break;
+    case O::F32Ceil:     UNOP(f32, f32, FloatCeil<f32>); break;
+    case O::F32Floor:    UNOP(f32, f32, FloatFloor<f32>); break;
+    case O::F32Trunc:    UNOP(f32, f32, FloatTrunc<f32>); break;
+    case O::F32Nearest:  UNOP(f32, f32, FloatNearest<f32>); break;
+    case O::F32Sqrt:     UNOP(f32, f32, FloatSqrt<f32>); break;
+    case O::F32Add:      BINOP(f32, f32, Add<f32>); break;
+    case O::F32Sub:      BINOP(f32, f32, Sub<f32>); break;
+    case O::F32Mul:      BINOP(f32, f32, Mul<f32>); break;
+    case O::F32Div:      BINOP(f32, f32, FloatDiv<f32>); break;
+    case O::F32Min:      BINOP(f32, f32, FloatMin<f32>); break;
+    case O::F32Max:      BINOP(f32, f32, FloatMax<f32>); break;
+    case O::F32Copysign: BINOP(f32, f32, FloatCopysign<f32>); break;
+
+    case O::F64Abs:      UNOP(f64, f64, FloatAbs<f64>); break;
+    case O::F64Neg:      UNOP(f64, f64, FloatNeg<f64>); break;
+    case O::F64Ceil:     UNOP(f64, f64, FloatCeil<f64>); break;
+    case O::F64Floor:    UNOP(f64, f64, FloatFloor<f64>); break;
+    case O::F64Trunc:    UNOP(f64, f64, FloatTrunc<f64>); break;
+    case O::F64Nearest:  UNOP(f64, f64, FloatNearest<f64>); break;
+    case O::F64Sqrt:     UNOP(f64, f64, FloatSqrt<f64>); break;
+    case O::F64Add:      BINOP(f64, f64, Add<f64>); break;
+    case O::F64Sub:      BINOP(f64, f64, Sub<f64>); break;
+    case O::F64Mul:      BINOP(f64, f64, Mul<f64>); break;
+    case O::F64Div:      BINOP(f64, f64, FloatDiv<f64>); break;
+    case O::F64Min:      BINOP(f64, f64, FloatMin<f64>); break;
+    case O::F64Max:      BINOP(f64, f64, FloatMax<f64>); break;
+    case O::F64Copysign: BINOP(f64, f64, FloatCopysign<f64>); break;
+
+    case O::I32TruncF32S:   CONVERT(s32, f32); break;
+    case O::I32TruncF32U:   CONVERT(u32, f32); break;
+    case O::I32TruncF64S:   CONVERT(s32, f64); break;
+    case O::I32TruncF64U:   CONVERT(u32, f64); break;
+    case O::I64TruncF32S:   CONVERT(s64, f32); break;
+    case O::I64TruncF32U:   CONVERT(u64, f32); break;
+    case O::I64TruncF64S:   CONVERT(s64, f64); break;
+    case O::I64TruncF64U:   CONVERT(u64, f64); break;
+    case O::F32ConvertI32S: CONVERT(f32, s32); break;
+    case O::F32ConvertI32U: CONVERT(f32, u32); break;
+    case O::F32ConvertI64S: CONVERT(f32, s64); break;
+    case O::F32ConvertI64U: CONVERT(f32, u64); break;
+    case O::F32DemoteF64:   CONVERT(f32, f64); break;
+    case O::F64ConvertI32S: CONVERT(f64, s32); break;
+    case O::F64ConvertI32U: CONVERT(f64, u32); break;
+    case O::F64ConvertI64S: CONVERT(f64, s64); break;
+    case O::F64ConvertI64U: CONVERT(f64, u64); break;
+    case O::F64PromoteF32:  CONVERT(f64, f32); break;
+
+    case O::I32TruncSatF32S: UNOP(s32, f32, (IntTruncSat<s32, f32>)); break;
+    case O::I32TruncSatF32U: UNOP(u32, f32, (IntTruncSat<u32, f32>)); break;
+    case O::I32TruncSatF64S: UNOP(s32, f64, (IntTruncSat<s32, f64>)); break;
+    case O::I32TruncSatF64U: UNOP(u32, f64, (IntTruncSat<u32, f64>)); break;
+    case O::I64TruncSatF32S: UNOP(s64, f32, (IntTruncSat<s64, f32>)); break;
+    case O::I64TruncSatF32U: UNOP(u64, f32, (IntTruncSat<u64, f32>)); break;
+    case O::I64TruncSatF64S: UNOP(s64, f64, (IntTruncSat<s64, f64>)); break;
+    case O::I64TruncSatF64U: UNOP(u64, f64, (IntTruncSat<u64, f64>)); break;
+
+    default:
+      return false;
+  }
+  // clang-format on
+#undef UNOP
+#undef BINOP
+#undef CONVERT
+  return true;
+}
+
+// A memory operand, [base + index * (1 << scale) + disp].
+struct Mem {
+  Mem(int base, s32 disp) : base(base), disp(disp) {}
+  Mem(int base, int index, int scale, s32 disp)
+      : base(base), index(index), scale(scale), disp(disp) {}
+
+  int base;
+  int index = -1;
+  int scale = 0;
+  s32 disp;
+};
+
+// Just enough of an x86-64 assembler for the templates. |reg| is either a
+// register or the opcode extension of the ModRM byte.
+class Assembler {
+ public:
+  static const size_t kInvalidFixup = ~size_t(0);
+
+  size_t pos() const { return buf_.size(); }
+  const std::vector<u8>& buf() const { return buf_; }
+
+  void Emit8(u8 val) { buf_.push_back(val); }
+  void Emit32(u32 val) {
+    for (int i = 0; i < 4; ++i) {
+      Emit8(val >> (i * 8));
+    }
+  }
+  void Emit64(u64 val) {
+    Emit32(val);
+    Emit32(val >> 32);
+  }
+
+  // Points the rel32 at |fixup| to |target|.
+  void PatchRel32(size_t fixup, size_t target) {
+    Patch32(fixup, static_cast<u32>(target - (fixup + 4)));
+  }
+  void Patch32(size_t at, u32 val) {
+    for (int i = 0; i < 4; ++i) {
+      buf_[at + i] = val >> (i * 8);
+    }
+  }
+
+  // <opcode> reg, [mem]
+  void Op(u8 prefix,
+          bool w,
+          std::initializer_list<u8> opcode,
+          int reg,
+          const Mem& mem) {
+    if (prefix) {
+      Emit8(prefix);
+    }
+    Rex(w, reg, mem.index < 0 ? 0 : mem.index, mem.base);
+    for (u8 byte : opcode) {
+      Emit8(byte);
+    }
+    ModRm(reg, mem);
+  }
+
+  // <opcode> reg, rm
+  void OpReg(bool w, std::initializer_list<u8> opcode, int reg, int rm) {
+    Rex(w, reg, 0, rm);
+    for (u8 byte : opcode) {
+      Emit8(byte);
+    }
+    Emit8(0xc0 | ((reg & 7) << 3) | (rm & 7));
+  }
+
+  void Load(bool w, Reg dst, const Mem& src) { Op(0, w, {0x8b}, dst, src); }
+  void Store(int size, const Mem& dst, Reg src) {
+    switch (size) {
+      case 1:
+        Op(0, false, {0x88}, src, dst);
+        break;
+      case 2:
+        Op(0x66, false, {0x89}, src, dst);
+        break;
+      case 4:
+        Op(0, false, {0x89}, src, dst);
+        break;
+      case 8:
+        Op(0, true, {0x89}, src, dst);
+        break;
+      default:
+        WABT_UNREACHABLE;
+    }
+  }
+  void Lea(Reg dst, const Mem& src) { Op(0, true, {0x8d}, dst, src); }
+  void Mov(bool w, Reg dst, Reg src) { OpReg(w, {0x8b}, dst, src); }
+  void MovImm32(Reg dst, u32 imm) {
+    Rex(false, 0, 0, dst);
+    Emit8(0xb8 + (dst & 7));
+    Emit32(imm);
+  }
+  void MovImm64(Reg dst, u64 imm) {
+    Rex(true, 0, 0, dst);
+    Emit8(0xb8 + (dst & 7));
+    Emit64(imm);
+  }
+  void MovImm(bool w, const Mem& dst, s32 imm) {
+    Op(0, w, {0xc7}, 0, dst);
+    Emit32(imm);
+  }
+  void Movsx(bool w, int size, Reg dst, const Mem& src) {
+    if (size == 4) {
+      Op(0, true, {0x63}, dst, src);
+    } else {
+      Op(0, w, {0x0f, u8(size == 1 ? 0xbe : 0xbf)}, dst, src);
+    }
+  }
+  void Movzx(int size, Reg dst, const Mem& src) {
+    Op(0, false, {0x0f, u8(size == 1 ? 0xb6 : 0xb7)}, dst, src);
+  }
+
+  void AluOp(bool w, Alu op, Reg dst, const Mem& src) {
+    Op(0, w, {u8(op * 8 + 3)}, dst, src);
+  }
+  void AluOp(bool w, Alu op, Reg dst, Reg src) {
+    OpReg(w, {u8(op * 8 + 3)}, dst, src);
+  }
+  void AluImm(bool w, Alu op, Reg dst, s32 imm) {
+    if (imm >= -128 && imm <= 127) {
+      OpReg(w, {0x83}, op, dst);
+      Emit8(imm);
+    } else {
+      OpReg(w, {0x81}, op, dst);
+      Emit32(imm);
+    }
+  }
+  void CmpZero(bool w, const Mem& mem) {
+    Op(0, w, {0x83}, kCmp, mem);
+    Emit8(0);
+  }
+  void Test(bool w, Reg a, Reg b) { OpReg(w, {0x85}, b, a); }
+  void Test8(Reg a, Reg b) { OpReg(false, {0x84}, b, a); }
+  void Imul(bool w, Reg dst, const Mem& src) {
+    Op(0, w, {0x0f, 0xaf}, dst, src);
+  }
+  void ShiftCl(bool w, Shift op, Reg dst) { OpReg(w, {0xd3}, op, dst); }
+  void Div(bool w, bool is_signed, Reg divisor) {
+    OpReg(w, {0xf7}, is_signed ? 7 : 6, divisor);
+  }
+  void SignExtendRax(bool w) {
+    if (w) {
+      Emit8(0x48);
+    }
+    Emit8(0x99);  // cdq/cqo
+  }
+  void Setcc(Cond cond, Reg dst) {
+    OpReg(false, {0x0f, u8(0x90 + cond)}, 0, dst);
+  }
+  void Movzx8(Reg dst, Reg src) { OpReg(false, {0x0f, 0xb6}, dst, src); }
+
+  // Whole-Value copies go through xmm0.
+  void LoadValue(const Mem& src) { Op(0, false, {0x0f, 0x10}, 0, src); }
+  void StoreValue(const Mem& dst) { Op(0, false, {0x0f, 0x11}, 0, dst); }
+  void ZeroXmm0() { OpReg(false, {0x0f, 0x57}, 0, 0); }
+
+  void Push(Reg reg) {
+    Rex(false, 0, 0, reg);
+    Emit8(0x50 + (reg & 7));
+  }
+  void Pop(Reg reg) {
+    Rex(false, 0, 0, reg);
+    Emit8(0x58 + (reg & 7));
+  }
+  void Call(Reg target) { OpReg(false, {0xff}, 2, target); }
+  void Jmp(Reg target) { OpReg(false, {0xff}, 4, target); }
+  void Ret() { Emit8(0xc3); }
+
+  // These return the position of the rel32 to patch.
+  size_t Jcc(Cond cond) {
+    Emit8(0x0f);
+    Emit8(0x80 + cond);
+    return EmitRel32();
+  }
+  size_t Jmp() {
+    Emit8(0xe9);
+    return EmitRel32();
+  }
+  size_t LeaRip(Reg dst) {
+    Rex(true, dst, 0, 0);
+    Emit8(0x8d);
+    Emit8(0x05 | ((dst & 7) << 3));
+    return EmitRel32();
+  }
+
+ private:
+  void Rex(bool w, int reg, int index, int base) {
+    u8 rex = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((index & 8) ? 2 : 0) |
+             ((base & 8) ? 1 : 0);
+    if (rex != 0x40) {
+      Emit8(rex);
+    }
+  }
+
+  void ModRm(int reg, const Mem& mem) {
+    int mod;
+    if (mem.disp == 0 && (mem.base & 7) != RBP) {
+      mod = 0;
+    } else if (mem.disp >= -128 && mem.disp <= 127) {
+      mod = 1;
+    } else {
+      mod = 2;
+    }
+    bool sib = mem.index >= 0 || (mem.base & 7) == RSP;
+    Emit8((mod << 6) | ((reg & 7) << 3) | (sib ? RSP : (mem.base & 7)));
+    if (sib) {
+      int index = mem.index >= 0 ? mem.index : RSP;  // RSP means no index.
+      Emit8((mem.scale << 6) | ((index & 7) << 3) | (mem.base & 7));
+    }
+    if (mod == 1) {
+      Emit8(mem.disp);
+    } else if (mod == 2) {
+      Emit32(mem.disp);
+    }
+  }
+
+  size_t EmitRel32() {
+    size_t fixup = pos();
+    Emit32(0);
+    return fixup;
+  }
+
+  std::vector<u8> buf_;
+};
+
+class Compiler {
+ public:
+  Compiler(Store&,
+           Instance&,
+           Module&,
+           const FuncDesc&,
+           std::vector<Value*> global_values);
+
+  Result Compile(JitCode*, std::string* out_reason);
+
+ private:
+  // How an instruction is compiled. Inline instructions continue with the
+  // next one, though they may exit to the interpreter to trap. Jump
+  // instructions always branch, and Exit instructions are left to the
+  // interpreter.
+  enum class Lowering { Inline, Jump, Exit };
+
+  struct Decoded {
+    Istream::Offset pc;
+    Instr instr;
+    Istream::Offset next;
+  };
+
+  struct Label {
+    size_t pos = Assembler::kInvalidFixup;
+    std::vector<size_t> fixups;
+  };
+
+  struct Stub {
+    size_t fixup;
+    Istream::Offset pc;
+    ExitKind kind;
+    s32 sp_delta;
+    u32 count;
+  };
+
+  struct TableFixup {
+    size_t at;
+    size_t table;
+    Istream::Offset pc;
+  };
+
+  Result Decode(std::string* out_reason);
+  Result CheckRefs(const Instr&, std::string* out_reason);
+  bool HasRefs(const FuncType&) const;
+  bool InRange(Istream::Offset pc) const {
+    return pc >= begin_ && pc < end_;
+  }
+  void AddLabel(Istream::Offset pc) { labels_[pc]; }
+  bool IsNativeMemory(Index memory) const;
+
+  Lowering GetLowering(const Instr&, u32* pops, u32* pushes) const;
+  u32 GetBlockDepth(size_t index) const;
+  bool IsWorthEntering(size_t index) const;
+
+  Mem Slot(int n) const { return Mem(kSp, sp_delta_ - n * kValueSize); }
+  void Flush();
+  void ExitIf(Cond, Istream::Offset pc, ExitKind);
+  void Exit(Istream::Offset pc, ExitKind);
+  void JumpIf(Cond, Istream::Offset target);
+  void Jump(Istream::Offset target);
+  void BindLabel(Istream::Offset pc);
+  void Bind(size_t fixup) { asm_.PatchRel32(fixup, asm_.pos()); }
+
+  void EmitEntry();
+  void EmitStackCheck(Istream::Offset pc, u32 depth);
+  void EmitInstr(const Decoded&);
+  void EmitBinop(bool w, Alu);
+  void EmitCompare(bool w, Cond);
+  void EmitShift(bool w, Shift);
+  void EmitDivRem(bool w, bool is_signed, bool is_rem, Istream::Offset pc);
+  void EmitAddress(const Decoded&, int slot, int size, Mem* out_mem);
+  void EmitLoad(const Decoded&, int size, bool is_signed, bool w);
+  void EmitStore(const Decoded&, int size);
+  void EmitHelper(const Helper&, Istream::Offset pc);
+  void EmitCall(uintptr_t func);
+  void EmitStubs();
+
+  Store& store_;
+  Instance& inst_;
+  Module& mod_;
+  const FuncDesc& func_;
+  Istream::Offset begin_;
+  Istream::Offset end_;
+  Memory* memory_ = nullptr;
+  // The instance keeps its globals alive for as long as the function, so the
+  // code accesses them in place.
+  std::vector<Value*> global_values_;
+
+  std::vector<Decoded> instrs_;
+  std::unordered_map<Istream::Offset, Label> labels_;
+  std::vector<Stub> stubs_;
+  std::vector<TableFixup> table_fixups_;
+
+  Assembler asm_;
+  size_t epilogue_ = 0;
+  // Offset of the code's kSp from the actual top of the value stack, and the
+  // instructions executed that aren't in kCount yet. Both are zero at every
+  // label and entry point.
+  s32 sp_delta_ = 0;
+  u32 pending_count_ = 0;
+};
+
+Compiler::Compiler(Store& store,
+                   Instance& inst,
+                   Module& mod,
+                   const FuncDesc& func,
+                   std::vector<Value*> global_values)
+    : store_(store),
+      inst_(inst),
+      mod_(mod),
+      func_(func),
+      global_values_(std::move(global_values)) {
+  // Functions are laid out in the istream in order, so this one ends where
+  // the next one starts.
+  auto&& funcs = mod.desc().funcs;
+  begin_ = func.code_offset;
+  auto iter = std::upper_bound(
+      funcs.begin(), funcs.end(), begin_,
+      [](Istream::Offset offset, const FuncDesc& desc) {
+        return offset < desc.code_offset;
+      });
+  end_ = iter == funcs.end() ? mod.desc().istream.end() : iter->code_offset;
+
+  if (!inst.memories().empty()) {
+    memory_ = store.UnsafeGet<Memory>(inst.memories()[0]).get();
+  }
+}
+
+bool Compiler::HasRefs(const FuncType& type) const {
+  return std::any_of(type.params.begin(), type.params.end(),
+                     [](ValueType type) { return IsReference(type); }) ||
+         std::any_of(type.results.begin(), type.results.end(),
+                     [](ValueType type) { return IsReference(type); });
+}
+
+bool Compiler::IsNativeMemory(Index memory) const {
+  return memory == 0 && memory_ && !memory_->type().limits.is_64;
+}
+
+Result Compiler::CheckRefs(const Instr& instr, std::string* out_reason) {
+  switch (instr.op) {
+    case O::RefNull:
+    case O::RefIsNull:
+    case O::RefFunc:
+    case O::TableGet:
+    case O::TableSet:
+    case O::TableGrow:
+    case O::TableFill:
+      *out_reason = StringPrintf("uses references (%s)", instr.op.GetName());
+      return Result::Error;
+
+    case O::GlobalGet:
+    case O::GlobalSet: {
+      Global::Ptr global{store_, inst_.globals()[instr.imm_u32]};
+      if (IsReference(global->type().type)) {
+        *out_reason = "accesses a reference-typed global";
+        return Result::Error;
+      }
+      break;
+    }
+
+    case O::Call:
+    case O::InterpCallImport: {
+      Func::Ptr func{store_, inst_.funcs()[instr.imm_u32]};
+      if (HasRefs(func->type())) {
+        *out_reason = "calls a function that takes or returns references";
+        return Result::Error;
+      }
+      break;
+    }
+
+    case O::CallIndirect:
+    case O::ReturnCallIndirect:
+      if (HasRefs(mod_.desc().func_types[instr.imm_u32x2.snd])) {
+        *out_reason = "calls a function that takes or returns references";
+        return Result::Error;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return Result::Ok;
+}
+
+Result Compiler::Decode(std::string* out_reason) {
+  if (HasRefs(func_.type) ||
+      std::any_of(func_.locals.begin(), func_.locals.end(),
+                  [](const LocalDesc& local) {
+                    return IsReference(local.type);
+                  })) {
+    *out_reason = "has reference-typed locals, parameters or results";
+    return Result::Error;
+  }
+  // Catches are run by the interpreter, but the native code may see the
+  // values they push.
+  for (auto&& handler : func_.handlers) {
+    for (auto&& catch_ : handler.catches) {
+      Tag::Ptr tag{store_, inst_.tags()[catch_.tag_index]};
+      auto&& signature = tag->type().signature;
+      if (std::any_of(signature.begin(), signature.end(),
+                      [](ValueType type) { return IsReference(type); })) {
+        *out_reason = "catches an exception with reference values";
+        return Result::Error;
+      }
+    }
+  }
+
+  auto&& istream = mod_.desc().istream;
+  for (Istream::Offset pc = begin_; pc < end_;) {
+    Decoded decoded;
+    decoded.pc = pc;
+    decoded.instr = istream.Read(&pc);
+    decoded.next = pc;
+    CHECK_RESULT(CheckRefs(decoded.instr, out_reason));
+
+    switch (decoded.instr.op) {
+      case O::Br:
+      case O::BrIf:
+      case O::InterpBrUnless:
+        if (InRange(decoded.instr.imm_u32)) {
+          AddLabel(decoded.instr.imm_u32);
+        }
+        break;
+
+      case O::BrTable:
+        for (u32 i = 0; i <= decoded.instr.imm_u32; ++i) {
+          AddLabel(decoded.next + i * Istream::kBrTableEntrySize);
+        }
+        break;
+
+      default:
+        break;
+    }
+    instrs_.push_back(decoded);
+  }
+
+  // Every label must be the start of an instruction.
+  size_t found = 0;
+  for (auto&& decoded : instrs_) {
+    found += labels_.count(decoded.pc);
+  }
+  if (found != labels_.size()) {
+    *out_reason = "branches into the middle of an instruction";
+    return Result::Error;
+  }
+  return Result::Ok;
+}
+
+Compiler::Lowering Compiler::GetLowering(const Instr& instr,
+                                         u32* out_pops,
+                                         u32* out_pushes) const {
+  u32 pops = 0;
+  u32 pushes = 0;
+  Lowering lowering = Lowering::Inline;
+  Helper helper;
+  // clang-format off
+  switch (instr.op) {
+    case O::Nop:
+    case O::I32ReinterpretF32:
+    case O::F32ReinterpretI32:
+    case O::I64ReinterpretF64:
+    case O::F64ReinterpretI64:
+    case O::LocalTee:
+    case O::InterpLocalCopy:
+      break;
+
+    case O::Br:
+      lowering = Lowering::Jump;
+      break;
+
+    case O::BrTable:
+      pops = 1;
+      lowering = Lowering::Jump;
+      break;
+
+    case O::BrIf:
+    case O::InterpBrUnless:
+    case O::Drop:
+    case O::LocalSet:
+    case O::GlobalSet:
+      pops = 1;
+      break;
+
+    case O::Select:
+      pops = 3;
+      pushes = 1;
+      break;
+
+    case O::LocalGet:
+    case O::GlobalGet:
+    case O::I32Const:
+    case O::I64Const:
+    case O::F32Const:
+    case O::F64Const:
+      pushes = 1;
+      break;
+
+    case O::InterpAlloca:
+      pushes = instr.imm_u32;
+      break;
+
+    case O::InterpDropKeep:
+      pops = instr.imm_u32x2.fst + instr.imm_u32x2.snd;
+      pushes = instr.imm_u32x2.snd;
+      break;
+
+    case O::InterpCatchDrop:
+      if (instr.imm_u32 != 0) {
+        lowering = Lowering::Exit;
+      }
+      break;
+
+    case O::I32Eqz:
+    case O::I64Eqz:
+    case O::I32WrapI64:
+    case O::I64ExtendI32S:
+    case O::I64ExtendI32U:
+    case O::I32Extend8S:
+    case O::I32Extend16S:
+    case O::I64Extend8S:
+    case O::I64Extend16S:
+    case O::I64Extend32S:
+      pops = pushes = 1;
+      break;
+
+    case O::I32Eq: case O::I32Ne:
+    case O::I32LtS: case O::I32LtU: case O::I32GtS: case O::I32GtU:
+    case O::I32LeS: case O::I32LeU: case O::I32GeS: case O::I32GeU:
+    case O::I64Eq: case O::I64Ne:
+    case O::I64LtS: case O::I64LtU: case O::I64GtS: case O::I64GtU:
+    case O::I64LeS: case O::I64LeU: case O::I64GeS: case O::I64GeU:
+    case O::I32Add: case O::I32Sub: case O::I32Mul:
+    case O::I32DivS: case O::I32DivU: case O::I32RemS: case O::I32RemU:
+    case O::I32And: case O::I32Or: case O::I32Xor:
+    case O::I32Shl: case O::I32ShrS: case O::I32ShrU:
+    case O::I32Rotl: case O::I32Rotr:
+    case O::I64Add: case O::I64Sub: case O::I64Mul:
+    case O::I64DivS: case O::I64DivU: case O::I64RemS: case O::I64RemU:
+    case O::I64And: case O::I64Or: case O::I64Xor:
+    case O::I64Shl: case O::I64ShrS: case O::I64ShrU:
+    case O::I64Rotl: case O::I64Rotr:
+      pops = 2;
+      pushes = 1;
+      break;
+
+    case O::I32Load: case O::I64Load: case O::F32Load: case O::F64Load:
+    case O::I32Load8S: case O::I32Load8U:
+    case O::I32Load16S: case O::I32Load16U:
+    case O::I64Load8S: case O::I64Load8U:
+    case O::I64Load16S: case O::I64Load16U:
+    case O::I64Load32S: case O::I64Load32U:
+    case O::InterpI32LoadM32: case O::InterpI64LoadM32:
+    case O::InterpF32LoadM32: case O::InterpF64LoadM32:
+    case O::InterpI32Load8SM32: case O::InterpI32Load8UM32:
+    case O::InterpI32Load16SM32: case O::InterpI32Load16UM32:
+    case O::InterpI64Load8SM32: case O::InterpI64Load8UM32:
+    case O::InterpI64Load16SM32: case O::InterpI64Load16UM32:
+    case O::InterpI64Load32SM32: case O::InterpI64Load32UM32:
+      if (!IsNativeMemory(instr.imm_u32x2.fst)) {
+        lowering = Lowering::Exit;
+      }
+      pops = pushes = 1;
+      break;
+
+    case O::I32Store: case O::I64Store: case O::F32Store: case O::F64Store:
+    case O::I32Store8: case O::I32Store16:
+    case O::I64Store8: case O::I64Store16: case O::I64Store32:
+    case O::InterpI32StoreM32: case O::InterpI64StoreM32:
+    case O::InterpF32StoreM32: case O::InterpF64StoreM32:
+    case O::InterpI32Store8M32: case O::InterpI32Store16M32:
+    case O::InterpI64Store8M32: case O::InterpI64Store16M32:
+    case O::InterpI64Store32M32:
+      if (!IsNativeMemory(instr.imm_u32x2.fst)) {
+        lowering = Lowering::Exit;
+      }
+      pops = 2;
+      break;
+
+    default:
+      if (GetHelper(instr.op, &helper)) {
+        pops = helper.pops;
+        pushes = 1;
+      } else {
+        lowering = Lowering::Exit;
+      }
+      break;
+  }
+  // clang-format on
+  // The native code keeps the whole value stack in memory, so instructions
+  // that use the interpreter's TOS register are left to it.
+  if (instr.tos_state) {
+    lowering = Lowering::Exit;
+  }
+  *out_pops = pops;
+  *out_pushes = pushes;
+  return lowering;
+}
+
+// The most the block starting at instrs_[index] grows the value stack by.
+u32 Compiler::GetBlockDepth(size_t index) const {
+  s64 height = 0;
+  s64 depth = 0;
+  for (size_t i = index; i < instrs_.size(); ++i) {
+    if (i != index && labels_.count(instrs_[i].pc)) {
+      break;
+    }
+    u32 pops, pushes;
+    Lowering lowering = GetLowering(instrs_[i].instr, &pops, &pushes);
+    if (lowering == Lowering::Exit) {
+      break;
+    }
+    height += s64(pushes) - pops;
+    depth = std::max(depth, height);
+    if (lowering == Lowering::Jump) {
+      break;
+    }
+  }
+  return depth;
+}
+
+bool Compiler::IsWorthEntering(size_t index) const {
+  u32 run = 0;
+  for (size_t i = index; i < instrs_.size() && run < kMinEntryRun; ++i) {
+    u32 pops, pushes;
+    Lowering lowering = GetLowering(instrs_[i].instr, &pops, &pushes);
+    if (lowering == Lowering::Exit) {
+      return false;
+    } else if (lowering == Lowering::Jump) {
+      return true;
+    }
+    run++;
+  }
+  return run == kMinEntryRun;
+}
+
+void Compiler::Flush() {
+  if (sp_delta_) {
+    asm_.AluImm(true, kAdd, kSp, sp_delta_);
+    sp_delta_ = 0;
+  }
+  if (pending_count_) {
+    asm_.AluImm(true, kAdd, kCount, pending_count_);
+    pending_count_ = 0;
+  }
+}
+
+void Compiler::ExitIf(Cond cond, Istream::Offset pc, ExitKind kind) {
+  stubs_.push_back({asm_.Jcc(cond), pc, kind, sp_delta_, pending_count_});
+}
+
+void Compiler::Exit(Istream::Offset pc, ExitKind kind) {
+  stubs_.push_back({asm_.Jmp(), pc, kind, sp_delta_, pending_count_});
+}
+
+void Compiler::JumpIf(Cond cond, Istream::Offset target) {
+  assert(sp_delta_ == 0 && pending_count_ == 0);
+  if (!InRange(target)) {
+    ExitIf(cond, target, kExitJump);
+    return;
+  }
+  Label& label = labels_[target];
+  size_t fixup = asm_.Jcc(cond);
+  if (label.pos != Assembler::kInvalidFixup) {
+    asm_.PatchRel32(fixup, label.pos);
+  } else {
+    label.fixups.push_back(fixup);
+  }
+}
+
+void Compiler::Jump(Istream::Offset target) {
+  assert(sp_delta_ == 0 && pending_count_ == 0);
+  if (!InRange(target)) {
+    Exit(target, kExitJump);
+    return;
+  }
+  Label& label = labels_[target];
+  size_t fixup = asm_.Jmp();
+  if (label.pos != Assembler::kInvalidFixup) {
+    asm_.PatchRel32(fixup, label.pos);
+  } else {
+    label.fixups.push_back(fixup);
+  }
+}
+
+void Compiler::BindLabel(Istream::Offset pc) {
+  Label& label = labels_[pc];
+  label.pos = asm_.pos();
+  for (size_t fixup : label.fixups) {
+    asm_.PatchRel32(fixup, label.pos);
+  }
+  label.fixups.clear();
+}
+
+// u32 Entry(Context* context, const u8* target) saves the callee-saved
+// registers, loads the state from |context| and jumps to |target|. The
+// epilogue, which the generated code jumps to with the ExitKind in eax, does
+// the reverse.
+void Compiler::EmitEntry() {
+  asm_.Push(RBP);
+  asm_.Push(RBX);
+  asm_.Push(R12);
+  asm_.Push(R13);
+  asm_.Push(R14);
+  asm_.Push(R15);
+  asm_.AluImm(true, kSub, RSP, 8);  // Keep the stack 16-byte aligned.
+  asm_.Mov(true, kContext, RDI);
+  asm_.Load(true, kSp, Mem(kContext, offsetof(Context, sp)));
+  asm_.Load(true, kLimit, Mem(kContext, offsetof(Context, limit)));
+  asm_.Load(true, kMemory, Mem(kContext, offsetof(Context, memory)));
+  asm_.Load(true, kMemorySize, Mem(kContext, offsetof(Context, memory_size)));
+  asm_.AluOp(false, kXor, kCount, kCount);
+  asm_.Jmp(RSI);
+
+  epilogue_ = asm_.pos();
+  asm_.Store(8, Mem(kContext, offsetof(Context, sp)), kSp);
+  asm_.Store(8, Mem(kContext, offsetof(Context, instructions)), kCount);
+  asm_.AluImm(true, kAdd, RSP, 8);
+  asm_.Pop(R15);
+  asm_.Pop(R14);
+  asm_.Pop(R13);
+  asm_.Pop(R12);
+  asm_.Pop(RBX);
+  asm_.Pop(RBP);
+  asm_.Ret();
+}
+
+void Compiler::EmitStackCheck(Istream::Offset pc, u32 depth) {
+  asm_.Lea(RAX, Mem(kSp, depth * kValueSize));
+  asm_.AluOp(true, kCmp, RAX, kLimit);
+  ExitIf(kAbove, pc, kExitInterpret);
+}
+
+void Compiler::EmitStubs() {
+  for (const Stub& stub : stubs_) {
+    Bind(stub.fixup);
+    if (stub.sp_delta) {
+      asm_.Lea(kSp, Mem(kSp, stub.sp_delta));
+    }
+    if (stub.count) {
+      asm_.AluImm(true, kAdd, kCount, stub.count);
+    }
+    asm_.MovImm(false, Mem(kContext, offsetof(Context, pc)), stub.pc);
+    asm_.MovImm32(RAX, stub.kind);
+    asm_.PatchRel32(asm_.Jmp(), epilogue_);
+  }
+}
+
+void Compiler::EmitCall(uintptr_t func) {
+  asm_.MovImm64(RAX, func);
+  asm_.Call(RAX);
+}
+
+void Compiler::EmitHelper(const Helper& helper, Istream::Offset pc) {
+  asm_.Lea(RDI, Slot(0));
+  EmitCall(helper.func);
+  if (helper.can_trap) {
+    asm_.Test8(RAX, RAX);
+    ExitIf(kEqual, pc, kExitInterpret);
+  }
+  sp_delta_ -= (helper.pops - 1) * kValueSize;
+}
+
+void Compiler::EmitBinop(bool w, Alu op) {
+  asm_.Load(w, RAX, Slot(2));
+  asm_.AluOp(w, op, RAX, Slot(1));
+  asm_.Store(8, Slot(2), RAX);
+  sp_delta_ -= kValueSize;
+}
+
+void Compiler::EmitCompare(bool w, Cond cond) {
+  asm_.Load(w, RCX, Slot(2));
+  asm_.AluOp(false, kXor, RAX, RAX);
+  asm_.AluOp(w, kCmp, RCX, Slot(1));
+  asm_.Setcc(cond, RAX);
+  asm_.Store(8, Slot(2), RAX);
+  sp_delta_ -= kValueSize;
+}
+
+void Compiler::EmitShift(bool w, Shift op) {
+  // The hardware masks the count the same way wasm does.
+  asm_.Load(false, RCX, Slot(1));
+  asm_.Load(w, RAX, Slot(2));
+  asm_.ShiftCl(w, op, RAX);
+  asm_.Store(8, Slot(2), RAX);
+  sp_delta_ -= kValueSize;
+}
+
+void Compiler::EmitDivRem(bool w,
+                          bool is_signed,
+                          bool is_rem,
+                          Istream::Offset pc) {
+  // Anything that traps is left to the interpreter, so that it reports it.
+  asm_.Load(w, RCX, Slot(1));
+  asm_.Test(w, RCX, RCX);
+  ExitIf(kEqual, pc, kExitInterpret);
+  asm_.Load(w, RAX, Slot(2));
+  size_t done = Assembler::kInvalidFixup;
+  if (is_signed) {
+    asm_.AluImm(w, kCmp, RCX, -1);
+    size_t divide = asm_.Jcc(kNotEqual);
+    if (is_rem) {
+      // idiv faults on INT_MIN % -1, but the result is 0 like for any other
+      // dividend.
+      asm_.AluOp(false, kXor, RAX, RAX);
+      done = asm_.Jmp();
+    } else {
+      if (w) {
+        asm_.MovImm64(RDX, u64{1} << 63);
+        asm_.AluOp(true, kCmp, RAX, RDX);
+      } else {
+        asm_.AluImm(false, kCmp, RAX, INT32_MIN);
+      }
+      ExitIf(kEqual, pc, kExitInterpret);
+    }
+    Bind(divide);
+    asm_.SignExtendRax(w);
+  } else {
+    asm_.AluOp(false, kXor, RDX, RDX);
+  }
+  asm_.Div(w, is_signed, RCX);
+  if (is_rem) {
+    asm_.Mov(w, RAX, RDX);
+  }
+  if (done != Assembler::kInvalidFixup) {
+    Bind(done);
+  }
+  asm_.Store(8, Slot(2), RAX);
+  sp_delta_ -= kValueSize;
+}
+
+// Loads the address in |slot| into rax and checks the access, leaving the
+// memory operand to use in |out_mem|.
+void Compiler::EmitAddress(const Decoded& decoded,
+                           int slot,
+                           int size,
+                           Mem* out_mem) {
+  u64 offset = decoded.instr.imm_u32x2.snd;
+  asm_.Load(false, RAX, Slot(slot));
+  s32 disp = 0;
+  if (offset + size <= INT32_MAX) {
+    disp = offset;
+  } else {
+    asm_.MovImm32(RCX, offset);
+    asm_.AluOp(true, kAdd, RAX, RCX);
+    offset = 0;
+  }
+  asm_.Lea(RDX, Mem(RAX, offset + size));
+  asm_.AluOp(true, kCmp, RDX, kMemorySize);
+  ExitIf(kAbove, decoded.pc, kExitInterpret);
+  *out_mem = Mem(kMemory, RAX, 0, disp);
+}
+
+void Compiler::EmitLoad(const Decoded& decoded,
+                        int size,
+                        bool is_signed,
+                        bool w) {
+  Mem mem(0, 0);
+  EmitAddress(decoded, 1, size, &mem);
+  if (size == 8 || (size == 4 && !is_signed)) {
+    asm_.Load(size == 8, RAX, mem);
+  } else if (is_signed) {
+    asm_.Movsx(w, size, RAX, mem);
+  } else {
+    asm_.Movzx(size, RAX, mem);
+  }
+  asm_.Store(8, Slot(1), RAX);
+}
+
+void Compiler::EmitStore(const Decoded& decoded, int size) {
+  Mem mem(0, 0);
+  EmitAddress(decoded, 2, size, &mem);
+  asm_.Load(true, RCX, Slot(1));
+  asm_.Store(size, mem, RCX);
+  sp_delta_ -= 2 * kValueSize;
+}
+
+void Compiler::EmitInstr(const Decoded& decoded) {
+  const Instr& instr = decoded.instr;
+  Helper helper;
+  switch (instr.op) {
+    case O::Nop:
+    case O::I32ReinterpretF32:
+    case O::F32ReinterpretI32:
+    case O::I64ReinterpretF64:
+    case O::F64ReinterpretI64:
+      break;
+
+    case O::InterpCatchDrop:
+      assert(instr.imm_u32 == 0);
+      break;
+
+    case O::Br:
+      pending_count_++;
+      Flush();
+      Jump(instr.imm_u32);
+      return;
+
+    case O::BrIf:
+    case O::InterpBrUnless:
+      asm_.Load(false, RAX, Slot(1));
+      sp_delta_ -= kValueSize;
+      pending_count_++;
+      Flush();
+      asm_.Test(false, RAX, RAX);
+      JumpIf(instr.op == O::BrIf ? kNotEqual : kEqual, instr.imm_u32);
+      return;
+
+    case O::BrTable: {
+      asm_.Load(false, RAX, Slot(1));
+      sp_delta_ -= kValueSize;
+      pending_count_++;
+      Flush();
+      // Keys past the end use the last entry, which is the default.
+      asm_.AluImm(false, kCmp, RAX, instr.imm_u32);
+      size_t in_range = asm_.Jcc(kBelow);
+      asm_.MovImm32(RAX, instr.imm_u32);
+      Bind(in_range);
+      size_t lea = asm_.LeaRip(RCX);
+      asm_.Movsx(true, 4, RAX, Mem(RCX, RAX, 2, 0));
+      asm_.AluOp(true, kAdd, RAX, RCX);
+      asm_.Jmp(RAX);
+      size_t table = asm_.pos();
+      asm_.PatchRel32(lea, table);
+      for (u32 i = 0; i <= instr.imm_u32; ++i) {
+        table_fixups_.push_back(
+            {asm_.pos(), table, decoded.next + i * Istream::kBrTableEntrySize});
+        asm_.Emit32(0);
+      }
+      return;
+    }
+
+    case O::Drop:
+      sp_delta_ -= kValueSize;
+      break;
+
+    case O::Select: {
+      asm_.Load(false, RAX, Slot(1));
+      asm_.Test(false, RAX, RAX);
+      size_t done = asm_.Jcc(kNotEqual);
+      asm_.LoadValue(Slot(2));
+      asm_.StoreValue(Slot(3));
+      Bind(done);
+      sp_delta_ -= 2 * kValueSize;
+      break;
+    }
+
+    case O::LocalGet:
+      asm_.LoadValue(Slot(instr.imm_u32));
+      asm_.StoreValue(Slot(0));
+      sp_delta_ += kValueSize;
+      break;
+
+    case O::LocalSet:
+      asm_.LoadValue(Slot(1));
+      asm_.StoreValue(Slot(instr.imm_u32));
+      sp_delta_ -= kValueSize;
+      break;
+
+    case O::LocalTee:
+      asm_.LoadValue(Slot(1));
+      asm_.StoreValue(Slot(instr.imm_u32));
+      break;
+
+    case O::InterpLocalCopy:
+      asm_.LoadValue(Slot(instr.imm_u32x2.fst));
+      asm_.StoreValue(Slot(instr.imm_u32x2.snd));
+      break;
+
+    case O::GlobalGet:
+    case O::GlobalSet: {
+      asm_.MovImm64(RAX,
+                    reinterpret_cast<uintptr_t>(global_values_[instr.imm_u32]));
+      if (instr.op == O::GlobalGet) {
+        asm_.LoadValue(Mem(RAX, 0));
+        asm_.StoreValue(Slot(0));
+        sp_delta_ += kValueSize;
+      } else {
+        asm_.LoadValue(Slot(1));
+        asm_.StoreValue(Mem(RAX, 0));
+        sp_delta_ -= kValueSize;
+      }
+      break;
+    }
+
+    case O::I32Const:
+    case O::F32Const:
+      asm_.MovImm32(RAX, instr.imm_u32);
+      asm_.Store(8, Slot(0), RAX);
+      sp_delta_ += kValueSize;
+      break;
+
+    case O::I64Const:
+    case O::F64Const:
+      if (s64(instr.imm_u64) == s32(instr.imm_u64)) {
+        asm_.MovImm(true, Slot(0), s32(instr.imm_u64));
+      } else {
+        asm_.MovImm64(RAX, instr.imm_u64);
+        asm_.Store(8, Slot(0), RAX);
+      }
+      sp_delta_ += kValueSize;
+      break;
+
+    case O::InterpAlloca:
+      if (instr.imm_u32 <= 16) {
+        asm_.ZeroXmm0();
+        for (u32 i = 0; i < instr.imm_u32; ++i) {
+          asm_.StoreValue(Slot(-s32(i)));
+        }
+      } else {
+        asm_.Lea(RDI, Slot(0));
+        asm_.MovImm32(RSI, instr.imm_u32);
+        EmitCall(reinterpret_cast<uintptr_t>(ZeroHelper));
+      }
+      sp_delta_ += instr.imm_u32 * kValueSize;
+      break;
+
+    case O::InterpDropKeep: {
+      u32 drop = instr.imm_u32x2.fst;
+      u32 keep = instr.imm_u32x2.snd;
+      if (drop == 0) {
+        break;
+      }
+      if (keep <= 8) {
+        for (u32 i = keep; i > 0; --i) {
+          asm_.LoadValue(Slot(i));
+          asm_.StoreValue(Slot(i + drop));
+        }
+      } else {
+        asm_.Lea(RDI, Slot(0));
+        asm_.MovImm32(RSI, drop);
+        asm_.MovImm32(RDX, keep);
+        EmitCall(reinterpret_cast<uintptr_t>(DropKeepHelper));
+      }
+      sp_delta_ -= drop * kValueSize;
+      break;
+    }
+
+    case O::I32Eqz:
+    case O::I64Eqz:
+      asm_.AluOp(false, kXor, RAX, RAX);
+      asm_.CmpZero(instr.op == O::I64Eqz, Slot(1));
+      asm_.Setcc(kEqual, RAX);
+      asm_.Store(8, Slot(1), RAX);
+      break;
+
+    // clang-format off
+    case O::I32Eq:  EmitCompare(false, kEqual); break;
+    case O::I32Ne:  EmitCompare(false, kNotEqual); break;
+    case O::I32LtS: EmitCompare(false, kLess); break;
+    case O::I32LtU: EmitCompare(false, kBelow); break;
+    case O::I32GtS: EmitCompare(false, kGreater); break;
+    case O::I32GtU: EmitCompare(false, kAbove); break;
+    case O::I32LeS: EmitCompare(false, kLessEqual); break;
+    case O::I32LeU: EmitCompare(false, kBelowEqual); break;
+    case O::I32GeS: EmitCompare(false, kGreaterEqual); break;
+    case O::I32GeU: EmitCompare(false, kAboveEqual); break;
+    case O::I64Eq:  EmitCompare(true, kEqual); break;
+    case O::I64Ne:  EmitCompare(true, kNotEqual); break;
+    case O::I64LtS: EmitCompare(true, kLess); break;
+    case O::I64LtU: EmitCompare(true, kBelow); break;
+    case O::I64GtS: EmitCompare(true, kGreater); break;
+    case O::I64GtU: EmitCompare(true, kAbove); break;
+    case O::I64LeS: EmitCompare(true, kLessEqual); break;
+    case O::I64LeU: EmitCompare(true, kBelowEqual); break;
+    case O::I64GeS: EmitCompare(true, kGreaterEqual); break;
+    case O::I64GeU: EmitCompare(true, kAboveEqual); break;
+
+    case O::I32Add: EmitBinop(false, kAdd); break;
+    case O::I32Sub: EmitBinop(false, kSub); break;
+    case O::I32And: EmitBinop(false, kAnd); break;
+    case O::I32Or:  EmitBinop(false, kOr); break;
+    case O::I32Xor: EmitBinop(false, kXor); break;
+    case O::I64Add: EmitBinop(true, kAdd); break;
+    case O::I64Sub: EmitBinop(true, kSub); break;
+    case O::I64And: EmitBinop(true, kAnd); break;
+    case O::I64Or:  EmitBinop(true, kOr); break;
+    case O::I64Xor: EmitBinop(true, kXor); break;
+
+    case O::I32Mul:
+    case O::I64Mul: {
+      bool w = instr.op == O::I64Mul;
+      asm_.Load(w, RAX, Slot(2));
+      asm_.Imul(w, RAX, Slot(1));
+      asm_.Store(8, Slot(2), RAX);
+      sp_delta_ -= kValueSize;
+      break;
+    }
+
+    case O::I32DivS: EmitDivRem(false, true, false, decoded.pc); break;
+    case O::I32DivU: EmitDivRem(false, false, false, decoded.pc); break;
+    case O::I32RemS: EmitDivRem(false, true, true, decoded.pc); break;
+    case O::I32RemU: EmitDivRem(false, false, true, decoded.pc); break;
+    case O::I64DivS: EmitDivRem(true, true, false, decoded.pc); break;
+    case O::I64DivU: EmitDivRem(true, false, false, decoded.pc); break;
+    case O::I64RemS: EmitDivRem(true, true, true, decoded.pc); break;
+    case O::I64RemU: EmitDivRem(true, false, true, decoded.pc); break;
+
+    case O::I32Shl:  EmitShift(false, kShl); break;
+    case O::I32ShrS: EmitShift(false, kSar); break;
+    case O::I32ShrU: EmitShift(false, kShr); break;
+    case O::I32Rotl: EmitShift(false, kRol); break;
+    case O::I32Rotr: EmitShift(false, kRor); break;
+    case O::I64Shl:  EmitShift(true, kShl); break;
+    case O::I64ShrS: EmitShift(true, kSar); break;
+    case O::I64ShrU: EmitShift(true, kShr); break;
+    case O::I64Rotl: EmitShift(true, kRol); break;
+    case O::I64Rotr: EmitShift(true, kRor); break;
+    // clang-format on
+
+    case O::I32WrapI64:
+    case O::I64ExtendI32U:
+      asm_.Load(false, RAX, Slot(1));
+      asm_.Store(8, Slot(1), RAX);
+      break;
+
+    case O::I64ExtendI32S:
+    case O::I64Extend32S:
+      asm_.Movsx(true, 4, RAX, Slot(1));
+      asm_.Store(8, Slot(1), RAX);
+      break;
+
+    case O::I32Extend8S:
+    case O::I32Extend16S:
+    case O::I64Extend8S:
+    case O::I64Extend16S: {
+      bool w = instr.op == O::I64Extend8S || instr.op == O::I64Extend16S;
+      int size =
+          instr.op == O::I32Extend8S || instr.op == O::I64Extend8S ? 1 : 2;
+      asm_.Movsx(w, size, RAX, Slot(1));
+      asm_.Store(8, Slot(1), RAX);
+      break;
+    }
+
+    // clang-format off
+    case O::I32Load:
+    case O::InterpI32LoadM32:    EmitLoad(decoded, 4, false, false); break;
+    case O::F32Load:
+    case O::InterpF32LoadM32:    EmitLoad(decoded, 4, false, false); break;
+    case O::I64Load:
+    case O::InterpI64LoadM32:    EmitLoad(decoded, 8, false, true); break;
+    case O::F64Load:
+    case O::InterpF64LoadM32:    EmitLoad(decoded, 8, false, true); break;
+    case O::I32Load8S:
+    case O::InterpI32Load8SM32:  EmitLoad(decoded, 1, true, false); break;
+    case O::I32Load8U:
+    case O::InterpI32Load8UM32:  EmitLoad(decoded, 1, false, false); break;
+    case O::I32Load16S:
+    case O::InterpI32Load16SM32: EmitLoad(decoded, 2, true, false); break;
+    case O::I32Load16U:
+    case O::InterpI32Load16UM32: EmitLoad(decoded, 2, false, false); break;
+    case O::I64Load8S:
+    case O::InterpI64Load8SM32:  EmitLoad(decoded, 1, true, true); break;
+    case O::I64Load8U:
+    case O::InterpI64Load8UM32:  EmitLoad(decoded, 1, false, true); break;
+    case O::I64Load16S:
+    case O::InterpI64Load16SM32: EmitLoad(decoded, 2, true, true); break;
+    case O::I64Load16U:
+    case O::InterpI64Load16UM32: EmitLoad(decoded, 2, false, true); break;
+    case O::I64Load32S:
+    case O::InterpI64Load32SM32: EmitLoad(decoded, 4, true, true); break;
+    case O::I64Load32U:
+    case O::InterpI64Load32UM32: EmitLoad(decoded, 4, false, true); break;
+
+    case O::I32Store:
+    case O::InterpI32StoreM32:   EmitStore(decoded, 4); break;
+    case O::F32Store:
+    case O::InterpF32StoreM32:   EmitStore(decoded, 4); break;
+    case O::I64Store:
+    case O::InterpI64StoreM32:   EmitStore(decoded, 8); break;
+    case O::F64Store:
+    case O::InterpF64StoreM32:   EmitStore(decoded, 8); break;
+    case O::I32Store8:
+    case O::InterpI32Store8M32:  EmitStore(decoded, 1); break;
+    case O::I32Store16:
+    case O::InterpI32Store16M32: EmitStore(decoded, 2); break;
+    case O::I64Store8:
+    case O::InterpI64Store8M32:  EmitStore(decoded, 1); break;
+    case O::I64Store16:
+    case O::InterpI64Store16M32: EmitStore(decoded, 2); break;
+    case O::I64Store32:
+    case O::InterpI64Store32M32: EmitStore(decoded, 4); break;
+    // clang-format on
+
+    default:
+      if (!GetHelper(instr.op, &helper)) {
+        WABT_UNREACHABLE;
+      }
+      EmitHelper(helper, decoded.pc);
+      break;
+  }
+  pending_count_++;
+}
+
+Result Compiler::Compile(JitCode* code, std::string* out_reason) {
+  CHECK_RESULT(Decode(out_reason));
+
+  EmitEntry();
+  bool block_start = true;
+  for (size_t i = 0; i < instrs_.size(); ++i) {
+    const Decoded& decoded = instrs_[i];
+    bool is_label = labels_.count(decoded.pc) != 0;
+    u32 pops, pushes;
+    Lowering lowering = GetLowering(decoded.instr, &pops, &pushes);
+    if (is_label || block_start) {
+      Flush();
+      if (is_label) {
+        BindLabel(decoded.pc);
+      }
+      u32 depth = GetBlockDepth(i);
+      // Entering only to exit again soon after would just slow down the
+      // instructions without a template around it.
+      if (IsWorthEntering(i)) {
+        code->entries.push_back(
+            {decoded.pc, static_cast<u32>(asm_.pos()), depth + kStackSlack});
+      }
+      if (depth) {
+        EmitStackCheck(decoded.pc, depth);
+      }
+    }
+
+    if (lowering == Lowering::Exit) {
+      Flush();
+      Exit(decoded.pc, kExitInterpret);
+    } else {
+      EmitInstr(decoded);
+    }
+    block_start = lowering != Lowering::Inline;
+  }
+  // Validation guarantees that functions end with a return, so this is never
+  // reached.
+  Flush();
+  Exit(end_, kExitInterpret);
+  EmitStubs();
+
+  for (auto&& fixup : table_fixups_) {
+    Label& label = labels_[fixup.pc];
+    assert(label.pos != Assembler::kInvalidFixup);
+    asm_.Patch32(fixup.at, static_cast<u32>(label.pos - fixup.table));
+  }
+
+  size_t size = asm_.buf().size();
+  void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    *out_reason = "couldn't allocate executable memory";
+    code->entries.clear();
+    return Result::Error;
+  }
+  memcpy(mem, asm_.buf().data(), size);
+  if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+    munmap(mem, size);
+    *out_reason = "couldn't allocate executable memory";
+    code->entries.clear();
+    return Result::Error;
+  }
+  code->code = static_cast<u8*>(mem);
+  code->size = size;
+  code->memory = memory_;
+  return Result::Ok;
+}
+
+}  // end anonymous namespace
+
+#endif  // WABT_JIT_SUPPORTED
+
+Jit::Jit(Store& store, const JitOptions& options)
+    : store_(store), options_(options) {}
+
+Jit::~Jit() = default;
+
+// static
+bool Jit::IsSupported() {
+  return WABT_JIT_SUPPORTED;
+}
+
+const JitCode& Jit::Compile(DefinedFunc& func) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (const JitCode* code = func.jit_code_.load(std::memory_order_acquire)) {
+    return *code;
+  }
+
+  auto code = std::make_unique<JitCode>();
+  std::string reason = "not supported on this platform";
+  Result result = Result::Error;
+#if WABT_JIT_SUPPORTED
+  auto inst = store_.UnsafeGet<Instance>(func.instance());
+  auto mod = store_.UnsafeGet<Module>(inst->module());
+  std::vector<Value*> global_values;
+  for (Ref global : inst->globals()) {
+    global_values.push_back(&store_.UnsafeGet<Global>(global)->value_);
+  }
+  result = Compiler(store_, *inst, *mod, func.desc(), std::move(global_values))
+               .Compile(code.get(), &reason);
+#endif
+  if (Succeeded(result)) {
+    compiled_func_count_++;
+  } else {
+    rejected_func_count_++;
+    if (options_.log_stream) {
+      options_.log_stream->Writef(
+          "jit: function at istream offset %u is interpreted: %s\n",
+          func.desc().code_offset, reason.c_str());
+    }
+  }
+  func.jit_code_.store(code.get(), std::memory_order_release);
+  code_.push_back(std::move(code));
+  return *code_.back();
+}
+
+void Jit::Run(Thread& thread) {
+#if WABT_JIT_SUPPORTED
+  for (;;) {
+    Frame& frame = thread.frames_.back();
+    if (!frame.inst) {
+      return;
+    }
+    // The frame keeps its function alive, so there's no need for a RefPtr.
+    auto* func = cast<DefinedFunc>(store_.objects_.Get(frame.func.index));
+    const JitCode* maybe_code = func->jit_code_.load(std::memory_order_acquire);
+    const JitCode& code = maybe_code ? *maybe_code : Compile(*func);
+    auto iter = std::lower_bound(
+        code.entries.begin(), code.entries.end(), frame.offset,
+        [](const JitCode::Entry& entry, Istream::Offset pc) {
+          return entry.pc < pc;
+        });
+    if (iter == code.entries.end() || iter->pc != frame.offset) {
+      return;
+    }
+
+    auto& values = thread.values_;
+    size_t height = values.size();
+    values.resize(height + iter->stack_reserve);
+    Context context;
+    context.sp = values.data() + height;
+    context.limit = values.data() + values.size();
+    context.memory = code.memory ? code.memory->UnsafeData() : nullptr;
+    context.memory_size = code.memory ? code.memory->ByteSize() : 0;
+    context.instructions = 0;
+    context.pc = 0;
+    auto entry = reinterpret_cast<EntryFunc>(code.code);
+    u32 exit = entry(&context, code.code + iter->code_offset);
+    values.resize(context.sp - values.data());
+    thread.instruction_count_ += context.instructions;
+    frame.offset = context.pc;
+    if (exit != kExitJump) {
+      return;
+    }
+  }
+#else
+  WABT_UNREACHABLE;
+#endif
+}
+
+}  // namespace interp
+}  // namespace wabt
@@ -0,0 +1,1168 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/interp/interp-tier-up.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include "wabt/apply-names.h"
+#include "wabt/binary-reader-ir.h"
+#include "wabt/binary-reader.h"
+#include "wabt/c-writer.h"
+#include "wabt/error-formatter.h"
+#include "wabt/generate-names.h"
+#include "wabt/ir.h"
+#include "wabt/stream.h"
+#include "wabt/validator.h"
+
+// The generated code shares memories and globals with the interpreter in
+// place, so the byte order has to match the one wasm2c assumes.
+#if HAVE_DLFCN_H && HAVE_UNISTD_H && !WABT_BIG_ENDIAN && \
+    !defined(__EMSCRIPTEN__)
+#define WABT_TIER_UP_SUPPORTED 1
+#include <dlfcn.h>
+#include <unistd.h>
+#else
+#define WABT_TIER_UP_SUPPORTED 0
+#endif
+
+namespace wabt {
+namespace interp {
+
+namespace {
+
+// Must match struct wabt_tier_up_host in the generated glue code.
+struct NativeHost {
+  void* host;
+  void** globals;
+  int (*call)(void* host, u32 func_index, const u64* args, u64* results);
+  u64 (*grow)(void* host, u32 memory_index, u64 delta);
+};
+
+// Entry points of the generated glue code. The const char* results are null
+// on success, or the message of the trap that occurred.
+using NewFunc = void* (*)(const NativeHost*);
+using SetMemoryFunc = void (*)(void* native,
+                               u32 memory_index,
+                               u8* data,
+                               u64 pages,
+                               u64 max_pages,
+                               u64 size,
+                               int is64);
+using InstantiateFunc = const char* (*)(void* native);
+using CallFunc = const char* (*)(void* native,
+                                 u32 func_index,
+                                 const u64* args,
+                                 u64* results);
+using FreeFunc = void (*)(void* native);
+
+const char kModuleName[] = "m";
+const char kImportModuleName[] = "wabt";
+
+u64 ToBits(ValueType type, Value value) {
+  switch (type) {
+    case ValueType::I32: return value.Get<u32>();
+    case ValueType::I64: return value.Get<u64>();
+    case ValueType::F32: return Bitcast<u32>(value.Get<f32>());
+    case ValueType::F64: return Bitcast<u64>(value.Get<f64>());
+    default: WABT_UNREACHABLE;
+  }
+}
+
+Value FromBits(ValueType type, u64 bits) {
+  switch (type) {
+    case ValueType::I32: return Value::Make(static_cast<u32>(bits));
+    case ValueType::I64: return Value::Make(bits);
+    case ValueType::F32: return Value::Make(Bitcast<f32>(u32(bits)));
+    case ValueType::F64: return Value::Make(Bitcast<f64>(bits));
+    default: WABT_UNREACHABLE;
+  }
+}
+
+bool IsNumeric(Type type) {
+  return type == Type::I32 || type == Type::I64 || type == Type::F32 ||
+         type == Type::F64;
+}
+
+const char* GetCTypeName(Type type) {
+  switch (type) {
+    case Type::I32: return "u32";
+    case Type::I64: return "u64";
+    case Type::F32: return "f32";
+    case Type::F64: return "f64";
+    default: WABT_UNREACHABLE;
+  }
+}
+
+bool CheckExprs(const ExprList& exprs, std::string* out_reason) {
+  for (const Expr& expr : exprs) {
+    switch (expr.type()) {
+      case ExprType::Block:
+        if (!CheckExprs(cast<BlockExpr>(&expr)->block.exprs, out_reason)) {
+          return false;
+        }
+        break;
+
+      case ExprType::Loop:
+        if (!CheckExprs(cast<LoopExpr>(&expr)->block.exprs, out_reason)) {
+          return false;
+        }
+        break;
+
+      case ExprType::If: {
+        auto* if_expr = cast<IfExpr>(&expr);
+        if (!CheckExprs(if_expr->true_.exprs, out_reason) ||
+            !CheckExprs(if_expr->false_, out_reason)) {
+          return false;
+        }
+        break;
+      }
+
+      // Anything that touches tables, reference values or passive data
+      // segments would need state that isn't shared with the interpreter.
+      case ExprType::CallRef:
+      case ExprType::DataDrop:
+      case ExprType::ElemDrop:
+      case ExprType::MemoryInit:
+      case ExprType::RefFunc:
+      case ExprType::RefIsNull:
+      case ExprType::RefNull:
+      case ExprType::Rethrow:
+      case ExprType::ReturnCall:
+      case ExprType::ReturnCallIndirect:
+      case ExprType::TableCopy:
+      case ExprType::TableFill:
+      case ExprType::TableGet:
+      case ExprType::TableGrow:
+      case ExprType::TableInit:
+      case ExprType::TableSet:
+      case ExprType::TableSize:
+      case ExprType::Throw:
+      case ExprType::Try:
+        *out_reason = std::string("uses ") + GetExprTypeName(expr.type());
+        return false;
+
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+// Returns false, and the reason in |out_reason|, if the generated code for
+// |module| could not share all of its state with the interpreter.
+bool CanCompile(const wabt::Module& module, std::string* out_reason) {
+  if (module.features_used.simd) {
+    *out_reason = "uses SIMD";
+    return false;
+  }
+  if (module.features_used.exceptions) {
+    *out_reason = "uses exceptions";
+    return false;
+  }
+  if (module.features_used.threads) {
+    *out_reason = "uses threads";
+    return false;
+  }
+  for (const Import* import : module.imports) {
+    if (import->kind() == ExternalKind::Table ||
+        import->kind() == ExternalKind::Tag) {
+      *out_reason = "imports a table or tag";
+      return false;
+    }
+  }
+  for (const Export* export_ : module.exports) {
+    if (export_->kind == ExternalKind::Table) {
+      *out_reason = "exports a table";
+      return false;
+    }
+  }
+  for (const wabt::Global* global : module.globals) {
+    if (!IsNumeric(global->type)) {
+      *out_reason = "has a non-numeric global";
+      return false;
+    }
+  }
+  for (const wabt::Func* func : module.funcs) {
+    if (func->GetNumResults() > 1) {
+      *out_reason = "has a function with multiple results";
+      return false;
+    }
+    for (Index i = 0; i < func->GetNumParamsAndLocals(); ++i) {
+      if (!IsNumeric(func->GetLocalType(i))) {
+        *out_reason = "has a non-numeric parameter or local";
+        return false;
+      }
+    }
+    if (func->GetNumResults() == 1 && !IsNumeric(func->GetResultType(0))) {
+      *out_reason = "has a non-numeric result";
+      return false;
+    }
+    if (func->features_used.tailcall) {
+      *out_reason = "uses tail calls";
+      return false;
+    }
+  }
+  for (Index i = module.num_func_imports; i < module.funcs.size(); ++i) {
+    if (!CheckExprs(module.funcs[i]->exprs, out_reason)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Rewrites |module| so that the generated code gets everything it shares
+// with the interpreter through its imports: every import is renamed to
+// "wabt" "f<index>", "m<index>" or "g<index>", defined memories and globals
+// become imports too, and each defined function is exported as "f<index>",
+// counting defined functions only. Data segments and start functions are
+// dropped, since the interpreter has already run them.
+void PrepareModule(wabt::Module* module) {
+  Index func_index = 0;
+  Index memory_index = 0;
+  Index global_index = 0;
+  for (Import* import : module->imports) {
+    import->module_name = kImportModuleName;
+    switch (import->kind()) {
+      case ExternalKind::Func:
+        import->field_name = "f" + std::to_string(func_index++);
+        break;
+      case ExternalKind::Memory:
+        import->field_name = "m" + std::to_string(memory_index++);
+        break;
+      case ExternalKind::Global:
+        import->field_name = "g" + std::to_string(global_index++);
+        break;
+      default:
+        WABT_UNREACHABLE;
+    }
+  }
+
+  for (Index i = module->num_memory_imports; i < module->memories.size();
+       ++i) {
+    auto import = std::make_unique<MemoryImport>();
+    import->module_name = kImportModuleName;
+    import->field_name = "m" + std::to_string(i);
+    import->memory = std::move(*module->memories[i]);
+    module->memories[i] = &import->memory;
+    module->imports.push_back(import.get());
+    module->fields.push_back(
+        std::make_unique<ImportModuleField>(std::move(import)));
+  }
+  module->num_memory_imports = module->memories.size();
+
+  for (Index i = module->num_global_imports; i < module->globals.size(); ++i) {
+    auto import = std::make_unique<GlobalImport>();
+    import->module_name = kImportModuleName;
+    import->field_name = "g" + std::to_string(i);
+    import->global = std::move(*module->globals[i]);
+    module->globals[i] = &import->global;
+    module->imports.push_back(import.get());
+    module->fields.push_back(
+        std::make_unique<ImportModuleField>(std::move(import)));
+  }
+  module->num_global_imports = module->globals.size();
+
+  module->data_segments.clear();
+  module->starts.clear();
+  module->exports.clear();
+  for (Index i = module->num_func_imports; i < module->funcs.size(); ++i) {
+    auto field = std::make_unique<ExportModuleField>();
+    field->export_.name = "f" + std::to_string(i - module->num_func_imports);
+    field->export_.kind = ExternalKind::Func;
+    field->export_.var = Var(i, Location());
+    module->exports.push_back(&field->export_);
+    module->fields.push_back(std::move(field));
+  }
+}
+
+void WriteArg(Stream* stream, Type type, const char* value) {
+  switch (type) {
+    case Type::F32:
+      stream->Writef("wabt_tier_up_from_f32(%s)", value);
+      break;
+    case Type::F64:
+      stream->Writef("wabt_tier_up_from_f64(%s)", value);
+      break;
+    default:
+      stream->Writef("(uint64_t)%s", value);
+      break;
+  }
+}
+
+void WriteResult(Stream* stream, Type type, const char* bits) {
+  switch (type) {
+    case Type::F32:
+      stream->Writef("wabt_tier_up_f32(%s)", bits);
+      break;
+    case Type::F64:
+      stream->Writef("wabt_tier_up_f64(%s)", bits);
+      break;
+    default:
+      stream->Writef("(%s)%s", GetCTypeName(type), bits);
+      break;
+  }
+}
+
+// Writes the C code that connects the wasm2c output for |module|, prepared
+// by PrepareModule, to the interpreter: the struct w2c_wabt that provides its
+// imports, and the wabt_tier_up_* functions that TierUp loads. The exported
+// functions run on the ggt thread given by the C expression |ggt_thread|.
+void WriteGlue(Stream* stream,
+               const wabt::Module& module,
+               const std::string& ggt_thread) {
+  Index num_memories = module.memories.size();
+  stream->Writef(
+      "/* Generated by the wabt interpreter's tier-up. */\n"
+      "#include <stdlib.h>\n"
+      "#include <string.h>\n"
+      "\n"
+      "#include \"%s.h\"\n"
+      "#include \"wasm-rt-exceptions.h\"\n"
+      "#include \"wasm-rt-impl.h\"\n"
+      "\n"
+      "/* The ggt thread that the exported functions run on. */\n"
+      "#define WABT_TIER_UP_THREAD (%s)\n"
+      "\n"
+      "#define WABT_TIER_UP_EXPORT __attribute__((visibility(\"default\")))\n"
+      "#define WABT_TIER_UP_NUM_MEMORIES %u\n"
+      "\n"
+      "struct wabt_tier_up_host {\n"
+      "  void* host;\n"
+      "  void** globals;\n"
+      "  int (*call)(void*, uint32_t, const uint64_t*, uint64_t*);\n"
+      "  uint64_t (*grow)(void*, uint32_t, uint64_t);\n"
+      "};\n"
+      "\n"
+      "struct wabt_tier_up_memory {\n"
+      "  wasm_rt_memory_t memory;\n"
+      "  struct w2c_%s* instance;\n"
+      "  uint32_t index;\n"
+      "};\n"
+      "\n"
+      "struct w2c_%s {\n"
+      "  struct wabt_tier_up_host host;\n"
+      "  struct wabt_tier_up_memory memories[WABT_TIER_UP_NUM_MEMORIES ? "
+      "WABT_TIER_UP_NUM_MEMORIES : 1];\n"
+      "  w2c_%s module;\n"
+      "};\n"
+      "\n",
+      kModuleName, ggt_thread.c_str(), num_memories, kImportModuleName,
+      kImportModuleName, kModuleName);
+
+  stream->Writef(
+      "static inline f32 wabt_tier_up_f32(uint64_t bits) {\n"
+      "  uint32_t x = (uint32_t)bits;\n"
+      "  f32 result;\n"
+      "  memcpy(&result, &x, sizeof(result));\n"
+      "  return result;\n"
+      "}\n"
+      "\n"
+      "static inline f64 wabt_tier_up_f64(uint64_t bits) {\n"
+      "  f64 result;\n"
+      "  memcpy(&result, &bits, sizeof(result));\n"
+      "  return result;\n"
+      "}\n"
+      "\n"
+      "static inline uint64_t wabt_tier_up_from_f32(f32 value) {\n"
+      "  uint32_t x;\n"
+      "  memcpy(&x, &value, sizeof(x));\n"
+      "  return x;\n"
+      "}\n"
+      "\n"
+      "static inline uint64_t wabt_tier_up_from_f64(f64 value) {\n"
+      "  uint64_t x;\n"
+      "  memcpy(&x, &value, sizeof(x));\n"
+      "  return x;\n"
+      "}\n"
+      "\n");
+
+  // Memories and globals.
+  for (Index i = 0; i < num_memories; ++i) {
+    stream->Writef(
+        "wasm_rt_memory_t* w2c_%s_m%u(struct w2c_%s* instance) {\n"
+        "  return &instance->memories[%u].memory;\n"
+        "}\n"
+        "\n",
+        kImportModuleName, i, kImportModuleName, i);
+  }
+  for (Index i = 0; i < module.globals.size(); ++i) {
+    const char* type = GetCTypeName(module.globals[i]->type);
+    stream->Writef(
+        "%s* w2c_%s_g%u(struct w2c_%s* instance) {\n"
+        "  return (%s*)instance->host.globals[%u];\n"
+        "}\n"
+        "\n",
+        type, kImportModuleName, i, kImportModuleName, type, i);
+  }
+
+  stream->Writef(
+      "uint64_t wasm_rt_grow_memory(wasm_rt_memory_t* memory, uint64_t "
+      "delta) {\n"
+      "  struct wabt_tier_up_memory* m = (struct wabt_tier_up_memory*)memory;\n"
+      "  return m->instance->host.grow(m->instance->host.host, m->index, "
+      "delta);\n"
+      "}\n"
+      "\n"
+      "void wasm_rt_memmove_large(void* dest, const void* src, size_t n) {\n"
+      "  memmove(dest, src, n);\n"
+      "}\n"
+      "\n");
+
+  // Imported functions call back into the interpreter. If that traps, the
+  // interpreter keeps the trap, and the native code only has to unwind.
+  for (Index i = 0; i < module.num_func_imports; ++i) {
+    const FuncSignature& sig = module.funcs[i]->decl.sig;
+    Index num_params = sig.param_types.size();
+    const char* result_type =
+        sig.result_types.empty() ? "void" : GetCTypeName(sig.result_types[0]);
+    stream->Writef("GGT(w2c_%s_f%u, (ggt_thread_t *thr, %s *ret, struct w2c_%s "
+                   "*instance",
+                   kImportModuleName, i, result_type, kImportModuleName);
+    for (Index j = 0; j < num_params; ++j) {
+      stream->Writef(", %s p%u", GetCTypeName(sig.param_types[j]), j);
+    }
+    stream->Writef("),\n    { %s *ret; struct w2c_%s *instance;", result_type,
+                   kImportModuleName);
+    for (Index j = 0; j < num_params; ++j) {
+      stream->Writef(" %s p%u;", GetCTypeName(sig.param_types[j]), j);
+    }
+    stream->Writef(" },\n    { l->ret = ret; l->instance = instance;");
+    for (Index j = 0; j < num_params; ++j) {
+      stream->Writef(" l->p%u = p%u;", j, j);
+    }
+    stream->Writef(
+        " }) {\n"
+        "  uint64_t args[%u];\n"
+        "  uint64_t results[1];\n",
+        num_params ? num_params : 1);
+    for (Index j = 0; j < num_params; ++j) {
+      std::string value = "l->p" + std::to_string(j);
+      stream->Writef("  args[%u] = ", j);
+      WriteArg(stream, sig.param_types[j], value.c_str());
+      stream->Writef(";\n");
+    }
+    stream->Writef(
+        "  if (l->instance->host.call(l->instance->host.host, %u, args, "
+        "results)) {\n"
+        "    wasm_rt_trap(WASM_RT_TRAP_UNREACHABLE);\n"
+        "  }\n",
+        i);
+    if (!sig.result_types.empty()) {
+      stream->Writef("  *l->ret = ");
+      WriteResult(stream, sig.result_types[0], "results[0]");
+      stream->Writef(";\n");
+    }
+    stream->Writef(
+        "  GGT_END();\n"
+        "}\n"
+        "\n");
+  }
+
+  // Calls into the generated code may nest, through imported functions, so
+  // the runtime's trap state is saved and restored around each one.
+  stream->Writef(
+      "typedef struct {\n"
+      "  wasm_rt_jmp_buf jmp_buf;\n"
+      "  WASM_RT_UNWIND_TARGET* unwind_target;\n"
+      "#if WASM_RT_STACK_DEPTH_COUNT\n"
+      "  uint32_t call_stack_depth;\n"
+      "#endif\n"
+      "#if WASM_RT_FRAME_CHAIN\n"
+      "  wasm_rt_frame_t* frame_chain;\n"
+      "#endif\n"
+      "} wabt_tier_up_state;\n"
+      "\n"
+      "static void wabt_tier_up_save(wabt_tier_up_state* state) {\n"
+      "  state->jmp_buf = g_wasm_rt_jmp_buf;\n"
+      "  state->unwind_target = wasm_rt_get_unwind_target();\n"
+      "#if WASM_RT_STACK_DEPTH_COUNT\n"
+      "  state->call_stack_depth = wasm_rt_saved_call_stack_depth;\n"
+      "#endif\n"
+      "#if WASM_RT_FRAME_CHAIN\n"
+      "  state->frame_chain = wasm_rt_saved_frame_chain;\n"
+      "#endif\n"
+      "}\n"
+      "\n"
+      "static const char* wabt_tier_up_restore(const wabt_tier_up_state* "
+      "state,\n"
+      "                                        wasm_rt_trap_t code) {\n"
+      "  g_wasm_rt_jmp_buf = state->jmp_buf;\n"
+      "  wasm_rt_set_unwind_target(state->unwind_target);\n"
+      "#if WASM_RT_STACK_DEPTH_COUNT\n"
+      "  wasm_rt_saved_call_stack_depth = state->call_stack_depth;\n"
+      "#endif\n"
+      "#if WASM_RT_FRAME_CHAIN\n"
+      "  wasm_rt_saved_frame_chain = state->frame_chain;\n"
+      "#endif\n"
+      "  switch (code) {\n"
+      "    case WASM_RT_TRAP_NONE:\n"
+      "      return NULL;\n"
+      "    case WASM_RT_TRAP_OOB:\n"
+      "      return \"out of bounds memory access\";\n"
+      "    case WASM_RT_TRAP_INT_OVERFLOW:\n"
+      "      return \"integer overflow\";\n"
+      "    case WASM_RT_TRAP_DIV_BY_ZERO:\n"
+      "      return \"integer divide by zero\";\n"
+      "    case WASM_RT_TRAP_INVALID_CONVERSION:\n"
+      "      return \"invalid conversion to integer\";\n"
+      "    case WASM_RT_TRAP_UNREACHABLE:\n"
+      "      return \"unreachable executed\";\n"
+      "    case WASM_RT_TRAP_CALL_INDIRECT:\n"
+      "      return \"invalid indirect call\";\n"
+      "#if !WASM_RT_MERGED_OOB_AND_EXHAUSTION_TRAPS\n"
+      "    case WASM_RT_TRAP_EXHAUSTION:\n"
+      "      return \"call stack exhausted\";\n"
+      "#endif\n"
+      "    default:\n"
+      "      return \"trap\";\n"
+      "  }\n"
+      "}\n"
+      "\n");
+
+  stream->Writef(
+      "WABT_TIER_UP_EXPORT struct w2c_%s* wabt_tier_up_new(\n"
+      "    const struct wabt_tier_up_host* host) {\n"
+      "  struct w2c_%s* instance;\n"
+      "  uint32_t i;\n"
+      "  if (!wasm_rt_is_initialized()) {\n"
+      "    wasm_rt_init();\n"
+      "  }\n"
+      "  instance = calloc(1, sizeof(*instance));\n"
+      "  if (!instance) {\n"
+      "    return NULL;\n"
+      "  }\n"
+      "  instance->host = *host;\n"
+      "  for (i = 0; i < WABT_TIER_UP_NUM_MEMORIES; ++i) {\n"
+      "    instance->memories[i].instance = instance;\n"
+      "    instance->memories[i].index = i;\n"
+      "  }\n"
+      "  return instance;\n"
+      "}\n"
+      "\n"
+      "WABT_TIER_UP_EXPORT void wabt_tier_up_set_memory(struct w2c_%s* "
+      "instance,\n"
+      "                                                 uint32_t index,\n"
+      "                                                 uint8_t* data,\n"
+      "                                                 uint64_t pages,\n"
+      "                                                 uint64_t max_pages,\n"
+      "                                                 uint64_t size,\n"
+      "                                                 int is64) {\n"
+      "  wasm_rt_memory_t* memory = &instance->memories[index].memory;\n"
+      "  memory->data = data;\n"
+      "  memory->pages = pages;\n"
+      "  memory->max_pages = max_pages;\n"
+      "  memory->size = size;\n"
+      "  memory->is64 = is64;\n"
+      "}\n"
+      "\n"
+      "WABT_TIER_UP_EXPORT const char* wabt_tier_up_instantiate(\n"
+      "    struct w2c_%s* instance) {\n"
+      "  wabt_tier_up_state state;\n"
+      "  wasm_rt_trap_t code;\n"
+      "  wabt_tier_up_save(&state);\n"
+      "  code = wasm_rt_impl_try();\n"
+      "  if (code == WASM_RT_TRAP_NONE) {\n"
+      "    wasm2c_%s_instantiate(&instance->module%s);\n"
+      "  }\n"
+      "  return wabt_tier_up_restore(&state, code);\n"
+      "}\n"
+      "\n"
+      "WABT_TIER_UP_EXPORT void wabt_tier_up_free(struct w2c_%s* instance) {\n"
+      "  wasm2c_%s_free(&instance->module);\n"
+      "  free(instance);\n"
+      "}\n"
+      "\n",
+      kImportModuleName, kImportModuleName, kImportModuleName,
+      kImportModuleName, kModuleName,
+      // Without imports, wasm2c doesn't take an import instance.
+      module.imports.empty() ? "" : ", instance", kImportModuleName,
+      kModuleName);
+
+  stream->Writef(
+      "WABT_TIER_UP_EXPORT const char* wabt_tier_up_call(struct w2c_%s* "
+      "instance,\n"
+      "                                                  uint32_t index,\n"
+      "                                                  const uint64_t* "
+      "args,\n"
+      "                                                  uint64_t* results) "
+      "{\n"
+      "  wabt_tier_up_state state;\n"
+      "  wasm_rt_trap_t code;\n"
+      "  if (!wasm_rt_is_initialized()) {\n"
+      "    /* The first call on another OS thread of a concurrent Store. */\n"
+      "    wasm_rt_init_thread();\n"
+      "  }\n"
+      "  wabt_tier_up_save(&state);\n"
+      "  code = wasm_rt_impl_try();\n"
+      "  if (code == WASM_RT_TRAP_NONE) {\n"
+      "    switch (index) {\n",
+      kImportModuleName);
+  for (Index i = module.num_func_imports; i < module.funcs.size(); ++i) {
+    const FuncSignature& sig = module.funcs[i]->decl.sig;
+    Index index = i - module.num_func_imports;
+    stream->Writef("      case %u: {\n", index);
+    if (sig.result_types.empty()) {
+      stream->Writef("        w2c_%s_f%u(WABT_TIER_UP_THREAD, NULL, ",
+                     kModuleName, index);
+    } else {
+      stream->Writef(
+          "        %s ret;\n"
+          "        w2c_%s_f%u(WABT_TIER_UP_THREAD, &ret, ",
+          GetCTypeName(sig.result_types[0]), kModuleName, index);
+    }
+    stream->Writef("&instance->module");
+    for (Index j = 0; j < sig.param_types.size(); ++j) {
+      std::string bits = "args[" + std::to_string(j) + "]";
+      stream->Writef(", ");
+      WriteResult(stream, sig.param_types[j], bits.c_str());
+    }
+    stream->Writef(");\n");
+    if (!sig.result_types.empty()) {
+      stream->Writef("        results[0] = ");
+      WriteArg(stream, sig.result_types[0], "ret");
+      stream->Writef(";\n");
+    }
+    stream->Writef(
+        "        break;\n"
+        "      }\n");
+  }
+  stream->Writef(
+      "    }\n"
+      "  }\n"
+      "  return wabt_tier_up_restore(&state, code);\n"
+      "}\n");
+}
+
+std::string Quote(const std::string& path) {
+  return "'" + path + "'";
+}
+
+}  // end anonymous namespace
+
+struct NativeFunc {
+  TierUp::NativeInstance* instance;
+  u32 index;  // Among the defined functions of its module.
+};
+
+struct TierUp::NativeModule {
+  enum class State {
+    Registered,
+    Compiling,
+    Ready,
+    Failed,
+  };
+
+  Module::Ptr module;
+  std::vector<u8> data;
+  Features features;
+  // Maps the istream offset of each defined function to its index among the
+  // defined functions.
+  std::unordered_map<u32, u32> func_indexes;
+
+  State state = State::Registered;
+  std::thread worker;
+  std::atomic<bool> done{false};
+  // Written by the worker, and copied to the log stream once it is joined.
+  std::string log;
+
+#if WABT_TIER_UP_SUPPORTED
+  void* handle = nullptr;
+#endif
+  NewFunc new_ = nullptr;
+  SetMemoryFunc set_memory = nullptr;
+  InstantiateFunc instantiate = nullptr;
+  CallFunc call = nullptr;
+  FreeFunc free = nullptr;
+};
+
+struct TierUp::NativeInstance {
+  // The native code reads and writes the memory buffers directly, so they are
+  // passed again whenever the interpreter may have grown one of them.
+  struct CachedMemory {
+    Memory* memory;
+    u8* data;
+    u64 size;
+  };
+
+  void SyncMemories();
+
+  static int CallImport(void* host,
+                        u32 func_index,
+                        const u64* args,
+                        u64* results);
+  static u64 GrowMemory(void* host, u32 memory_index, u64 delta);
+
+  TierUp* tier_up;
+  NativeModule* module;
+  Instance::Ptr instance;
+  std::vector<NativeFunc> funcs;
+  std::vector<CachedMemory> memories;
+  std::vector<void*> globals;
+  NativeHost host;
+  // Null if the native instance could not be created.
+  void* native = nullptr;
+  // Guards |memories|, which threads of a concurrent Store sync at once.
+  std::mutex memories_mutex;
+};
+
+namespace {
+
+// A call of native code by the interpreter.
+struct NativeCall {
+  // The Thread running the native code.
+  Thread* thread;
+  // The trap of an imported function, which is reported in place of the trap
+  // the native code unwinds with.
+  Trap::Ptr pending_trap;
+};
+
+// The innermost NativeCall of the calling OS thread, which is the one that
+// the native code calls imports for.
+thread_local NativeCall* s_native_call = nullptr;
+
+}  // end anonymous namespace
+
+void TierUp::NativeInstance::SyncMemories() {
+  std::lock_guard<std::mutex> lock(memories_mutex);
+  for (Index i = 0; i < memories.size(); ++i) {
+    CachedMemory& cached = memories[i];
+    Memory* memory = cached.memory;
+    if (cached.data == memory->UnsafeData() &&
+        cached.size == memory->ByteSize()) {
+      continue;
+    }
+    cached.data = memory->UnsafeData();
+    cached.size = memory->ByteSize();
+    const Limits& limits = memory->type().limits;
+    u64 max_pages = limits.has_max ? limits.max
+                    : limits.is_64 ? WABT_MAX_PAGES64
+                                   : WABT_MAX_PAGES32;
+    module->set_memory(native, i, cached.data, memory->PageSize(), max_pages,
+                       cached.size, limits.is_64);
+  }
+}
+
+// static
+int TierUp::NativeInstance::CallImport(void* host,
+                                       u32 func_index,
+                                       const u64* args,
+                                       u64* results) {
+  auto* self = static_cast<NativeInstance*>(host);
+  Store& store = self->tier_up->store_;
+  NativeCall& call = *s_native_call;
+  Thread& thread = *call.thread;
+  Func::Ptr func{store, self->instance->funcs()[func_index]};
+  const FuncType& type = func->type();
+
+  Values params(type.params.size());
+  for (Index i = 0; i < params.size(); ++i) {
+    params[i] = FromBits(type.params[i], args[i]);
+  }
+  Values func_results(type.results.size());
+  Trap::Ptr trap;
+
+  size_t num_frames = thread.frames_.size();
+  Instance* inst = thread.inst_;
+  Module* mod = thread.mod_;
+  RunResult result;
+  if (auto* host_func = dyn_cast<HostFunc>(func.get())) {
+    // The frame of the native code is the caller, as for an interpreted call.
+    result = thread.PushCall(*host_func, &trap);
+  } else {
+    // Push a host frame, so that the interpreter returns here.
+    thread.inst_ = nullptr;
+    thread.mod_ = nullptr;
+    result = thread.PushCall(thread.frames_.back().func, 0, &trap);
+  }
+  if (result == RunResult::Ok &&
+      Failed(func->Call(thread, params, func_results, &trap))) {
+    result = RunResult::Trap;
+  }
+  thread.frames_.erase(thread.frames_.begin() + num_frames,
+                       thread.frames_.end());
+  thread.inst_ = inst;
+  thread.mod_ = mod;
+
+  if (result != RunResult::Ok) {
+    call.pending_trap = trap;
+    return 1;
+  }
+  self->SyncMemories();
+  for (Index i = 0; i < func_results.size(); ++i) {
+    results[i] = ToBits(type.results[i], func_results[i]);
+  }
+  return 0;
+}
+
+// static
+u64 TierUp::NativeInstance::GrowMemory(void* host,
+                                       u32 memory_index,
+                                       u64 delta) {
+  auto* self = static_cast<NativeInstance*>(host);
+  Memory* memory = self->memories[memory_index].memory;
+  u64 old_pages = memory->PageSize();
+  if (Failed(memory->Grow(delta))) {
+    return ~u64{0};
+  }
+  self->SyncMemories();
+  return old_pages;
+}
+
+TierUp::TierUp(Store& store, const TierUpOptions& options)
+    : store_(store), options_(options) {}
+
+TierUp::~TierUp() {
+  if (store_.tier_up() == this) {
+    store_.set_tier_up(nullptr);
+  }
+  for (auto& [index, module] : modules_) {
+    if (module->worker.joinable()) {
+      module->worker.join();
+    }
+  }
+  for (auto& [index, instance] : instances_) {
+    for (Ref func_ref : instance->instance->funcs()) {
+      if (auto func = store_.UnsafeGet<Func>(func_ref);
+          isa<DefinedFunc>(func.get())) {
+        cast<DefinedFunc>(func.get())->native_.store(
+            nullptr, std::memory_order_relaxed);
+      }
+    }
+    if (instance->native) {
+      instance->module->free(instance->native);
+    }
+  }
+  instances_.clear();
+#if WABT_TIER_UP_SUPPORTED
+  for (auto& [index, module] : modules_) {
+    if (module->handle) {
+      dlclose(module->handle);
+    }
+  }
+#endif
+}
+
+// static
+bool TierUp::IsSupported() {
+  return WABT_TIER_UP_SUPPORTED;
+}
+
+void TierUp::AddModule(const Module::Ptr& module, std::vector<u8> data) {
+  auto native_module = std::make_unique<NativeModule>();
+  native_module->module = module;
+  native_module->data = std::move(data);
+  native_module->features = store_.features();
+  const auto& funcs = module->desc().funcs;
+  for (u32 i = 0; i < funcs.size(); ++i) {
+    native_module->func_indexes.emplace(funcs[i].code_offset, i);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  modules_[module.ref().index] = std::move(native_module);
+}
+
+void TierUp::OnHot(DefinedFunc& func) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Check again after another threshold's worth of calls and loops, if the
+  // module isn't ready yet.
+  func.hotness_.store(0, std::memory_order_relaxed);
+  if (func.native_.load(std::memory_order_relaxed)) {
+    // Still running in the interpreter since before it was switched.
+    return;
+  }
+
+  NativeInstance* instance;
+  auto instance_iter = instances_.find(func.instance().index);
+  if (instance_iter != instances_.end()) {
+    instance = instance_iter->second.get();
+  } else {
+    auto inst = store_.UnsafeGet<Instance>(func.instance());
+    auto module_iter = modules_.find(inst->module().index);
+    if (module_iter == modules_.end()) {
+      return;
+    }
+    NativeModule* module = module_iter->second.get();
+    if (!IsReady(module)) {
+      return;
+    }
+
+    auto new_instance = std::make_unique<NativeInstance>();
+    instance = new_instance.get();
+    instance->tier_up = this;
+    instance->module = module;
+    instance->instance = inst;
+    for (Ref memory_ref : inst->memories()) {
+      instance->memories.push_back(
+          {store_.UnsafeGet<Memory>(memory_ref).get(), nullptr, 0});
+    }
+    for (Ref global_ref : inst->globals()) {
+      instance->globals.push_back(
+          &store_.UnsafeGet<Global>(global_ref)->value_);
+    }
+    instance->host = {instance, instance->globals.data(),
+                      &NativeInstance::CallImport,
+                      &NativeInstance::GrowMemory};
+    instances_.emplace(func.instance().index, std::move(new_instance));
+
+    instance->native = module->new_(&instance->host);
+    if (instance->native) {
+      // Force every memory to be passed the first time.
+      for (auto& cached : instance->memories) {
+        cached.size = ~u64{0};
+      }
+      instance->SyncMemories();
+      if (const char* message = module->instantiate(instance->native)) {
+        if (options_.log_stream) {
+          options_.log_stream->Writef("tier-up: instantiation failed: %s\n",
+                                      message);
+        }
+        module->free(instance->native);
+        instance->native = nullptr;
+      }
+    }
+    if (instance->native) {
+      for (u32 i = 0; i < module->func_indexes.size(); ++i) {
+        instance->funcs.push_back({instance, i});
+      }
+    }
+  }
+
+  if (!instance->native) {
+    return;
+  }
+  u32 index = instance->module->func_indexes.at(func.desc().code_offset);
+  func.native_.store(&instance->funcs[index], std::memory_order_release);
+  ++native_func_count_;
+}
+
+bool TierUp::IsReady(NativeModule* module) {
+  switch (module->state) {
+    case NativeModule::State::Registered:
+      module->state = NativeModule::State::Compiling;
+      module->worker = std::thread([this, module]() {
+        Compile(module);
+        module->done = true;
+      });
+      return false;
+
+    case NativeModule::State::Compiling:
+      if (!module->done) {
+        return false;
+      }
+      module->worker.join();
+      if (options_.log_stream && !module->log.empty()) {
+        options_.log_stream->WriteData(module->log.data(), module->log.size());
+      }
+      module->log.clear();
+      module->state = module->call ? NativeModule::State::Ready
+                                   : NativeModule::State::Failed;
+      return module->state == NativeModule::State::Ready;
+
+    case NativeModule::State::Ready:
+      return true;
+
+    case NativeModule::State::Failed:
+      return false;
+  }
+  WABT_UNREACHABLE;
+}
+
+// Runs on a worker thread, so this must not touch the Store.
+void TierUp::Compile(NativeModule* module) {
+#if WABT_TIER_UP_SUPPORTED
+  std::string& log = module->log;
+  if (options_.ggt_thread.empty()) {
+    log += "tier-up: module not compiled: no ggt thread was given\n";
+    return;
+  }
+
+  Errors errors;
+  wabt::Module ir;
+  const bool kReadDebugNames = false;
+  const bool kStopOnFirstError = true;
+  const bool kFailOnCustomSectionError = false;
+  ReadBinaryOptions read_options(module->features, nullptr, kReadDebugNames,
+                                 kStopOnFirstError, kFailOnCustomSectionError);
+  if (Failed(ReadBinaryIr("<tier-up>", module->data.data(),
+                          module->data.size(), read_options, &errors, &ir)) ||
+      Failed(ValidateModule(&ir, &errors, module->features))) {
+    log += FormatErrorsToString(errors, Location::Type::Binary);
+    return;
+  }
+  module->data.clear();
+  module->data.shrink_to_fit();
+
+  std::string reason;
+  if (!CanCompile(ir, &reason)) {
+    log += "tier-up: module not compiled: " + reason + "\n";
+    return;
+  }
+  PrepareModule(&ir);
+  if (Failed(GenerateNames(&ir, NameOpts::LocalNamesOnDemand)) ||
+      Failed(ApplyNames(&ir))) {
+    log += "tier-up: module not compiled: naming failed\n";
+    return;
+  }
+
+  const char* tmpdir = getenv("TMPDIR");
+  std::string dir = std::string(tmpdir ? tmpdir : "/tmp") +
+                    "/wabt-tier-up-XXXXXX";
+  if (!mkdtemp(&dir[0])) {
+    log += "tier-up: unable to create a temporary directory\n";
+    return;
+  }
+  std::string c_file = dir + "/" + kModuleName + ".c";
+  std::string h_file = dir + "/" + kModuleName + ".h";
+  std::string glue_file = dir + "/glue.c";
+  std::string so_file = dir + "/" + kModuleName + ".so";
+
+  Result result = Result::Ok;
+  {
+    FileStream c_stream(c_file);
+    FileStream h_stream(h_file);
+    FileStream glue_stream(glue_file);
+    WriteCOptions write_c_options;
+    write_c_options.module_name = kModuleName;
+    write_c_options.features = module->features;
+    std::string header_name = std::string(kModuleName) + ".h";
+    result = WriteC({&c_stream}, &h_stream, &c_stream, header_name.c_str(),
+                    "", &ir, write_c_options);
+    WriteGlue(&glue_stream, ir, options_.ggt_thread);
+    if (!c_stream.is_open() || !h_stream.is_open() || !glue_stream.is_open()) {
+      result = Result::Error;
+    }
+  }
+
+  if (Succeeded(result)) {
+    const std::string& rt = options_.runtime_dir;
+    std::string command =
+        options_.cc +
+        " -shared -fPIC -fvisibility=hidden"
+        " -DWASM_RT_MEMCHECK_BOUNDS_CHECK=1"
+        " -DWASM_RT_NONCONFORMING_MEMCHECK_NONE=0" +
+        " -DWASM_RT_MAX_CALL_STACK_DEPTH=" +
+        std::to_string(Thread::Options::kDefaultCallStackSize) + " -I" +
+        Quote(rt) + " -I" + Quote(dir) + " -o " + Quote(so_file) + " " +
+        Quote(c_file) + " " + Quote(glue_file) + " " +
+        Quote(rt + "/wasm-rt-impl.c") + " " +
+        Quote(rt + "/wasm-rt-exceptions-impl.c") + " -lm 2>&1";
+    if (FILE* pipe = popen(command.c_str(), "r")) {
+      char buffer[4096];
+      size_t size;
+      while ((size = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        log.append(buffer, size);
+      }
+      if (pclose(pipe) != 0) {
+        log += "tier-up: compiler failed: " + command + "\n";
+        result = Result::Error;
+      }
+    } else {
+      log += "tier-up: unable to run the compiler\n";
+      result = Result::Error;
+    }
+  } else {
+    log += "tier-up: unable to write the generated code\n";
+  }
+
+  if (Succeeded(result)) {
+    void* handle = dlopen(so_file.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle) {
+      module->new_ =
+          reinterpret_cast<NewFunc>(dlsym(handle, "wabt_tier_up_new"));
+      module->set_memory = reinterpret_cast<SetMemoryFunc>(
+          dlsym(handle, "wabt_tier_up_set_memory"));
+      module->instantiate = reinterpret_cast<InstantiateFunc>(
+          dlsym(handle, "wabt_tier_up_instantiate"));
+      module->free =
+          reinterpret_cast<FreeFunc>(dlsym(handle, "wabt_tier_up_free"));
+      CallFunc call =
+          reinterpret_cast<CallFunc>(dlsym(handle, "wabt_tier_up_call"));
+      if (module->new_ && module->set_memory && module->instantiate &&
+          module->free && call) {
+        module->handle = handle;
+        module->call = call;
+        log += StringPrintf("tier-up: compiled %" PRIzd " functions\n",
+                            module->func_indexes.size());
+      } else {
+        log += "tier-up: missing entry points\n";
+        dlclose(handle);
+      }
+    } else {
+      log += std::string("tier-up: ") + dlerror() + "\n";
+    }
+  }
+
+  for (const std::string& file : {c_file, h_file, glue_file, so_file}) {
+    remove(file.c_str());
+  }
+  rmdir(dir.c_str());
+#else
+  module->log += "tier-up: not supported on this platform\n";
+#endif
+}
+
+Result TierUp::Call(Thread& thread,
+                    const DefinedFunc& func,
+                    const Value* params,
+                    Value* results,
+                    Trap::Ptr* out_trap) {
+  const NativeFunc& native_func =
+      *func.native_.load(std::memory_order_acquire);
+  NativeInstance& instance = *native_func.instance;
+  const FuncType& type = func.type();
+
+  const size_t kInlineArgs = 8;
+  u64 inline_args[kInlineArgs];
+  std::vector<u64> heap_args;
+  u64* args = inline_args;
+  if (type.params.size() > kInlineArgs) {
+    heap_args.resize(type.params.size());
+    args = heap_args.data();
+  }
+  for (Index i = 0; i < type.params.size(); ++i) {
+    args[i] = ToBits(type.params[i], params[i]);
+  }
+
+  NativeCall call{&thread, {}};
+  NativeCall* saved_call = s_native_call;
+  s_native_call = &call;
+  instance.SyncMemories();
+  u64 result_bits = 0;
+  const char* message = instance.module->call(
+      instance.native, native_func.index, args, &result_bits);
+  s_native_call = saved_call;
+
+  if (message) {
+    if (call.pending_trap) {
+      *out_trap = call.pending_trap;
+    } else {
+      *out_trap = Trap::New(store_, message, thread.frames_);
+    }
+    return Result::Error;
+  }
+  if (!type.results.empty()) {
+    results[0] = FromBits(type.results[0], result_bits);
+  }
+  return Result::Ok;
+}
+
+}  // namespace interp
+}  // namespace wabt
@@ -20,11 +20,120 @@
 #include <cassert>
 #include <cinttypes>
 
+#include "wabt/interp/interp-jit.h"
 #include "wabt/interp/interp-math.h"
+#include "wabt/interp/interp-tier-up.h"
+#include "wabt/memory-stats.h"
 
 namespace wabt {
 namespace interp {
 
+namespace {
+
+u64 ExternTypeBytes(const ExternType& type) {
+  switch (type.kind) {
+    case ExternKind::Func: {
+      auto* func_type = cast<FuncType>(&type);
+      return sizeof(FuncType) + MemoryStats::HeapBytes(func_type->params) +
+             MemoryStats::HeapBytes(func_type->results);
+    }
+    case ExternKind::Table:
+      return sizeof(TableType);
+    case ExternKind::Memory:
+      return sizeof(MemoryType);
+    case ExternKind::Global:
+      return sizeof(GlobalType);
+    case ExternKind::Tag:
+      return sizeof(TagType) +
+             MemoryStats::HeapBytes(cast<TagType>(&type)->signature);
+  }
+  WABT_UNREACHABLE;
+}
+
+u64 HeapBytes(const ImportType& type) {
+  return MemoryStats::HeapBytes(type.module) +
+         MemoryStats::HeapBytes(type.name) + ExternTypeBytes(*type.type);
+}
+
+u64 HeapBytes(const ExportType& type) {
+  return MemoryStats::HeapBytes(type.name) + ExternTypeBytes(*type.type);
+}
+
+u64 HeapBytes(const FuncDesc& desc) {
+  u64 bytes = MemoryStats::HeapBytes(desc.type.params) +
+              MemoryStats::HeapBytes(desc.type.results) +
+              MemoryStats::HeapBytes(desc.locals) +
+              MemoryStats::HeapBytes(desc.handlers);
+  for (auto&& handler : desc.handlers) {
+    bytes += MemoryStats::HeapBytes(handler.catches);
+  }
+  return bytes;
+}
+
+Value EvalConstInitInstr(const InitExpr::Instr& instr) {
+  switch (instr.op) {
+    case Opcode::I32Const: return Value::Make(instr.imm.u32(0));
+    case Opcode::I64Const: return Value::Make(instr.imm.u64(0));
+    case Opcode::F32Const: return Value::Make(Bitcast<f32>(instr.imm.u32(0)));
+    case Opcode::F64Const: return Value::Make(Bitcast<f64>(instr.imm.u64(0)));
+    case Opcode::V128Const: return Value::Make(instr.imm);
+    case Opcode::RefNull: return Value::Make(Ref::Null);
+    default: WABT_UNREACHABLE;
+  }
+}
+
+// Evaluates the postfix |instrs| of an init expression, calling |eval_instr|
+// for everything but the extended-const arithmetic.
+template <typename F>
+Value EvalInitInstrs(const std::vector<InitExpr::Instr>& instrs,
+                     F&& eval_instr) {
+  Values stack;
+  for (auto&& instr : instrs) {
+    if (instr.op.GetParamType1() == Type::Void) {
+      stack.push_back(eval_instr(instr));
+      continue;
+    }
+
+    Value rhs = stack.back();
+    stack.pop_back();
+    Value& lhs = stack.back();
+    // clang-format off
+    switch (instr.op) {
+      case Opcode::I32Add: lhs = Value::Make(Add(lhs.Get<u32>(), rhs.Get<u32>())); break;
+      case Opcode::I32Sub: lhs = Value::Make(Sub(lhs.Get<u32>(), rhs.Get<u32>())); break;
+      case Opcode::I32Mul: lhs = Value::Make(Mul(lhs.Get<u32>(), rhs.Get<u32>())); break;
+      case Opcode::I64Add: lhs = Value::Make(Add(lhs.Get<u64>(), rhs.Get<u64>())); break;
+      case Opcode::I64Sub: lhs = Value::Make(Sub(lhs.Get<u64>(), rhs.Get<u64>())); break;
+      case Opcode::I64Mul: lhs = Value::Make(Mul(lhs.Get<u64>(), rhs.Get<u64>())); break;
+      default: WABT_UNREACHABLE;
+    }
+    // clang-format on
+  }
+  assert(stack.size() == 1);
+  return stack[0];
+}
+
+size_t ObjectSize(ObjectKind kind) {
+  switch (kind) {
+    case ObjectKind::Null:        return sizeof(Object);
+    case ObjectKind::Foreign:     return sizeof(Foreign);
+    case ObjectKind::Trap:        return sizeof(Trap);
+    case ObjectKind::Exception:   return sizeof(Exception);
+    case ObjectKind::DefinedFunc: return sizeof(DefinedFunc);
+    case ObjectKind::HostFunc:    return sizeof(HostFunc);
+    case ObjectKind::Table:       return sizeof(Table);
+    case ObjectKind::Memory:      return sizeof(Memory);
+    case ObjectKind::Global:      return sizeof(Global);
+    case ObjectKind::Tag:         return sizeof(Tag);
+    case ObjectKind::Module:      return sizeof(Module);
+    case ObjectKind::Instance:    return sizeof(Instance);
+    case ObjectKind::Continuation: return sizeof(Continuation);
+  }
+  WABT_UNREACHABLE;
+}
+
+}  // end anonymous namespace
+
 const char* GetName(Mutability mut) {
   static const char* kNames[] = {"immutable", "mutable"};
   return kNames[int(mut)];
@@ -42,6 +151,7 @@ const char* GetName(ObjectKind kind) {
   static const char* kNames[] = {
       "Null",  "Foreign", "Trap",   "Exception", "DefinedFunc", "HostFunc",
       "Table", "Memory",  "Global", "Tag",       "Module",      "Instance",
+      "Continuation",
   };
 
   WABT_STATIC_ASSERT(WABT_ARRAY_SIZE(kNames) == kCommandTypeCount);
@@ -89,7 +199,11 @@ std::unique_ptr<ExternType> FuncType::Clone() const {
 Result Match(const FuncType& expected,
              const FuncType& actual,
              std::string* out_msg) {
-  if (expected.params != actual.params || expected.results != actual.results) {
+  bool matches = expected.id != kInvalidIndex && actual.id != kInvalidIndex
+                     ? expected.id == actual.id
+                     : expected.params == actual.params &&
+                           expected.results == actual.results;
+  if (!matches) {
     if (out_msg) {
       *out_msg = "import signature mismatch";
     }
@@ -200,13 +314,165 @@ ValueType FuncDesc::GetLocalType(Index index) const {
   return iter->type;
 }
 
+void AccountMemory(const ModuleDesc& desc, MemoryStats* stats) {
+  u64 bytes = MemoryStats::HeapBytes(desc.func_types) +
+              MemoryStats::HeapBytes(desc.imports) +
+              MemoryStats::HeapBytes(desc.funcs) +
+              MemoryStats::HeapBytes(desc.tables) +
+              MemoryStats::HeapBytes(desc.memories) +
+              MemoryStats::HeapBytes(desc.globals) +
+              MemoryStats::HeapBytes(desc.tags) +
+              MemoryStats::HeapBytes(desc.exports) +
+              MemoryStats::HeapBytes(desc.starts) +
+              MemoryStats::HeapBytes(desc.elems) +
+              MemoryStats::HeapBytes(desc.datas);
+  for (auto&& func_type : desc.func_types) {
+    bytes += MemoryStats::HeapBytes(func_type.params) +
+             MemoryStats::HeapBytes(func_type.results);
+  }
+  for (auto&& import : desc.imports) {
+    bytes += HeapBytes(import.type);
+  }
+  for (auto&& func : desc.funcs) {
+    bytes += HeapBytes(func);
+  }
+  for (auto&& global : desc.globals) {
+    bytes += MemoryStats::HeapBytes(global.init.instrs);
+  }
+  for (auto&& tag : desc.tags) {
+    bytes += MemoryStats::HeapBytes(tag.type.signature);
+  }
+  for (auto&& export_ : desc.exports) {
+    bytes += HeapBytes(export_.type);
+  }
+  for (auto&& elem : desc.elems) {
+    bytes += MemoryStats::HeapBytes(elem.elements) +
+             MemoryStats::HeapBytes(elem.offset.instrs);
+    for (auto&& element : elem.elements) {
+      bytes += MemoryStats::HeapBytes(element.instrs);
+    }
+  }
+  for (auto&& data : desc.datas) {
+    bytes += MemoryStats::HeapBytes(data.data) +
+             MemoryStats::HeapBytes(data.offset.instrs);
+  }
+  stats->Add("interp.module_descs", bytes);
+  stats->Add("interp.istream", desc.istream.capacity());
+}
+
+void FoldInitExpr(InitExpr* init) {
+  if (init->instrs.size() == 1) {
+    return;
+  }
+  for (auto&& instr : init->instrs) {
+    if (instr.op == Opcode::GlobalGet || instr.op == Opcode::RefFunc) {
+      return;
+    }
+  }
+
+  // Only integer arithmetic can combine constants.
+  Opcode result_op = init->instrs.back().op.GetResultType() == Type::I64
+                         ? Opcode::I64Const
+                         : Opcode::I32Const;
+  Value value = EvalInitInstrs(init->instrs, EvalConstInitInstr);
+  v128 imm{};
+  imm.set_u64(0, result_op == Opcode::I64Const ? value.Get<u64>()
+                                               : value.Get<u32>());
+  init->instrs.assign(1, InitExpr::Instr{result_op, imm});
+}
+
 //// Store ////
-Store::Store(const Features& features) : features_(features) {
+namespace {
+
+// The innermost Mutator of the calling OS thread, if any.
+thread_local Store::Mutator* s_mutator = nullptr;
+
+}  // end anonymous namespace
+
+Store::Mutator::Mutator(Store& store) : store_(store), prev_(s_mutator) {
+  assert(store.concurrent_);
+  assert(!store.GetMutator());
+  std::unique_lock<std::mutex> lock(store.mutex_);
+  // A collection that is already waiting for the attached threads doesn't
+  // know about this one, so it can't join until that is over.
+  store.cond_.wait(lock, [&store] { return !store.collecting_; });
+  store.attached_count_++;
+  s_mutator = this;
+}
+
+Store::Mutator::~Mutator() {
+  assert(s_mutator == this);
+  s_mutator = prev_;
+  std::lock_guard<std::mutex> lock(store_.mutex_);
+  store_.free_objects_.insert(store_.free_objects_.end(),
+                              free_objects_.begin(), free_objects_.end());
+  store_.free_roots_.insert(store_.free_roots_.end(), free_roots_.begin(),
+                            free_roots_.end());
+  store_.free_root_count_.store(store_.free_roots_.size(),
+                                std::memory_order_relaxed);
+  store_.attached_count_--;
+  // A collection may be waiting for this thread.
+  store_.cond_.notify_all();
+}
+
+Store::Store(const Features& features) : Store(features, Options{}) {}
+
+Store::Store(const Features& features, const Options& options)
+    : features_(features),
+      objects_(options.concurrent),
+      roots_(options.concurrent),
+      concurrent_(options.concurrent) {
   Ref ref{objects_.New(new Object(ObjectKind::Null))};
   assert(ref == Ref::Null);
   roots_.New(ref);
 }
 
+Store::Mutator* Store::GetMutator() const {
+  Mutator* mutator = s_mutator;
+  return mutator && &mutator->store_ == this ? mutator : nullptr;
+}
+
+Ref Store::NewObject(Object* obj) {
+  if (WABT_LIKELY(!concurrent_)) {
+    return Ref{objects_.New(obj)};
+  }
+
+  ObjectList::Index index;
+  if (Mutator* mutator = GetMutator()) {
+    if (WABT_UNLIKELY(mutator->free_objects_.empty())) {
+      RefillObjects(mutator);
+    }
+    index = mutator->free_objects_.back();
+    mutator->free_objects_.pop_back();
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_objects_.empty()) {
+      index = objects_.Reserve(1);
+    } else {
+      index = free_objects_.back();
+      free_objects_.pop_back();
+    }
+  }
+  objects_.Put(index, obj);
+  return Ref{index};
+}
+
+void Store::RefillObjects(Mutator* mutator) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t count = std::min(free_objects_.size(), kMutatorBufferSize);
+  if (count == 0) {
+    ObjectList::Index first = objects_.Reserve(kMutatorBufferSize);
+    // Reversed, so the lowest index is used first.
+    for (size_t i = kMutatorBufferSize; i > 0; --i) {
+      mutator->free_objects_.push_back(first + i - 1);
+    }
+    return;
+  }
+  mutator->free_objects_.assign(free_objects_.end() - count,
+                                free_objects_.end());
+  free_objects_.resize(free_objects_.size() - count);
+}
+
 #ifndef NDEBUG
 bool Store::HasValueType(Ref ref, ValueType type) const {
   // TODO opt?
@@ -232,7 +498,10 @@ bool Store::HasValueType(Ref ref, ValueType type) const {
 #endif
 
 Store::RootList::Index Store::NewRoot(Ref ref) {
-  return roots_.New(ref);
+  if (WABT_LIKELY(!concurrent_)) {
+    return roots_.New(ref);
+  }
+  return NewRootConcurrent(ref);
 }
 
 Store::RootList::Index Store::CopyRoot(RootList::Index index) {
@@ -241,14 +510,180 @@ Store::RootList::Index Store::CopyRoot(RootList::Index index) {
   // vector. This seems to "work" in most environments, but fails on Visual
   // Studio 2015 Win64. Copying it to a value fixes the issue.
   auto obj_index = roots_.Get(index);
-  return roots_.New(obj_index);
+  return NewRoot(obj_index);
 }
 
 void Store::DeleteRoot(RootList::Index index) {
-  roots_.Delete(index);
+  if (WABT_LIKELY(!concurrent_)) {
+    roots_.Delete(index);
+    return;
+  }
+  DeleteRootConcurrent(index);
+}
+
+Store::RootList::Index Store::NewRootConcurrent(Ref ref) {
+  RootList::Index index;
+  if (Mutator* mutator = GetMutator()) {
+    std::vector<RootList::Index>& free_roots = mutator->free_roots_;
+    if (WABT_UNLIKELY(free_roots.empty())) {
+      // Only take the lock if there are roots to take back; otherwise, new
+      // slots can be reserved without it.
+      if (free_root_count_.load(std::memory_order_relaxed) != 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = std::min(free_roots_.size(), kMutatorBufferSize);
+        free_roots.assign(free_roots_.end() - count, free_roots_.end());
+        free_roots_.resize(free_roots_.size() - count);
+        free_root_count_.store(free_roots_.size(), std::memory_order_relaxed);
+      }
+      if (free_roots.empty()) {
+        RootList::Index first = roots_.Reserve(kMutatorBufferSize);
+        for (size_t i = kMutatorBufferSize; i > 0; --i) {
+          free_roots.push_back(first + i - 1);
+        }
+      }
+    }
+    index = free_roots.back();
+    free_roots.pop_back();
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_roots_.empty()) {
+      index = roots_.Reserve(1);
+    } else {
+      index = free_roots_.back();
+      free_roots_.pop_back();
+      free_root_count_.store(free_roots_.size(), std::memory_order_relaxed);
+    }
+  }
+  roots_.Put(index, ref);
+  return index;
+}
+
+void Store::DeleteRootConcurrent(RootList::Index index) {
+  Mutator* mutator = GetMutator();
+  if (!mutator) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    roots_.Clear(index);
+    free_roots_.push_back(index);
+    free_root_count_.store(free_roots_.size(), std::memory_order_relaxed);
+    return;
+  }
+
+  roots_.Clear(index);
+  std::vector<RootList::Index>& free_roots = mutator->free_roots_;
+  free_roots.push_back(index);
+  // Roots are often deleted by a different thread than the one that created
+  // them, so hand some back once there are more than a thread needs.
+  if (WABT_UNLIKELY(free_roots.size() >= 2 * kMutatorBufferSize)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_roots_.insert(free_roots_.end(),
+                       free_roots.end() - kMutatorBufferSize, free_roots.end());
+    free_roots.resize(free_roots.size() - kMutatorBufferSize);
+    free_root_count_.store(free_roots_.size(), std::memory_order_relaxed);
+  }
+}
+
+void Store::InternFuncType(FuncType* type) {
+  if (concurrent_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    type->id = func_types_.Intern(type->params, type->results);
+    return;
+  }
+  type->id = func_types_.Intern(type->params, type->results);
+}
+
+Store::ObjectList::Index Store::object_count() const {
+  if (!concurrent_) {
+    return objects_.count();
+  }
+  // The slots that are free aren't tracked in one place; they may be in any
+  // Mutator's buffer.
+  ObjectList::Index count = 0;
+  for (ObjectList::Index i = 0; i < objects_.size(); ++i) {
+    count += objects_.IsUsed(i);
+  }
+  return count;
+}
+
+void Store::AddThread(Thread* thread) {
+  if (concurrent_) {
+    // Otherwise, a Collect could run while the thread is running.
+    assert(GetMutator());
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.insert(thread);
+    return;
+  }
+  threads_.insert(thread);
+}
+
+void Store::RemoveThread(Thread* thread) {
+  if (concurrent_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.erase(thread);
+    return;
+  }
+  threads_.erase(thread);
+}
+
+void Store::AccountMemory(MemoryStats* stats) const {
+  for (ObjectList::Index i = 0; i < objects_.size(); ++i) {
+    if (objects_.IsUsed(i)) {
+      const Object* obj = objects_.Get(i);
+      stats->Add("interp.objects", ObjectSize(obj->kind()));
+      obj->AccountMemory(stats);
+    }
+  }
+  stats->Add("interp.free_lists",
+             objects_.capacity() * sizeof(Object*) +
+                 roots_.capacity() * sizeof(Ref),
+             (objects_.size() - object_count()) +
+                 (roots_.size() - roots_.count()));
+  for (const Thread* thread : threads_) {
+    thread->AccountMemory(stats);
+  }
 }
 
 void Store::Collect() {
+  if (WABT_LIKELY(!concurrent_)) {
+    MarkAndSweep();
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool attached = GetMutator() != nullptr;
+  if (collecting_) {
+    // Another thread got here first; its collection is as good as this one.
+    WaitForCollection(lock, attached);
+    return;
+  }
+
+  collecting_ = true;
+  safepoint_requested_.store(true, std::memory_order_relaxed);
+  cond_.wait(lock, [this, attached] {
+    return stopped_count_ == attached_count_ - attached;
+  });
+  // Threads that aren't attached are kept out by the lock.
+  MarkAndSweep();
+  collecting_ = false;
+  safepoint_requested_.store(false, std::memory_order_relaxed);
+  cond_.notify_all();
+}
+
+void Store::SafepointSlow() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (collecting_) {
+    WaitForCollection(lock, GetMutator() != nullptr);
+  }
+}
+
+void Store::WaitForCollection(std::unique_lock<std::mutex>& lock,
+                              bool attached) {
+  stopped_count_ += attached;
+  cond_.notify_all();
+  cond_.wait(lock, [this] { return !collecting_; });
+  stopped_count_ -= attached;
+}
+
+void Store::MarkAndSweep() {
   size_t object_count = objects_.size();
 
   assert(gc_context_.call_depth == 0);
@@ -284,7 +719,12 @@ void Store::Collect() {
   // Delete all unmarked objects.
   for (size_t i = 0; i < object_count; ++i) {
     if (objects_.IsUsed(i) && !gc_context_.marks[i]) {
-      objects_.Delete(i);
+      if (concurrent_) {
+        objects_.Clear(i);
+        free_objects_.push_back(i);
+      } else {
+        objects_.Delete(i);
+      }
     }
   }
 }
@@ -342,14 +782,22 @@ void Trap::Mark(Store& store) {
   }
 }
 
+void Trap::AccountMemory(MemoryStats* stats) const {
+  stats->Add("interp.objects",
+             MemoryStats::HeapBytes(message_) + MemoryStats::HeapBytes(trace_),
+             0);
+}
+
 //// Exception ////
 Exception::Exception(Store& store, Ref tag, Values& args)
     : Object(skind), tag_(tag), args_(args) {}
 
 void Exception::Mark(Store& store) {
-  Tag::Ptr tag(store, tag_);
+  // Marking must not create roots: a concurrent Store holds its lock while
+  // collecting.
+  auto* tag = cast<Tag>(store.objects_.Get(tag_.index));
   store.Mark(tag_);
-  ValueTypes params = tag->type().signature;
+  const ValueTypes& params = tag->type().signature;
   for (size_t i = 0; i < params.size(); i++) {
     if (params[i].IsRef()) {
       store.Mark(args_[i].Get<Ref>());
@@ -357,6 +805,10 @@ void Exception::Mark(Store& store) {
   }
 }
 
+void Exception::AccountMemory(MemoryStats* stats) const {
+  stats->Add("interp.objects", MemoryStats::HeapBytes(args_), 0);
+}
+
 //// Extern ////
 template <typename T>
 Result Extern::MatchImpl(Store& store,
@@ -403,7 +855,9 @@ Result Func::Call(Thread& thread,
 
 //// DefinedFunc ////
 DefinedFunc::DefinedFunc(Store& store, Ref instance, FuncDesc desc)
-    : Func(skind, desc.type), instance_(instance), desc_(desc) {}
+    : Func(skind, desc.type), instance_(instance), desc_(desc) {
+  store.InternFuncType(&type_);
+}
 
 void DefinedFunc::Mark(Store& store) {
   store.Mark(instance_);
@@ -420,12 +874,26 @@ Result DefinedFunc::DoCall(Thread& thread,
                            Values& results,
                            Trap::Ptr* out_trap) {
   assert(params.size() == type_.params.size());
+  if (WABT_UNLIKELY(thread.tier_up_)) {
+    if (native_.load(std::memory_order_acquire)) {
+      results.resize(type_.results.size());
+      return thread.CallNative(*this, params.data(), results.data(),
+                               out_trap) == RunResult::Ok
+                 ? Result::Ok
+                 : Result::Error;
+    }
+    thread.CountCall(*this);
+  }
   thread.PushValues(type_.params, params);
   RunResult result = thread.PushCall(*this, out_trap);
   if (result == RunResult::Trap) {
     return Result::Error;
   }
+  thread.sync_call_depth_++;
   result = thread.Run(out_trap);
+  thread.sync_call_depth_--;
+  // Suspend fails while sync_call_depth_ is nonzero.
+  assert(result != RunResult::Suspend);
   if (result == RunResult::Trap) {
     return Result::Error;
   } else if (result == RunResult::Exception) {
@@ -439,8 +907,10 @@ Result DefinedFunc::DoCall(Thread& thread,
 }
 
 //// HostFunc ////
-HostFunc::HostFunc(Store&, FuncType type, Callback callback)
-    : Func(skind, type), callback_(callback) {}
+HostFunc::HostFunc(Store& store, FuncType type, Callback callback)
+    : Func(skind, type), callback_(callback) {
+  store.InternFuncType(&type_);
+}
 
 void HostFunc::Mark(Store&) {}
 
@@ -466,6 +936,10 @@ void Table::Mark(Store& store) {
   store.Mark(elements_);
 }
 
+void Table::AccountMemory(MemoryStats* stats) const {
+  stats->Add("interp.tables", MemoryStats::HeapBytes(elements_));
+}
+
 Result Table::Match(Store& store,
                     const ImportType& import_type,
                     Trap::Ptr* out_trap) {
@@ -571,6 +1045,10 @@ Memory::Memory(class Store&, MemoryType type)
 
 void Memory::Mark(class Store&) {}
 
+void Memory::AccountMemory(MemoryStats* stats) const {
+  stats->Add("interp.memories", MemoryStats::HeapBytes(data_));
+}
+
 Result Memory::Match(class Store& store,
                      const ImportType& import_type,
                      Trap::Ptr* out_trap) {
@@ -654,18 +1132,27 @@ Result Memory::Copy(Memory& dst,
   return Result::Error;
 }
 
-Result Instance::CallInitFunc(Store& store,
-                              const Ref func_ref,
-                              Value* result,
-                              Trap::Ptr* out_trap) {
-  Values results;
-  Func::Ptr func{store, func_ref};
-  if (Failed(func->Call(store, {}, results, out_trap))) {
-    return Result::Error;
+Value Instance::EvalInitExpr(Store& store, const InitExpr& init) const {
+  auto eval_instr = [&](const InitExpr::Instr& instr) {
+    switch (instr.op) {
+      case Opcode::GlobalGet: {
+        Global::Ptr global{store, globals_[instr.imm.u32(0)]};
+        return global->Get();
+      }
+
+      case Opcode::RefFunc:
+        return Value::Make(funcs_[instr.imm.u32(0)]);
+
+      default:
+        return EvalConstInitInstr(instr);
+    }
+  };
+
+  // Almost all expressions are a single instruction, and need no stack.
+  if (init.instrs.size() == 1) {
+    return eval_instr(init.instrs[0]);
   }
-  assert(results.size() == 1);
-  *result = results[0];
-  return Result::Ok;
+  return EvalInitInstrs(init.instrs, eval_instr);
 }
 
 //// Global ////
@@ -709,15 +1196,9 @@ ElemSegment::ElemSegment(Store& store,
                          const ElemDesc* desc,
                          Instance::Ptr& inst)
     : desc_(desc) {
-  Trap::Ptr out_trap;
   elements_.reserve(desc->elements.size());
   for (auto&& elem_expr : desc->elements) {
-    Value value;
-    Ref func_ref = DefinedFunc::New(store, inst.ref(), elem_expr).ref();
-    if (Failed(inst->CallInitFunc(store, func_ref, &value, &out_trap))) {
-      WABT_UNREACHABLE;  // valid const expression cannot trap
-    }
-    elements_.push_back(value.Get<Ref>());
+    elements_.push_back(inst->EvalInitExpr(store, elem_expr).Get<Ref>());
   }
 }
 
@@ -736,8 +1217,19 @@ bool DataSegment::IsValidRange(u64 offset, u64 size) const {
 }
 
 //// Module ////
-Module::Module(Store&, ModuleDesc desc)
+Module::Module(Store& store, ModuleDesc desc)
     : Object(skind), desc_(std::move(desc)) {
+  // Intern the signatures used by call_indirect and import matching, so they
+  // can be checked by id.
+  for (auto&& func_type : desc_.func_types) {
+    store.InternFuncType(&func_type);
+  }
+  for (auto&& import : desc_.imports) {
+    if (auto* func_type = dyn_cast<FuncType>(import.type.type.get())) {
+      store.InternFuncType(func_type);
+    }
+  }
+
   for (auto&& import : desc_.imports) {
     import_types_.emplace_back(import.type);
   }
@@ -749,6 +1241,19 @@ Module::Module(Store&, ModuleDesc desc)
 
 void Module::Mark(Store&) {}
 
+void Module::AccountMemory(MemoryStats* stats) const {
+  interp::AccountMemory(desc_, stats);
+  u64 bytes = MemoryStats::HeapBytes(import_types_) +
+              MemoryStats::HeapBytes(export_types_);
+  for (auto&& import_type : import_types_) {
+    bytes += HeapBytes(import_type);
+  }
+  for (auto&& export_type : export_types_) {
+    bytes += HeapBytes(export_type);
+  }
+  stats->Add("interp.module_descs", bytes, 0);
+}
+
 //// ElemSegment ////
 void ElemSegment::Mark(Store& store) {
   store.Mark(elements_);
@@ -814,14 +1319,13 @@ Instance::Ptr Instance::Instantiate(Store& store,
   for (auto&& desc : mod->desc().memories) {
     inst->memories_.push_back(Memory::New(store, desc.type).ref());
   }
+  if (!inst->memories_.empty()) {
+    inst->memory0_ = store.UnsafeGet<Memory>(inst->memories_[0]).get();
+  }
 
   // Globals.
   for (auto&& desc : mod->desc().globals) {
-    Value value;
-    Ref func_ref = DefinedFunc::New(store, inst.ref(), desc.init_func).ref();
-    if (Failed(inst->CallInitFunc(store, func_ref, &value, out_trap))) {
-      return {};
-    }
+    Value value = inst->EvalInitExpr(store, desc.init);
     inst->globals_.push_back(Global::New(store, desc.type, value).ref());
   }
 
@@ -867,13 +1371,7 @@ Instance::Ptr Instance::Instantiate(Store& store,
       if (desc.mode == SegmentMode::Active) {
         Result result;
         Table::Ptr table{store, inst->tables_[desc.table_index]};
-        Value value;
-        Ref func_ref =
-            DefinedFunc::New(store, inst.ref(), desc.init_func).ref();
-        if (Failed(inst->CallInitFunc(store, func_ref, &value, out_trap))) {
-          return {};
-        }
-
+        Value value = inst->EvalInitExpr(store, desc.offset);
         u64 offset;
         if (table->type().limits.is_64) {
           offset = value.Get<u64>();
@@ -911,12 +1409,7 @@ Instance::Ptr Instance::Instantiate(Store& store,
       if (desc.mode == SegmentMode::Active) {
         Result result;
         Memory::Ptr memory{store, inst->memories_[desc.memory_index]};
-        Value offset_op;
-        Ref func_ref =
-            DefinedFunc::New(store, inst.ref(), desc.init_func).ref();
-        if (Failed(inst->CallInitFunc(store, func_ref, &offset_op, out_trap))) {
-          return {};
-        }
+        Value offset_op = inst->EvalInitExpr(store, desc.offset);
         u64 offset = memory->type().limits.is_64 ? offset_op.Get<u64>()
                                                  : offset_op.Get<u32>();
         if (pass == Check) {
@@ -971,13 +1464,54 @@ void Instance::Mark(Store& store) {
   }
 }
 
+void Instance::AccountMemory(MemoryStats* stats) const {
+  u64 bytes = MemoryStats::HeapBytes(imports_) +
+              MemoryStats::HeapBytes(funcs_) +
+              MemoryStats::HeapBytes(tables_) +
+              MemoryStats::HeapBytes(memories_) +
+              MemoryStats::HeapBytes(globals_) +
+              MemoryStats::HeapBytes(tags_) +
+              MemoryStats::HeapBytes(exports_) +
+              MemoryStats::HeapBytes(elems_) + MemoryStats::HeapBytes(datas_);
+  for (auto&& elem : elems_) {
+    bytes += MemoryStats::HeapBytes(elem.elements());
+  }
+  stats->Add("interp.instances", bytes);
+}
+
+//// Continuation ////
+Continuation::Continuation(Store& store) : Object(skind) {}
+
+void Continuation::Mark(Store& store) {
+  for (auto&& frame : frames_) {
+    frame.Mark(store);
+  }
+  for (auto index : refs_) {
+    store.Mark(values_[index].Get<Ref>());
+  }
+  store.Mark(exceptions_);
+}
+
+void Continuation::AccountMemory(MemoryStats* stats) const {
+  stats->Add("interp.continuations",
+             MemoryStats::HeapBytes(frames_) + MemoryStats::HeapBytes(values_) +
+                 MemoryStats::HeapBytes(refs_) +
+                 MemoryStats::HeapBytes(exceptions_) +
+                 MemoryStats::HeapBytes(result_types_));
+}
+
 //// Thread ////
 Thread::Thread(Store& store, Stream* trace_stream)
-    : store_(store), trace_stream_(trace_stream) {
-  store.threads().insert(this);
+    : store_(store),
+      tier_up_(store.tier_up()),
+      jit_(store.jit()),
+      trace_stream_(trace_stream) {
+  store.AddThread(this);
 
   Thread::Options options;
-  frames_.reserve(options.call_stack_size);
+  call_stack_size_ = options.call_stack_size;
+  frames_.reserve(
+      std::min(Options::kInitialCallStackSize, options.call_stack_size));
   values_.reserve(options.value_stack_size);
   if (trace_stream) {
     trace_source_ = std::make_unique<TraceSource>(this);
@@ -985,7 +1519,7 @@ Thread::Thread(Store& store, Stream* trace_stream)
 }
 
 Thread::~Thread() {
-  store_.threads().erase(this);
+  store_.RemoveThread(this);
 }
 
 void Thread::Mark() {
@@ -998,6 +1532,13 @@ void Thread::Mark() {
   store_.Mark(exceptions_);
 }
 
+void Thread::AccountMemory(MemoryStats* stats) const {
+  stats->Add("interp.value_stacks",
+             MemoryStats::HeapBytes(values_) + MemoryStats::HeapBytes(refs_) +
+                 MemoryStats::HeapBytes(exceptions_));
+  stats->Add("interp.call_stacks", MemoryStats::HeapBytes(frames_));
+}
+
 void Thread::PushValues(const ValueTypes& types, const Values& values) {
   assert(types.size() == values.size());
   for (size_t i = 0; i < types.size(); ++i) {
@@ -1021,15 +1562,30 @@ Instance* Thread::GetCallerInstance() {
   return frames_[frames_.size() - 2].inst;
 }
 
+bool Thread::GrowCallStack(size_t count) {
+  size_t size = frames_.size() + count;
+  if (size <= frames_.capacity()) {
+    return true;
+  }
+  if (size > call_stack_size_) {
+    return false;
+  }
+  size_t capacity = std::max(size, frames_.capacity() * 2);
+  frames_.reserve(std::min<size_t>(capacity, call_stack_size_));
+  return true;
+}
+
 RunResult Thread::PushCall(Ref func, u32 offset, Trap::Ptr* out_trap) {
-  TRAP_IF(frames_.size() == frames_.capacity(), "call stack exhausted");
+  TRAP_IF(frames_.size() == frames_.capacity() && !GrowCallStack(),
+          "call stack exhausted");
   frames_.emplace_back(func, values_.size(), exceptions_.size(), offset, inst_,
                        mod_);
   return RunResult::Ok;
 }
 
 RunResult Thread::PushCall(const DefinedFunc& func, Trap::Ptr* out_trap) {
-  TRAP_IF(frames_.size() == frames_.capacity(), "call stack exhausted");
+  TRAP_IF(frames_.size() == frames_.capacity() && !GrowCallStack(),
+          "call stack exhausted");
   inst_ = store_.UnsafeGet<Instance>(func.instance()).get();
   mod_ = store_.UnsafeGet<Module>(inst_->module()).get();
   frames_.emplace_back(func.self(), values_.size(), exceptions_.size(),
@@ -1038,7 +1594,8 @@ RunResult Thread::PushCall(const DefinedFunc& func, Trap::Ptr* out_trap) {
 }
 
 RunResult Thread::PushCall(const HostFunc& func, Trap::Ptr* out_trap) {
-  TRAP_IF(frames_.size() == frames_.capacity(), "call stack exhausted");
+  TRAP_IF(frames_.size() == frames_.capacity() && !GrowCallStack(),
+          "call stack exhausted");
   inst_ = nullptr;
   mod_ = nullptr;
   frames_.emplace_back(func.self(), values_.size(), exceptions_.size(), 0,
@@ -1068,8 +1625,78 @@ RunResult Thread::PopCall() {
 
 RunResult Thread::DoReturnCall(const Func::Ptr& func, Trap::Ptr* out_trap) {
   PopCall();
-  DoCall(func, out_trap);
-  return frames_.empty() ? RunResult::Return : RunResult::Ok;
+  RunResult result = DoCall(func, out_trap);
+  if (result != RunResult::Ok) {
+    return result;
+  }
+  // A host or native callee doesn't leave a frame, so this may be back at a
+  // host frame.
+  return frames_.empty() || !frames_.back().inst ? RunResult::Return
+                                                 : RunResult::Ok;
+}
+
+void Thread::CountCall(DefinedFunc& func) {
+  // Not an atomic increment, which would slow down every call.
+  u32 hotness = func.hotness_.load(std::memory_order_relaxed) + 1;
+  func.hotness_.store(hotness, std::memory_order_relaxed);
+  if (hotness >= tier_up_->threshold()) {
+    tier_up_->OnHot(func);
+  }
+}
+
+void Thread::CountBackEdge() {
+  if (++back_edges_ < kBackEdgeBatch) {
+    return;
+  }
+  back_edges_ = 0;
+  auto func = store_.UnsafeGet<DefinedFunc>(frames_.back().func);
+  u32 hotness =
+      func->hotness_.load(std::memory_order_relaxed) + kBackEdgeBatch;
+  func->hotness_.store(hotness, std::memory_order_relaxed);
+  if (hotness >= tier_up_->threshold()) {
+    tier_up_->OnHot(*func);
+  }
+}
+
+RunResult Thread::DoNativeCall(const DefinedFunc& func, Trap::Ptr* out_trap) {
+  auto& type = func.type();
+  assert(type.results.size() <= 1);
+  Value results[1];
+  RunResult result = CallNative(func, values_.data() + values_.size() -
+                                          type.params.size(),
+                                results, out_trap);
+  if (result != RunResult::Ok) {
+    return result;
+  }
+  values_.resize(values_.size() - type.params.size());
+  for (size_t i = 0; i < type.results.size(); ++i) {
+    Push(results[i]);
+  }
+  return RunResult::Ok;
+}
+
+RunResult Thread::CallNative(const DefinedFunc& func,
+                             const Value* params,
+                             Value* results,
+                             Trap::Ptr* out_trap) {
+  // The native code gets a frame of its own, so that traps and host functions
+  // it calls see it as the caller.
+  Instance* inst = inst_;
+  Module* mod = mod_;
+  size_t num_frames = frames_.size();
+  inst_ = store_.UnsafeGet<Instance>(func.instance()).get();
+  mod_ = store_.UnsafeGet<Module>(inst_->module()).get();
+  RunResult result = PushCall(func.self(), 0, out_trap);
+  sync_call_depth_++;
+  if (result == RunResult::Ok &&
+      Failed(tier_up_->Call(*this, func, params, results, out_trap))) {
+    result = RunResult::Trap;
+  }
+  sync_call_depth_--;
+  frames_.erase(frames_.begin() + num_frames, frames_.end());
+  inst_ = inst;
+  mod_ = mod;
+  return result;
 }
 
 void Thread::PopValues(const ValueTypes& types, Values* out_values) {
@@ -1089,8 +1716,53 @@ RunResult Thread::Run(Trap::Ptr* out_trap) {
 }
 
 RunResult Thread::Run(int num_instructions, Trap::Ptr* out_trap) {
+  store_.Safepoint();
   DefinedFunc::Ptr func{store_, frames_.back().func};
-  for (; num_instructions > 0; --num_instructions) {
+  if (WABT_UNLIKELY(jit_) && !trace_stream_) {
+    return RunJit(num_instructions, out_trap);
+  }
+  if (WABT_UNLIKELY(trace_stream_)) {
+    for (int i = 0; i < num_instructions; ++i) {
+      instruction_count_++;
+      auto result = StepInternal(out_trap);
+      if (result != RunResult::Ok) {
+        return result;
+      }
+    }
+    return RunResult::Ok;
+  }
+
+  // Count the whole batch at once to keep the dispatch loop small, and keep
+  // the TOS register in a local so it can stay in a machine register.
+  Value tos = tos_;
+  u64 tos_hits = 0;
+  RunResult result = RunResult::Ok;
+  int i = 0;
+  while (i < num_instructions) {
+    auto instr = mod_->desc().istream.Read(&frames_.back().offset);
+    ++i;
+    if (instr.tos_state) {
+      tos_hits += instr.tos_state & Istream::kTosIn;
+      StepTos(instr, &tos);
+      continue;
+    }
+    result = Execute(instr, out_trap);
+    if (result != RunResult::Ok) {
+      break;
+    }
+  }
+  tos_ = tos;
+  tos_hit_count_ += tos_hits;
+  instruction_count_ += i;
+  return result;
+}
+
+RunResult Thread::RunJit(int num_instructions, Trap::Ptr* out_trap) {
+  // Only the instructions left to the interpreter count towards
+  // |num_instructions|.
+  for (int i = 0; i < num_instructions; ++i) {
+    jit_->Run(*this);
+    instruction_count_++;
     auto result = StepInternal(out_trap);
     if (result != RunResult::Ok) {
       return result;
@@ -1101,6 +1773,7 @@ RunResult Thread::Run(int num_instructions, Trap::Ptr* out_trap) {
 
 RunResult Thread::Step(Trap::Ptr* out_trap) {
   DefinedFunc::Ptr func{store_, frames_.back().func};
+  instruction_count_++;
   return StepInternal(out_trap);
 }
 
@@ -1166,9 +1839,136 @@ void Thread::Push(Ref ref) {
   values_.push_back(Value::Make(ref));
 }
 
-RunResult Thread::StepInternal(Trap::Ptr* out_trap) {
+// Bool results are pushed as i32, like Push<bool>.
+template <typename T>
+static Value WABT_VECTORCALL MakeTosValue(T value) {
+  return Value::Make(value);
+}
+
+template <>
+Value WABT_VECTORCALL MakeTosValue(bool value) {
+  return Value::Make(static_cast<u32>(value ? 1 : 0));
+}
+
+inline void Thread::SetTosResult(Value value, Instr instr, Value* tos) {
+  if (instr.tos_state & Istream::kTosOut) {
+    *tos = value;
+  } else {
+    Push(value);
+  }
+}
+
+template <typename R, typename T>
+inline void Thread::DoTosUnop(UnopFunc<R, T> f, Instr instr, Value* tos) {
+  T val = (instr.tos_state & Istream::kTosIn) ? tos->Get<T>() : Pop<T>();
+  SetTosResult(MakeTosValue(f(val)), instr, tos);
+}
+
+template <typename R, typename T>
+inline void Thread::DoTosBinop(BinopFunc<R, T> f, Instr instr, Value* tos) {
+  T rhs = (instr.tos_state & Istream::kTosIn) ? tos->Get<T>() : Pop<T>();
+  T lhs = Pop<T>();
+  SetTosResult(MakeTosValue(f(lhs, rhs)), instr, tos);
+}
+
+// With kTosIn, the top of the stack is in |tos| rather than in values_, so
+// local indexes, which count the whole stack, are one less for values_.
+inline void Thread::StepTos(Instr instr, Value* tos) {
   using O = Opcode;
 
+  // clang-format off
+  switch (instr.op) {
+    // These only get kTosOut; see CacheTopOfStack.
+    case O::I32Const: *tos = Value::Make(instr.imm_u32); break;
+    case O::I64Const: *tos = Value::Make(instr.imm_u64); break;
+    case O::F32Const: *tos = Value::Make(instr.imm_f32); break;
+    case O::F64Const: *tos = Value::Make(instr.imm_f64); break;
+    case O::LocalGet: *tos = Pick(instr.imm_u32); break;
+
+    case O::LocalTee: {
+      Value value = (instr.tos_state & Istream::kTosIn) ? *tos : Pop();
+      Pick(instr.imm_u32 - 1) = value;
+      SetTosResult(value, instr, tos);
+      break;
+    }
+
+    // These only get kTosIn.
+    case O::LocalSet: Pick(instr.imm_u32 - 1) = *tos; break;
+    case O::Drop: break;
+    case O::InterpBrUnless:
+      if (!tos->Get<u32>()) {
+        frames_.back().offset = instr.imm_u32;
+      }
+      break;
+
+    case O::I32Eqz:        return DoTosUnop(IntEqz<u32>, instr, tos);
+    case O::I32Clz:        return DoTosUnop(IntClz<u32>, instr, tos);
+    case O::I32Ctz:        return DoTosUnop(IntCtz<u32>, instr, tos);
+    case O::I32Popcnt:     return DoTosUnop(IntPopcnt<u32>, instr, tos);
+    case O::I32Extend8S:   return DoTosUnop(IntExtend<u32, 7>, instr, tos);
+    case O::I32Extend16S:  return DoTosUnop(IntExtend<u32, 15>, instr, tos);
+    case O::I32WrapI64:    return DoTosUnop(Convert<u32, u64>, instr, tos);
+    case O::I64Eqz:        return DoTosUnop(IntEqz<u64>, instr, tos);
+    case O::I64Clz:        return DoTosUnop(IntClz<u64>, instr, tos);
+    case O::I64Ctz:        return DoTosUnop(IntCtz<u64>, instr, tos);
+    case O::I64Popcnt:     return DoTosUnop(IntPopcnt<u64>, instr, tos);
+    case O::I64Extend8S:   return DoTosUnop(IntExtend<u64, 7>, instr, tos);
+    case O::I64Extend16S:  return DoTosUnop(IntExtend<u64, 15>, instr, tos);
+    case O::I64Extend32S:  return DoTosUnop(IntExtend<u64, 31>, instr, tos);
+    case O::I64ExtendI32S: return DoTosUnop(Convert<s64, s32>, instr, tos);
+    case O::I64ExtendI32U: return DoTosUnop(Convert<u64, u32>, instr, tos);
+
+    case O::I32Add:  return DoTosBinop(Add<u32>, instr, tos);
+    case O::I32Sub:  return DoTosBinop(Sub<u32>, instr, tos);
+    case O::I32Mul:  return DoTosBinop(Mul<u32>, instr, tos);
+    case O::I32And:  return DoTosBinop(IntAnd<u32>, instr, tos);
+    case O::I32Or:   return DoTosBinop(IntOr<u32>, instr, tos);
+    case O::I32Xor:  return DoTosBinop(IntXor<u32>, instr, tos);
+    case O::I32Shl:  return DoTosBinop(IntShl<u32>, instr, tos);
+    case O::I32ShrS: return DoTosBinop(IntShr<s32>, instr, tos);
+    case O::I32ShrU: return DoTosBinop(IntShr<u32>, instr, tos);
+    case O::I32Rotl: return DoTosBinop(IntRotl<u32>, instr, tos);
+    case O::I32Rotr: return DoTosBinop(IntRotr<u32>, instr, tos);
+    case O::I32Eq:   return DoTosBinop(Eq<u32>, instr, tos);
+    case O::I32Ne:   return DoTosBinop(Ne<u32>, instr, tos);
+    case O::I32LtS:  return DoTosBinop(Lt<s32>, instr, tos);
+    case O::I32LtU:  return DoTosBinop(Lt<u32>, instr, tos);
+    case O::I32LeS:  return DoTosBinop(Le<s32>, instr, tos);
+    case O::I32LeU:  return DoTosBinop(Le<u32>, instr, tos);
+    case O::I32GtS:  return DoTosBinop(Gt<s32>, instr, tos);
+    case O::I32GtU:  return DoTosBinop(Gt<u32>, instr, tos);
+    case O::I32GeS:  return DoTosBinop(Ge<s32>, instr, tos);
+    case O::I32GeU:  return DoTosBinop(Ge<u32>, instr, tos);
+
+    case O::I64Add:  return DoTosBinop(Add<u64>, instr, tos);
+    case O::I64Sub:  return DoTosBinop(Sub<u64>, instr, tos);
+    case O::I64Mul:  return DoTosBinop(Mul<u64>, instr, tos);
+    case O::I64And:  return DoTosBinop(IntAnd<u64>, instr, tos);
+    case O::I64Or:   return DoTosBinop(IntOr<u64>, instr, tos);
+    case O::I64Xor:  return DoTosBinop(IntXor<u64>, instr, tos);
+    case O::I64Shl:  return DoTosBinop(IntShl<u64>, instr, tos);
+    case O::I64ShrS: return DoTosBinop(IntShr<s64>, instr, tos);
+    case O::I64ShrU: return DoTosBinop(IntShr<u64>, instr, tos);
+    case O::I64Rotl: return DoTosBinop(IntRotl<u64>, instr, tos);
+    case O::I64Rotr: return DoTosBinop(IntRotr<u64>, instr, tos);
+    case O::I64Eq:   return DoTosBinop(Eq<u64>, instr, tos);
+    case O::I64Ne:   return DoTosBinop(Ne<u64>, instr, tos);
+    case O::I64LtS:  return DoTosBinop(Lt<s64>, instr, tos);
+    case O::I64LtU:  return DoTosBinop(Lt<u64>, instr, tos);
+    case O::I64LeS:  return DoTosBinop(Le<s64>, instr, tos);
+    case O::I64LeU:  return DoTosBinop(Le<u64>, instr, tos);
+    case O::I64GtS:  return DoTosBinop(Gt<s64>, instr, tos);
+    case O::I64GtU:  return DoTosBinop(Gt<u64>, instr, tos);
+    case O::I64GeS:  return DoTosBinop(Ge<s64>, instr, tos);
+    case O::I64GeU:  return DoTosBinop(Ge<u64>, instr, tos);
+
+    default:
+      WABT_UNREACHABLE;
+  }
+  // clang-format on
+}
+
+RunResult Thread::StepInternal(Trap::Ptr* out_trap) {
   u32& pc = frames_.back().offset;
   auto& istream = mod_->desc().istream;
 
@@ -1176,18 +1976,37 @@ RunResult Thread::StepInternal(Trap::Ptr* out_trap) {
     istream.Trace(trace_stream_, pc, trace_source_.get());
   }
 
-  // clang-format off
   auto instr = istream.Read(&pc);
+  if (WABT_UNLIKELY(instr.tos_state)) {
+    tos_hit_count_ += instr.tos_state & Istream::kTosIn;
+    StepTos(instr, &tos_);
+    return RunResult::Ok;
+  }
+  return Execute(instr, out_trap);
+}
+
+RunResult Thread::Execute(Instr instr, Trap::Ptr* out_trap) {
+  using O = Opcode;
+
+  u32& pc = frames_.back().offset;
+
+  // clang-format off
   switch (instr.op) {
     case O::Unreachable:
       return TRAP("unreachable executed");
 
     case O::Br:
+      if (WABT_UNLIKELY(tier_up_) && instr.imm_u32 < pc) {
+        CountBackEdge();
+      }
       pc = instr.imm_u32;
       break;
 
     case O::BrIf:
       if (Pop<u32>()) {
+        if (WABT_UNLIKELY(tier_up_) && instr.imm_u32 < pc) {
+          CountBackEdge();
+        }
         pc = instr.imm_u32;
       }
       break;
@@ -1207,6 +2026,12 @@ RunResult Thread::StepInternal(Trap::Ptr* out_trap) {
     case O::Call: {
       Ref new_func_ref = inst_->funcs()[instr.imm_u32];
       DefinedFunc::Ptr new_func{store_, new_func_ref};
+      if (WABT_UNLIKELY(tier_up_)) {
+        if (new_func->native_.load(std::memory_order_acquire)) {
+          return DoNativeCall(*new_func, out_trap);
+        }
+        CountCall(*new_func);
+      }
       if (PushCall(new_func_ref, new_func->desc().code_offset, out_trap) ==
           RunResult::Trap) {
         return RunResult::Trap;
@@ -1223,9 +2048,10 @@ RunResult Thread::StepInternal(Trap::Ptr* out_trap) {
       auto new_func_ref = table->elements()[entry];
       TRAP_IF(new_func_ref == Ref::Null, "uninitialized table element");
       Func::Ptr new_func{store_, new_func_ref};
-      TRAP_IF(
-          Failed(Match(new_func->type(), func_type, nullptr)),
-          "indirect call signature mismatch");  // TODO: don't use "signature"
+      assert(func_type.id != kInvalidIndex &&
+             new_func->type().id != kInvalidIndex);
+      TRAP_IF(new_func->type().id != func_type.id,
+              "indirect call signature mismatch");  // TODO: don't use "signature"
       if (instr.op == O::ReturnCallIndirect) {
         return DoReturnCall(new_func, out_trap);
       } else {
@@ -1261,6 +2087,10 @@ RunResult Thread::StepInternal(Trap::Ptr* out_trap) {
       Pick(instr.imm_u32) = Pick(1);
       break;
 
+    case O::InterpLocalCopy:
+      Pick(instr.imm_u32x2.snd) = Pick(instr.imm_u32x2.fst);
+      break;
+
     case O::GlobalGet: {
       // TODO: need to mark whether this is a ref.
       Global::Ptr global{store_, inst_->globals()[instr.imm_u32]};
@@ -1299,6 +2129,119 @@ RunResult Thread::StepInternal(Trap::Ptr* out_trap) {
     case O::I64Store16: return DoStore<u64, u16>(instr, out_trap);
     case O::I64Store32: return DoStore<u64, u32>(instr, out_trap);
 
+    // Loads and stores of memory 0, whose address type is known.
+    case O::InterpI32LoadM32: return DoLoad<u32, u32, u32>(instr, out_trap);
+    case O::InterpI64LoadM32: return DoLoad<u64, u64, u32>(instr, out_trap);
+    case O::InterpF32LoadM32: return DoLoad<f32, f32, u32>(instr, out_trap);
+    case O::InterpF64LoadM32: return DoLoad<f64, f64, u32>(instr, out_trap);
+    case O::InterpI32Load8SM32: return DoLoad<s32, s8, u32>(instr, out_trap);
+    case O::InterpI32Load8UM32: return DoLoad<u32, u8, u32>(instr, out_trap);
+    case O::InterpI32Load16SM32: return DoLoad<s32, s16, u32>(instr, out_trap);
+    case O::InterpI32Load16UM32: return DoLoad<u32, u16, u32>(instr, out_trap);
+    case O::InterpI64Load8SM32: return DoLoad<s64, s8, u32>(instr, out_trap);
+    case O::InterpI64Load8UM32: return DoLoad<u64, u8, u32>(instr, out_trap);
+    case O::InterpI64Load16SM32: return DoLoad<s64, s16, u32>(instr, out_trap);
+    case O::InterpI64Load16UM32: return DoLoad<u64, u16, u32>(instr, out_trap);
+    case O::InterpI64Load32SM32: return DoLoad<s64, s32, u32>(instr, out_trap);
+    case O::InterpI64Load32UM32: return DoLoad<u64, u32, u32>(instr, out_trap);
+
+    case O::InterpI32StoreM32: return DoStore<u32, u32, u32>(instr, out_trap);
+    case O::InterpI64StoreM32: return DoStore<u64, u64, u32>(instr, out_trap);
+    case O::InterpF32StoreM32: return DoStore<f32, f32, u32>(instr, out_trap);
+    case O::InterpF64StoreM32: return DoStore<f64, f64, u32>(instr, out_trap);
+    case O::InterpI32Store8M32: return DoStore<u32, u8, u32>(instr, out_trap);
+    case O::InterpI32Store16M32: return DoStore<u32, u16, u32>(instr, out_trap);
+    case O::InterpI64Store8M32: return DoStore<u64, u8, u32>(instr, out_trap);
+    case O::InterpI64Store16M32: return DoStore<u64, u16, u32>(instr, out_trap);
+    case O::InterpI64Store32M32: return DoStore<u64, u32, u32>(instr, out_trap);
+
+    case O::InterpI32LoadM64: return DoLoad<u32, u32, u64>(instr, out_trap);
+    case O::InterpI64LoadM64: return DoLoad<u64, u64, u64>(instr, out_trap);
+    case O::InterpF32LoadM64: return DoLoad<f32, f32, u64>(instr, out_trap);
+    case O::InterpF64LoadM64: return DoLoad<f64, f64, u64>(instr, out_trap);
+    case O::InterpI32Load8SM64: return DoLoad<s32, s8, u64>(instr, out_trap);
+    case O::InterpI32Load8UM64: return DoLoad<u32, u8, u64>(instr, out_trap);
+    case O::InterpI32Load16SM64: return DoLoad<s32, s16, u64>(instr, out_trap);
+    case O::InterpI32Load16UM64: return DoLoad<u32, u16, u64>(instr, out_trap);
+    case O::InterpI64Load8SM64: return DoLoad<s64, s8, u64>(instr, out_trap);
+    case O::InterpI64Load8UM64: return DoLoad<u64, u8, u64>(instr, out_trap);
+    case O::InterpI64Load16SM64: return DoLoad<s64, s16, u64>(instr, out_trap);
+    case O::InterpI64Load16UM64: return DoLoad<u64, u16, u64>(instr, out_trap);
+    case O::InterpI64Load32SM64: return DoLoad<s64, s32, u64>(instr, out_trap);
+    case O::InterpI64Load32UM64: return DoLoad<u64, u32, u64>(instr, out_trap);
+
+    case O::InterpI32StoreM64: return DoStore<u32, u32, u64>(instr, out_trap);
+    case O::InterpI64StoreM64: return DoStore<u64, u64, u64>(instr, out_trap);
+    case O::InterpF32StoreM64: return DoStore<f32, f32, u64>(instr, out_trap);
+    case O::InterpF64StoreM64: return DoStore<f64, f64, u64>(instr, out_trap);
+    case O::InterpI32Store8M64: return DoStore<u32, u8, u64>(instr, out_trap);
+    case O::InterpI32Store16M64: return DoStore<u32, u16, u64>(instr, out_trap);
+    case O::InterpI64Store8M64: return DoStore<u64, u8, u64>(instr, out_trap);
+    case O::InterpI64Store16M64: return DoStore<u64, u16, u64>(instr, out_trap);
+    case O::InterpI64Store32M64: return DoStore<u64, u32, u64>(instr, out_trap);
+
+    case O::InterpV128LoadM32: return DoLoad<v128, v128, u32>(instr, out_trap);
+    case O::InterpV128StoreM32:
+      return DoStore<v128, v128, u32>(instr, out_trap);
+
+    case O::InterpV128Load8X8SM32:
+      return DoSimdLoadExtend<s16x8, s8x8, u32>(instr, out_trap);
+    case O::InterpV128Load8X8UM32:
+      return DoSimdLoadExtend<u16x8, u8x8, u32>(instr, out_trap);
+    case O::InterpV128Load16X4SM32:
+      return DoSimdLoadExtend<s32x4, s16x4, u32>(instr, out_trap);
+    case O::InterpV128Load16X4UM32:
+      return DoSimdLoadExtend<u32x4, u16x4, u32>(instr, out_trap);
+    case O::InterpV128Load32X2SM32:
+      return DoSimdLoadExtend<s64x2, s32x2, u32>(instr, out_trap);
+    case O::InterpV128Load32X2UM32:
+      return DoSimdLoadExtend<u64x2, u32x2, u32>(instr, out_trap);
+
+    case O::InterpV128Load8SplatM32:
+      return DoSimdLoadSplat<u8x16, u32>(instr, out_trap);
+    case O::InterpV128Load16SplatM32:
+      return DoSimdLoadSplat<u16x8, u32>(instr, out_trap);
+    case O::InterpV128Load32SplatM32:
+      return DoSimdLoadSplat<u32x4, u32>(instr, out_trap);
+    case O::InterpV128Load64SplatM32:
+      return DoSimdLoadSplat<u64x2, u32>(instr, out_trap);
+
+    case O::InterpV128Load32ZeroM32:
+      return DoSimdLoadZero<u32x4, u32, u32>(instr, out_trap);
+    case O::InterpV128Load64ZeroM32:
+      return DoSimdLoadZero<u64x2, u64, u32>(instr, out_trap);
+
+    case O::InterpV128LoadM64: return DoLoad<v128, v128, u64>(instr, out_trap);
+    case O::InterpV128StoreM64:
+      return DoStore<v128, v128, u64>(instr, out_trap);
+
+    case O::InterpV128Load8X8SM64:
+      return DoSimdLoadExtend<s16x8, s8x8, u64>(instr, out_trap);
+    case O::InterpV128Load8X8UM64:
+      return DoSimdLoadExtend<u16x8, u8x8, u64>(instr, out_trap);
+    case O::InterpV128Load16X4SM64:
+      return DoSimdLoadExtend<s32x4, s16x4, u64>(instr, out_trap);
+    case O::InterpV128Load16X4UM64:
+      return DoSimdLoadExtend<u32x4, u16x4, u64>(instr, out_trap);
+    case O::InterpV128Load32X2SM64:
+      return DoSimdLoadExtend<s64x2, s32x2, u64>(instr, out_trap);
+    case O::InterpV128Load32X2UM64:
+      return DoSimdLoadExtend<u64x2, u32x2, u64>(instr, out_trap);
+
+    case O::InterpV128Load8SplatM64:
+      return DoSimdLoadSplat<u8x16, u64>(instr, out_trap);
+    case O::InterpV128Load16SplatM64:
+      return DoSimdLoadSplat<u16x8, u64>(instr, out_trap);
+    case O::InterpV128Load32SplatM64:
+      return DoSimdLoadSplat<u32x4, u64>(instr, out_trap);
+    case O::InterpV128Load64SplatM64:
+      return DoSimdLoadSplat<u64x2, u64>(instr, out_trap);
+
+    case O::InterpV128Load32ZeroM64:
+      return DoSimdLoadZero<u32x4, u32, u64>(instr, out_trap);
+    case O::InterpV128Load64ZeroM64:
+      return DoSimdLoadZero<u64x2, u64, u64>(instr, out_trap);
+
     case O::MemorySize: {
       Memory::Ptr memory{store_, inst_->memories()[instr.imm_u32]};
       PushPtr(memory, memory->PageSize());
@@ -1982,23 +2925,200 @@ RunResult Thread::DoCall(const Func::Ptr& func, Trap::Ptr* out_trap) {
 
     Values results(func_type.results.size());
     if (Failed(host_func->Call(*this, params, results, out_trap))) {
+      suspended_ = false;
       return RunResult::Trap;
     }
+    if (suspended_) {
+      // The host frame stays on the stack until Resume.
+      return RunResult::Suspend;
+    }
 
     PopCall();
     PushValues(func_type.results, results);
   } else {
-    if (PushCall(*cast<DefinedFunc>(func.get()), out_trap) == RunResult::Trap) {
+    auto* defined_func = cast<DefinedFunc>(func.get());
+    if (WABT_UNLIKELY(tier_up_)) {
+      if (defined_func->native_.load(std::memory_order_acquire)) {
+        return DoNativeCall(*defined_func, out_trap);
+      }
+      CountCall(*defined_func);
+    }
+    if (PushCall(*defined_func, out_trap) == RunResult::Trap) {
       return RunResult::Ok;
     }
   }
   return RunResult::Ok;
 }
 
-template <typename T>
+RunResult Thread::CallAsync(const Func::Ptr& func,
+                            const Values& params,
+                            Values& results,
+                            Trap::Ptr* out_trap) {
+  assert(!async_);
+  assert(params.size() == func->type().params.size());
+  async_ = true;
+  async_result_types_ = func->type().results;
+  async_frames_ = frames_.size();
+  async_values_ = values_.size();
+  async_exceptions_ = exceptions_.size();
+  PushValues(func->type().params, params);
+  size_t num_frames = frames_.size();
+  RunResult result = DoCall(func, out_trap);
+  if (result == RunResult::Ok && frames_.size() > num_frames) {
+    // A DefinedFunc's frame was pushed; host and native calls are done.
+    result = Run(out_trap);
+  } else if (result == RunResult::Ok) {
+    result = RunResult::Return;
+  }
+  return FinishAsync(result, results, out_trap);
+}
+
+RunResult Thread::Resume(const Values& host_results,
+                         Values& results,
+                         Trap::Ptr* out_trap) {
+  assert(suspended_);
+  suspended_ = false;
+  auto host_func = store_.UnsafeGet<HostFunc>(frames_.back().func);
+  auto& func_type = host_func->type();
+  assert(host_results.size() == func_type.results.size());
+  // Returns RunResult::Return if the host function was the one called by
+  // CallAsync, or was the target of a return_call from it.
+  RunResult result = PopCall();
+  PushValues(func_type.results, host_results);
+  if (result == RunResult::Ok) {
+    result = Run(out_trap);
+  }
+  return FinishAsync(result, results, out_trap);
+}
+
+RunResult Thread::ResumeWithTrap(Trap::Ptr trap, Trap::Ptr* out_trap) {
+  assert(suspended_);
+  suspended_ = false;
+  UnwindAsync();
+  async_ = false;
+  *out_trap = trap;
+  return RunResult::Trap;
+}
+
+Continuation::Ptr Thread::Capture() {
+  assert(suspended_);
+  auto cont = store_.Alloc<Continuation>(store_);
+  cont->frames_.assign(frames_.begin() + async_frames_, frames_.end());
+  for (Frame& frame : cont->frames_) {
+    frame.values -= async_values_;
+    frame.exceptions -= async_exceptions_;
+  }
+  cont->values_.assign(values_.begin() + async_values_, values_.end());
+  auto first_ref =
+      std::lower_bound(refs_.begin(), refs_.end(), async_values_);
+  for (auto iter = first_ref; iter != refs_.end(); ++iter) {
+    cont->refs_.push_back(*iter - async_values_);
+  }
+  cont->exceptions_.assign(exceptions_.begin() + async_exceptions_,
+                           exceptions_.end());
+  cont->result_types_ = std::move(async_result_types_);
+  UnwindAsync();
+  suspended_ = false;
+  async_ = false;
+  return cont;
+}
+
+RunResult Thread::Resume(const Continuation::Ptr& cont,
+                         const Values& host_results,
+                         Values& results,
+                         Trap::Ptr* out_trap) {
+  assert(!async_);
+  assert(!cont->empty());
+  TRAP_IF(!GrowCallStack(cont->frames_.size()), "call stack exhausted");
+  async_ = true;
+  suspended_ = true;
+  async_frames_ = frames_.size();
+  async_values_ = values_.size();
+  async_exceptions_ = exceptions_.size();
+  for (Frame frame : cont->frames_) {
+    frame.values += async_values_;
+    frame.exceptions += async_exceptions_;
+    frames_.push_back(frame);
+  }
+  values_.insert(values_.end(), cont->values_.begin(), cont->values_.end());
+  for (auto index : cont->refs_) {
+    refs_.push_back(index + async_values_);
+  }
+  exceptions_.insert(exceptions_.end(), cont->exceptions_.begin(),
+                     cont->exceptions_.end());
+  async_result_types_ = std::move(cont->result_types_);
+  // Release the memory; the continuation can't be resumed again.
+  cont->frames_ = {};
+  cont->values_ = {};
+  cont->refs_ = {};
+  cont->exceptions_ = {};
+  return Resume(host_results, results, out_trap);
+}
+
+Result Thread::Suspend() {
+  if (!async_ || sync_call_depth_ != 0) {
+    return Result::Error;
+  }
+  suspended_ = true;
+  return Result::Ok;
+}
+
+RunResult Thread::FinishAsync(RunResult result,
+                              Values& results,
+                              Trap::Ptr* out_trap) {
+  switch (result) {
+    case RunResult::Suspend:
+      return result;
+
+    case RunResult::Return:
+      PopValues(async_result_types_, &results);
+      break;
+
+    case RunResult::Exception:
+      // As in DefinedFunc::DoCall.
+      *out_trap = Trap::New(store_, "uncaught exception");
+      result = RunResult::Trap;
+      break;
+
+    case RunResult::Ok:
+    case RunResult::Trap:
+      break;
+  }
+  UnwindAsync();
+  async_ = false;
+  return result;
+}
+
+void Thread::UnwindAsync() {
+  frames_.erase(frames_.begin() + async_frames_, frames_.end());
+  values_.erase(values_.begin() + async_values_, values_.end());
+  // refs_ is sorted, since values are only pushed and popped at the top.
+  refs_.erase(std::lower_bound(refs_.begin(), refs_.end(), async_values_),
+              refs_.end());
+  exceptions_.erase(exceptions_.begin() + async_exceptions_,
+                    exceptions_.end());
+  if (!frames_.empty() && frames_.back().inst) {
+    inst_ = frames_.back().inst;
+    mod_ = frames_.back().mod;
+  }
+}
+
+template <typename A>
+Memory* Thread::PopAddress(Instr instr, u64* out_offset) {
+  if constexpr (std::is_void_v<A>) {
+    Memory::Ptr memory{store_, inst_->memories()[instr.imm_u32x2.fst]};
+    *out_offset = PopPtr(memory);
+    return memory.get();
+  } else {
+    *out_offset = Pop<A>();
+    return inst_->memory0();
+  }
+}
+
+template <typename T, typename A>
 RunResult Thread::Load(Instr instr, T* out, Trap::Ptr* out_trap) {
-  Memory::Ptr memory{store_, inst_->memories()[instr.imm_u32x2.fst]};
-  u64 offset = PopPtr(memory);
+  u64 offset;
+  Memory* memory = PopAddress<A>(instr, &offset);
   TRAP_IF(Failed(memory->Load(offset, instr.imm_u32x2.snd, out)),
           StringPrintf("out of bounds memory access: access at %" PRIu64
                        "+%" PRIzd " >= max value %" PRIu64,
@@ -2007,21 +3127,21 @@ RunResult Thread::Load(Instr instr, T* out, Trap::Ptr* out_trap) {
   return RunResult::Ok;
 }
 
-template <typename T, typename V>
+template <typename T, typename V, typename A>
 RunResult Thread::DoLoad(Instr instr, Trap::Ptr* out_trap) {
   V val;
-  if (Load<V>(instr, &val, out_trap) != RunResult::Ok) {
+  if (Load<V, A>(instr, &val, out_trap) != RunResult::Ok) {
     return RunResult::Trap;
   }
   Push(static_cast<T>(val));
   return RunResult::Ok;
 }
 
-template <typename T, typename V>
+template <typename T, typename V, typename A>
 RunResult Thread::DoStore(Instr instr, Trap::Ptr* out_trap) {
-  Memory::Ptr memory{store_, inst_->memories()[instr.imm_u32x2.fst]};
   V val = static_cast<V>(Pop<T>());
-  u64 offset = PopPtr(memory);
+  u64 offset;
+  Memory* memory = PopAddress<A>(instr, &offset);
   TRAP_IF(Failed(memory->Store(offset, instr.imm_u32x2.snd, val)),
           StringPrintf("out of bounds memory access: access at %" PRIu64
                        "+%" PRIzd " >= max value %" PRIu64,
@@ -2327,11 +3447,11 @@ RunResult Thread::DoSimdShift(BinopFunc<R, T> f) {
   return RunResult::Ok;
 }
 
-template <typename S>
+template <typename S, typename A>
 RunResult Thread::DoSimdLoadSplat(Instr instr, Trap::Ptr* out_trap) {
   using L = typename S::LaneType;
   L val;
-  if (Load<L>(instr, &val, out_trap) != RunResult::Ok) {
+  if (Load<L, A>(instr, &val, out_trap) != RunResult::Ok) {
     return RunResult::Trap;
   }
   S result;
@@ -2368,11 +3488,11 @@ RunResult Thread::DoSimdStoreLane(Instr instr, Trap::Ptr* out_trap) {
   return RunResult::Ok;
 }
 
-template <typename S, typename T>
+template <typename S, typename T, typename A>
 RunResult Thread::DoSimdLoadZero(Instr instr, Trap::Ptr* out_trap) {
   using L = typename S::LaneType;
   L val;
-  if (Load<L>(instr, &val, out_trap) != RunResult::Ok) {
+  if (Load<L, A>(instr, &val, out_trap) != RunResult::Ok) {
     return RunResult::Trap;
   }
   S result;
@@ -2450,10 +3570,10 @@ RunResult Thread::DoSimdExtmul() {
   return RunResult::Ok;
 }
 
-template <typename S, typename T>
+template <typename S, typename T, typename A>
 RunResult Thread::DoSimdLoadExtend(Instr instr, Trap::Ptr* out_trap) {
   T val;
-  if (Load<T>(instr, &val, out_trap) != RunResult::Ok) {
+  if (Load<T, A>(instr, &val, out_trap) != RunResult::Ok) {
     return RunResult::Trap;
   }
   S result;
@@ -2691,7 +3811,12 @@ std::string Thread::TraceSource::Header(Istream::Offset offset) {
 }
 
 std::string Thread::TraceSource::Pick(Index index, Instr instr) {
-  Value val = thread_->Pick(index);
+  // With kTosIn, the top of the stack is in the TOS register.
+  Index depth = index;
+  if (instr.tos_state & Istream::kTosIn) {
+    --depth;
+  }
+  Value val = depth == 0 ? thread_->tos_ : thread_->Pick(depth);
   const char* reftype;
   // Estimate number of operands.
   // TODO: Instead, record this accurately in opcode.def.
@@ -2713,7 +3838,10 @@ std::string Thread::TraceSource::Pick(Index index, Instr instr) {
     switch (instr.op) {
       case Opcode::GlobalSet: type = GetGlobalType(instr.imm_u32); break;
       case Opcode::LocalSet:
-      case Opcode::LocalTee:  type = GetLocalType(instr.imm_u32); break;
+      case Opcode::LocalTee:
+        // Local indexes count the TOS register too.
+        type = GetLocalType(instr.imm_u32 - (index - depth));
+        break;
       case Opcode::TableSet:
       case Opcode::TableGrow:
       case Opcode::TableFill: type = GetTableElementType(instr.imm_u32); break;
@@ -0,0 +1,626 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/interp/istream-cache.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if COMPILER_IS_MSVC
+#include <direct.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "wabt/mapped-file.h"
+#include "wabt/sha256.h"
+#include "wabt/stream.h"
+
+namespace wabt {
+namespace interp {
+
+namespace {
+
+// Bump this whenever the entry format below changes.
+const u32 kFormatVersion = 2;
+
+// The SHA-256 of the rest of the entry follows the version stamp.
+const size_t kDigestSize = 32;
+
+// The version stamp at the start of each entry. Besides the format version,
+// it includes wabt's version and the number of opcodes, since the istream
+// stores Opcode::Enum values directly.
+std::string GetVersionStamp() {
+  return StringPrintf("wabt-istream-cache %u %s %u\n", kFormatVersion,
+                      WABT_VERSION_STRING, static_cast<u32>(Opcode::Invalid));
+}
+
+class Writer {
+ public:
+  explicit Writer(std::vector<u8>* out) : out_(*out) {}
+
+  void WriteModule(const ModuleDesc&);
+
+ private:
+  void WriteU8(u8 value) { out_.push_back(value); }
+  void WriteU32(u32 value) { WriteBytes(&value, sizeof(value)); }
+  void WriteU64(u64 value) { WriteBytes(&value, sizeof(value)); }
+  void WriteBytes(const void* data, size_t size) {
+    const u8* p = static_cast<const u8*>(data);
+    out_.insert(out_.end(), p, p + size);
+  }
+  void WriteString(std::string_view s) {
+    WriteU32(s.size());
+    WriteBytes(s.data(), s.size());
+  }
+  void WriteType(ValueType);
+  void WriteTypes(const ValueTypes&);
+  void WriteLimits(const Limits&);
+  void WriteExternType(const ExternType&);
+  void WriteInitExpr(const InitExpr&);
+  void WriteFunc(const FuncDesc&);
+
+  std::vector<u8>& out_;
+};
+
+void Writer::WriteType(ValueType type) {
+  WriteU32(static_cast<u32>(static_cast<Type::Enum>(type)));
+  if (type.IsReferenceWithIndex()) {
+    WriteU32(type.GetReferenceIndex());
+  }
+}
+
+void Writer::WriteTypes(const ValueTypes& types) {
+  WriteU32(types.size());
+  for (ValueType type : types) {
+    WriteType(type);
+  }
+}
+
+void Writer::WriteLimits(const Limits& limits) {
+  WriteU64(limits.initial);
+  WriteU64(limits.max);
+  WriteU8(limits.has_max);
+  WriteU8(limits.is_shared);
+  WriteU8(limits.is_64);
+}
+
+void Writer::WriteExternType(const ExternType& type) {
+  WriteU8(static_cast<u8>(type.kind));
+  switch (type.kind) {
+    case ExternKind::Func: {
+      auto* func_type = cast<FuncType>(&type);
+      WriteTypes(func_type->params);
+      WriteTypes(func_type->results);
+      break;
+    }
+
+    case ExternKind::Table: {
+      auto* table_type = cast<TableType>(&type);
+      WriteType(table_type->element);
+      WriteLimits(table_type->limits);
+      break;
+    }
+
+    case ExternKind::Memory:
+      WriteLimits(cast<MemoryType>(&type)->limits);
+      break;
+
+    case ExternKind::Global: {
+      auto* global_type = cast<GlobalType>(&type);
+      WriteType(global_type->type);
+      WriteU8(static_cast<u8>(global_type->mut));
+      break;
+    }
+
+    case ExternKind::Tag: {
+      auto* tag_type = cast<TagType>(&type);
+      WriteU8(static_cast<u8>(tag_type->attr));
+      WriteTypes(tag_type->signature);
+      break;
+    }
+  }
+}
+
+void Writer::WriteInitExpr(const InitExpr& init) {
+  WriteU32(init.instrs.size());
+  for (const InitExpr::Instr& instr : init.instrs) {
+    WriteU32(static_cast<u32>(static_cast<Opcode::Enum>(instr.op)));
+    WriteBytes(&instr.imm, sizeof(instr.imm));
+  }
+}
+
+void Writer::WriteFunc(const FuncDesc& func) {
+  WriteExternType(func.type);
+  WriteU32(func.locals.size());
+  for (const LocalDesc& local : func.locals) {
+    WriteType(local.type);
+    WriteU32(local.count);
+    WriteU32(local.end);
+  }
+  WriteU32(func.code_offset);
+  WriteU32(func.handlers.size());
+  for (const HandlerDesc& handler : func.handlers) {
+    WriteU8(static_cast<u8>(handler.kind));
+    WriteU32(handler.try_start_offset);
+    WriteU32(handler.try_end_offset);
+    WriteU32(handler.catches.size());
+    for (const CatchDesc& catch_ : handler.catches) {
+      WriteU32(catch_.tag_index);
+      WriteU32(catch_.offset);
+    }
+    // Also delegate_handler_index.
+    WriteU32(handler.catch_all_offset);
+    WriteU32(handler.values);
+    WriteU32(handler.exceptions);
+  }
+}
+
+void Writer::WriteModule(const ModuleDesc& desc) {
+  WriteU32(desc.func_types.size());
+  for (const FuncType& func_type : desc.func_types) {
+    WriteExternType(func_type);
+  }
+  WriteU32(desc.imports.size());
+  for (const ImportDesc& import : desc.imports) {
+    WriteString(import.type.module);
+    WriteString(import.type.name);
+    WriteExternType(*import.type.type);
+  }
+  WriteU32(desc.funcs.size());
+  for (const FuncDesc& func : desc.funcs) {
+    WriteFunc(func);
+  }
+  WriteU32(desc.tables.size());
+  for (const TableDesc& table : desc.tables) {
+    WriteExternType(table.type);
+  }
+  WriteU32(desc.memories.size());
+  for (const MemoryDesc& memory : desc.memories) {
+    WriteExternType(memory.type);
+  }
+  WriteU32(desc.globals.size());
+  for (const GlobalDesc& global : desc.globals) {
+    WriteExternType(global.type);
+    WriteInitExpr(global.init);
+  }
+  WriteU32(desc.tags.size());
+  for (const TagDesc& tag : desc.tags) {
+    WriteExternType(tag.type);
+  }
+  WriteU32(desc.exports.size());
+  for (const ExportDesc& export_ : desc.exports) {
+    WriteString(export_.type.name);
+    WriteExternType(*export_.type.type);
+    WriteU32(export_.index);
+  }
+  WriteU32(desc.starts.size());
+  for (const StartDesc& start : desc.starts) {
+    WriteU32(start.func_index);
+  }
+  WriteU32(desc.elems.size());
+  for (const ElemDesc& elem : desc.elems) {
+    WriteU32(elem.elements.size());
+    for (const InitExpr& element : elem.elements) {
+      WriteInitExpr(element);
+    }
+    WriteType(elem.type);
+    WriteU8(static_cast<u8>(elem.mode));
+    WriteU32(elem.table_index);
+    WriteInitExpr(elem.offset);
+  }
+  WriteU32(desc.datas.size());
+  for (const DataDesc& data : desc.datas) {
+    WriteU32(data.data.size());
+    WriteBytes(data.data.data(), data.data.size());
+    WriteU8(static_cast<u8>(data.mode));
+    WriteU32(data.memory_index);
+    WriteInitExpr(data.offset);
+  }
+  Buffer istream = desc.istream.Slice(0, desc.istream.end());
+  WriteU32(istream.size());
+  WriteBytes(istream.data(), istream.size());
+}
+
+// Reads what Writer wrote. Any read past the end of the data sets |ok_| to
+// false and returns zeroes, so callers only need to check it once at the end,
+// as long as they don't trust counts before then.
+// Stand-ins for types that couldn't be read. The entry is rejected anyway.
+FuncType Placeholder(FuncType*) {
+  return FuncType({}, {});
+}
+TableType Placeholder(TableType*) {
+  return TableType(ValueType::FuncRef, Limits());
+}
+MemoryType Placeholder(MemoryType*) {
+  return MemoryType(Limits());
+}
+GlobalType Placeholder(GlobalType*) {
+  return GlobalType(ValueType::I32, Mutability::Const);
+}
+TagType Placeholder(TagType*) {
+  return TagType(TagAttr::Exception, {});
+}
+
+class Reader {
+ public:
+  Reader(const u8* data, size_t size) : p_(data), end_(data + size) {}
+
+  Result ReadModule(ModuleDesc*);
+
+ private:
+  u8 ReadU8() {
+    u8 value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+  }
+  u32 ReadU32() {
+    u32 value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+  }
+  u64 ReadU64() {
+    u64 value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+  }
+  void ReadBytes(void* out, size_t size) {
+    if (ok_ && static_cast<size_t>(end_ - p_) >= size) {
+      memcpy(out, p_, size);
+      p_ += size;
+    } else {
+      ok_ = false;
+      memset(out, 0, size);
+    }
+  }
+  // Reads a count of items that each take at least |min_item_size| bytes, so
+  // a corrupt count can't cause a huge allocation.
+  u32 ReadCount(size_t min_item_size = 1) {
+    u32 count = ReadU32();
+    if (static_cast<size_t>(end_ - p_) / min_item_size < count) {
+      ok_ = false;
+      return 0;
+    }
+    return count;
+  }
+  std::string ReadString() {
+    u32 size = ReadCount();
+    std::string s(reinterpret_cast<const char*>(p_), size);
+    p_ += size;
+    return s;
+  }
+  ValueType ReadType();
+  ValueTypes ReadTypes();
+  Limits ReadLimits();
+  std::unique_ptr<ExternType> ReadExternType();
+  template <typename T>
+  T ReadExternTypeAs();
+  InitExpr ReadInitExpr();
+  FuncDesc ReadFunc();
+
+  const u8* p_;
+  const u8* end_;
+  bool ok_ = true;
+};
+
+ValueType Reader::ReadType() {
+  auto type = static_cast<Type::Enum>(ReadU32());
+  if (type == Type::Reference) {
+    return ValueType(type, ReadU32());
+  }
+  return ValueType(type);
+}
+
+ValueTypes Reader::ReadTypes() {
+  ValueTypes types(ReadCount(sizeof(u32)));
+  for (ValueType& type : types) {
+    type = ReadType();
+  }
+  return types;
+}
+
+Limits Reader::ReadLimits() {
+  Limits limits;
+  limits.initial = ReadU64();
+  limits.max = ReadU64();
+  limits.has_max = ReadU8();
+  limits.is_shared = ReadU8();
+  limits.is_64 = ReadU8();
+  return limits;
+}
+
+std::unique_ptr<ExternType> Reader::ReadExternType() {
+  auto kind = static_cast<ExternKind>(ReadU8());
+  switch (kind) {
+    case ExternKind::Func: {
+      ValueTypes params = ReadTypes();
+      ValueTypes results = ReadTypes();
+      return std::make_unique<FuncType>(std::move(params), std::move(results));
+    }
+
+    case ExternKind::Table: {
+      ValueType element = ReadType();
+      return std::make_unique<TableType>(element, ReadLimits());
+    }
+
+    case ExternKind::Memory:
+      return std::make_unique<MemoryType>(ReadLimits());
+
+    case ExternKind::Global: {
+      ValueType type = ReadType();
+      return std::make_unique<GlobalType>(type,
+                                          static_cast<Mutability>(ReadU8()));
+    }
+
+    case ExternKind::Tag: {
+      auto attr = static_cast<TagAttr>(ReadU8());
+      return std::make_unique<TagType>(attr, ReadTypes());
+    }
+  }
+  ok_ = false;
+  return Placeholder(static_cast<FuncType*>(nullptr)).Clone();
+}
+
+template <typename T>
+T Reader::ReadExternTypeAs() {
+  std::unique_ptr<ExternType> type = ReadExternType();
+  if (auto* result = dyn_cast<T>(type.get())) {
+    return *result;
+  }
+  ok_ = false;
+  return Placeholder(static_cast<T*>(nullptr));
+}
+
+InitExpr Reader::ReadInitExpr() {
+  InitExpr init;
+  init.instrs.resize(ReadCount(sizeof(u32) + sizeof(v128)));
+  for (InitExpr::Instr& instr : init.instrs) {
+    instr.op = static_cast<Opcode::Enum>(ReadU32());
+    ReadBytes(&instr.imm, sizeof(instr.imm));
+  }
+  return init;
+}
+
+FuncDesc Reader::ReadFunc() {
+  FuncDesc func{ReadExternTypeAs<FuncType>(), {}, 0, {}};
+  func.locals.resize(ReadCount(3 * sizeof(u32)));
+  for (LocalDesc& local : func.locals) {
+    local.type = ReadType();
+    local.count = ReadU32();
+    local.end = ReadU32();
+  }
+  func.code_offset = ReadU32();
+  func.handlers.resize(ReadCount(6 * sizeof(u32)));
+  for (HandlerDesc& handler : func.handlers) {
+    handler.kind = static_cast<HandlerKind>(ReadU8());
+    handler.try_start_offset = ReadU32();
+    handler.try_end_offset = ReadU32();
+    handler.catches.resize(ReadCount(2 * sizeof(u32)));
+    for (CatchDesc& catch_ : handler.catches) {
+      catch_.tag_index = ReadU32();
+      catch_.offset = ReadU32();
+    }
+    handler.catch_all_offset = ReadU32();
+    handler.values = ReadU32();
+    handler.exceptions = ReadU32();
+  }
+  return func;
+}
+
+Result Reader::ReadModule(ModuleDesc* desc) {
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    desc->func_types.push_back(ReadExternTypeAs<FuncType>());
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    std::string module = ReadString();
+    std::string name = ReadString();
+    desc->imports.push_back(ImportDesc{
+        ImportType(std::move(module), std::move(name), ReadExternType())});
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    desc->funcs.push_back(ReadFunc());
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    desc->tables.push_back(TableDesc{ReadExternTypeAs<TableType>()});
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    desc->memories.push_back(MemoryDesc{ReadExternTypeAs<MemoryType>()});
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    GlobalType type = ReadExternTypeAs<GlobalType>();
+    desc->globals.push_back(GlobalDesc{type, ReadInitExpr()});
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    desc->tags.push_back(TagDesc{ReadExternTypeAs<TagType>()});
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    std::string name = ReadString();
+    std::unique_ptr<ExternType> type = ReadExternType();
+    desc->exports.push_back(
+        ExportDesc{ExportType(std::move(name), std::move(type)), ReadU32()});
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    desc->starts.push_back(StartDesc{ReadU32()});
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    ElemDesc elem;
+    elem.elements.resize(ReadCount(sizeof(u32)));
+    for (InitExpr& element : elem.elements) {
+      element = ReadInitExpr();
+    }
+    elem.type = ReadType();
+    elem.mode = static_cast<SegmentMode>(ReadU8());
+    elem.table_index = ReadU32();
+    elem.offset = ReadInitExpr();
+    desc->elems.push_back(std::move(elem));
+  }
+  for (u32 i = 0, n = ReadCount(); i < n; ++i) {
+    DataDesc data;
+    data.data.resize(ReadCount());
+    ReadBytes(data.data.data(), data.data.size());
+    data.mode = static_cast<SegmentMode>(ReadU8());
+    data.memory_index = ReadU32();
+    data.offset = ReadInitExpr();
+    desc->datas.push_back(std::move(data));
+  }
+  u32 istream_size = ReadCount();
+  if (ok_) {
+    desc->istream.EmitBytes(p_, istream_size);
+    p_ += istream_size;
+  }
+  return ok_ && p_ == end_ ? Result::Ok : Result::Error;
+}
+
+}  // end anonymous namespace
+
+void SerializeModuleDesc(const ModuleDesc& desc, std::vector<u8>* out_data) {
+  Writer(out_data).WriteModule(desc);
+}
+
+Result DeserializeModuleDesc(const u8* data, size_t size, ModuleDesc* desc) {
+  return Reader(data, size).ReadModule(desc);
+}
+
+IstreamCache::IstreamCache(std::string dir) : dir_(std::move(dir)) {}
+
+// static
+std::string IstreamCache::GetKey(const void* data,
+                                 size_t size,
+                                 const Features& features,
+                                 const IstreamOptions& options) {
+  std::string input(static_cast<const char*>(data), size);
+#define WABT_FEATURE(variable, flag, default_, help) \
+  input += features.variable##_enabled() ? '1' : '0';
+#include "wabt/feature.def"
+#undef WABT_FEATURE
+  input += options.optimize ? '1' : '0';
+  input += options.cache_top_of_stack ? '1' : '0';
+
+  std::string digest;
+  sha256(input, digest);
+  std::string key;
+  for (char c : digest) {
+    key += StringPrintf("%02x", static_cast<u8>(c));
+  }
+  return key;
+}
+
+std::string IstreamCache::GetPath(std::string_view key) const {
+  std::string path = dir_;
+  if (!path.empty() && path.back() != '/') {
+    path += '/';
+  }
+  path += key;
+  return path;
+}
+
+Result IstreamCache::Load(std::string_view key, ModuleDesc* out_desc) const {
+  std::string path = GetPath(key);
+  struct stat statbuf;
+  if (stat(path.c_str(), &statbuf) != 0) {
+    return Result::Error;
+  }
+
+  MappedFile file;
+  CHECK_RESULT(file.Open(path));
+  std::string stamp = GetVersionStamp();
+  size_t header_size = stamp.size() + kDigestSize;
+  if (file.size() < header_size ||
+      memcmp(file.data(), stamp.data(), stamp.size()) != 0) {
+    return Result::Error;
+  }
+  // The istream is run without being validated again, so the whole payload
+  // has to match what was written.
+  const u8* payload = file.data() + header_size;
+  size_t payload_size = file.size() - header_size;
+  std::string digest;
+  sha256(std::string_view(reinterpret_cast<const char*>(payload), payload_size),
+         digest);
+  if (digest.size() != kDigestSize ||
+      memcmp(file.data() + stamp.size(), digest.data(), kDigestSize) != 0) {
+    return Result::Error;
+  }
+  if (Failed(DeserializeModuleDesc(payload, payload_size, out_desc))) {
+    *out_desc = ModuleDesc();
+    return Result::Error;
+  }
+  return Result::Ok;
+}
+
+Result IstreamCache::Save(std::string_view key, const ModuleDesc& desc) const {
+#if COMPILER_IS_MSVC
+  _mkdir(dir_.c_str());
+#else
+  mkdir(dir_.c_str(), 0700);
+#endif
+
+  std::vector<u8> payload;
+  SerializeModuleDesc(desc, &payload);
+  std::string digest;
+  sha256(std::string_view(reinterpret_cast<const char*>(payload.data()),
+                          payload.size()),
+         digest);
+  assert(digest.size() == kDigestSize);
+  std::string stamp = GetVersionStamp();
+  std::vector<u8> data(stamp.begin(), stamp.end());
+  data.insert(data.end(), digest.begin(), digest.end());
+  data.insert(data.end(), payload.begin(), payload.end());
+
+  // The temporary file gets a unique name, and is only readable by us.
+  std::string path = GetPath(key);
+  std::string temp_path = path + ".XXXXXX";
+#if COMPILER_IS_MSVC
+  if (_mktemp_s(&temp_path[0], temp_path.size() + 1) != 0) {
+    return Result::Error;
+  }
+  FILE* file = fopen(temp_path.c_str(), "wb");
+#else
+  int fd = mkstemp(&temp_path[0]);
+  FILE* file = fd == -1 ? nullptr : fdopen(fd, "wb");
+  if (fd != -1 && !file) {
+    close(fd);
+    remove(temp_path.c_str());
+  }
+#endif
+  if (!file) {
+    return Result::Error;
+  }
+  Result result;
+  {
+    FileStream stream(file);
+    stream.WriteData(data.data(), data.size());
+    result = stream.result();
+  }
+  if (fclose(file) != 0 || Failed(result)) {
+    remove(temp_path.c_str());
+    return Result::Error;
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    remove(temp_path.c_str());
+    return Result::Error;
+  }
+  return Result::Ok;
+}
+
+}  // namespace interp
+}  // namespace wabt
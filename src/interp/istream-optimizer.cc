@@ -0,0 +1,831 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/interp/istream-optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <unordered_set>
+
+#include "wabt/interp/interp-math.h"
+
+namespace wabt {
+namespace interp {
+
+namespace {
+
+using O = Opcode;
+using Offset = Istream::Offset;
+
+// Each pass runs until nothing changes; folding usually settles in two rounds,
+// so this only guards against pathological inputs.
+const int kMaxRounds = 8;
+
+template <typename R, typename T>
+using UnopFunc = R WABT_VECTORCALL(T);
+template <typename R, typename T>
+using BinopFunc = R WABT_VECTORCALL(T, T);
+template <typename T>
+using BinopTrapFunc = RunResult WABT_VECTORCALL(T, T, T*, std::string*);
+
+// Constants are kept as the bits of their i32 or i64 value.
+u64 ToBits(bool val) { return val ? 1 : 0; }
+u64 ToBits(u32 val) { return val; }
+u64 ToBits(s32 val) { return static_cast<u32>(val); }
+u64 ToBits(u64 val) { return val; }
+u64 ToBits(s64 val) { return static_cast<u64>(val); }
+
+template <typename R, typename T>
+u64 Fold(UnopFunc<R, T> f, u64 val) {
+  return ToBits(f(static_cast<T>(val)));
+}
+
+template <typename R, typename T>
+u64 Fold(BinopFunc<R, T> f, u64 lhs, u64 rhs) {
+  return ToBits(f(static_cast<T>(lhs), static_cast<T>(rhs)));
+}
+
+template <typename T>
+bool FoldTrap(BinopTrapFunc<T> f, u64 lhs, u64 rhs, u64* out) {
+  T result;
+  std::string msg;
+  if (f(static_cast<T>(lhs), static_cast<T>(rhs), &result, &msg) !=
+      RunResult::Ok) {
+    return false;
+  }
+  *out = ToBits(result);
+  return true;
+}
+
+// Returns false if |op| isn't an integer unop, or can't be folded.
+bool FoldUnop(Opcode op, u64 val, u64* out) {
+  // clang-format off
+  switch (op) {
+    case O::I32Eqz:        *out = Fold(IntEqz<u32>, val); return true;
+    case O::I32Clz:        *out = Fold(IntClz<u32>, val); return true;
+    case O::I32Ctz:        *out = Fold(IntCtz<u32>, val); return true;
+    case O::I32Popcnt:     *out = Fold(IntPopcnt<u32>, val); return true;
+    case O::I32Extend8S:   *out = Fold(IntExtend<u32, 7>, val); return true;
+    case O::I32Extend16S:  *out = Fold(IntExtend<u32, 15>, val); return true;
+    case O::I32WrapI64:    *out = Fold(Convert<u32, u64>, val); return true;
+
+    case O::I64Eqz:        *out = Fold(IntEqz<u64>, val); return true;
+    case O::I64Clz:        *out = Fold(IntClz<u64>, val); return true;
+    case O::I64Ctz:        *out = Fold(IntCtz<u64>, val); return true;
+    case O::I64Popcnt:     *out = Fold(IntPopcnt<u64>, val); return true;
+    case O::I64Extend8S:   *out = Fold(IntExtend<u64, 7>, val); return true;
+    case O::I64Extend16S:  *out = Fold(IntExtend<u64, 15>, val); return true;
+    case O::I64Extend32S:  *out = Fold(IntExtend<u64, 31>, val); return true;
+    case O::I64ExtendI32S: *out = Fold(Convert<s64, s32>, val); return true;
+    case O::I64ExtendI32U: *out = Fold(Convert<u64, u32>, val); return true;
+
+    default: return false;
+  }
+  // clang-format on
+}
+
+// Returns false if |op| isn't an integer binop, or would trap.
+bool FoldBinop(Opcode op, u64 lhs, u64 rhs, u64* out) {
+  // clang-format off
+  switch (op) {
+    case O::I32Add:  *out = Fold(Add<u32>, lhs, rhs); return true;
+    case O::I32Sub:  *out = Fold(Sub<u32>, lhs, rhs); return true;
+    case O::I32Mul:  *out = Fold(Mul<u32>, lhs, rhs); return true;
+    case O::I32DivS: return FoldTrap(IntDiv<s32>, lhs, rhs, out);
+    case O::I32DivU: return FoldTrap(IntDiv<u32>, lhs, rhs, out);
+    case O::I32RemS: return FoldTrap(IntRem<s32>, lhs, rhs, out);
+    case O::I32RemU: return FoldTrap(IntRem<u32>, lhs, rhs, out);
+    case O::I32And:  *out = Fold(IntAnd<u32>, lhs, rhs); return true;
+    case O::I32Or:   *out = Fold(IntOr<u32>, lhs, rhs); return true;
+    case O::I32Xor:  *out = Fold(IntXor<u32>, lhs, rhs); return true;
+    case O::I32Shl:  *out = Fold(IntShl<u32>, lhs, rhs); return true;
+    case O::I32ShrS: *out = Fold(IntShr<s32>, lhs, rhs); return true;
+    case O::I32ShrU: *out = Fold(IntShr<u32>, lhs, rhs); return true;
+    case O::I32Rotl: *out = Fold(IntRotl<u32>, lhs, rhs); return true;
+    case O::I32Rotr: *out = Fold(IntRotr<u32>, lhs, rhs); return true;
+    case O::I32Eq:   *out = Fold(Eq<u32>, lhs, rhs); return true;
+    case O::I32Ne:   *out = Fold(Ne<u32>, lhs, rhs); return true;
+    case O::I32LtS:  *out = Fold(Lt<s32>, lhs, rhs); return true;
+    case O::I32LtU:  *out = Fold(Lt<u32>, lhs, rhs); return true;
+    case O::I32LeS:  *out = Fold(Le<s32>, lhs, rhs); return true;
+    case O::I32LeU:  *out = Fold(Le<u32>, lhs, rhs); return true;
+    case O::I32GtS:  *out = Fold(Gt<s32>, lhs, rhs); return true;
+    case O::I32GtU:  *out = Fold(Gt<u32>, lhs, rhs); return true;
+    case O::I32GeS:  *out = Fold(Ge<s32>, lhs, rhs); return true;
+    case O::I32GeU:  *out = Fold(Ge<u32>, lhs, rhs); return true;
+
+    case O::I64Add:  *out = Fold(Add<u64>, lhs, rhs); return true;
+    case O::I64Sub:  *out = Fold(Sub<u64>, lhs, rhs); return true;
+    case O::I64Mul:  *out = Fold(Mul<u64>, lhs, rhs); return true;
+    case O::I64DivS: return FoldTrap(IntDiv<s64>, lhs, rhs, out);
+    case O::I64DivU: return FoldTrap(IntDiv<u64>, lhs, rhs, out);
+    case O::I64RemS: return FoldTrap(IntRem<s64>, lhs, rhs, out);
+    case O::I64RemU: return FoldTrap(IntRem<u64>, lhs, rhs, out);
+    case O::I64And:  *out = Fold(IntAnd<u64>, lhs, rhs); return true;
+    case O::I64Or:   *out = Fold(IntOr<u64>, lhs, rhs); return true;
+    case O::I64Xor:  *out = Fold(IntXor<u64>, lhs, rhs); return true;
+    case O::I64Shl:  *out = Fold(IntShl<u64>, lhs, rhs); return true;
+    case O::I64ShrS: *out = Fold(IntShr<s64>, lhs, rhs); return true;
+    case O::I64ShrU: *out = Fold(IntShr<u64>, lhs, rhs); return true;
+    case O::I64Rotl: *out = Fold(IntRotl<u64>, lhs, rhs); return true;
+    case O::I64Rotr: *out = Fold(IntRotr<u64>, lhs, rhs); return true;
+    case O::I64Eq:   *out = Fold(Eq<u64>, lhs, rhs); return true;
+    case O::I64Ne:   *out = Fold(Ne<u64>, lhs, rhs); return true;
+    case O::I64LtS:  *out = Fold(Lt<s64>, lhs, rhs); return true;
+    case O::I64LtU:  *out = Fold(Lt<u64>, lhs, rhs); return true;
+    case O::I64LeS:  *out = Fold(Le<s64>, lhs, rhs); return true;
+    case O::I64LeU:  *out = Fold(Le<u64>, lhs, rhs); return true;
+    case O::I64GtS:  *out = Fold(Gt<s64>, lhs, rhs); return true;
+    case O::I64GtU:  *out = Fold(Gt<u64>, lhs, rhs); return true;
+    case O::I64GeS:  *out = Fold(Ge<s64>, lhs, rhs); return true;
+    case O::I64GeU:  *out = Fold(Ge<u64>, lhs, rhs); return true;
+
+    default: return false;
+  }
+  // clang-format on
+}
+
+bool IsConst(const Instr& instr, Type type) {
+  return (type == Type::I32 && instr.op == O::I32Const) ||
+         (type == Type::I64 && instr.op == O::I64Const);
+}
+
+u64 GetConstBits(const Instr& instr) {
+  return instr.op == O::I32Const ? instr.imm_u32 : instr.imm_u64;
+}
+
+Instr MakeConst(Type type, u64 bits) {
+  Instr instr;
+  if (type == Type::I32) {
+    instr.op = O::I32Const;
+    instr.kind = InstrKind::Imm_I32_Op_0;
+    instr.imm_u32 = static_cast<u32>(bits);
+  } else {
+    assert(type == Type::I64);
+    instr.op = O::I64Const;
+    instr.kind = InstrKind::Imm_I64_Op_0;
+    instr.imm_u64 = bits;
+  }
+  return instr;
+}
+
+Instr MakeInstr(Opcode op, InstrKind kind, u32 imm) {
+  Instr instr;
+  instr.op = op;
+  instr.kind = kind;
+  instr.imm_u32 = imm;
+  return instr;
+}
+
+Instr MakeInstr(Opcode op, u32 fst, u32 snd) {
+  Instr instr;
+  instr.op = op;
+  instr.kind = InstrKind::Imm_I32_I32_Op_0;
+  instr.imm_u32x2.fst = fst;
+  instr.imm_u32x2.snd = snd;
+  return instr;
+}
+
+// Instructions without side effects, that only push one value.
+bool IsPure(Opcode op) {
+  switch (op) {
+    case O::I32Const:
+    case O::I64Const:
+    case O::F32Const:
+    case O::F64Const:
+    case O::V128Const:
+    case O::LocalGet:
+    case O::GlobalGet:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsBranch(Opcode op) {
+  return op == O::Br || op == O::BrIf || op == O::InterpBrUnless;
+}
+
+// Instructions that never continue with the next one.
+bool IsUnconditional(Opcode op) {
+  switch (op) {
+    case O::Br:
+    case O::BrTable:
+    case O::Return:
+    case O::Unreachable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Gets the drop and keep counts if |instr| is a drop or drop_keep.
+bool GetDropKeep(const Instr& instr, u32* drop, u32* keep) {
+  if (instr.op == O::Drop) {
+    *drop = 1;
+    *keep = 0;
+    return true;
+  }
+  if (instr.op == O::InterpDropKeep) {
+    *drop = instr.imm_u32x2.fst;
+    *keep = instr.imm_u32x2.snd;
+    return true;
+  }
+  return false;
+}
+
+// How an instruction that supports top-of-stack caching uses the stack; see
+// Thread::StepTos, which must handle the same instructions.
+enum class TosKind {
+  None,
+  Push,     // Pushes one value.
+  Produce,  // Pops one or two values, and pushes one.
+  Consume,  // Pops one value.
+};
+
+TosKind GetTosKind(Opcode op) {
+  switch (op) {
+    case O::I32Const:
+    case O::I64Const:
+    case O::F32Const:
+    case O::F64Const:
+    case O::LocalGet:
+      return TosKind::Push;
+
+    case O::LocalTee:
+    case O::I32Eqz:
+    case O::I32Clz:
+    case O::I32Ctz:
+    case O::I32Popcnt:
+    case O::I32Extend8S:
+    case O::I32Extend16S:
+    case O::I32WrapI64:
+    case O::I64Eqz:
+    case O::I64Clz:
+    case O::I64Ctz:
+    case O::I64Popcnt:
+    case O::I64Extend8S:
+    case O::I64Extend16S:
+    case O::I64Extend32S:
+    case O::I64ExtendI32S:
+    case O::I64ExtendI32U:
+    case O::I32Add:
+    case O::I32Sub:
+    case O::I32Mul:
+    case O::I32And:
+    case O::I32Or:
+    case O::I32Xor:
+    case O::I32Shl:
+    case O::I32ShrS:
+    case O::I32ShrU:
+    case O::I32Rotl:
+    case O::I32Rotr:
+    case O::I32Eq:
+    case O::I32Ne:
+    case O::I32LtS:
+    case O::I32LtU:
+    case O::I32LeS:
+    case O::I32LeU:
+    case O::I32GtS:
+    case O::I32GtU:
+    case O::I32GeS:
+    case O::I32GeU:
+    case O::I64Add:
+    case O::I64Sub:
+    case O::I64Mul:
+    case O::I64And:
+    case O::I64Or:
+    case O::I64Xor:
+    case O::I64Shl:
+    case O::I64ShrS:
+    case O::I64ShrU:
+    case O::I64Rotl:
+    case O::I64Rotr:
+    case O::I64Eq:
+    case O::I64Ne:
+    case O::I64LtS:
+    case O::I64LtU:
+    case O::I64LeS:
+    case O::I64LeU:
+    case O::I64GtS:
+    case O::I64GtU:
+    case O::I64GeS:
+    case O::I64GeU:
+      return TosKind::Produce;
+
+    case O::LocalSet:
+    case O::Drop:
+    case O::InterpBrUnless:
+      return TosKind::Consume;
+
+    default:
+      return TosKind::None;
+  }
+}
+
+class FuncOptimizer {
+ public:
+  FuncOptimizer(Istream* istream, FuncDesc* func)
+      : istream_(istream),
+        func_(func),
+        begin_(func->code_offset),
+        end_(istream->end()) {}
+
+  bool Decode();
+  void Optimize();
+  void Emit(std::vector<std::pair<Offset, Offset>>* out_offsets);
+  void CacheTopOfStack();
+
+ private:
+  struct Node {
+    Instr instr;
+    Offset pc;  // The offset before optimizing.
+    u32 size;   // The encoded size before optimizing, or 0 if synthesized.
+    bool is_label;  // A branch target or handler offset.
+    // Must be kept as is: a br_table entry, or the last instruction before a
+    // try block's start or end. A frame's offset is after the instruction
+    // that threw, so removing those could move a throw into or out of a try.
+    bool is_pinned;
+  };
+
+  using Nodes = std::vector<Node>;
+
+  bool InRange(Offset offset) const {
+    return offset >= begin_ && offset < end_;
+  }
+  void AddLabel(Offset);
+  void MarkLabels();
+
+  bool RemoveDeadCode();
+  bool Peephole();
+  bool Reduce(Nodes*);
+  bool CanReduce(const Nodes&, size_t count) const;
+  void Replace(Nodes*, size_t count, const Instr&);
+  void Remove(Nodes*, size_t count);
+  void EmitInstr(const Instr&);
+
+  Istream* istream_;
+  FuncDesc* func_;
+  Offset begin_;
+  Offset end_;
+  Nodes nodes_;
+  // Labels that aren't branch targets: the function's start, the default
+  // br_table entries and the handler offsets.
+  std::vector<Offset> fixed_labels_;
+  // Set when a label's instructions were removed, so the label moves to the
+  // next instruction.
+  bool carry_label_ = false;
+};
+
+void FuncOptimizer::AddLabel(Offset offset) {
+  if (InRange(offset)) {
+    fixed_labels_.push_back(offset);
+  }
+}
+
+bool FuncOptimizer::Decode() {
+  for (Offset pc = begin_; pc < end_;) {
+    Node node;
+    node.pc = pc;
+    node.instr = istream_->Read(&pc);
+    node.size = pc - node.pc;
+    node.is_label = false;
+    node.is_pinned = false;
+    nodes_.push_back(node);
+
+    if (node.instr.op == O::BrTable) {
+      // The entries follow immediately; the default entry's drop_keep and
+      // catch_drop may be empty, so it starts at a label instead.
+      for (u32 i = 0; i < node.instr.imm_u32 * 3; ++i) {
+        Node entry;
+        entry.pc = pc;
+        entry.instr = istream_->Read(&pc);
+        entry.size = pc - entry.pc;
+        entry.is_label = false;
+        entry.is_pinned = true;
+        nodes_.push_back(entry);
+      }
+      AddLabel(pc);
+    }
+  }
+
+  AddLabel(begin_);
+  for (const HandlerDesc& handler : func_->handlers) {
+    AddLabel(handler.try_start_offset);
+    AddLabel(handler.try_end_offset);
+    for (const CatchDesc& catch_ : handler.catches) {
+      AddLabel(catch_.offset);
+    }
+    if (handler.kind == HandlerKind::Catch) {
+      AddLabel(handler.catch_all_offset);
+    }
+  }
+
+  std::unordered_set<Offset> try_bounds;
+  for (const HandlerDesc& handler : func_->handlers) {
+    try_bounds.insert(handler.try_start_offset);
+    try_bounds.insert(handler.try_end_offset);
+  }
+
+  std::unordered_set<Offset> labels(fixed_labels_.begin(),
+                                    fixed_labels_.end());
+  for (const Node& node : nodes_) {
+    if (IsBranch(node.instr.op) && InRange(node.instr.imm_u32)) {
+      labels.insert(node.instr.imm_u32);
+    }
+  }
+
+  size_t found = 0;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (labels.count(nodes_[i].pc)) {
+      ++found;
+    }
+    if (i > 0 && try_bounds.count(nodes_[i].pc)) {
+      nodes_[i - 1].is_pinned = true;
+    }
+  }
+  // Every label must be at an instruction boundary; if not, the function's
+  // code isn't what we expect, so leave it alone.
+  return found == labels.size();
+}
+
+// Labels are found again before each round, since removed branches no longer
+// make their targets labels. A label whose instructions were removed is at
+// the next instruction that was kept.
+void FuncOptimizer::MarkLabels() {
+  std::vector<Offset> labels = fixed_labels_;
+  for (const Node& node : nodes_) {
+    if (IsBranch(node.instr.op) && InRange(node.instr.imm_u32)) {
+      labels.push_back(node.instr.imm_u32);
+    }
+  }
+
+  for (Node& node : nodes_) {
+    node.is_label = false;
+  }
+  for (Offset label : labels) {
+    auto iter = std::lower_bound(
+        nodes_.begin(), nodes_.end(), label,
+        [](const Node& node, Offset offset) { return node.pc < offset; });
+    if (iter != nodes_.end()) {
+      iter->is_label = true;
+    }
+  }
+}
+
+void FuncOptimizer::Optimize() {
+  for (int round = 0; round < kMaxRounds; ++round) {
+    MarkLabels();
+    bool changed = RemoveDeadCode();
+    changed |= Peephole();
+    if (!changed) {
+      break;
+    }
+  }
+}
+
+bool FuncOptimizer::RemoveDeadCode() {
+  bool changed = false;
+  bool reachable = true;
+  Nodes live;
+  live.reserve(nodes_.size());
+  for (const Node& node : nodes_) {
+    if (node.is_label) {
+      reachable = true;
+    }
+    // Unresolved branches are kept, since their offset is patched later.
+    bool unresolved =
+        node.instr.op == O::Br && node.instr.imm_u32 == Istream::kInvalidOffset;
+    // A br_table is kept along with its pinned entries.
+    if (!reachable && !node.is_pinned && !unresolved &&
+        node.instr.op != O::BrTable) {
+      changed = true;
+      continue;
+    }
+    live.push_back(node);
+    if (IsUnconditional(node.instr.op)) {
+      reachable = false;
+    }
+  }
+
+  nodes_.clear();
+  for (size_t i = 0; i < live.size(); ++i) {
+    const Node& node = live[i];
+    if (node.instr.op == O::Br && !node.is_pinned && i + 1 < live.size() &&
+        live[i + 1].pc == node.instr.imm_u32) {
+      live[i + 1].is_label |= node.is_label;
+      changed = true;
+      continue;
+    }
+    nodes_.push_back(node);
+  }
+  return changed;
+}
+
+bool FuncOptimizer::Peephole() {
+  bool changed = false;
+  Nodes out;
+  out.reserve(nodes_.size());
+  for (const Node& node : nodes_) {
+    out.push_back(node);
+    out.back().is_label |= carry_label_;
+    carry_label_ = false;
+    while (Reduce(&out)) {
+      changed = true;
+    }
+  }
+  nodes_ = std::move(out);
+  return changed;
+}
+
+// The last |count| nodes can be combined if only the first of them can be
+// reached by a branch, and none of them is a br_table entry.
+bool FuncOptimizer::CanReduce(const Nodes& nodes, size_t count) const {
+  size_t size = nodes.size();
+  if (size < count || nodes[size - count].is_pinned) {
+    return false;
+  }
+  for (size_t i = size - count + 1; i < size; ++i) {
+    if (nodes[i].is_label || nodes[i].is_pinned) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Replaces the last |count| nodes with |instr|, which takes over the first
+// node's offset.
+void FuncOptimizer::Replace(Nodes* nodes, size_t count, const Instr& instr) {
+  Node node = (*nodes)[nodes->size() - count];
+  nodes->resize(nodes->size() - count);
+  node.instr = instr;
+  node.size = 0;
+  nodes->push_back(node);
+}
+
+// Removes the last |count| nodes, which have no effect.
+void FuncOptimizer::Remove(Nodes* nodes, size_t count) {
+  carry_label_ |= (*nodes)[nodes->size() - count].is_label;
+  nodes->resize(nodes->size() - count);
+}
+
+bool FuncOptimizer::Reduce(Nodes* nodes) {
+  size_t size = nodes->size();
+  if (size < 2) {
+    return false;
+  }
+  const Node& prev = (*nodes)[size - 2];
+  const Node& last = (*nodes)[size - 1];
+  Opcode op = last.instr.op;
+  u64 bits;
+
+  // const, const, binop => const
+  if (size >= 3 && CanReduce(*nodes, 3)) {
+    const Node& lhs = (*nodes)[size - 3];
+    if (IsConst(lhs.instr, op.GetParamType1()) &&
+        IsConst(prev.instr, op.GetParamType2()) &&
+        FoldBinop(op, GetConstBits(lhs.instr), GetConstBits(prev.instr),
+                  &bits)) {
+      Replace(nodes, 3, MakeConst(op.GetResultType(), bits));
+      return true;
+    }
+  }
+
+  if (!CanReduce(*nodes, 2)) {
+    return false;
+  }
+
+  // const, unop => const
+  if (IsConst(prev.instr, op.GetParamType1()) &&
+      FoldUnop(op, GetConstBits(prev.instr), &bits)) {
+    Replace(nodes, 2, MakeConst(op.GetResultType(), bits));
+    return true;
+  }
+
+  switch (op) {
+    case O::Drop:
+      // local.get x, drop => (nothing)
+      if (IsPure(prev.instr.op)) {
+        Remove(nodes, 2);
+        return true;
+      }
+      // local.tee x, drop => local.set x
+      if (prev.instr.op == O::LocalTee) {
+        Replace(nodes, 2,
+                MakeInstr(O::LocalSet, InstrKind::Imm_Index_Op_1,
+                          prev.instr.imm_u32));
+        return true;
+      }
+      break;
+
+    case O::LocalGet:
+      // local.set x, local.get x => local.tee x
+      //
+      // Local indexes are relative to the top of the stack, so the same local
+      // is one closer after local.set pops its operand.
+      if (prev.instr.op == O::LocalSet &&
+          last.instr.imm_u32 + 1 == prev.instr.imm_u32) {
+        Replace(nodes, 2,
+                MakeInstr(O::LocalTee, InstrKind::Imm_Index_Op_1,
+                          prev.instr.imm_u32));
+        return true;
+      }
+      break;
+
+    case O::LocalSet:
+      // local.get x, local.set y => local_copy x, y
+      if (prev.instr.op == O::LocalGet) {
+        u32 from = prev.instr.imm_u32;
+        u32 to = last.instr.imm_u32 - 1;
+        if (from == to) {
+          Remove(nodes, 2);
+        } else {
+          Replace(nodes, 2, MakeInstr(O::InterpLocalCopy, from, to));
+        }
+        return true;
+      }
+      break;
+
+    case O::BrIf:
+    case O::InterpBrUnless:
+      // i32.const c, br_if l => br l, or nothing
+      if (prev.instr.op == O::I32Const) {
+        bool taken = (op == O::BrIf) == (prev.instr.imm_u32 != 0);
+        if (taken) {
+          Replace(nodes, 2,
+                  MakeInstr(O::Br, InstrKind::Imm_Jump_Op_0,
+                            last.instr.imm_u32));
+        } else {
+          Remove(nodes, 2);
+        }
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  // drop_keep a k, drop_keep b k => drop_keep a+b k
+  u32 prev_drop, prev_keep, drop, keep;
+  if (GetDropKeep(prev.instr, &prev_drop, &prev_keep) &&
+      GetDropKeep(last.instr, &drop, &keep) && prev_keep == keep) {
+    Replace(nodes, 2, MakeInstr(O::InterpDropKeep, prev_drop + drop, keep));
+    return true;
+  }
+
+  return false;
+}
+
+void FuncOptimizer::EmitInstr(const Instr& instr) {
+  switch (instr.kind) {
+    case InstrKind::Imm_I32_Op_0:
+    case InstrKind::Imm_Index_Op_1:
+    case InstrKind::Imm_Jump_Op_0:
+      istream_->Emit(instr.op, instr.imm_u32);
+      break;
+
+    case InstrKind::Imm_I64_Op_0:
+      istream_->Emit(instr.op, instr.imm_u64);
+      break;
+
+    case InstrKind::Imm_I32_I32_Op_0:
+      istream_->Emit(instr.op, instr.imm_u32x2.fst, instr.imm_u32x2.snd);
+      break;
+
+    default:
+      WABT_UNREACHABLE;
+  }
+}
+
+void FuncOptimizer::Emit(std::vector<std::pair<Offset, Offset>>* out_offsets) {
+  Buffer old = istream_->Slice(begin_, end_);
+  istream_->Truncate(begin_);
+
+  std::vector<std::pair<Offset, Offset>>& offsets = *out_offsets;
+  offsets.reserve(nodes_.size() + 1);
+  for (const Node& node : nodes_) {
+    offsets.emplace_back(node.pc, istream_->end());
+    if (node.size) {
+      istream_->EmitBytes(old.data() + (node.pc - begin_), node.size);
+    } else {
+      EmitInstr(node.instr);
+    }
+  }
+  // Anything at the old end maps to the new end.
+  offsets.emplace_back(end_, istream_->end());
+
+  auto remap = [&](u32* offset) {
+    if (InRange(*offset)) {
+      // Removed instructions map to the next one that was kept.
+      auto iter = std::lower_bound(
+          offsets.begin(), offsets.end(), std::make_pair(*offset, Offset{0}));
+      assert(iter != offsets.end());
+      *offset = iter->second;
+    }
+  };
+
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    const Node& node = nodes_[i];
+    if (IsBranch(node.instr.op) && InRange(node.instr.imm_u32)) {
+      u32 target = node.instr.imm_u32;
+      remap(&target);
+      istream_->PatchU32(offsets[i].second + sizeof(Istream::SerializedOpcode),
+                         target);
+    }
+  }
+
+  for (HandlerDesc& handler : func_->handlers) {
+    remap(&handler.try_start_offset);
+    remap(&handler.try_end_offset);
+    for (CatchDesc& catch_ : handler.catches) {
+      remap(&catch_.offset);
+    }
+    if (handler.kind == HandlerKind::Catch) {
+      remap(&handler.catch_all_offset);
+    }
+  }
+}
+
+void FuncOptimizer::CacheTopOfStack() {
+  MarkLabels();
+  // Instructions that push without popping could only spill the register
+  // first, which is no better than the previous instruction pushing.
+  auto takes_cached = [](const Node& node) {
+    TosKind kind = GetTosKind(node.instr.op);
+    return !node.is_label && !node.is_pinned &&
+           (kind == TosKind::Produce || kind == TosKind::Consume);
+  };
+
+  bool cached = false;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    const Node& node = nodes_[i];
+    TosKind kind = GetTosKind(node.instr.op);
+    if (kind == TosKind::None) {
+      assert(!cached);
+      continue;
+    }
+
+    u32 state = cached ? Istream::kTosIn : 0;
+    // A result is only left in the register if the next instruction picks it
+    // up; otherwise the instruction pushes it as usual.
+    if (kind != TosKind::Consume && i + 1 < nodes_.size() &&
+        takes_cached(nodes_[i + 1])) {
+      state |= Istream::kTosOut;
+    }
+    cached = state & Istream::kTosOut;
+    if (state) {
+      Opcode::Enum op = node.instr.op;
+      istream_->PatchU32(node.pc, op | (state << Istream::kTosStateShift));
+    }
+  }
+}
+
+}  // namespace
+
+Istream::Offset IstreamOffsetMap::Map(Istream::Offset offset) const {
+  if (offsets_.empty() || offset < offsets_.front().first) {
+    return offset;
+  }
+  auto iter = std::lower_bound(offsets_.begin(), offsets_.end(),
+                               std::make_pair(offset, Istream::Offset{0}));
+  if (iter == offsets_.end()) {
+    // Past the end of the function; the code there was never moved.
+    return offset;
+  }
+  // Offsets of removed instructions map to the next one that was kept.
+  return iter->second;
+}
+
+void OptimizeFunc(Istream* istream, FuncDesc* func, IstreamOffsetMap* out_map) {
+  out_map->offsets_.clear();
+  FuncOptimizer optimizer(istream, func);
+  if (optimizer.Decode()) {
+    optimizer.Optimize();
+    optimizer.Emit(&out_map->offsets_);
+  }
+}
+
+void CacheTopOfStack(Istream* istream, FuncDesc* func) {
+  FuncOptimizer optimizer(istream, func);
+  if (optimizer.Decode()) {
+    optimizer.CacheTopOfStack();
+  }
+}
+
+}  // namespace interp
+}  // namespace wabt
@@ -102,10 +102,33 @@ void Istream::ResolveFixupU32(Offset fixup_offset) {
   EmitAt(fixup_offset, end());
 }
 
+Buffer Istream::Slice(Offset from, Offset to) const {
+  assert(from <= to && to <= data_.size());
+  return Buffer(data_.begin() + from, data_.begin() + to);
+}
+
+void Istream::Truncate(Offset offset) {
+  assert(offset <= data_.size());
+  data_.resize(offset);
+}
+
+void Istream::EmitBytes(const u8* data, size_t size) {
+  data_.insert(data_.end(), data, data + size);
+}
+
+void Istream::PatchU32(Offset offset, u32 val) {
+  assert(offset + sizeof(val) <= data_.size());
+  EmitAt(offset, val);
+}
+
 Istream::Offset Istream::end() const {
   return static_cast<u32>(data_.size());
 }
 
+size_t Istream::capacity() const {
+  return data_.capacity();
+}
+
 template <typename T>
 T WABT_VECTORCALL Istream::ReadAt(Offset* offset) const {
   assert(*offset + sizeof(T) <= data_.size());
@@ -117,7 +140,9 @@ T WABT_VECTORCALL Istream::ReadAt(Offset* offset) const {
 
 Instr Istream::Read(Offset* offset) const {
   Instr instr;
-  instr.op = static_cast<Opcode::Enum>(ReadAt<SerializedOpcode>(offset));
+  SerializedOpcode opcode = ReadAt<SerializedOpcode>(offset);
+  instr.op = static_cast<Opcode::Enum>(opcode & ((1 << kTosStateShift) - 1));
+  instr.tos_state = opcode >> kTosStateShift;
 
   switch (instr.op) {
     case Opcode::Drop:
@@ -608,6 +633,60 @@ Instr Istream::Read(Offset* offset) const {
     case Opcode::V128Load:
     case Opcode::V128Load32Zero:
     case Opcode::V128Load64Zero:
+    case Opcode::InterpI32LoadM32:
+    case Opcode::InterpI64LoadM32:
+    case Opcode::InterpF32LoadM32:
+    case Opcode::InterpF64LoadM32:
+    case Opcode::InterpI32Load8SM32:
+    case Opcode::InterpI32Load8UM32:
+    case Opcode::InterpI32Load16SM32:
+    case Opcode::InterpI32Load16UM32:
+    case Opcode::InterpI64Load8SM32:
+    case Opcode::InterpI64Load8UM32:
+    case Opcode::InterpI64Load16SM32:
+    case Opcode::InterpI64Load16UM32:
+    case Opcode::InterpI64Load32SM32:
+    case Opcode::InterpI64Load32UM32:
+    case Opcode::InterpV128LoadM32:
+    case Opcode::InterpV128Load8X8SM32:
+    case Opcode::InterpV128Load8X8UM32:
+    case Opcode::InterpV128Load16X4SM32:
+    case Opcode::InterpV128Load16X4UM32:
+    case Opcode::InterpV128Load32X2SM32:
+    case Opcode::InterpV128Load32X2UM32:
+    case Opcode::InterpV128Load8SplatM32:
+    case Opcode::InterpV128Load16SplatM32:
+    case Opcode::InterpV128Load32SplatM32:
+    case Opcode::InterpV128Load64SplatM32:
+    case Opcode::InterpV128Load32ZeroM32:
+    case Opcode::InterpV128Load64ZeroM32:
+    case Opcode::InterpI32LoadM64:
+    case Opcode::InterpI64LoadM64:
+    case Opcode::InterpF32LoadM64:
+    case Opcode::InterpF64LoadM64:
+    case Opcode::InterpI32Load8SM64:
+    case Opcode::InterpI32Load8UM64:
+    case Opcode::InterpI32Load16SM64:
+    case Opcode::InterpI32Load16UM64:
+    case Opcode::InterpI64Load8SM64:
+    case Opcode::InterpI64Load8UM64:
+    case Opcode::InterpI64Load16SM64:
+    case Opcode::InterpI64Load16UM64:
+    case Opcode::InterpI64Load32SM64:
+    case Opcode::InterpI64Load32UM64:
+    case Opcode::InterpV128LoadM64:
+    case Opcode::InterpV128Load8X8SM64:
+    case Opcode::InterpV128Load8X8UM64:
+    case Opcode::InterpV128Load16X4SM64:
+    case Opcode::InterpV128Load16X4UM64:
+    case Opcode::InterpV128Load32X2SM64:
+    case Opcode::InterpV128Load32X2UM64:
+    case Opcode::InterpV128Load8SplatM64:
+    case Opcode::InterpV128Load16SplatM64:
+    case Opcode::InterpV128Load32SplatM64:
+    case Opcode::InterpV128Load64SplatM64:
+    case Opcode::InterpV128Load32ZeroM64:
+    case Opcode::InterpV128Load64ZeroM64:
       // Index + memory offset immediates, 1 operand.
       instr.kind = InstrKind::Imm_Index_Offset_Op_1;
       instr.imm_u32x2.fst = ReadAt<u32>(offset);
@@ -674,6 +753,26 @@ Instr Istream::Read(Offset* offset) const {
     case Opcode::I64Store32:
     case Opcode::I64Store8:
     case Opcode::V128Store:
+    case Opcode::InterpI32StoreM32:
+    case Opcode::InterpI64StoreM32:
+    case Opcode::InterpF32StoreM32:
+    case Opcode::InterpF64StoreM32:
+    case Opcode::InterpI32Store8M32:
+    case Opcode::InterpI32Store16M32:
+    case Opcode::InterpI64Store8M32:
+    case Opcode::InterpI64Store16M32:
+    case Opcode::InterpI64Store32M32:
+    case Opcode::InterpV128StoreM32:
+    case Opcode::InterpI32StoreM64:
+    case Opcode::InterpI64StoreM64:
+    case Opcode::InterpF32StoreM64:
+    case Opcode::InterpF64StoreM64:
+    case Opcode::InterpI32Store8M64:
+    case Opcode::InterpI32Store16M64:
+    case Opcode::InterpI64Store8M64:
+    case Opcode::InterpI64Store16M64:
+    case Opcode::InterpI64Store32M64:
+    case Opcode::InterpV128StoreM64:
       // Index and memory offset immediates, 2 operands.
       instr.kind = InstrKind::Imm_Index_Offset_Op_2;
       instr.imm_u32x2.fst = ReadAt<u32>(offset);
@@ -739,6 +838,7 @@ Instr Istream::Read(Offset* offset) const {
       break;
 
     case Opcode::InterpDropKeep:
+    case Opcode::InterpLocalCopy:
       // i32 and i32 immediates, 0 operands.
       instr.kind = InstrKind::Imm_I32_I32_Op_0;
       instr.imm_u32x2.fst = ReadAt<u32>(offset);
@@ -833,6 +933,10 @@ Istream::Offset Istream::Trace(Stream* stream,
   Offset start = offset;
   Instr instr = Read(&offset);
   stream->Writef("%s| %s", source->Header(start).c_str(), instr.op.GetName());
+  if (instr.tos_state) {
+    stream->Writef(" [tos%s%s]", (instr.tos_state & kTosIn) ? " in" : "",
+                   (instr.tos_state & kTosOut) ? " out" : "");
+  }
 
   switch (instr.kind) {
     case InstrKind::Imm_0_Op_0:
@@ -76,7 +76,13 @@ Index ModuleContext::GetFuncResultCount(const Var& var) const {
 }
 
 void ModuleContext::BeginBlock(LabelType label_type, const Block& block) {
-  label_stack_.emplace_back(label_type, block.label, block.decl.sig.param_types,
+  BeginBlock(label_type, block, block.label);
+}
+
+void ModuleContext::BeginBlock(LabelType label_type,
+                               const Block& block,
+                               const std::string& name) {
+  label_stack_.emplace_back(label_type, name, block.decl.sig.param_types,
                             block.decl.sig.result_types);
 }
 
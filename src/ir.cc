@@ -16,9 +16,9 @@
 
 #include "wabt/ir.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
-#include <numeric>
 
 #include "wabt/cast.h"
 
@@ -172,6 +172,7 @@ bool Module::IsImport(ExternalKind kind, const Var& var) const {
 
 void LocalTypes::Set(const TypeVector& types) {
   decls_.clear();
+  decl_ends_.clear();
   if (types.empty()) {
     return;
   }
@@ -180,32 +181,23 @@ void LocalTypes::Set(const TypeVector& types) {
   Index count = 1;
   for (Index i = 1; i < types.size(); ++i) {
     if (types[i] != type) {
-      decls_.emplace_back(type, count);
+      AppendDecl(type, count);
       type = types[i];
       count = 1;
     } else {
       ++count;
     }
   }
-  decls_.emplace_back(type, count);
-}
-
-Index LocalTypes::size() const {
-  return std::accumulate(
-      decls_.begin(), decls_.end(), 0,
-      [](Index sum, const Decl& decl) { return sum + decl.second; });
+  AppendDecl(type, count);
 }
 
 Type LocalTypes::operator[](Index i) const {
-  Index count = 0;
-  for (auto decl : decls_) {
-    if (i < count + decl.second) {
-      return decl.first;
-    }
-    count += decl.second;
+  auto iter = std::upper_bound(decl_ends_.begin(), decl_ends_.end(), i);
+  if (iter == decl_ends_.end()) {
+    assert(i < size());
+    return Type::Any;
   }
-  assert(i < count);
-  return Type::Any;
+  return decls_[iter - decl_ends_.begin()].first;
 }
 
 Type Func::GetLocalType(Index index) const {
@@ -18,6 +18,7 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cfloat>
 #include <cinttypes>
 #include <cmath>
 #include <cstdlib>
@@ -29,6 +30,8 @@ namespace wabt {
 
 namespace {
 
+#include "prebuilt/float-pow5-table.cc"
+
 template <typename T>
 struct FloatTraitsBase {};
 
@@ -42,8 +45,27 @@ struct FloatTraitsBase<float> {
   static constexpr int kSigBits = 23;
   static constexpr float kHugeVal = HUGE_VALF;
   static constexpr int kMaxHexBufferSize = WABT_MAX_FLOAT_HEX;
+  static constexpr int kMaxDecimalBufferSize = WABT_MAX_FLOAT_DECIMAL;
+
+  // Decimal exponents outside this range always give zero or infinity for a
+  // significand of at most 19 digits.
+  static constexpr int kMinPow10 = -65;
+  static constexpr int kMaxPow10 = 38;
+  // Range of decimal exponents where a product can land exactly halfway
+  // between two floats, so ties need to be detected.
+  static constexpr int kMinRoundToEvenPow10 = -17;
+  static constexpr int kMaxRoundToEvenPow10 = 10;
+  // Significands and powers of ten that are exactly representable, so one
+  // correctly rounded multiply or divide gives the correct result.
+  static constexpr int kMaxExactPow10 = 10;
+  static constexpr uint64_t kMaxExactSig = uint64_t(1) << 24;
 
   static float Strto(const char* s, char** endptr) { return strtof(s, endptr); }
+  static float ExactPow10(int exp) {
+    static const float kPowers[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                    1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    return kPowers[exp];
+  }
 };
 
 template <>
@@ -53,10 +75,24 @@ struct FloatTraitsBase<double> {
   static constexpr int kSigBits = 52;
   static constexpr float kHugeVal = HUGE_VAL;
   static constexpr int kMaxHexBufferSize = WABT_MAX_DOUBLE_HEX;
+  static constexpr int kMaxDecimalBufferSize = WABT_MAX_DOUBLE_DECIMAL;
+
+  static constexpr int kMinPow10 = kPow5TableMinExp;
+  static constexpr int kMaxPow10 = kPow5TableMaxExp;
+  static constexpr int kMinRoundToEvenPow10 = -4;
+  static constexpr int kMaxRoundToEvenPow10 = 23;
+  static constexpr int kMaxExactPow10 = 22;
+  static constexpr uint64_t kMaxExactSig = uint64_t(1) << 53;
 
   static double Strto(const char* s, char** endptr) {
     return strtod(s, endptr);
   }
+  static double ExactPow10(int exp) {
+    static const double kPowers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    return kPowers[exp];
+  }
 };
 
 template <typename T>
@@ -77,6 +113,336 @@ struct FloatTraits : FloatTraitsBase<T> {
   static constexpr Uint kQuietNanTag = Uint(1) << (kSigBits - 1);
 };
 
+struct Uint128 {
+  uint64_t high;
+  uint64_t low;
+};
+
+Uint128 Multiply64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+  return {static_cast<uint64_t>(product >> 64),
+          static_cast<uint64_t>(product)};
+#else
+  uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+  uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo;
+  uint64_t hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi;
+  uint64_t hi_hi = a_hi * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+  return {hi_hi + (hi_lo >> 32) + (cross >> 32),
+          (cross << 32) | (lo_lo & 0xffffffff)};
+#endif
+}
+
+// Binary to shortest decimal conversion, using the Ryu algorithm: "Ryu: Fast
+// Float-to-String Conversion", Ulf Adams, PLDI 2018.
+//
+// A finite non-zero value is converted to sig * 10^exp, where sig has the
+// fewest digits that still round to the original value, and among those is
+// the closest to it.
+
+struct Decimal {
+  uint64_t sig;
+  int exp;
+};
+
+// ceil(log2(5^e)) for 0 < e <= 3528; 1 for e == 0.
+int RyuPow5Bits(int e) {
+  return static_cast<int>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650.
+uint32_t RyuLog10Pow2(int e) {
+  return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620.
+uint32_t RyuLog10Pow5(int e) {
+  return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+template <typename U>
+bool RyuIsMultipleOfPow5(U value, uint32_t p) {
+  uint32_t count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    count++;
+  }
+  return count >= p;
+}
+
+template <typename U>
+bool RyuIsMultipleOfPow2(U value, uint32_t p) {
+  return (value & ((U(1) << p) - 1)) == 0;
+}
+
+// (m * factor) >> shift, where factor is a 64-bit table entry and
+// 32 < shift < 96.
+uint32_t RyuMulShift32(uint32_t m, uint64_t factor, int shift) {
+  uint64_t low = static_cast<uint64_t>(m) * static_cast<uint32_t>(factor);
+  uint64_t high = static_cast<uint64_t>(m) * (factor >> 32);
+  return static_cast<uint32_t>(((low >> 32) + high) >> (shift - 32));
+}
+
+// (m * factor) >> shift, where factor is a 128-bit {low, high} table entry and
+// 64 < shift < 128.
+uint64_t RyuMulShift64(uint64_t m, const uint64_t* factor, int shift) {
+  Uint128 low = Multiply64(m, factor[0]);
+  Uint128 high = Multiply64(m, factor[1]);
+  uint64_t sum_low = low.high + high.low;
+  uint64_t sum_high = high.high + (sum_low < low.high);
+  int s = shift - 64;
+  return (sum_high << (64 - s)) | (sum_low >> s);
+}
+
+Decimal ShortestDecimal(uint32_t bits) {
+  constexpr int kSigBits = 23;
+  constexpr int kBias = 127;
+  const uint32_t ieee_sig = bits & ((1u << kSigBits) - 1);
+  const uint32_t ieee_exp = (bits >> kSigBits) & 0xff;
+
+  int e2;
+  uint32_t m2;
+  if (ieee_exp == 0) {
+    e2 = 1 - kBias - kSigBits - 2;
+    m2 = ieee_sig;
+  } else {
+    e2 = static_cast<int>(ieee_exp) - kBias - kSigBits - 2;
+    m2 = (1u << kSigBits) | ieee_sig;
+  }
+  // Round-to-even means the interval's bounds round to the value itself when
+  // its significand is even.
+  const bool accept_bounds = (m2 & 1) == 0;
+
+  // The value and the halfway points to its neighbours, all times 4. The
+  // lower neighbour is closer when the significand is a power of two.
+  const uint32_t mv = 4 * m2;
+  const uint32_t mp = 4 * m2 + 2;
+  const uint32_t mm_shift = ieee_sig != 0 || ieee_exp <= 1;
+  const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+  uint32_t vr, vp, vm;
+  int e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  uint8_t last_removed_digit = 0;
+  if (e2 >= 0) {
+    const uint32_t q = RyuLog10Pow2(e2);
+    e10 = static_cast<int>(q);
+    const int k = kRyuFloatPow5InvBitCount + RyuPow5Bits(q) - 1;
+    const int i = -e2 + static_cast<int>(q) + k;
+    vr = RyuMulShift32(mv, kRyuFloatPow5InvSplit[q], i);
+    vp = RyuMulShift32(mp, kRyuFloatPow5InvSplit[q], i);
+    vm = RyuMulShift32(mm, kRyuFloatPow5InvSplit[q], i);
+    if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+      // One digit is removed below even if the loop doesn't run, so compute
+      // it here with one less power of ten.
+      const int l = kRyuFloatPow5InvBitCount + RyuPow5Bits(q - 1) - 1;
+      last_removed_digit = static_cast<uint8_t>(
+          RyuMulShift32(mv, kRyuFloatPow5InvSplit[q - 1],
+                        -e2 + static_cast<int>(q) - 1 + l) %
+          10);
+    }
+    if (q <= 9) {
+      // Only one of mp, mv and mm can be a multiple of 5, if any.
+      if (mv % 5 == 0) {
+        vr_is_trailing_zeros = RyuIsMultipleOfPow5(mv, q);
+      } else if (accept_bounds) {
+        vm_is_trailing_zeros = RyuIsMultipleOfPow5(mm, q);
+      } else {
+        vp -= RyuIsMultipleOfPow5(mp, q);
+      }
+    }
+  } else {
+    const uint32_t q = RyuLog10Pow5(-e2);
+    e10 = static_cast<int>(q) + e2;
+    const int i = -e2 - static_cast<int>(q);
+    const int k = RyuPow5Bits(i) - kRyuFloatPow5BitCount;
+    int j = static_cast<int>(q) - k;
+    vr = RyuMulShift32(mv, kRyuFloatPow5Split[i], j);
+    vp = RyuMulShift32(mp, kRyuFloatPow5Split[i], j);
+    vm = RyuMulShift32(mm, kRyuFloatPow5Split[i], j);
+    if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+      j = static_cast<int>(q) - 1 -
+          (RyuPow5Bits(i + 1) - kRyuFloatPow5BitCount);
+      last_removed_digit = static_cast<uint8_t>(
+          RyuMulShift32(mv, kRyuFloatPow5Split[i + 1], j) % 10);
+    }
+    if (q <= 1) {
+      // mv = 4 * m2 always has at least two trailing zero bits.
+      vr_is_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_is_trailing_zeros = mm_shift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 31) {
+      vr_is_trailing_zeros = RyuIsMultipleOfPow2(mv, q - 1);
+    }
+  }
+
+  // Remove digits while the bounds still differ.
+  int removed = 0;
+  uint32_t output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = static_cast<uint8_t>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = static_cast<uint8_t>(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+      // Exactly halfway; round to even.
+      last_removed_digit = 4;
+    }
+    output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                   last_removed_digit >= 5);
+  } else {
+    while (vp / 10 > vm / 10) {
+      last_removed_digit = static_cast<uint8_t>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr + (vr == vm || last_removed_digit >= 5);
+  }
+  return {output, e10 + removed};
+}
+
+Decimal ShortestDecimal(uint64_t bits) {
+  constexpr int kSigBits = 52;
+  constexpr int kBias = 1023;
+  const uint64_t ieee_sig = bits & ((uint64_t(1) << kSigBits) - 1);
+  const uint32_t ieee_exp = static_cast<uint32_t>(bits >> kSigBits) & 0x7ff;
+
+  int e2;
+  uint64_t m2;
+  if (ieee_exp == 0) {
+    e2 = 1 - kBias - kSigBits - 2;
+    m2 = ieee_sig;
+  } else {
+    e2 = static_cast<int>(ieee_exp) - kBias - kSigBits - 2;
+    m2 = (uint64_t(1) << kSigBits) | ieee_sig;
+  }
+  const bool accept_bounds = (m2 & 1) == 0;
+
+  const uint64_t mv = 4 * m2;
+  const uint32_t mm_shift = ieee_sig != 0 || ieee_exp <= 1;
+
+  uint64_t vr, vp, vm;
+  int e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  if (e2 >= 0) {
+    // Computing one digit fewer than needed leaves one digit to be removed
+    // below, which gives the rounding digit.
+    const uint32_t q = RyuLog10Pow2(e2) - (e2 > 3);
+    e10 = static_cast<int>(q);
+    const int k = kRyuDoublePow5InvBitCount + RyuPow5Bits(q) - 1;
+    const int i = -e2 + static_cast<int>(q) + k;
+    const uint64_t* factor = kRyuDoublePow5InvSplit[q];
+    vr = RyuMulShift64(mv, factor, i);
+    vp = RyuMulShift64(mv + 2, factor, i);
+    vm = RyuMulShift64(mv - 1 - mm_shift, factor, i);
+    if (q <= 21) {
+      // Only one of mp, mv and mm can be a multiple of 5, if any.
+      if (mv % 5 == 0) {
+        vr_is_trailing_zeros = RyuIsMultipleOfPow5(mv, q);
+      } else if (accept_bounds) {
+        vm_is_trailing_zeros = RyuIsMultipleOfPow5(mv - 1 - mm_shift, q);
+      } else {
+        vp -= RyuIsMultipleOfPow5(mv + 2, q);
+      }
+    }
+  } else {
+    const uint32_t q = RyuLog10Pow5(-e2) - (-e2 > 1);
+    e10 = static_cast<int>(q) + e2;
+    const int i = -e2 - static_cast<int>(q);
+    const int k = RyuPow5Bits(i) - kRyuDoublePow5BitCount;
+    const int j = static_cast<int>(q) - k;
+    const uint64_t* factor = kRyuDoublePow5Split[i];
+    vr = RyuMulShift64(mv, factor, j);
+    vp = RyuMulShift64(mv + 2, factor, j);
+    vm = RyuMulShift64(mv - 1 - mm_shift, factor, j);
+    if (q <= 1) {
+      vr_is_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_is_trailing_zeros = mm_shift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 63) {
+      vr_is_trailing_zeros = RyuIsMultipleOfPow2(mv, q);
+    }
+  }
+
+  int removed = 0;
+  uint8_t last_removed_digit = 0;
+  uint64_t output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = static_cast<uint8_t>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = static_cast<uint8_t>(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+      last_removed_digit = 4;
+    }
+    output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                   last_removed_digit >= 5);
+  } else {
+    // The common case: no trailing zeros to track, so two digits can be
+    // removed at a time.
+    bool round_up = false;
+    if (vp / 100 > vm / 100) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr + (vr == vm || round_up);
+  }
+  return {output, e10 + removed};
+}
+
 template <typename T>
 class FloatParser {
  public:
@@ -99,6 +465,8 @@ class FloatParser {
                                      bool seen_trailing_non_zero);
 
   static Result ParseFloat(const char* s, const char* end, Uint* out_bits);
+  static bool ParseDecimal(const char* s, const char* end, Uint* out_bits);
+  static Uint DecimalToBits(int64_t exp10, uint64_t sig10);
   static Result ParseNan(const char* s, const char* end, Uint* out_bits);
   static Result ParseHex(const char* s, const char* end, Uint* out_bits);
   static void ParseInfinity(const char* s, const char* end, Uint* out_bits);
@@ -111,6 +479,16 @@ class FloatWriter {
   using Uint = typename Traits::Uint;
 
   static void WriteHex(char* out, size_t size, Uint bits);
+  static void WriteDecimal(char* out, size_t size, Uint bits);
+
+ private:
+  template <size_t kMaxBufferSize>
+  static void WriteTruncated(char* (*append)(char*, Uint),
+                             char* out,
+                             size_t size,
+                             Uint bits);
+  static char* AppendHex(char* p, Uint bits);
+  static char* AppendDecimal(char* p, Uint bits);
 };
 
 // Return 1 if the non-NULL-terminated string starting with |start| and ending
@@ -155,6 +533,20 @@ Result FloatParser<T>::ParseFloat(const char* s,
   // The WebAssembly spec also ignores underflow, so we don't need to check for
   // ERANGE at all.
 
+  // Nearly every literal is handled exactly by ParseDecimal; only those with
+  // more than 19 significant digits that sit too close to a rounding boundary
+  // (and hex integers) fall back to strto{f,d} below.
+  Uint bits;
+  if (ParseDecimal(s, end, &bits)) {
+    // A decimal literal can't produce a NaN, so a maximal exponent means the
+    // value overflowed to infinity.
+    if (((bits >> Traits::kSigBits) & Traits::kExpMask) == Traits::kExpMask) {
+      return Result::Error;
+    }
+    *out_bits = bits;
+    return Result::Ok;
+  }
+
   // WebAssembly floats can contain underscores, but strto* can't parse those,
   // so remove them first.
   assert(s <= end);
@@ -176,6 +568,204 @@ Result FloatParser<T>::ParseFloat(const char* s,
   return Result::Ok;
 }
 
+// Parses a decimal literal into a significand of at most 19 digits and a
+// power of ten. Returns false if the literal isn't in that form, or if digits
+// had to be dropped and the result depends on them.
+// static
+template <typename T>
+bool FloatParser<T>::ParseDecimal(const char* s,
+                                  const char* end,
+                                  Uint* out_bits) {
+  constexpr int kMaxSigDigits = 19;
+
+  bool is_neg = false;
+  if (s < end && (*s == '-' || *s == '+')) {
+    is_neg = *s == '-';
+    s++;
+  }
+  if (StringStartsWith(s, end, "0x") || StringStartsWith(s, end, "0X")) {
+    return false;
+  }
+
+  uint64_t sig = 0;
+  int num_sig_digits = 0;
+  int64_t exp10 = 0;
+  bool seen_digit = false;
+  bool truncated = false;
+
+  for (; s < end; ++s) {
+    if (*s == '_') {
+      continue;
+    }
+    if (*s < '0' || *s > '9') {
+      break;
+    }
+    seen_digit = true;
+    int digit = *s - '0';
+    if (num_sig_digits < kMaxSigDigits) {
+      sig = sig * 10 + digit;
+      num_sig_digits += sig != 0;
+    } else {
+      exp10++;
+      truncated |= digit != 0;
+    }
+  }
+
+  if (s < end && *s == '.') {
+    for (++s; s < end; ++s) {
+      if (*s == '_') {
+        continue;
+      }
+      if (*s < '0' || *s > '9') {
+        break;
+      }
+      seen_digit = true;
+      int digit = *s - '0';
+      if (num_sig_digits < kMaxSigDigits) {
+        sig = sig * 10 + digit;
+        num_sig_digits += sig != 0;
+        exp10--;
+      } else {
+        truncated |= digit != 0;
+      }
+    }
+  }
+
+  if (!seen_digit) {
+    return false;
+  }
+
+  if (s < end && (*s == 'e' || *s == 'E')) {
+    ++s;
+    bool exp_is_neg = false;
+    if (s < end && (*s == '-' || *s == '+')) {
+      exp_is_neg = *s == '-';
+      s++;
+    }
+    // Saturate; anything this large is zero or infinity either way.
+    const int64_t kMaxExp = 1000000;
+    int64_t exp = 0;
+    bool seen_exp_digit = false;
+    for (; s < end; ++s) {
+      if (*s == '_') {
+        continue;
+      }
+      if (*s < '0' || *s > '9') {
+        break;
+      }
+      seen_exp_digit = true;
+      if (exp < kMaxExp) {
+        exp = exp * 10 + (*s - '0');
+      }
+    }
+    if (!seen_exp_digit) {
+      return false;
+    }
+    exp10 += exp_is_neg ? -exp : exp;
+  }
+
+  if (s != end) {
+    return false;
+  }
+
+  Uint bits = DecimalToBits(exp10, sig);
+  // The dropped digits put the exact value between sig and sig + 1 (times
+  // 10^exp10); if both round to the same float, so does the exact value.
+  if (truncated && DecimalToBits(exp10, sig + 1) != bits) {
+    return false;
+  }
+  *out_bits = (Uint(is_neg) << Traits::kSignShift) | bits;
+  return true;
+}
+
+// Returns the bits of the float nearest to sig10 * 10^exp10, without the sign,
+// using the Eisel-Lemire algorithm ("Number Parsing at a Gigabyte per Second",
+// Lemire 2021). Values too large for T give infinity.
+// static
+template <typename T>
+typename FloatParser<T>::Uint FloatParser<T>::DecimalToBits(int64_t exp10,
+                                                            uint64_t sig10) {
+  const Uint kInfinity = Uint(Traits::kExpMask) << Traits::kSigBits;
+  if (sig10 == 0 || exp10 < Traits::kMinPow10) {
+    return 0;
+  }
+  if (exp10 > Traits::kMaxPow10) {
+    return kInfinity;
+  }
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  // Clinger's fast path: both operands are exact, so the one rounding done by
+  // the FPU is the correct one.
+  if (sig10 <= Traits::kMaxExactSig && exp10 >= -Traits::kMaxExactPow10 &&
+      exp10 <= Traits::kMaxExactPow10) {
+    Float value = static_cast<Float>(sig10);
+    if (exp10 < 0) {
+      value /= Traits::ExactPow10(-exp10);
+    } else {
+      value *= Traits::ExactPow10(exp10);
+    }
+    Uint bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+#endif
+
+  const int q = static_cast<int>(exp10);
+  const int lz = Clz(sig10);
+  const uint64_t w = sig10 << lz;
+
+  // Multiply by the truncated 128-bit 5^q. The low half is only needed when
+  // the bits below the ones we keep (plus a rounding bit) are all ones.
+  const uint64_t* pow5 = kPow5Table[q - kPow5TableMinExp];
+  Uint128 product = Multiply64(w, pow5[0]);
+  const uint64_t kPrecisionMask = ~uint64_t(0) >> (Traits::kSigBits + 3);
+  if ((product.high & kPrecisionMask) == kPrecisionMask) {
+    Uint128 low = Multiply64(w, pow5[1]);
+    product.low += low.high;
+    if (low.high > product.low) {
+      product.high++;
+    }
+  }
+
+  const int upper_bit = static_cast<int>(product.high >> 63);
+  const int shift = upper_bit + 64 - Traits::kSigBits - 3;
+  uint64_t mantissa = product.high >> shift;
+  // floor(log2(10^q)) + 63, plus the normalization shifts.
+  int exp2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz +
+             Traits::kExpBias;
+
+  if (exp2 <= 0) {
+    // Subnormal (or zero). Rounding up may carry into the smallest normal.
+    if (-exp2 + 1 >= 64) {
+      return 0;
+    }
+    mantissa >>= -exp2 + 1;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    exp2 = mantissa < (uint64_t(1) << Traits::kSigBits) ? 0 : 1;
+    return (Uint(exp2) << Traits::kSigBits) | Uint(mantissa);
+  }
+
+  // Exactly halfway between two floats: round to even rather than up.
+  if (product.low <= 1 && q >= Traits::kMinRoundToEvenPow10 &&
+      q <= Traits::kMaxRoundToEvenPow10 && (mantissa & 3) == 1 &&
+      (mantissa << shift) == product.high) {
+    mantissa &= ~uint64_t(1);
+  }
+
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= (uint64_t(2) << Traits::kSigBits)) {
+    mantissa = uint64_t(1) << Traits::kSigBits;
+    exp2++;
+  }
+  mantissa &= ~(uint64_t(1) << Traits::kSigBits);
+  if (exp2 >= Traits::kExpMask) {
+    return kInfinity;
+  }
+  return (Uint(exp2) << Traits::kSigBits) | Uint(mantissa);
+}
+
 // static
 template <typename T>
 typename FloatParser<T>::Uint FloatParser<T>::Make(bool sign,
@@ -452,16 +1042,53 @@ Result FloatParser<T>::Parse(LiteralType literal_type,
   WABT_UNREACHABLE;
 }
 
+// Writes the literal for |bits| into |out|, truncating it to fit |size|. The
+// literal is appended in place when |out| is large enough for any value, and
+// through a temporary buffer otherwise.
+// static
+template <typename T>
+template <size_t kMaxBufferSize>
+void FloatWriter<T>::WriteTruncated(char* (*append)(char*, Uint),
+                                    char* out,
+                                    size_t size,
+                                    Uint bits) {
+  if (size >= kMaxBufferSize) {
+    *append(out, bits) = '\0';
+    return;
+  }
+
+  char buffer[kMaxBufferSize];
+  size_t len = append(buffer, bits) - buffer;
+  if (len >= size) {
+    len = size - 1;
+  }
+  memcpy(out, buffer, len);
+  out[len] = '\0';
+}
+
 // static
 template <typename T>
 void FloatWriter<T>::WriteHex(char* out, size_t size, Uint bits) {
+  WriteTruncated<Traits::kMaxHexBufferSize>(AppendHex, out, size, bits);
+}
+
+// static
+template <typename T>
+void FloatWriter<T>::WriteDecimal(char* out, size_t size, Uint bits) {
+  WriteTruncated<Traits::kMaxDecimalBufferSize>(AppendDecimal, out, size,
+                                                bits);
+}
+
+// Writes the unterminated hex literal for |bits| to |p|, which must have room
+// for kMaxHexBufferSize - 1 characters, and returns the end of the literal.
+// static
+template <typename T>
+char* FloatWriter<T>::AppendHex(char* p, Uint bits) {
   static constexpr int kNumNybbles = Traits::kBits / 4;
   static constexpr int kTopNybbleShift = Traits::kBits - 4;
   static constexpr Uint kTopNybble = Uint(0xf) << kTopNybbleShift;
   static const char s_hex_digits[] = "0123456789abcdef";
 
-  char buffer[Traits::kMaxHexBufferSize];
-  char* p = buffer;
   bool is_neg = (bits >> Traits::kSignShift);
   int exp = ((bits >> Traits::kSigBits) & Traits::kExpMask) - Traits::kExpBias;
   Uint sig = bits & Traits::kSigMask;
@@ -472,13 +1099,13 @@ void FloatWriter<T>::WriteHex(char* out, size_t size, Uint bits) {
   if (exp == Traits::kMaxExp) {
     // Infinity or nan.
     if (sig == 0) {
-      strcpy(p, "inf");
+      memcpy(p, "inf", 3);
       p += 3;
     } else {
-      strcpy(p, "nan");
+      memcpy(p, "nan", 3);
       p += 3;
       if (sig != Traits::kQuietNanTag) {
-        strcpy(p, ":0x");
+        memcpy(p, ":0x", 3);
         p += 3;
         // Skip leading zeroes.
         int num_nybbles = kNumNybbles;
@@ -496,7 +1123,7 @@ void FloatWriter<T>::WriteHex(char* out, size_t size, Uint bits) {
     }
   } else {
     bool is_zero = sig == 0 && exp == Traits::kMinExp;
-    strcpy(p, "0x");
+    memcpy(p, "0x", 2);
     p += 2;
     *p++ = is_zero ? '0' : '1';
 
@@ -524,7 +1151,7 @@ void FloatWriter<T>::WriteHex(char* out, size_t size, Uint bits) {
     }
     *p++ = 'p';
     if (is_zero) {
-      strcpy(p, "+0");
+      memcpy(p, "+0", 2);
       p += 2;
     } else {
       if (exp < 0) {
@@ -545,13 +1172,88 @@ void FloatWriter<T>::WriteHex(char* out, size_t size, Uint bits) {
       *p++ = '0' + exp % 10;
     }
   }
+  return p;
+}
+
+// Writes the unterminated shortest decimal literal for |bits| to |p|, which
+// must have room for kMaxDecimalBufferSize - 1 characters, and returns the end
+// of the literal.
+//
+// The digits are the fewest that parse back to exactly |bits| (the closest
+// such digits if there is a choice), and are laid out like JavaScript's
+// Number.prototype.toString: plain notation for magnitudes in [1e-6, 1e21),
+// and d.ddde+N otherwise. Infinities and NaNs are written as WriteHex does.
+// static
+template <typename T>
+char* FloatWriter<T>::AppendDecimal(char* p, Uint bits) {
+  int exp = ((bits >> Traits::kSigBits) & Traits::kExpMask) - Traits::kExpBias;
+  if (exp == Traits::kMaxExp) {
+    return AppendHex(p, bits);
+  }
+  if (bits >> Traits::kSignShift) {
+    *p++ = '-';
+  }
+  if ((bits & ~(Uint(1) << Traits::kSignShift)) == 0) {
+    *p++ = '0';
+    return p;
+  }
 
-  size_t len = p - buffer;
-  if (len >= size) {
-    len = size - 1;
+  Decimal decimal = ShortestDecimal(bits);
+  char digits[20];
+  int num_digits = 0;
+  for (uint64_t sig = decimal.sig; sig; sig /= 10) {
+    digits[sizeof(digits) - ++num_digits] = '0' + sig % 10;
   }
-  memcpy(out, buffer, len);
-  out[len] = '\0';
+  const char* first = digits + sizeof(digits) - num_digits;
+  // The value is 0.ddd * 10^point.
+  int point = decimal.exp + num_digits;
+
+  if (num_digits <= point && point <= 21) {
+    // ddd000
+    memcpy(p, first, num_digits);
+    p += num_digits;
+    memset(p, '0', point - num_digits);
+    p += point - num_digits;
+  } else if (0 < point && point <= 21) {
+    // dd.ddd
+    memcpy(p, first, point);
+    p += point;
+    *p++ = '.';
+    memcpy(p, first + point, num_digits - point);
+    p += num_digits - point;
+  } else if (-6 < point && point <= 0) {
+    // 0.000ddd
+    *p++ = '0';
+    *p++ = '.';
+    memset(p, '0', -point);
+    p += -point;
+    memcpy(p, first, num_digits);
+    p += num_digits;
+  } else {
+    // d.ddde+N
+    *p++ = first[0];
+    if (num_digits > 1) {
+      *p++ = '.';
+      memcpy(p, first + 1, num_digits - 1);
+      p += num_digits - 1;
+    }
+    int exp10 = point - 1;
+    *p++ = 'e';
+    if (exp10 < 0) {
+      *p++ = '-';
+      exp10 = -exp10;
+    } else {
+      *p++ = '+';
+    }
+    if (exp10 >= 100) {
+      *p++ = '0' + exp10 / 100;
+    }
+    if (exp10 >= 10) {
+      *p++ = '0' + (exp10 / 10) % 10;
+    }
+    *p++ = '0' + exp10 % 10;
+  }
+  return p;
 }
 
 }  // end anonymous namespace
@@ -791,6 +1493,14 @@ void WriteDoubleHex(char* buffer, size_t size, uint64_t bits) {
   return FloatWriter<double>::WriteHex(buffer, size, bits);
 }
 
+void WriteFloatDecimal(char* buffer, size_t size, uint32_t bits) {
+  return FloatWriter<float>::WriteDecimal(buffer, size, bits);
+}
+
+void WriteDoubleDecimal(char* buffer, size_t size, uint64_t bits) {
+  return FloatWriter<double>::WriteDecimal(buffer, size, bits);
+}
+
 void WriteUint128(char* buffer, size_t size, v128 bits) {
   uint64_t digits;
   uint64_t remainder;
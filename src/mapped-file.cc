@@ -0,0 +1,70 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/mapped-file.h"
+
+#include <string>
+
+#include "wabt/config.h"
+
+#if HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace wabt {
+
+MappedFile::~MappedFile() {
+#if HAVE_SYS_MMAN_H
+  if (mapped_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+#endif
+}
+
+Result MappedFile::Open(std::string_view filename) {
+#if HAVE_SYS_MMAN_H
+  std::string filename_str(filename);
+  int fd = open(filename_str.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) == 0 && S_ISREG(statbuf.st_mode) &&
+        statbuf.st_size > 0) {
+      void* addr =
+          mmap(nullptr, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data_ = static_cast<const uint8_t*>(addr);
+        size_ = statbuf.st_size;
+        mapped_ = true;
+      }
+    }
+    close(fd);
+    if (mapped_) {
+      return Result::Ok;
+    }
+  }
+#endif
+
+  // Reading the file also reports why it can't be opened.
+  CHECK_RESULT(ReadFile(filename, &buffer_));
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  return Result::Ok;
+}
+
+}  // namespace wabt
@@ -0,0 +1,460 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/memory-stats.h"
+
+#include <cinttypes>
+
+#include "wabt/cast.h"
+#include "wabt/ir.h"
+#include "wabt/stream.h"
+
+namespace wabt {
+
+void MemoryStats::Add(std::string_view name, uint64_t bytes, uint64_t count) {
+  for (Category& category : categories_) {
+    if (category.name == name) {
+      category.bytes += bytes;
+      category.count += count;
+      return;
+    }
+  }
+  Category category;
+  category.name = name;
+  category.bytes = bytes;
+  category.count = count;
+  categories_.push_back(std::move(category));
+}
+
+const MemoryStats::Category* MemoryStats::Find(std::string_view name) const {
+  for (const Category& category : categories_) {
+    if (category.name == name) {
+      return &category;
+    }
+  }
+  return nullptr;
+}
+
+uint64_t MemoryStats::total_bytes() const {
+  uint64_t total = 0;
+  for (const Category& category : categories_) {
+    total += category.bytes;
+  }
+  return total;
+}
+
+void MemoryStats::Print(Stream* stream) const {
+  stream->Writef("%12s %10s  %s\n", "bytes", "count", "category");
+  for (const Category& category : categories_) {
+    stream->Writef("%12" PRIu64 " %10" PRIu64 "  %s\n", category.bytes,
+                   category.count, category.name.c_str());
+  }
+  stream->Writef("%12" PRIu64 " %10s  %s\n", total_bytes(), "", "total");
+}
+
+// static
+uint64_t MemoryStats::HeapBytes(const std::string& str) {
+  // Strings that fit in the small string buffer don't allocate.
+  static const size_t kInlineCapacity = std::string().capacity();
+  return str.capacity() > kInlineCapacity ? str.capacity() + 1 : 0;
+}
+
+// static
+uint64_t MemoryStats::HashHeapBytes(size_t size,
+                                    size_t bucket_count,
+                                    size_t value_size) {
+  return size * (value_size + sizeof(void*) + sizeof(size_t)) +
+         bucket_count * sizeof(void*);
+}
+
+// static
+uint64_t MemoryStats::TreeHeapBytes(size_t size, size_t value_size) {
+  return size * (value_size + 4 * sizeof(void*));
+}
+
+namespace {
+
+class ModuleAccounter {
+ public:
+  explicit ModuleAccounter(MemoryStats* stats) : stats_(stats) {}
+
+  void Account(const Module&);
+
+ private:
+  static size_t ExprSize(const Expr&);
+
+  void AccountExprs(const ExprList&);
+  void AccountBlock(const Block&);
+  void AccountName(const std::string&);
+  void AccountBindings(const BindingHash&);
+  uint64_t SignatureHeapBytes(const FuncSignature&);
+  void AccountFunc(const Func&);
+  void AccountField(const ModuleField&);
+  void AccountImport(const Import&);
+
+  MemoryStats* stats_;
+};
+
+// static
+size_t ModuleAccounter::ExprSize(const Expr& expr) {
+  switch (expr.type()) {
+#define WABT_EXPR_SIZE(Name) \
+  case ExprType::Name:       \
+    return sizeof(Name##Expr);
+    WABT_EXPR_SIZE(AtomicLoad)
+    WABT_EXPR_SIZE(AtomicRmw)
+    WABT_EXPR_SIZE(AtomicRmwCmpxchg)
+    WABT_EXPR_SIZE(AtomicStore)
+    WABT_EXPR_SIZE(AtomicNotify)
+    WABT_EXPR_SIZE(AtomicFence)
+    WABT_EXPR_SIZE(AtomicWait)
+    WABT_EXPR_SIZE(Binary)
+    WABT_EXPR_SIZE(Block)
+    WABT_EXPR_SIZE(Br)
+    WABT_EXPR_SIZE(BrIf)
+    WABT_EXPR_SIZE(BrTable)
+    WABT_EXPR_SIZE(Call)
+    WABT_EXPR_SIZE(CallIndirect)
+    WABT_EXPR_SIZE(CallRef)
+    WABT_EXPR_SIZE(CodeMetadata)
+    WABT_EXPR_SIZE(Compare)
+    WABT_EXPR_SIZE(Const)
+    WABT_EXPR_SIZE(Convert)
+    WABT_EXPR_SIZE(Drop)
+    WABT_EXPR_SIZE(GlobalGet)
+    WABT_EXPR_SIZE(GlobalSet)
+    WABT_EXPR_SIZE(If)
+    WABT_EXPR_SIZE(Load)
+    WABT_EXPR_SIZE(LocalGet)
+    WABT_EXPR_SIZE(LocalSet)
+    WABT_EXPR_SIZE(LocalTee)
+    WABT_EXPR_SIZE(Loop)
+    WABT_EXPR_SIZE(MemoryCopy)
+    WABT_EXPR_SIZE(DataDrop)
+    WABT_EXPR_SIZE(MemoryFill)
+    WABT_EXPR_SIZE(MemoryGrow)
+    WABT_EXPR_SIZE(MemoryInit)
+    WABT_EXPR_SIZE(MemorySize)
+    WABT_EXPR_SIZE(Nop)
+    WABT_EXPR_SIZE(RefIsNull)
+    WABT_EXPR_SIZE(RefFunc)
+    WABT_EXPR_SIZE(RefNull)
+    WABT_EXPR_SIZE(Rethrow)
+    WABT_EXPR_SIZE(Return)
+    WABT_EXPR_SIZE(ReturnCall)
+    WABT_EXPR_SIZE(ReturnCallIndirect)
+    WABT_EXPR_SIZE(Select)
+    WABT_EXPR_SIZE(SimdLaneOp)
+    WABT_EXPR_SIZE(SimdLoadLane)
+    WABT_EXPR_SIZE(SimdStoreLane)
+    WABT_EXPR_SIZE(SimdShuffleOp)
+    WABT_EXPR_SIZE(LoadSplat)
+    WABT_EXPR_SIZE(LoadZero)
+    WABT_EXPR_SIZE(Store)
+    WABT_EXPR_SIZE(TableCopy)
+    WABT_EXPR_SIZE(ElemDrop)
+    WABT_EXPR_SIZE(TableInit)
+    WABT_EXPR_SIZE(TableGet)
+    WABT_EXPR_SIZE(TableGrow)
+    WABT_EXPR_SIZE(TableSize)
+    WABT_EXPR_SIZE(TableSet)
+    WABT_EXPR_SIZE(TableFill)
+    WABT_EXPR_SIZE(Ternary)
+    WABT_EXPR_SIZE(Throw)
+    WABT_EXPR_SIZE(Try)
+    WABT_EXPR_SIZE(Unary)
+    WABT_EXPR_SIZE(Unreachable)
+#undef WABT_EXPR_SIZE
+  }
+  WABT_UNREACHABLE;
+}
+
+void ModuleAccounter::AccountExprs(const ExprList& exprs) {
+  for (const Expr& expr : exprs) {
+    uint64_t bytes = ExprSize(expr);
+    switch (expr.type()) {
+      case ExprType::Block:
+        AccountBlock(cast<BlockExpr>(&expr)->block);
+        break;
+
+      case ExprType::Loop:
+        AccountBlock(cast<LoopExpr>(&expr)->block);
+        break;
+
+      case ExprType::If: {
+        auto* if_ = cast<IfExpr>(&expr);
+        AccountBlock(if_->true_);
+        AccountExprs(if_->false_);
+        break;
+      }
+
+      case ExprType::Try: {
+        auto* try_ = cast<TryExpr>(&expr);
+        AccountBlock(try_->block);
+        bytes += MemoryStats::HeapBytes(try_->catches);
+        for (const Catch& catch_ : try_->catches) {
+          AccountExprs(catch_.exprs);
+        }
+        break;
+      }
+
+      case ExprType::BrTable:
+        bytes += MemoryStats::HeapBytes(cast<BrTableExpr>(&expr)->targets);
+        break;
+
+      case ExprType::CallIndirect:
+        bytes += SignatureHeapBytes(cast<CallIndirectExpr>(&expr)->decl.sig);
+        break;
+
+      case ExprType::ReturnCallIndirect:
+        bytes +=
+            SignatureHeapBytes(cast<ReturnCallIndirectExpr>(&expr)->decl.sig);
+        break;
+
+      case ExprType::CodeMetadata:
+        bytes += MemoryStats::HeapBytes(cast<CodeMetadataExpr>(&expr)->data);
+        break;
+
+      default:
+        break;
+    }
+    stats_->Add("ir.exprs", bytes);
+  }
+}
+
+void ModuleAccounter::AccountBlock(const Block& block) {
+  AccountName(block.label);
+  stats_->Add("ir.exprs", SignatureHeapBytes(block.decl.sig), 0);
+  AccountExprs(block.exprs);
+}
+
+void ModuleAccounter::AccountName(const std::string& name) {
+  if (uint64_t bytes = MemoryStats::HeapBytes(name)) {
+    stats_->Add("ir.names", bytes);
+  }
+}
+
+void ModuleAccounter::AccountBindings(const BindingHash& bindings) {
+  uint64_t bytes = MemoryStats::HashHeapBytes(
+      bindings.size(), bindings.bucket_count(),
+      sizeof(BindingHash::value_type));
+  for (const auto& [name, binding] : bindings) {
+    bytes += MemoryStats::HeapBytes(name);
+  }
+  stats_->Add("ir.bindings", bytes, bindings.size());
+}
+
+uint64_t ModuleAccounter::SignatureHeapBytes(const FuncSignature& sig) {
+  return MemoryStats::HeapBytes(sig.param_types) +
+         MemoryStats::HeapBytes(sig.result_types) +
+         MemoryStats::HeapBytes(sig.param_type_names) +
+         MemoryStats::HeapBytes(sig.result_type_names);
+}
+
+void ModuleAccounter::AccountFunc(const Func& func) {
+  AccountName(func.name);
+  stats_->Add("ir.funcs",
+              SignatureHeapBytes(func.decl.sig) +
+                  MemoryStats::HeapBytes(func.local_types.decls()),
+              0);
+  AccountBindings(func.bindings);
+  AccountExprs(func.exprs);
+}
+
+void ModuleAccounter::AccountImport(const Import& import) {
+  AccountName(import.module_name);
+  AccountName(import.field_name);
+  switch (import.kind()) {
+    case ExternalKind::Func:
+      stats_->Add("ir.imports", sizeof(FuncImport));
+      AccountFunc(cast<FuncImport>(&import)->func);
+      break;
+
+    case ExternalKind::Table:
+      stats_->Add("ir.imports", sizeof(TableImport));
+      AccountName(cast<TableImport>(&import)->table.name);
+      break;
+
+    case ExternalKind::Memory:
+      stats_->Add("ir.imports", sizeof(MemoryImport));
+      AccountName(cast<MemoryImport>(&import)->memory.name);
+      break;
+
+    case ExternalKind::Global: {
+      auto* global = &cast<GlobalImport>(&import)->global;
+      stats_->Add("ir.imports", sizeof(GlobalImport));
+      AccountName(global->name);
+      AccountExprs(global->init_expr);
+      break;
+    }
+
+    case ExternalKind::Tag: {
+      auto* tag = &cast<TagImport>(&import)->tag;
+      stats_->Add("ir.imports",
+                  sizeof(TagImport) + SignatureHeapBytes(tag->decl.sig));
+      AccountName(tag->name);
+      break;
+    }
+  }
+}
+
+void ModuleAccounter::AccountField(const ModuleField& field) {
+  switch (field.type()) {
+    case ModuleFieldType::Func:
+      stats_->Add("ir.funcs", sizeof(FuncModuleField));
+      AccountFunc(cast<FuncModuleField>(&field)->func);
+      break;
+
+    case ModuleFieldType::Global: {
+      auto* global = &cast<GlobalModuleField>(&field)->global;
+      stats_->Add("ir.globals", sizeof(GlobalModuleField));
+      AccountName(global->name);
+      AccountExprs(global->init_expr);
+      break;
+    }
+
+    case ModuleFieldType::Import: {
+      auto* import = cast<ImportModuleField>(&field)->import.get();
+      stats_->Add("ir.imports", sizeof(ImportModuleField), 0);
+      AccountImport(*import);
+      break;
+    }
+
+    case ModuleFieldType::Export: {
+      auto* export_ = &cast<ExportModuleField>(&field)->export_;
+      stats_->Add("ir.exports", sizeof(ExportModuleField));
+      AccountName(export_->name);
+      break;
+    }
+
+    case ModuleFieldType::Type: {
+      auto* entry = cast<TypeModuleField>(&field)->type.get();
+      uint64_t bytes = sizeof(TypeModuleField);
+      AccountName(entry->name);
+      switch (entry->kind()) {
+        case TypeEntryKind::Func:
+          bytes += sizeof(FuncType) +
+                   SignatureHeapBytes(cast<FuncType>(entry)->sig);
+          break;
+
+        case TypeEntryKind::Struct: {
+          auto* struct_ = cast<StructType>(entry);
+          bytes += sizeof(StructType) + MemoryStats::HeapBytes(struct_->fields);
+          for (const Field& struct_field : struct_->fields) {
+            AccountName(struct_field.name);
+          }
+          break;
+        }
+
+        case TypeEntryKind::Array:
+          bytes += sizeof(ArrayType);
+          AccountName(cast<ArrayType>(entry)->field.name);
+          break;
+      }
+      stats_->Add("ir.types", bytes);
+      break;
+    }
+
+    case ModuleFieldType::Table:
+      stats_->Add("ir.tables", sizeof(TableModuleField));
+      AccountName(cast<TableModuleField>(&field)->table.name);
+      break;
+
+    case ModuleFieldType::ElemSegment: {
+      auto* segment = &cast<ElemSegmentModuleField>(&field)->elem_segment;
+      stats_->Add("ir.elem_segments",
+                  sizeof(ElemSegmentModuleField) +
+                      MemoryStats::HeapBytes(segment->elem_exprs));
+      AccountName(segment->name);
+      AccountExprs(segment->offset);
+      for (const ExprList& exprs : segment->elem_exprs) {
+        AccountExprs(exprs);
+      }
+      break;
+    }
+
+    case ModuleFieldType::Memory:
+      stats_->Add("ir.memories", sizeof(MemoryModuleField));
+      AccountName(cast<MemoryModuleField>(&field)->memory.name);
+      break;
+
+    case ModuleFieldType::DataSegment: {
+      auto* segment = &cast<DataSegmentModuleField>(&field)->data_segment;
+      stats_->Add("ir.data_segments",
+                  sizeof(DataSegmentModuleField) +
+                      MemoryStats::HeapBytes(segment->data));
+      AccountName(segment->name);
+      AccountExprs(segment->offset);
+      break;
+    }
+
+    case ModuleFieldType::Start:
+      stats_->Add("ir.module", sizeof(StartModuleField), 0);
+      break;
+
+    case ModuleFieldType::Tag: {
+      auto* tag = &cast<TagModuleField>(&field)->tag;
+      stats_->Add("ir.tags",
+                  sizeof(TagModuleField) + SignatureHeapBytes(tag->decl.sig));
+      AccountName(tag->name);
+      break;
+    }
+  }
+}
+
+void ModuleAccounter::Account(const Module& module) {
+  // The module itself and its index vectors, whose pointers are shared with
+  // the fields.
+  stats_->Add("ir.module",
+              sizeof(Module) + MemoryStats::HeapBytes(module.tags) +
+                  MemoryStats::HeapBytes(module.funcs) +
+                  MemoryStats::HeapBytes(module.globals) +
+                  MemoryStats::HeapBytes(module.imports) +
+                  MemoryStats::HeapBytes(module.exports) +
+                  MemoryStats::HeapBytes(module.types) +
+                  MemoryStats::HeapBytes(module.tables) +
+                  MemoryStats::HeapBytes(module.elem_segments) +
+                  MemoryStats::HeapBytes(module.memories) +
+                  MemoryStats::HeapBytes(module.data_segments) +
+                  MemoryStats::HeapBytes(module.starts) +
+                  MemoryStats::HeapBytes(module.customs));
+  AccountName(module.name);
+
+  for (const ModuleField& field : module.fields) {
+    AccountField(field);
+  }
+
+  for (const Custom& custom : module.customs) {
+    stats_->Add("ir.customs", MemoryStats::HeapBytes(custom.data));
+    AccountName(custom.name);
+  }
+
+  for (const BindingHash* bindings :
+       {&module.tag_bindings, &module.func_bindings, &module.global_bindings,
+        &module.export_bindings, &module.type_bindings, &module.table_bindings,
+        &module.memory_bindings, &module.data_segment_bindings,
+        &module.elem_segment_bindings}) {
+    AccountBindings(*bindings);
+  }
+}
+
+}  // end anonymous namespace
+
+void AccountMemory(const Module& module, MemoryStats* stats) {
+  ModuleAccounter(stats).Account(module);
+}
+
+}  // namespace wabt
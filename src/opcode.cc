@@ -62,6 +62,9 @@ Address Opcode::GetAlignment(Address alignment) const {
 }
 
 bool Opcode::IsEnabled(const Features& features) const {
+  if (GetPrefix() == kInterpPrefix) {
+    return false;
+  }
   switch (enum_) {
     case Opcode::Try:
     case Opcode::Catch:
@@ -366,6 +369,7 @@ bool Opcode::IsEnabled(const Features& features) const {
     case Opcode::InterpCallImport:
     case Opcode::InterpData:
     case Opcode::InterpDropKeep:
+    case Opcode::InterpLocalCopy:
       return false;
 
     default:
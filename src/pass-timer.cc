@@ -0,0 +1,107 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/pass-timer.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "wabt/stream.h"
+
+#if HAVE_UNISTD_H
+#include <sys/resource.h>
+#endif
+
+namespace wabt {
+
+PassTimer::Scope::Scope(PassTimer* timer, std::string_view name)
+    : timer_(timer) {
+  if (!timer_) {
+    return;
+  }
+
+  index_ = timer_->records_.size();
+  Record record;
+  record.name = name;
+  record.depth = timer_->depth_++;
+  timer_->records_.push_back(std::move(record));
+  wall_start_ = std::chrono::steady_clock::now();
+  cpu_start_ = std::clock();
+}
+
+void PassTimer::Scope::Stop() {
+  if (!timer_) {
+    return;
+  }
+
+  std::clock_t cpu_end = std::clock();
+  auto wall_end = std::chrono::steady_clock::now();
+  Record& record = timer_->records_[index_];
+  record.wall_seconds =
+      std::chrono::duration<double>(wall_end - wall_start_).count();
+  record.cpu_seconds = static_cast<double>(cpu_end - cpu_start_) /
+                       static_cast<double>(CLOCKS_PER_SEC);
+  record.peak_rss_bytes = GetPeakRss();
+  timer_->depth_--;
+  timer_ = nullptr;
+}
+
+void PassTimer::Print(Stream* stream) const {
+  stream->Writef("%10s %10s %12s  %s\n", "wall (s)", "cpu (s)", "peak RSS",
+                 "phase");
+  for (const Record& record : records_) {
+    stream->Writef("%10.4f %10.4f %9" PRIu64 " KB  %*s%s\n",
+                   record.wall_seconds, record.cpu_seconds,
+                   record.peak_rss_bytes / 1024, record.depth * 2, "",
+                   record.name.c_str());
+  }
+}
+
+// static
+uint64_t PassTimer::GetPeakRss() {
+#if defined(__linux__)
+  // ru_maxrss survives exec, so a process started by a large parent would
+  // report the parent's peak. VmHWM belongs to this address space only.
+  if (FILE* file = fopen("/proc/self/status", "r")) {
+    char line[128];
+    unsigned long long kilobytes = 0;
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), file)) {
+      found = sscanf(line, "VmHWM: %llu kB", &kilobytes) == 1;
+    }
+    fclose(file);
+    if (found) {
+      return static_cast<uint64_t>(kilobytes) * 1024;
+    }
+  }
+#endif
+#if HAVE_UNISTD_H
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  // macOS reports bytes; everyone else reports kilobytes.
+  return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+}  // namespace wabt
@@ -160,6 +160,78 @@ R"w2c_template(
 R"w2c_template(#endif
 )w2c_template"
 R"w2c_template(
+#if WASM_RT_FRAME_CHAIN
+)w2c_template"
+R"w2c_template(#if defined(__GNUC__) || defined(__clang__)
+)w2c_template"
+R"w2c_template(#define FRAME_CHAIN_FENCE() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+)w2c_template"
+R"w2c_template(#else
+)w2c_template"
+R"w2c_template(#define FRAME_CHAIN_FENCE() (void)0
+)w2c_template"
+R"w2c_template(#endif
+)w2c_template"
+R"w2c_template(
+// The frame is filled in before it is published, so a signal handler walking
+)w2c_template"
+R"w2c_template(// the chain never sees a partially initialized frame.
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_FIELD wasm_rt_frame_t frame;
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_ENTER(module, name, index) \
+)w2c_template"
+R"w2c_template(  do {                                        \
+)w2c_template"
+R"w2c_template(    l->frame.parent = wasm_rt_frame_chain;    \
+)w2c_template"
+R"w2c_template(    l->frame.module_name = module;            \
+)w2c_template"
+R"w2c_template(    l->frame.func_name = name;                \
+)w2c_template"
+R"w2c_template(    l->frame.func_index = index;              \
+)w2c_template"
+R"w2c_template(    l->frame.offset = 0;                      \
+)w2c_template"
+R"w2c_template(    FRAME_CHAIN_FENCE();                      \
+)w2c_template"
+R"w2c_template(    wasm_rt_frame_chain = &l->frame;          \
+)w2c_template"
+R"w2c_template(  } while (0)
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_EXIT() (wasm_rt_frame_chain = l->frame.parent)
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_RESUME() (wasm_rt_frame_chain = &l->frame)
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_AT(off) (l->frame.offset = (off))
+)w2c_template"
+R"w2c_template(#define PROFILE_COUNT_STACK(func) \
+)w2c_template"
+R"w2c_template(  wasm_rt_profile_count_stack(&l->instance->profile_stacks, func)
+)w2c_template"
+R"w2c_template(#define PROFILE_FREE_STACKS() \
+)w2c_template"
+R"w2c_template(  wasm_rt_profile_free_stacks(&instance->profile_stacks)
+)w2c_template"
+R"w2c_template(#else
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_FIELD
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_ENTER(module, name, index)
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_EXIT()
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_RESUME()
+)w2c_template"
+R"w2c_template(#define FUNC_FRAME_AT(off)
+)w2c_template"
+R"w2c_template(#define PROFILE_COUNT_STACK(func)
+)w2c_template"
+R"w2c_template(#define PROFILE_FREE_STACKS()
+)w2c_template"
+R"w2c_template(#endif
+)w2c_template"
+R"w2c_template(
 #define UNREACHABLE TRAP(UNREACHABLE)
 )w2c_template"
 R"w2c_template(
@@ -1200,11 +1272,67 @@ R"w2c_template(  RANGE_CHECK(dest, dest_addr, n);
 )w2c_template"
 R"w2c_template(  RANGE_CHECK(src, src_addr, n);
 )w2c_template"
+R"w2c_template(  if (UNLIKELY(n >= WASM_RT_NONTEMPORAL_COPY_THRESHOLD)) {
+)w2c_template"
+R"w2c_template(    wasm_rt_memmove_large(MEM_ADDR(dest, dest_addr, n),
+)w2c_template"
+R"w2c_template(                          MEM_ADDR(src, src_addr, n), n);
+)w2c_template"
+R"w2c_template(    return;
+)w2c_template"
+R"w2c_template(  }
+)w2c_template"
 R"w2c_template(  memmove(MEM_ADDR(dest, dest_addr, n), MEM_ADDR(src, src_addr, n), n);
 )w2c_template"
 R"w2c_template(}
 )w2c_template"
 R"w2c_template(
+// Specialized version of memory_copy, used by wasm2c when the length operand is
+)w2c_template"
+R"w2c_template(// a constant no larger than MEMORY_COPY_CONST_MAX. The length is always a
+)w2c_template"
+R"w2c_template(// literal at the call site, so once inlined the memcpy calls below become a
+)w2c_template"
+R"w2c_template(// fixed sequence of loads and stores.
+)w2c_template"
+R"w2c_template(#define MEMORY_COPY_CONST_MAX 64
+)w2c_template"
+R"w2c_template(
+static inline void memory_copy_const(wasm_rt_memory_t* dest,
+)w2c_template"
+R"w2c_template(                                     const wasm_rt_memory_t* src,
+)w2c_template"
+R"w2c_template(                                     u32 dest_addr,
+)w2c_template"
+R"w2c_template(                                     u32 src_addr,
+)w2c_template"
+R"w2c_template(                                     u32 n) {
+)w2c_template"
+R"w2c_template(  u8 tmp[MEMORY_COPY_CONST_MAX];
+)w2c_template"
+R"w2c_template(  if (dest == src) {
+)w2c_template"
+R"w2c_template(    // A single check of the higher address covers both ranges.
+)w2c_template"
+R"w2c_template(    RANGE_CHECK(dest, (dest_addr > src_addr ? dest_addr : src_addr), n);
+)w2c_template"
+R"w2c_template(  } else {
+)w2c_template"
+R"w2c_template(    RANGE_CHECK(dest, dest_addr, n);
+)w2c_template"
+R"w2c_template(    RANGE_CHECK(src, src_addr, n);
+)w2c_template"
+R"w2c_template(  }
+)w2c_template"
+R"w2c_template(  // Copying through a temporary gives memmove semantics without a call.
+)w2c_template"
+R"w2c_template(  wasm_rt_memcpy(tmp, MEM_ADDR(src, src_addr, n), n);
+)w2c_template"
+R"w2c_template(  wasm_rt_memcpy(MEM_ADDR(dest, dest_addr, n), tmp, n);
+)w2c_template"
+R"w2c_template(}
+)w2c_template"
+R"w2c_template(
 static inline void memory_init(wasm_rt_memory_t* dest,
 )w2c_template"
 R"w2c_template(                               const u8* src,
@@ -1339,6 +1467,19 @@ R"w2c_template(  memset((unsigned char *) dest->data + dest_addr, 0, n);
 R"w2c_template(}
 )w2c_template"
 R"w2c_template(
+// Bounds check for an active elem segment whose copy into a module-private
+)w2c_template"
+R"w2c_template(// table is deferred until the table is first accessed.
+)w2c_template"
+R"w2c_template(static inline void table_init_check(u32 table_size, u32 dest_addr, u32 n) {
+)w2c_template"
+R"w2c_template(  if (UNLIKELY(dest_addr + (uint64_t)n > table_size))
+)w2c_template"
+R"w2c_template(    TRAP(OOB);
+)w2c_template"
+R"w2c_template(}
+)w2c_template"
+R"w2c_template(
 #define DEFINE_TABLE_COPY(type)                                              \
 )w2c_template"
 R"w2c_template(  static inline void type##_table_copy(wasm_rt_##type##_table_t* dest,       \
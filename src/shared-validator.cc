@@ -56,10 +56,10 @@ Result SharedValidator::OnFuncType(const Location& loc,
                          "multiple result values are not supported without "
                          "multi-value enabled.");
   }
-  func_types_.emplace(
-      num_types_++,
-      FuncType{ToTypeVector(param_count, param_types),
-               ToTypeVector(result_count, result_types), type_index});
+  FuncTypeTable::Id id =
+      func_type_table_.Intern(ToTypeVector(param_count, param_types),
+                              ToTypeVector(result_count, result_types));
+  func_types_.emplace(num_types_++, FuncType{id, type_index});
   return result;
 }
 
@@ -189,10 +189,10 @@ Result SharedValidator::OnTag(const Location& loc, Var sig_var) {
   Result result = Result::Ok;
   FuncType type;
   result |= CheckFuncTypeIndex(sig_var, &type);
-  if (!type.results.empty()) {
+  if (!GetResults(type).empty()) {
     result |= PrintError(loc, "Tag signature must have 0 results.");
   }
-  tags_.push_back(TagType{type.params});
+  tags_.push_back(TagType{GetParams(type)});
   return result;
 }
 
@@ -240,10 +240,10 @@ Result SharedValidator::OnStart(const Location& loc, Var func_var) {
   }
   FuncType func_type;
   result |= CheckFuncIndex(func_var, &func_type);
-  if (func_type.params.size() != 0) {
+  if (GetParams(func_type).size() != 0) {
     result |= PrintError(loc, "start function must be nullary");
   }
-  if (func_type.results.size() != 0) {
+  if (GetResults(func_type).size() != 0) {
     result |= PrintError(loc, "start function must not return anything");
   }
   return result;
@@ -405,15 +405,16 @@ Result SharedValidator::CheckBlockSignature(const Location& loc,
     FuncType func_type;
     result |= CheckFuncTypeIndex(Var(sig_index, loc), &func_type);
 
-    if (!func_type.params.empty() && !options_.features.multi_value_enabled()) {
+    if (!GetParams(func_type).empty() &&
+        !options_.features.multi_value_enabled()) {
       result |= PrintError(loc, "%s params not currently supported.",
                            opcode.GetName());
     }
     // Multiple results without --enable-multi-value is checked above in
     // OnType.
 
-    *out_param_types = func_type.params;
-    *out_result_types = func_type.results;
+    *out_param_types = GetParams(func_type);
+    *out_result_types = GetResults(func_type);
   } else {
     out_param_types->clear();
     *out_result_types = sig_type.GetInlineVector();
@@ -443,11 +444,11 @@ Result SharedValidator::BeginFunctionBody(const Location& loc,
   expr_loc_ = loc;
   locals_.clear();
   if (func_index < funcs_.size()) {
-    for (Type type : funcs_[func_index].params) {
+    for (Type type : GetParams(funcs_[func_index])) {
       // TODO: Coalesce parameters of the same type?
       locals_.push_back(LocalDecl{type, GetLocalCount() + 1});
     }
-    return typechecker_.BeginFunction(funcs_[func_index].results);
+    return typechecker_.BeginFunction(GetResults(funcs_[func_index]));
   } else {
     // Signature isn't available, use empty.
     return typechecker_.BeginFunction(TypeVector());
@@ -700,7 +701,8 @@ Result SharedValidator::OnCall(const Location& loc, Var func_var) {
   Result result = CheckInstr(Opcode::Call, loc);
   FuncType func_type;
   result |= CheckFuncIndex(func_var, &func_type);
-  result |= typechecker_.OnCall(func_type.params, func_type.results);
+  result |=
+      typechecker_.OnCall(GetParams(func_type), GetResults(func_type));
   return result;
 }
 
@@ -712,8 +714,8 @@ Result SharedValidator::OnCallIndirect(const Location& loc,
   TableType table_type;
   result |= CheckFuncTypeIndex(sig_var, &func_type);
   result |= CheckTableIndex(table_var, &table_type);
-  result |= typechecker_.OnCallIndirect(func_type.params, func_type.results,
-                                        table_type.limits);
+  result |= typechecker_.OnCallIndirect(
+      GetParams(func_type), GetResults(func_type), table_type.limits);
   return result;
 }
 
@@ -727,7 +729,8 @@ Result SharedValidator::OnCallRef(const Location& loc,
   }
   FuncType func_type;
   result |= CheckFuncTypeIndex(Var(func_index, loc), &func_type);
-  result |= typechecker_.OnCall(func_type.params, func_type.results);
+  result |=
+      typechecker_.OnCall(GetParams(func_type), GetResults(func_type));
   if (Succeeded(result)) {
     *function_type_index = func_index;
   }
@@ -1020,7 +1023,8 @@ Result SharedValidator::OnReturnCall(const Location& loc, Var func_var) {
   Result result = CheckInstr(Opcode::ReturnCall, loc);
   FuncType func_type;
   result |= CheckFuncIndex(func_var, &func_type);
-  result |= typechecker_.OnReturnCall(func_type.params, func_type.results);
+  result |=
+      typechecker_.OnReturnCall(GetParams(func_type), GetResults(func_type));
   return result;
 }
 
@@ -1031,8 +1035,8 @@ Result SharedValidator::OnReturnCallIndirect(const Location& loc,
   result |= CheckTableIndex(table_var);
   FuncType func_type;
   result |= CheckFuncTypeIndex(sig_var, &func_type);
-  result |=
-      typechecker_.OnReturnCallIndirect(func_type.params, func_type.results);
+  result |= typechecker_.OnReturnCallIndirect(GetParams(func_type),
+                                              GetResults(func_type));
   return result;
 }
 
@@ -14,7 +14,12 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -262,3 +267,215 @@ class ManyDoublesRoundtripTest : public ThreadedTest {
 TEST_F(ManyDoublesRoundtripTest, Run) {
   RunThreads();
 }
+
+/* shortest decimal literals */
+class AllFloatsDecimalRoundtripTest : public ThreadedTest {
+ protected:
+  virtual void RunShard(int shard) {
+    char buffer[WABT_MAX_FLOAT_DECIMAL];
+    FOREACH_UINT32(bits) {
+      LOG_COMPLETION(bits);
+      if (is_infinity_or_nan(bits))
+        continue;
+
+      WriteFloatDecimal(buffer, sizeof(buffer), bits);
+      int len = strlen(buffer);
+
+      uint32_t new_bits;
+      ASSERT_EQ(Result::Ok, ParseFloat(LiteralType::Float, buffer,
+                                       buffer + len, &new_bits));
+      ASSERT_EQ(new_bits, bits) << buffer;
+    }
+    LOG_DONE();
+  }
+};
+
+TEST_F(AllFloatsDecimalRoundtripTest, Run) {
+  RunThreads();
+}
+
+class ManyDoublesDecimalRoundtripTest : public ThreadedTest {
+ protected:
+  virtual void RunShard(int shard) {
+    char buffer[WABT_MAX_DOUBLE_DECIMAL];
+    FOREACH_UINT32(halfbits) {
+      LOG_COMPLETION(halfbits);
+      uint64_t bits = (static_cast<uint64_t>(halfbits) << 32) | halfbits;
+      if (is_infinity_or_nan(bits))
+        continue;
+
+      WriteDoubleDecimal(buffer, sizeof(buffer), bits);
+      int len = strlen(buffer);
+
+      uint64_t new_bits;
+      ASSERT_EQ(Result::Ok, ParseDouble(LiteralType::Float, buffer,
+                                        buffer + len, &new_bits));
+      ASSERT_EQ(new_bits, bits) << buffer;
+    }
+    LOG_DONE();
+  }
+};
+
+TEST_F(ManyDoublesDecimalRoundtripTest, Run) {
+  RunThreads();
+}
+
+/* decimal literals */
+class RandomDecimalParseTest : public ThreadedTest {
+ protected:
+  static constexpr int kLiteralsPerShard = 1 << 20;
+
+  virtual void SetUp() {
+    ThreadedTest::SetUp();
+    wabt_nanos_.assign(num_threads_, 0);
+    strto_nanos_.assign(num_threads_, 0);
+    sinks_.assign(num_threads_, 0);
+  }
+
+  // Literals in the shapes wat files contain (short and %g-style), plus long
+  // digit strings and values just around the halfway point between two
+  // floats, which exercise the slow path.
+  static std::string RandomLiteral(std::mt19937_64& rng) {
+    char buffer[100];
+    std::string result = rng() % 4 ? "" : "-";
+    switch (rng() % 5) {
+      case 0: {
+        double value = bit_cast<double>(rng() & 0x7fefffffffffffffull);
+        snprintf(buffer, sizeof(buffer), "%.*g", int(rng() % 20) + 1, value);
+        return result + buffer;
+      }
+
+      case 1: {
+        float value = bit_cast<float>(uint32_t(rng()) & 0x7f7fffff);
+        snprintf(buffer, sizeof(buffer), "%.*g", int(rng() % 12) + 1,
+                 static_cast<double>(value));
+        return result + buffer;
+      }
+
+      case 2: {
+        int num_digits = rng() % 40 + 1;
+        for (int i = 0; i < num_digits; ++i) {
+          result += static_cast<char>('0' + rng() % 10);
+          if (rng() % 8 == 0) {
+            result += '_';
+          }
+        }
+        if (result.back() == '_') {
+          result.pop_back();
+        }
+        if (rng() % 2) {
+          snprintf(buffer, sizeof(buffer), "e%d", int(rng() % 700) - 350);
+          result += buffer;
+        }
+        return result;
+      }
+
+      case 3: {
+        // Halfway between two floats is exactly representable as a double.
+        float lo = bit_cast<float>(uint32_t(rng()) & 0x7f7ffffe);
+        float hi = std::nextafter(lo, std::numeric_limits<float>::infinity());
+        double mid = (static_cast<double>(lo) + hi) / 2;
+        snprintf(buffer, sizeof(buffer), "%.*g", int(rng() % 15) + 8, mid);
+        return result + buffer;
+      }
+
+      default:
+        snprintf(buffer, sizeof(buffer), "%d.%de%d", int(rng() % 100000),
+                 int(rng() % 1000), int(rng() % 80) - 40);
+        return result + buffer;
+    }
+  }
+
+  template <typename T, typename U>
+  static bool StrtoParse(const std::string& literal, U* out_bits) {
+    std::string copy;
+    for (char c : literal) {
+      if (c != '_') {
+        copy += c;
+      }
+    }
+    char* endptr;
+    T value = sizeof(T) == 4 ? strtof(copy.c_str(), &endptr)
+                             : strtod(copy.c_str(), &endptr);
+    if (*endptr || std::isinf(value)) {
+      return false;
+    }
+    *out_bits = bit_cast<U>(value);
+    return true;
+  }
+
+  virtual void RunShard(int shard) {
+    std::mt19937_64 rng(shard);
+    std::vector<std::string> literals;
+    for (int i = 0; i < kLiteralsPerShard; ++i) {
+      literals.push_back(RandomLiteral(rng));
+    }
+
+    for (const std::string& literal : literals) {
+      const char* s = literal.data();
+      const char* end = s + literal.size();
+      uint32_t float_bits, them_float_bits;
+      bool them_ok = StrtoParse<float>(literal, &them_float_bits);
+      ASSERT_EQ(them_ok ? Result::Ok : Result::Error,
+                ParseFloat(LiteralType::Float, s, end, &float_bits))
+          << literal;
+      if (them_ok) {
+        ASSERT_EQ(them_float_bits, float_bits) << literal;
+      }
+
+      uint64_t double_bits, them_double_bits;
+      them_ok = StrtoParse<double>(literal, &them_double_bits);
+      ASSERT_EQ(them_ok ? Result::Ok : Result::Error,
+                ParseDouble(LiteralType::Float, s, end, &double_bits))
+          << literal;
+      if (them_ok) {
+        ASSERT_EQ(them_double_bits, double_bits) << literal;
+      }
+    }
+
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& literal : literals) {
+      uint64_t bits = 0;
+      ParseDouble(LiteralType::Float, literal.data(),
+                  literal.data() + literal.size(), &bits);
+      sink += bits;
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (const std::string& literal : literals) {
+      uint64_t bits = 0;
+      StrtoParse<double>(literal, &bits);
+      sink += bits;
+    }
+    auto stop = std::chrono::steady_clock::now();
+    wabt_nanos_[shard] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             middle - start)
+                             .count();
+    strto_nanos_[shard] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              stop - middle)
+                              .count();
+    // Keep the parses from being optimized away.
+    sinks_[shard] = sink;
+  }
+
+  void PrintThroughput() {
+    double wabt = 0, strto = 0;
+    for (int i = 0; i < num_threads_; ++i) {
+      wabt += wabt_nanos_[i];
+      strto += strto_nanos_[i];
+    }
+    double count = static_cast<double>(kLiteralsPerShard) * num_threads_;
+    printf("%.0f literals: ParseDouble %.1f ns/literal, strtod %.1f "
+           "ns/literal\n",
+           count, wabt / count, strto / count);
+  }
+
+  std::vector<int64_t> wabt_nanos_;
+  std::vector<int64_t> strto_nanos_;
+  std::vector<uint64_t> sinks_;
+};
+
+TEST_F(RandomDecimalParseTest, Run) {
+  RunThreads();
+  PrintThroughput();
+}
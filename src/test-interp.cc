@@ -16,10 +16,17 @@
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "wabt/binary-reader.h"
 #include "wabt/error-formatter.h"
+#include "wabt/memory-stats.h"
 
 #include "wabt/interp/binary-reader-interp.h"
+#include "wabt/interp/interp-jit.h"
+#include "wabt/interp/interp-tier-up.h"
 #include "wabt/interp/interp.h"
 
 using namespace wabt;
@@ -376,6 +383,281 @@ TEST_F(InterpTest, HostFunc_PingPong_SameThread) {
   EXPECT_EQ(11u, results[0].Get<u32>());
 }
 
+namespace {
+
+// (import "" "read" (func $read (param i32) (result i32)))
+// (func (export "f") (param i32) (result i32)
+//   (i32.add (call $read (local.get 0)) (call $read (i32.const 10))))
+const std::vector<u8> s_async_module = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01,
+    0x60, 0x01, 0x7f, 0x01, 0x7f, 0x02, 0x09, 0x01, 0x00, 0x04, 0x72,
+    0x65, 0x61, 0x64, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0x07, 0x05,
+    0x01, 0x01, 0x66, 0x00, 0x01, 0x0a, 0x0d, 0x01, 0x0b, 0x00, 0x20,
+    0x00, 0x10, 0x00, 0x41, 0x0a, 0x10, 0x00, 0x6a, 0x0b,
+};
+
+// (import "" "read" (func $read (param i32) (result i32)))
+// (func $f (export "f") (param i32) (result i32)
+//   (if (result i32) (local.get 0)
+//     (then (i32.add (call $f (i32.sub (local.get 0) (i32.const 1)))
+//                    (i32.const 1)))
+//     (else (i32.add (call $read (i32.const 0)) (call $read (i32.const 1))))))
+const std::vector<u8> s_async_deep_module = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01,
+    0x60, 0x01, 0x7f, 0x01, 0x7f, 0x02, 0x09, 0x01, 0x00, 0x04, 0x72,
+    0x65, 0x61, 0x64, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0x07, 0x05,
+    0x01, 0x01, 0x66, 0x00, 0x01, 0x0a, 0x1d, 0x01, 0x1b, 0x00, 0x20,
+    0x00, 0x04, 0x7f, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x10, 0x01, 0x41,
+    0x01, 0x6a, 0x05, 0x41, 0x00, 0x10, 0x00, 0x41, 0x01, 0x10, 0x00,
+    0x6a, 0x0b, 0x0b,
+};
+
+}  // namespace
+
+TEST_F(InterpTest, HostFunc_Async) {
+  ReadModule(s_async_module);
+
+  // Suspends, and records what it was asked to read.
+  std::vector<u32> reads;
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [&](Thread& thread, const Values& params, Values& results,
+                        Trap::Ptr* out_trap) -> Result {
+                      reads.push_back(params[0].Get<u32>());
+                      return thread.Suspend();
+                    });
+
+  Instantiate({host_func->self()});
+
+  Thread thread(store_);
+  Values results;
+  Trap::Ptr trap;
+  ASSERT_EQ(RunResult::Suspend, thread.CallAsync(GetFuncExport(0),
+                                                 {Value::Make(5)}, results,
+                                                 &trap));
+  EXPECT_TRUE(thread.suspended());
+  EXPECT_EQ(std::vector<u32>{5}, reads);
+
+  ASSERT_EQ(RunResult::Suspend,
+            thread.Resume({Value::Make(500)}, results, &trap));
+  EXPECT_EQ((std::vector<u32>{5, 10}), reads);
+
+  ASSERT_EQ(RunResult::Return,
+            thread.Resume({Value::Make(1000)}, results, &trap));
+  EXPECT_FALSE(thread.suspended());
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(1500u, results[0].Get<u32>());
+
+  // The host function can also be called directly.
+  ASSERT_EQ(RunResult::Suspend,
+            thread.CallAsync(host_func, {Value::Make(7)}, results, &trap));
+  ASSERT_EQ(RunResult::Return, thread.Resume({Value::Make(8)}, results, &trap));
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(8u, results[0].Get<u32>());
+}
+
+TEST_F(InterpTest, HostFunc_Async_Interleaved) {
+  ReadModule(s_async_module);
+
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [](Thread& thread, const Values& params, Values& results,
+                       Trap::Ptr* out_trap) -> Result {
+                      return thread.Suspend();
+                    });
+
+  Instantiate({host_func->self()});
+
+  // Several guests waiting at once, resumed in turn.
+  const u32 kThreadCount = 3;
+  std::vector<std::unique_ptr<Thread>> threads;
+  Values results;
+  Trap::Ptr trap;
+  for (u32 i = 0; i < kThreadCount; ++i) {
+    threads.push_back(std::make_unique<Thread>(store_));
+    ASSERT_EQ(RunResult::Suspend,
+              threads[i]->CallAsync(GetFuncExport(0), {Value::Make(i)},
+                                    results, &trap));
+  }
+  for (u32 i = 0; i < kThreadCount; ++i) {
+    ASSERT_EQ(RunResult::Suspend,
+              threads[i]->Resume({Value::Make(i * 100)}, results, &trap));
+  }
+  for (u32 i = 0; i < kThreadCount; ++i) {
+    ASSERT_EQ(RunResult::Return,
+              threads[i]->Resume({Value::Make(i)}, results, &trap));
+    EXPECT_EQ(i * 101, results[0].Get<u32>());
+  }
+}
+
+TEST_F(InterpTest, HostFunc_Async_Sync) {
+  ReadModule(s_async_module);
+
+  // Falls back to returning its result right away when it can't suspend.
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [](Thread& thread, const Values& params, Values& results,
+                       Trap::Ptr* out_trap) -> Result {
+                      if (Succeeded(thread.Suspend())) {
+                        return Result::Ok;
+                      }
+                      results[0] = Value::Make(params[0].Get<u32>() * 2);
+                      return Result::Ok;
+                    });
+
+  Instantiate({host_func->self()});
+
+  Values results;
+  Trap::Ptr trap;
+  ASSERT_EQ(Result::Ok, GetFuncExport(0)->Call(store_, {Value::Make(1)},
+                                               results, &trap));
+  EXPECT_EQ(22u, results[0].Get<u32>());
+}
+
+TEST_F(InterpTest, HostFunc_Async_Trap) {
+  ReadModule(s_async_module);
+
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [](Thread& thread, const Values& params, Values& results,
+                       Trap::Ptr* out_trap) -> Result {
+                      return thread.Suspend();
+                    });
+
+  Instantiate({host_func->self()});
+
+  Thread thread(store_);
+  Values results;
+  Trap::Ptr trap;
+  // Each trapped call is unwound; if its frames were left on the thread, the
+  // call stack would run out.
+  for (u32 i = 0; i < Thread::Options::kDefaultCallStackSize; ++i) {
+    ASSERT_EQ(RunResult::Suspend, thread.CallAsync(GetFuncExport(0),
+                                                   {Value::Make(1)}, results,
+                                                   &trap));
+    ASSERT_EQ(RunResult::Trap,
+              thread.ResumeWithTrap(Trap::New(store_, "read failed"), &trap));
+    ASSERT_TRUE(trap);
+    EXPECT_EQ("read failed", trap->message());
+    EXPECT_FALSE(thread.suspended());
+  }
+
+  // And the thread can still finish another call.
+  ASSERT_EQ(RunResult::Suspend, thread.CallAsync(GetFuncExport(0),
+                                                 {Value::Make(2)}, results,
+                                                 &trap));
+  ASSERT_EQ(RunResult::Suspend,
+            thread.Resume({Value::Make(20)}, results, &trap));
+  ASSERT_EQ(RunResult::Return,
+            thread.Resume({Value::Make(30)}, results, &trap));
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(50u, results[0].Get<u32>());
+}
+
+TEST_F(InterpTest, HostFunc_Async_Continuation) {
+  ReadModule(s_async_module);
+
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [](Thread& thread, const Values& params, Values& results,
+                       Trap::Ptr* out_trap) -> Result {
+                      return thread.Suspend();
+                    });
+
+  Instantiate({host_func->self()});
+
+  // Two guests started on one thread, each captured at its first read.
+  Thread thread1(store_);
+  Values results;
+  Trap::Ptr trap;
+  ASSERT_EQ(RunResult::Suspend, thread1.CallAsync(GetFuncExport(0),
+                                                  {Value::Make(1)}, results,
+                                                  &trap));
+  Continuation::Ptr cont1 = thread1.Capture();
+  EXPECT_FALSE(thread1.suspended());
+  ASSERT_EQ(RunResult::Suspend, thread1.CallAsync(GetFuncExport(0),
+                                                  {Value::Make(2)}, results,
+                                                  &trap));
+  Continuation::Ptr cont2 = thread1.Capture();
+
+  // The continuations keep the instance alive.
+  inst_.reset();
+  mod_.reset();
+  store_.Collect();
+
+  // Both are resumed on another thread, interleaved.
+  Thread thread2(store_);
+  ASSERT_EQ(RunResult::Suspend,
+            thread2.Resume(cont2, {Value::Make(200)}, results, &trap));
+  EXPECT_TRUE(cont2->empty());
+  cont2 = thread2.Capture();
+  ASSERT_EQ(RunResult::Suspend,
+            thread2.Resume(cont1, {Value::Make(100)}, results, &trap));
+  ASSERT_EQ(RunResult::Return,
+            thread2.Resume({Value::Make(10)}, results, &trap));
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(110u, results[0].Get<u32>());
+
+  // And the second finishes back on the first thread.
+  ASSERT_EQ(RunResult::Return,
+            thread1.Resume(cont2, {Value::Make(20)}, results, &trap));
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(220u, results[0].Get<u32>());
+}
+
+TEST_F(InterpTest, HostFunc_Async_DeepContinuation) {
+  ReadModule(s_async_deep_module);
+
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [](Thread& thread, const Values& params, Values& results,
+                       Trap::Ptr* out_trap) -> Result {
+                      return thread.Suspend();
+                    });
+
+  Instantiate({host_func->self()});
+
+  // Far deeper than the call stack a thread starts with, so both threads
+  // have to grow theirs.
+  const u32 kDepth = 1000;
+  static_assert(kDepth > Thread::Options::kInitialCallStackSize, "");
+  static_assert(kDepth < Thread::Options::kDefaultCallStackSize, "");
+
+  Thread thread1(store_);
+  Values results;
+  Trap::Ptr trap;
+  ASSERT_EQ(RunResult::Suspend, thread1.CallAsync(GetFuncExport(0),
+                                                  {Value::Make(kDepth)},
+                                                  results, &trap));
+  Continuation::Ptr cont = thread1.Capture();
+
+  // A fresh thread takes the whole continuation, and suspends again at the
+  // bottom of it.
+  Thread thread2(store_);
+  ASSERT_EQ(RunResult::Suspend,
+            thread2.Resume(cont, {Value::Make(10)}, results, &trap));
+  EXPECT_TRUE(cont->empty());
+  cont = thread2.Capture();
+  store_.Collect();
+
+  // Meanwhile the first thread runs another deep call.
+  ASSERT_EQ(RunResult::Suspend, thread1.CallAsync(GetFuncExport(0),
+                                                  {Value::Make(kDepth)},
+                                                  results, &trap));
+  ASSERT_EQ(RunResult::Suspend,
+            thread1.Resume({Value::Make(1)}, results, &trap));
+  ASSERT_EQ(RunResult::Return,
+            thread1.Resume({Value::Make(2)}, results, &trap));
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(kDepth + 3, results[0].Get<u32>());
+
+  // And then finishes the continuation.
+  ASSERT_EQ(RunResult::Return,
+            thread1.Resume(cont, {Value::Make(20)}, results, &trap));
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(kDepth + 30, results[0].Get<u32>());
+}
+
 TEST_F(InterpTest, HostTrap) {
   // (import "host" "a" (func $0))
   // (func $1 call $0)
@@ -561,6 +843,172 @@ TEST_F(InterpTest, Rot13) {
   ASSERT_EQ("Hello, WebAssembly!", string_data);
 }
 
+TEST_F(InterpTest, AccountMemory) {
+  auto memory = Memory::New(store_, MemoryType{Limits{2}});
+  auto table = Table::New(store_, TableType{ValueType::FuncRef, Limits{10}});
+
+  MemoryStats stats;
+  store_.AccountMemory(&stats);
+
+  const MemoryStats::Category* memories = stats.Find("interp.memories");
+  ASSERT_NE(nullptr, memories);
+  EXPECT_EQ(1u, memories->count);
+  EXPECT_EQ(2u * WABT_PAGE_SIZE, memories->bytes);
+
+  const MemoryStats::Category* tables = stats.Find("interp.tables");
+  ASSERT_NE(nullptr, tables);
+  EXPECT_EQ(10 * sizeof(Ref), tables->bytes);
+
+  const MemoryStats::Category* objects = stats.Find("interp.objects");
+  ASSERT_NE(nullptr, objects);
+  EXPECT_EQ(store_.object_count(), objects->count);
+
+  // No thread is running, so there are no stacks to count.
+  EXPECT_EQ(nullptr, stats.Find("interp.value_stacks"));
+  EXPECT_LT(memories->bytes, stats.total_bytes());
+}
+
+namespace {
+
+// Compiles every module that gets called, against the ggt stub. The stub runs
+// GGT functions as plain C functions, and aborts if the glue passes them a
+// null thread.
+TierUpOptions GetStubTierUpOptions() {
+  TierUpOptions options;
+  options.threshold = 1;
+  options.cc = "cc -O0 -I'" + options.runtime_dir + "/../test/ggt-stub'";
+  options.ggt_thread = "&ggt_stub_thread";
+  return options;
+}
+
+}  // namespace
+
+class InterpTierUpTest : public InterpTest {
+ public:
+  void SetUp() override {
+    if (!TierUp::IsSupported()) {
+      GTEST_SKIP() << "tier-up is not supported on this platform";
+    }
+    options_ = GetStubTierUpOptions();
+    options_.log_stream = &log_;
+  }
+
+  // Calls |func| with |arg| until the TierUp has compiled its module, or
+  // failed to.
+  void CallUntilCompiled(const Func::Ptr& func, u32 arg, u32 expected) {
+    for (int i = 0; i < 6000 && !LogContains("tier-up: "); ++i) {
+      Values results;
+      Trap::Ptr trap;
+      ASSERT_EQ(Result::Ok, func->Call(store_, {Value::Make(arg)}, results,
+                                       &trap));
+      ASSERT_EQ(expected, results[0].Get<u32>());
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  bool LogContains(const char* str) {
+    const auto& data = log_.output_buffer().data;
+    return std::string(data.begin(), data.end()).find(str) !=
+           std::string::npos;
+  }
+
+  TierUpOptions options_;
+  MemoryStream log_;
+};
+
+namespace {
+
+// (import "" "twice" (func $twice (param i32) (result i32)))
+// (func $fib (export "fib") (param i32) (result i32)
+//   (if (result i32) (i32.lt_u (local.get 0) (i32.const 2))
+//     (then (call $twice (local.get 0)))
+//     (else (i32.add (call $fib (i32.sub (local.get 0) (i32.const 1)))
+//                    (call $fib (i32.sub (local.get 0) (i32.const 2)))))))
+const std::vector<u8> s_fib_module = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01,
+    0x60, 0x01, 0x7f, 0x01, 0x7f, 0x02, 0x0a, 0x01, 0x00, 0x05, 0x74,
+    0x77, 0x69, 0x63, 0x65, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0x07,
+    0x07, 0x01, 0x03, 0x66, 0x69, 0x62, 0x00, 0x01, 0x0a, 0x20, 0x01,
+    0x1e, 0x00, 0x20, 0x00, 0x41, 0x02, 0x49, 0x04, 0x7f, 0x20, 0x00,
+    0x10, 0x00, 0x05, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x10, 0x01, 0x20,
+    0x00, 0x41, 0x02, 0x6b, 0x10, 0x01, 0x6a, 0x0b, 0x0b,
+};
+
+}  // namespace
+
+TEST_F(InterpTierUpTest, Native) {
+  TierUp tier_up(store_, options_);
+  store_.set_tier_up(&tier_up);
+
+  // Called from the native code through the glue.
+  u32 host_calls = 0;
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [&](Thread& thread, const Values& params, Values& results,
+                        Trap::Ptr* out_trap) -> Result {
+                      ++host_calls;
+                      results[0] = Value::Make(params[0].Get<u32>() * 2);
+                      return Result::Ok;
+                    });
+
+  ReadModule(s_fib_module);
+  Instantiate({host_func->self()});
+  tier_up.AddModule(mod_, s_fib_module);
+  auto fib = GetFuncExport(0);
+
+  CallUntilCompiled(fib, 10, 110);
+  ASSERT_TRUE(LogContains("tier-up: compiled 1 functions"))
+      << std::string(log_.output_buffer().data.begin(),
+                     log_.output_buffer().data.end());
+  // The call that found the module compiled also switched fib over.
+  EXPECT_EQ(1u, tier_up.native_func_count());
+
+  Values results;
+  Trap::Ptr trap;
+  host_calls = 0;
+  ASSERT_EQ(Result::Ok, fib->Call(store_, {Value::Make(10)}, results, &trap));
+  EXPECT_EQ(110u, results[0].Get<u32>());
+  EXPECT_EQ(89u, host_calls);
+}
+
+TEST_F(InterpTierUpTest, NoImports) {
+  TierUp tier_up(store_, options_);
+  store_.set_tier_up(&tier_up);
+
+  ReadModule(s_fac_module);
+  Instantiate();
+  tier_up.AddModule(mod_, s_fac_module);
+  auto fac = GetFuncExport(0);
+
+  CallUntilCompiled(fac, 10, 3628800);
+  ASSERT_TRUE(LogContains("tier-up: compiled 1 functions"))
+      << std::string(log_.output_buffer().data.begin(),
+                     log_.output_buffer().data.end());
+  EXPECT_EQ(1u, tier_up.native_func_count());
+}
+
+TEST_F(InterpTierUpTest, NoGgtThread) {
+  options_.ggt_thread.clear();
+  TierUp tier_up(store_, options_);
+  store_.set_tier_up(&tier_up);
+
+  auto host_func =
+      HostFunc::New(store_, FuncType{{ValueType::I32}, {ValueType::I32}},
+                    [](Thread& thread, const Values& params, Values& results,
+                       Trap::Ptr* out_trap) -> Result {
+                      results[0] = Value::Make(params[0].Get<u32>() * 2);
+                      return Result::Ok;
+                    });
+
+  ReadModule(s_fib_module);
+  Instantiate({host_func->self()});
+  tier_up.AddModule(mod_, s_fib_module);
+
+  CallUntilCompiled(GetFuncExport(0), 10, 110);
+  EXPECT_TRUE(LogContains("no ggt thread"));
+  EXPECT_EQ(0u, tier_up.native_func_count());
+}
+
 class InterpGCTest : public InterpTest {
  public:
   void SetUp() override { before_new = store_.object_count(); }
@@ -691,13 +1139,11 @@ TEST_F(InterpGCTest, Collect_InstanceExport) {
   });
   Instantiate();
   auto after_new = store_.object_count();
-  EXPECT_EQ(before_new + 7,
-            after_new);  // module, instance, f, t, m, g, g-init-func
+  EXPECT_EQ(before_new + 6, after_new);  // module, instance, f, t, m, g
 
-  // Instance keeps all exports alive, except the init func which can be
-  // collected once its has been run
+  // Instance keeps all exports alive.
   store_.Collect();
-  EXPECT_EQ(after_new - 1, store_.object_count());
+  EXPECT_EQ(after_new, store_.object_count());
 }
 
 TEST_F(InterpGCTest, Collect_DeepRecursion) {
@@ -729,6 +1175,158 @@ TEST_F(InterpGCTest, Collect_DeepRecursion) {
   EXPECT_EQ(1u, store_.object_count());
 }
 
+class InterpConcurrentGCTest : public ::testing::Test {
+ public:
+  static const int kThreadCount = 4;
+
+  InterpConcurrentGCTest() : store_(Features{}, Store::Options{true}) {}
+
+  void SetUp() override { before_new = store_.object_count(); }
+
+  void TearDown() override {
+    store_.Collect();
+    EXPECT_EQ(before_new, store_.object_count());
+  }
+
+  // Runs |func| on kThreadCount attached threads, while this thread collects
+  // until they are all done.
+  template <typename F>
+  void RunWhileCollecting(F&& func) {
+    std::atomic<int> done{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+      threads.emplace_back([&, i]() {
+        {
+          Store::Mutator mutator(store_);
+          func(i);
+        }
+        done++;
+      });
+    }
+    int collect_count = 0;
+    while (done < kThreadCount || collect_count == 0) {
+      store_.Collect();
+      collect_count++;
+    }
+    for (auto&& thread : threads) {
+      thread.join();
+    }
+  }
+
+  Store store_;
+  size_t before_new;
+};
+
+TEST_F(InterpConcurrentGCTest, Collect_Alloc) {
+  RunWhileCollecting([this](int thread_index) {
+    const int kObjectCount = 2000;
+    std::vector<Foreign::Ptr> kept;
+    for (int i = 0; i < kObjectCount; ++i) {
+      // Unaligned, so it's not mistaken for a free slot by accident.
+      void* ptr = reinterpret_cast<void*>(
+          static_cast<uintptr_t>(thread_index * kObjectCount + i) * 8 + 4);
+      auto foreign = Foreign::New(store_, ptr);
+      if (i % 8 == 0) {
+        kept.push_back(foreign);
+      }
+      store_.Safepoint();
+    }
+    // The kept objects survived any collections in the meantime.
+    for (size_t i = 0; i < kept.size(); ++i) {
+      uintptr_t expected = (thread_index * kObjectCount + i * 8) * 8 + 4;
+      EXPECT_TRUE(store_.Is<Foreign>(kept[i].ref()));
+      EXPECT_EQ(expected, reinterpret_cast<uintptr_t>(kept[i]->ptr()));
+    }
+  });
+}
+
+TEST_F(InterpConcurrentGCTest, Collect_Run) {
+  Errors errors;
+  ModuleDesc module_desc;
+  ASSERT_EQ(Result::Ok,
+            ReadBinaryInterp("<internal>", s_fac_module.data(),
+                             s_fac_module.size(), ReadBinaryOptions{}, &errors,
+                             &module_desc));
+  Func::Ptr func;
+  {
+    Store::Mutator mutator(store_);
+    auto mod = Module::New(store_, module_desc);
+    Trap::Ptr trap;
+    auto inst = Instance::Instantiate(store_, mod.ref(), {}, &trap);
+    ASSERT_TRUE(inst);
+    // Only the func is rooted; the instance and module are kept alive by it.
+    func = store_.UnsafeGet<Func>(inst->exports()[0]);
+  }
+
+  RunWhileCollecting([&](int) {
+    for (u32 i = 0; i < 200; ++i) {
+      Values results;
+      Trap::Ptr trap;
+      ASSERT_EQ(Result::Ok,
+                func->Call(store_, {Value::Make(10u)}, results, &trap));
+      EXPECT_EQ(3628800u, results[0].Get<u32>());
+    }
+  });
+
+  func.reset();
+}
+
+TEST_F(InterpConcurrentGCTest, Collect_JitTierUp) {
+  if (!TierUp::IsSupported()) {
+    GTEST_SKIP() << "tier-up is not supported on this platform";
+  }
+  Jit jit(store_, JitOptions{});
+  store_.set_jit(&jit);
+  MemoryStream log;
+  TierUpOptions options = GetStubTierUpOptions();
+  options.log_stream = &log;
+  TierUp tier_up(store_, options);
+  store_.set_tier_up(&tier_up);
+
+  Errors errors;
+  ModuleDesc module_desc;
+  ASSERT_EQ(Result::Ok,
+            ReadBinaryInterp("<internal>", s_fac_module.data(),
+                             s_fac_module.size(), ReadBinaryOptions{}, &errors,
+                             &module_desc));
+  Func::Ptr func;
+  {
+    Store::Mutator mutator(store_);
+    auto mod = Module::New(store_, module_desc);
+    tier_up.AddModule(mod, s_fac_module);
+    Trap::Ptr trap;
+    auto inst = Instance::Instantiate(store_, mod.ref(), {}, &trap);
+    ASSERT_TRUE(inst);
+    func = store_.UnsafeGet<Func>(inst->exports()[0]);
+  }
+
+  // Every thread starts out in the JIT, compiling and counting at the same
+  // time as the others, and keeps going until it has also run native code.
+  RunWhileCollecting([&](int) {
+    for (u32 i = 0; i < 200 || (tier_up.native_func_count() == 0 && i < 6000);
+         ++i) {
+      Values results;
+      Trap::Ptr trap;
+      ASSERT_EQ(Result::Ok,
+                func->Call(store_, {Value::Make(10u)}, results, &trap));
+      EXPECT_EQ(3628800u, results[0].Get<u32>());
+      if (tier_up.native_func_count() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+  });
+
+  EXPECT_EQ(1u, tier_up.native_func_count())
+      << std::string(log.output_buffer().data.begin(),
+                     log.output_buffer().data.end());
+  if (Jit::IsSupported()) {
+    EXPECT_EQ(1u, jit.compiled_func_count() + jit.rejected_func_count());
+  }
+  store_.set_tier_up(nullptr);
+  store_.set_jit(nullptr);
+  func.reset();
+}
+
 // TODO: Test for Thread keeping references alive as locals/params/stack values.
 // This requires better tracking of references than currently exists in the
 // interpreter. (see TODOs in Select/LocalGet/GlobalGet)
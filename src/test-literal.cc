@@ -185,6 +185,36 @@ void AssertHexDoubleFails(const char* s) {
       << s;
 }
 
+void AssertDecimalFloatEquals(uint32_t expected_bits, const char* s) {
+  uint32_t actual_bits;
+  ASSERT_EQ(Result::Ok,
+            ParseFloat(LiteralType::Float, s, s + strlen(s), &actual_bits))
+      << s;
+  ASSERT_EQ(expected_bits, actual_bits) << s;
+}
+
+void AssertDecimalFloatFails(const char* s) {
+  uint32_t actual_bits;
+  ASSERT_EQ(Result::Error,
+            ParseFloat(LiteralType::Float, s, s + strlen(s), &actual_bits))
+      << s;
+}
+
+void AssertDecimalDoubleEquals(uint64_t expected_bits, const char* s) {
+  uint64_t actual_bits;
+  ASSERT_EQ(Result::Ok,
+            ParseDouble(LiteralType::Float, s, s + strlen(s), &actual_bits))
+      << s;
+  ASSERT_EQ(expected_bits, actual_bits) << s;
+}
+
+void AssertDecimalDoubleFails(const char* s) {
+  uint64_t actual_bits;
+  ASSERT_EQ(Result::Error,
+            ParseDouble(LiteralType::Float, s, s + strlen(s), &actual_bits))
+      << s;
+}
+
 }  // end anonymous namespace
 
 TEST(ParseInt8, Both) {
@@ -617,6 +647,44 @@ TEST(ParseFloat, OutOfRange) {
   AssertHexFloatFails("-0x1.ffffffp127");
 }
 
+TEST(ParseFloat, Decimal) {
+  AssertDecimalFloatEquals(0, "0");
+  AssertDecimalFloatEquals(0x80000000, "-0.0");
+  AssertDecimalFloatEquals(0x3f800000, "1");
+  AssertDecimalFloatEquals(0x3f800000, "+1.");
+  AssertDecimalFloatEquals(0x3fc00000, "1.5");
+  AssertDecimalFloatEquals(0x447a2000, "1_000.5");
+  AssertDecimalFloatEquals(0x501502f9, "1e10");
+  AssertDecimalFloatEquals(0x501502f9, "1_0E+0_9");
+  AssertDecimalFloatEquals(0x3dcccccd, "0.1");
+  AssertDecimalFloatEquals(0x3dcccccd, "0.000_000_000_1e9");
+  AssertDecimalFloatEquals(0x7f7fffff, "3.4028234663852886e38");
+  AssertDecimalFloatEquals(0x00000001, "1.4e-45");
+  AssertDecimalFloatEquals(0, "1e-50");
+}
+
+TEST(ParseFloat, DecimalRounding) {
+  // 2^24 + 1 and 2^24 + 3 are halfway; ties go to even.
+  AssertDecimalFloatEquals(0x4b800000, "16777217");
+  AssertDecimalFloatEquals(0x4b800002, "16777219");
+  // 1 + 2^-24 is halfway between 1 and the next float.
+  AssertDecimalFloatEquals(0x3f800000, "1.000000059604644775390625");
+  AssertDecimalFloatEquals(0x3f800001,
+                           "1.00000005960464477539062500000000000000000001");
+  // Half of the smallest subnormal.
+  AssertDecimalFloatEquals(0, "7.006492321624085e-46");
+  AssertDecimalFloatEquals(1, "7.006492321624086e-46");
+  AssertDecimalFloatEquals(0x7f7fffff,
+                           "340282356779733661637539395458142568447");
+}
+
+TEST(ParseFloat, DecimalOutOfRange) {
+  AssertDecimalFloatFails("340282356779733661637539395458142568448");
+  AssertDecimalFloatFails("-3.5e38");
+  AssertDecimalFloatFails("1e39");
+  AssertDecimalFloatFails("1e1000000000000");
+}
+
 TEST(ParseDouble, NonCanonical) {
   AssertHexDoubleEquals(0x3ff0000000000000, "0x00000000000000000000001.0p0");
   AssertHexDoubleEquals(0x3ff0000000000000, "0x1.00000000000000000000000p0");
@@ -638,6 +706,40 @@ TEST(ParseDouble, Rounding) {
   AssertHexDoubleEquals(0x7fefffffffffffff, "0x1.fffffffffffff0p1023");
 }
 
+TEST(ParseDouble, Decimal) {
+  AssertDecimalDoubleEquals(0, "0");
+  AssertDecimalDoubleEquals(0x8000000000000000, "-0");
+  AssertDecimalDoubleEquals(0x3fb999999999999a, "0.1");
+  AssertDecimalDoubleEquals(0x43118b54f2236200, "123_456.789_e1_0");
+  AssertDecimalDoubleEquals(0x0010000000000000, "2.2250738585072014e-308");
+  AssertDecimalDoubleEquals(0x7fefffffffffffff, "1.7976931348623157e308");
+  AssertDecimalDoubleEquals(1, "4.9e-324");
+  AssertDecimalDoubleEquals(0, "1e-400");
+  AssertDecimalDoubleEquals(0, "1e-1000000000000");
+}
+
+TEST(ParseDouble, DecimalRounding) {
+  // 2^53 + 1 and 2^53 + 3 are halfway; ties go to even.
+  AssertDecimalDoubleEquals(0x4340000000000000, "9007199254740993");
+  AssertDecimalDoubleEquals(0x4340000000000002, "9007199254740995");
+  // 1 + 2^-53 is halfway between 1 and the next double.
+  AssertDecimalDoubleEquals(
+      0x3ff0000000000000,
+      "1.00000000000000011102230246251565404236316680908203125");
+  AssertDecimalDoubleEquals(
+      0x3ff0000000000001,
+      "1.000000000000000111022302462515654042363166809082031250001");
+  // Half of the smallest subnormal.
+  AssertDecimalDoubleEquals(0, "2.4703282292062327e-324");
+  AssertDecimalDoubleEquals(1, "2.4703282292062328e-324");
+}
+
+TEST(ParseDouble, DecimalOutOfRange) {
+  AssertDecimalDoubleFails("1.7976931348623159e308");
+  AssertDecimalDoubleFails("-1e309");
+  AssertDecimalDoubleFails("1e1000000000000");
+}
+
 TEST(ParseDouble, OutOfRange) {
   AssertHexDoubleFails("0x1p1024");
   AssertHexDoubleFails("-0x1p1024");
@@ -836,3 +938,76 @@ TEST(WriteUint128, BufferTooSmall) {
     ASSERT_EQ(buffer[2], '\0');
   }
 }
+
+void AssertWriteFloatDecimalEquals(uint32_t bits, const std::string& expected) {
+  char buffer[WABT_MAX_FLOAT_DECIMAL];
+  WriteFloatDecimal(buffer, sizeof(buffer), bits);
+  ASSERT_EQ(expected, std::string(buffer));
+}
+
+void AssertWriteDoubleDecimalEquals(uint64_t bits,
+                                    const std::string& expected) {
+  char buffer[WABT_MAX_DOUBLE_DECIMAL];
+  WriteDoubleDecimal(buffer, sizeof(buffer), bits);
+  ASSERT_EQ(expected, std::string(buffer));
+}
+
+TEST(WriteFloatDecimal, Basic) {
+  AssertWriteFloatDecimalEquals(0, "0");
+  AssertWriteFloatDecimalEquals(0x80000000, "-0");
+  AssertWriteFloatDecimalEquals(0x3f800000, "1");
+  AssertWriteFloatDecimalEquals(0xc0200000, "-2.5");
+  AssertWriteFloatDecimalEquals(0x3dcccccd, "0.1");
+  AssertWriteFloatDecimalEquals(0x40490fdb, "3.1415927");
+  AssertWriteFloatDecimalEquals(0x4640e6a0, "12345.656");
+  AssertWriteFloatDecimalEquals(0x4b800000, "16777216");
+  AssertWriteFloatDecimalEquals(0x501502f9, "10000000000");
+  AssertWriteFloatDecimalEquals(0x7f7fffff, "3.4028235e+38");
+  AssertWriteFloatDecimalEquals(0x00800000, "1.1754944e-38");
+  AssertWriteFloatDecimalEquals(0x00000001, "1e-45");
+  AssertWriteFloatDecimalEquals(0x358637bd, "0.000001");
+  AssertWriteFloatDecimalEquals(0x33d6bf95, "1e-7");
+  AssertWriteFloatDecimalEquals(0x7f800000, "inf");
+  AssertWriteFloatDecimalEquals(0xffc00000, "-nan");
+  AssertWriteFloatDecimalEquals(0x7f800001, "nan:0x1");
+}
+
+TEST(WriteFloatDecimal, PowersOfTwo) {
+  // The lower neighbour of a power of two is closer than the upper one, so
+  // the shortest digits can be further below the value than above it.
+  AssertWriteFloatDecimalEquals(0x6b000000, "1.5474251e+26");
+  AssertWriteFloatDecimalEquals(0x0f800000, "1.2621775e-29");
+}
+
+TEST(WriteDoubleDecimal, Basic) {
+  AssertWriteDoubleDecimalEquals(0, "0");
+  AssertWriteDoubleDecimalEquals(0x8000000000000000, "-0");
+  AssertWriteDoubleDecimalEquals(0x3ff0000000000000, "1");
+  AssertWriteDoubleDecimalEquals(0x3fb999999999999a, "0.1");
+  AssertWriteDoubleDecimalEquals(0x3fd5555555555555, "0.3333333333333333");
+  AssertWriteDoubleDecimalEquals(0x400921fb54442d18, "3.141592653589793");
+  AssertWriteDoubleDecimalEquals(0x4059000000000000, "100");
+  AssertWriteDoubleDecimalEquals(0x4415af1d78b58c40, "100000000000000000000");
+  AssertWriteDoubleDecimalEquals(0x444b1ae4d6e2ef50, "1e+21");
+  AssertWriteDoubleDecimalEquals(0x3eb0c6f7a0b5ed8d, "0.000001");
+  AssertWriteDoubleDecimalEquals(0x3e7ad7f29abcaf48, "1e-7");
+  AssertWriteDoubleDecimalEquals(0x7fefffffffffffff,
+                                 "1.7976931348623157e+308");
+  AssertWriteDoubleDecimalEquals(0x0010000000000000,
+                                 "2.2250738585072014e-308");
+  AssertWriteDoubleDecimalEquals(0x0000000000000001, "5e-324");
+  AssertWriteDoubleDecimalEquals(0xfff0000000000000, "-inf");
+  AssertWriteDoubleDecimalEquals(0x7ff8000000000000, "nan");
+}
+
+TEST(WriteDoubleDecimal, PowersOfTwo) {
+  AssertWriteDoubleDecimalEquals(0x0d70000000000000,
+                                 "5.858190679279809e-244");
+  AssertWriteDoubleDecimalEquals(0x4830000000000000, "5.444517870735016e+39");
+}
+
+TEST(WriteDoubleDecimal, BufferTooSmall) {
+  char buffer[5];
+  WriteDoubleDecimal(buffer, sizeof(buffer), 0x400921fb54442d18);
+  ASSERT_EQ(std::string("3.14"), std::string(buffer));
+}
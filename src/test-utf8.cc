@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <string>
+
 #include "gtest/gtest.h"
 
 #include "wabt/utf8.h"
@@ -165,3 +167,22 @@ TEST(utf8, invalid_4_bytes) {
     assert_is_valid_utf8(false, 4, cu0, 0x80, 0x80, 0x80);
   }
 }
+
+TEST(utf8, long_strings) {
+  // Long enough to take the word-at-a-time path, with a multi-byte sequence
+  // or a bad byte at every offset.
+  const char kTwoBytes[] = "\xc2\xa9";
+  for (size_t length = 0; length < 64; ++length) {
+    for (size_t i = 0; i < length; ++i) {
+      std::string s(length, 'a');
+      s[i] = '\x80';
+      ASSERT_FALSE(IsValidUtf8(s.data(), s.size())) << length << ", " << i;
+      s[i] = '\xc2';
+      ASSERT_FALSE(IsValidUtf8(s.data(), s.size())) << length << ", " << i;
+      s.replace(i, 1, kTwoBytes);
+      ASSERT_TRUE(IsValidUtf8(s.data(), s.size())) << length << ", " << i;
+    }
+    std::string s(length, 'a');
+    ASSERT_TRUE(IsValidUtf8(s.data(), s.size())) << length;
+  }
+}
@@ -27,14 +27,18 @@
 #include "wabt/binary-reader-ir.h"
 #include "wabt/binary-reader-nop.h"
 #include "wabt/binary-reader.h"
+#include "wabt/binary-writer-spec.h"
 #include "wabt/cast.h"
 #include "wabt/common.h"
 #include "wabt/error-formatter.h"
 #include "wabt/feature.h"
 #include "wabt/interp/binary-reader-interp.h"
+#include "wabt/interp/interp-jit.h"
 #include "wabt/interp/interp-util.h"
 #include "wabt/interp/interp.h"
+#include "wabt/leb128.h"
 #include "wabt/literal.h"
+#include "wabt/mapped-file.h"
 #include "wabt/option-parser.h"
 #include "wabt/stream.h"
 #include "wabt/string-util.h"
@@ -50,6 +54,8 @@ static std::string s_infile;
 static Thread::Options s_thread_options;
 static Stream* s_trace_stream;
 static Features s_features;
+static bool s_jit;
+static IstreamOptions s_istream_options;
 
 static std::unique_ptr<FileStream> s_log_stream;
 static std::unique_ptr<FileStream> s_stdout_stream;
@@ -60,11 +66,15 @@ enum class RunVerbosity {
 };
 
 static const char s_description[] =
-    R"(  read a Spectest JSON file, and run its tests in the interpreter.
+    R"(  read a Spectest JSON file or spec bundle, and run its tests in the
+  interpreter.
 
 examples:
   # parse test.json and run the spec tests
   $ spectest-interp test.json
+
+  # run the spec tests in a bundle written by wast2json --bundle
+  $ spectest-interp test.wsb
 )";
 
 static void ParseOptions(int argc, char** argv) {
@@ -89,6 +99,19 @@ static void ParseOptions(int argc, char** argv) {
                    });
   parser.AddOption('t', "trace", "Trace execution",
                    []() { s_trace_stream = s_stdout_stream.get(); });
+  parser.AddOption("jit",
+                   "Run functions as x86-64 machine code where the JIT "
+                   "supports them",
+                   []() { s_jit = true; });
+  s_istream_options.optimize = true;
+  parser.AddOption("no-optimize",
+                   "Don't run the istream optimization passes on each "
+                   "function",
+                   []() { s_istream_options.optimize = false; });
+  parser.AddOption("tos-cache",
+                   "Keep the top of the value stack in a register where "
+                   "possible",
+                   []() { s_istream_options.cache_top_of_stack = true; });
 
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) {
@@ -98,6 +121,33 @@ static void ParseOptions(int argc, char** argv) {
   parser.Parse(argc, argv);
 }
 
+// Module files embedded in a spec bundle, keyed by the path the JSON format
+// would have used. The contents point into the mapped bundle.
+static std::map<std::string, std::string_view, std::less<>> s_bundle_files;
+
+// The contents of a module file, either from the spec bundle or read from disk
+// into |buffer|.
+struct ModuleData {
+  std::vector<uint8_t> buffer;
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+};
+
+static wabt::Result ReadModuleData(std::string_view filename,
+                                   ModuleData* out_data) {
+  auto iter = s_bundle_files.find(filename);
+  if (iter != s_bundle_files.end()) {
+    out_data->data = reinterpret_cast<const uint8_t*>(iter->second.data());
+    out_data->size = iter->second.size();
+    return wabt::Result::Ok;
+  }
+
+  CHECK_RESULT(ReadFile(filename, &out_data->buffer));
+  out_data->data = out_data->buffer.data();
+  out_data->size = out_data->buffer.size();
+  return wabt::Result::Ok;
+}
+
 namespace spectest {
 
 class Command;
@@ -277,9 +327,9 @@ TypedValue GetLane(const TypedValue& tv, Type lane_type, int lane) {
 }
 
 bool CheckIR(const std::string& filename, bool validate) {
-  std::vector<uint8_t> file_data;
+  ModuleData file_data;
 
-  if (Failed(ReadFile(filename, &file_data))) {
+  if (Failed(ReadModuleData(filename, &file_data))) {
     return false;
   }
 
@@ -291,7 +341,7 @@ bool CheckIR(const std::string& filename, bool validate) {
 
   Errors errors;
   wabt::Module module;
-  if (Failed(ReadBinaryIr(filename.c_str(), file_data.data(), file_data.size(),
+  if (Failed(ReadBinaryIr(filename.c_str(), file_data.data, file_data.size,
                           options, &errors, &module))) {
     return false;
   }
@@ -358,7 +408,9 @@ class JSONParser {
  public:
   JSONParser() {}
 
-  wabt::Result ReadFile(std::string_view spec_json_filename);
+  void SetInput(std::string_view spec_json_filename,
+                const uint8_t* data,
+                size_t size);
   wabt::Result ParseScript(Script* out_script);
 
  private:
@@ -410,12 +462,12 @@ class JSONParser {
   wabt::Result ParseActionResult();
   wabt::Result ParseModuleType(ModuleType* out_type);
 
-  std::string CreateModulePath(std::string_view filename);
   wabt::Result ParseFilename(std::string* out_filename);
   wabt::Result ParseCommand(CommandPtr* out_command);
 
   // Parsing info.
-  std::vector<uint8_t> json_data_;
+  const uint8_t* json_data_ = nullptr;
+  size_t json_size_ = 0;
   size_t json_offset_ = 0;
   Location loc_;
   Location prev_loc_;
@@ -427,12 +479,15 @@ class JSONParser {
 #define PARSE_KEY_STRING_VALUE(key, value) \
   CHECK_RESULT(ParseKeyStringValue(key, value))
 
-wabt::Result JSONParser::ReadFile(std::string_view spec_json_filename) {
+void JSONParser::SetInput(std::string_view spec_json_filename,
+                          const uint8_t* data,
+                          size_t size) {
   loc_.filename = spec_json_filename;
   loc_.line = 1;
   loc_.first_column = 1;
-
-  return wabt::ReadFile(spec_json_filename, &json_data_);
+  json_data_ = data;
+  json_size_ = size;
+  json_offset_ = 0;
 }
 
 void JSONParser::PrintError(const char* format, ...) {
@@ -449,7 +504,7 @@ void JSONParser::PutbackChar() {
 }
 
 int JSONParser::ReadChar() {
-  if (json_offset_ >= json_data_.size()) {
+  if (json_offset_ >= json_size_) {
     return -1;
   }
   prev_loc_ = loc_;
@@ -1015,9 +1070,10 @@ static std::string_view GetDirname(std::string_view path) {
   return path.substr(0, std::max(last_slash, last_backslash));
 }
 
-std::string JSONParser::CreateModulePath(std::string_view filename) {
-  std::string_view spec_json_filename = loc_.filename;
-  std::string_view dirname = GetDirname(spec_json_filename);
+// Module filenames are relative to the script that references them.
+static std::string CreateModulePath(std::string_view script_filename,
+                                    std::string_view filename) {
+  std::string_view dirname = GetDirname(script_filename);
   std::string path;
 
   if (dirname.size() == 0) {
@@ -1032,7 +1088,7 @@ std::string JSONParser::CreateModulePath(std::string_view filename) {
 
 wabt::Result JSONParser::ParseFilename(std::string* out_filename) {
   PARSE_KEY_STRING_VALUE("filename", out_filename);
-  *out_filename = CreateModulePath(*out_filename);
+  *out_filename = CreateModulePath(loc_.filename, *out_filename);
   return wabt::Result::Ok;
 }
 
@@ -1186,6 +1242,479 @@ wabt::Result JSONParser::ParseScript(Script* out_script) {
   return wabt::Result::Ok;
 }
 
+// Reads the spec bundles written by wast2json --bundle, see
+// binary-writer-spec.h for the format. Modules are not copied; their contents
+// are registered in s_bundle_files and point into |data|.
+class BundleParser {
+ public:
+  BundleParser(std::string_view filename, const uint8_t* data, size_t size);
+
+  static bool IsBundle(const uint8_t* data, size_t size);
+
+  wabt::Result ParseScript(Script* out_script);
+
+ private:
+  void WABT_PRINTF_FORMAT(2, 3) PrintError(const char* format, ...);
+
+  wabt::Result ReadU8(uint8_t* out_value, const char* desc);
+  wabt::Result ReadU32Leb128(uint32_t* out_value, const char* desc);
+  wabt::Result ReadU64Leb128(uint64_t* out_value, const char* desc);
+  wabt::Result ReadString(std::string* out_string, const char* desc);
+  wabt::Result ReadType(Type* out_type);
+  wabt::Result ReadLane(Type lane_type, uint64_t* out_bits, ExpectedNan*);
+  wabt::Result ReadExpectedValue(ExpectedValue* out_value);
+  wabt::Result ReadExpectedValues(std::vector<ExpectedValue>* out_values);
+  wabt::Result ReadConstVector(ValueTypes* out_types, Values* out_values);
+  wabt::Result ReadAction(Action* out_action);
+  wabt::Result ReadModule(std::string* out_filename);
+  wabt::Result ReadModuleType(ModuleType* out_type);
+  wabt::Result ReadCommand(CommandPtr* out_command);
+
+  template <typename T>
+  wabt::Result ReadAssertModuleCommand(CommandPtr* out_command);
+  template <typename T>
+  wabt::Result ReadAssertTrapCommand(CommandPtr* out_command);
+
+  std::string filename_;
+  const uint8_t* data_;
+  const uint8_t* end_;
+  const uint8_t* p_;
+  std::vector<std::string> module_filenames_;
+};
+
+BundleParser::BundleParser(std::string_view filename,
+                           const uint8_t* data,
+                           size_t size)
+    : filename_(filename), data_(data), end_(data + size), p_(data) {}
+
+bool BundleParser::IsBundle(const uint8_t* data, size_t size) {
+  uint32_t magic;
+  if (size < sizeof(magic)) {
+    return false;
+  }
+  memcpy(&magic, data, sizeof(magic));
+  return magic == kSpecBundleMagic;
+}
+
+void BundleParser::PrintError(const char* format, ...) {
+  WABT_SNPRINTF_ALLOCA(buffer, length, format);
+  fprintf(stderr, "%s:%#" PRIzx ": %s\n", filename_.c_str(),
+          static_cast<size_t>(p_ - data_), buffer);
+}
+
+wabt::Result BundleParser::ReadU8(uint8_t* out_value, const char* desc) {
+  if (p_ == end_) {
+    PrintError("unable to read %s", desc);
+    return wabt::Result::Error;
+  }
+  *out_value = *p_++;
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadU32Leb128(uint32_t* out_value,
+                                         const char* desc) {
+  size_t length = wabt::ReadU32Leb128(p_, end_, out_value);
+  if (length == 0) {
+    PrintError("unable to read %s", desc);
+    return wabt::Result::Error;
+  }
+  p_ += length;
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadU64Leb128(uint64_t* out_value,
+                                         const char* desc) {
+  size_t length = wabt::ReadU64Leb128(p_, end_, out_value);
+  if (length == 0) {
+    PrintError("unable to read %s", desc);
+    return wabt::Result::Error;
+  }
+  p_ += length;
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadString(std::string* out_string,
+                                      const char* desc) {
+  uint32_t length;
+  CHECK_RESULT(ReadU32Leb128(&length, desc));
+  if (length > static_cast<size_t>(end_ - p_)) {
+    PrintError("%s extends past the end of the bundle", desc);
+    return wabt::Result::Error;
+  }
+  out_string->assign(reinterpret_cast<const char*>(p_), length);
+  p_ += length;
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadType(Type* out_type) {
+  uint32_t type;
+  size_t length = wabt::ReadS32Leb128(p_, end_, &type);
+  if (length == 0) {
+    PrintError("unable to read type");
+    return wabt::Result::Error;
+  }
+  p_ += length;
+
+  *out_type = Type(static_cast<int32_t>(type));
+  switch (*out_type) {
+    case Type::I32:
+    case Type::F32:
+    case Type::I64:
+    case Type::F64:
+    case Type::V128:
+    case Type::I8:
+    case Type::I16:
+    case Type::FuncRef:
+    case Type::ExternRef:
+      return wabt::Result::Ok;
+
+    default:
+      PrintError("unknown type: %d", static_cast<int32_t>(type));
+      return wabt::Result::Error;
+  }
+}
+
+wabt::Result BundleParser::ReadLane(Type lane_type,
+                                    uint64_t* out_bits,
+                                    ExpectedNan* out_nan) {
+  *out_nan = ExpectedNan::None;
+  if (lane_type == Type::F32 || lane_type == Type::F64) {
+    uint8_t nan;
+    CHECK_RESULT(ReadU8(&nan, "expected nan"));
+    if (nan > static_cast<uint8_t>(ExpectedNan::Arithmetic)) {
+      PrintError("invalid expected nan: %u", nan);
+      return wabt::Result::Error;
+    }
+    *out_nan = static_cast<ExpectedNan>(nan);
+  }
+  return ReadU64Leb128(out_bits, "bits");
+}
+
+wabt::Result BundleParser::ReadExpectedValue(ExpectedValue* out_value) {
+  Type type;
+  CHECK_RESULT(ReadType(&type));
+  out_value->value.type = type;
+
+  uint64_t bits;
+  switch (type) {
+    case Type::I32:
+      CHECK_RESULT(ReadLane(type, &bits, &out_value->nan[0]));
+      out_value->value.value.Set(static_cast<u32>(bits));
+      break;
+
+    case Type::I64:
+      CHECK_RESULT(ReadLane(type, &bits, &out_value->nan[0]));
+      out_value->value.value.Set(bits);
+      break;
+
+    case Type::F32:
+      CHECK_RESULT(ReadLane(type, &bits, &out_value->nan[0]));
+      out_value->value.value.Set(Bitcast<f32>(static_cast<u32>(bits)));
+      break;
+
+    case Type::F64:
+      CHECK_RESULT(ReadLane(type, &bits, &out_value->nan[0]));
+      out_value->value.value.Set(Bitcast<f64>(bits));
+      break;
+
+    case Type::FuncRef:
+    case Type::ExternRef:
+      // Matches JSONParser: non-null externrefs are whatever ref is at that
+      // index (skipping null), and any non-null funcref is just "not null".
+      CHECK_RESULT(ReadU64Leb128(&bits, "ref"));
+      if (bits == 0) {
+        out_value->value.value.Set(Ref::Null);
+      } else if (type == Type::FuncRef) {
+        out_value->value.value.Set(Ref{1});
+      } else {
+        out_value->value.value.Set(Ref{bits});
+      }
+      break;
+
+    case Type::V128: {
+      Type lane_type;
+      CHECK_RESULT(ReadType(&lane_type));
+      out_value->lane_type = lane_type;
+      v128 v;
+      v.set_zero();
+      int lane_count = LaneCountFromType(lane_type);
+      for (int lane = 0; lane < lane_count; ++lane) {
+        ExpectedNan nan;
+        CHECK_RESULT(ReadLane(lane_type, &bits, &nan));
+        switch (lane_type) {
+          case Type::I8:
+            v.set_u8(lane, bits);
+            break;
+
+          case Type::I16:
+            v.set_u16(lane, bits);
+            break;
+
+          case Type::I32:
+            v.set_u32(lane, bits);
+            break;
+
+          case Type::F32:
+            v.set_f32_bits(lane, bits);
+            out_value->nan[lane] = nan;
+            break;
+
+          case Type::I64:
+            v.set_u64(lane, bits);
+            break;
+
+          case Type::F64:
+            v.set_f64_bits(lane, bits);
+            out_value->nan[lane] = nan;
+            break;
+
+          default:
+            PrintError("unknown lane type: \"%s\"",
+                       lane_type.GetName().c_str());
+            return wabt::Result::Error;
+        }
+      }
+      out_value->value.value.Set(v);
+      break;
+    }
+
+    default:
+      WABT_UNREACHABLE;
+  }
+
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadExpectedValues(
+    std::vector<ExpectedValue>* out_values) {
+  uint32_t count;
+  CHECK_RESULT(ReadU32Leb128(&count, "value count"));
+  out_values->resize(count);
+  for (ExpectedValue& value : *out_values) {
+    CHECK_RESULT(ReadExpectedValue(&value));
+  }
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadConstVector(ValueTypes* out_types,
+                                           Values* out_values) {
+  std::vector<ExpectedValue> values;
+  CHECK_RESULT(ReadExpectedValues(&values));
+  for (const ExpectedValue& value : values) {
+    out_types->push_back(value.value.type);
+    out_values->push_back(value.value.value);
+  }
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadAction(Action* out_action) {
+  uint8_t type;
+  CHECK_RESULT(ReadU8(&type, "action type"));
+  if (type > static_cast<uint8_t>(ActionType::Get)) {
+    PrintError("unknown action type: %u", type);
+    return wabt::Result::Error;
+  }
+  out_action->type = static_cast<ActionType>(type);
+  CHECK_RESULT(ReadString(&out_action->module_name, "module name"));
+  CHECK_RESULT(ReadString(&out_action->field_name, "field name"));
+  if (out_action->type == ActionType::Invoke) {
+    CHECK_RESULT(ReadConstVector(&out_action->types, &out_action->args));
+  }
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadModule(std::string* out_filename) {
+  uint32_t index;
+  CHECK_RESULT(ReadU32Leb128(&index, "module index"));
+  if (index >= module_filenames_.size()) {
+    PrintError("invalid module index: %u", index);
+    return wabt::Result::Error;
+  }
+  *out_filename = module_filenames_[index];
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadModuleType(ModuleType* out_type) {
+  uint8_t type;
+  CHECK_RESULT(ReadU8(&type, "module type"));
+  switch (static_cast<SpecBundleModuleType>(type)) {
+    case SpecBundleModuleType::Binary:
+      *out_type = ModuleType::Binary;
+      return wabt::Result::Ok;
+
+    case SpecBundleModuleType::Text:
+      *out_type = ModuleType::Text;
+      return wabt::Result::Ok;
+  }
+
+  PrintError("unknown module type: %u", type);
+  return wabt::Result::Error;
+}
+
+template <typename T>
+wabt::Result BundleParser::ReadAssertModuleCommand(CommandPtr* out_command) {
+  auto command = std::make_unique<T>();
+  CHECK_RESULT(ReadModule(&command->filename));
+  CHECK_RESULT(ReadString(&command->text, "text"));
+  CHECK_RESULT(ReadModuleType(&command->type));
+  *out_command = std::move(command);
+  return wabt::Result::Ok;
+}
+
+template <typename T>
+wabt::Result BundleParser::ReadAssertTrapCommand(CommandPtr* out_command) {
+  auto command = std::make_unique<T>();
+  CHECK_RESULT(ReadAction(&command->action));
+  CHECK_RESULT(ReadString(&command->text, "text"));
+  *out_command = std::move(command);
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ReadCommand(CommandPtr* out_command) {
+  uint8_t type;
+  uint32_t line;
+  CHECK_RESULT(ReadU8(&type, "command type"));
+  CHECK_RESULT(ReadU32Leb128(&line, "line"));
+
+  switch (static_cast<CommandType>(type)) {
+    case CommandType::Module: {
+      auto command = std::make_unique<ModuleCommand>();
+      CHECK_RESULT(ReadString(&command->name, "module name"));
+      CHECK_RESULT(ReadModule(&command->filename));
+      *out_command = std::move(command);
+      break;
+    }
+
+    case CommandType::Action: {
+      auto command = std::make_unique<ActionCommand>();
+      CHECK_RESULT(ReadAction(&command->action));
+      *out_command = std::move(command);
+      break;
+    }
+
+    case CommandType::Register: {
+      auto command = std::make_unique<RegisterCommand>();
+      CHECK_RESULT(ReadString(&command->name, "module name"));
+      CHECK_RESULT(ReadString(&command->as, "register name"));
+      *out_command = std::move(command);
+      break;
+    }
+
+    case CommandType::AssertMalformed:
+      CHECK_RESULT(
+          ReadAssertModuleCommand<AssertMalformedCommand>(out_command));
+      break;
+
+    case CommandType::AssertInvalid:
+      CHECK_RESULT(ReadAssertModuleCommand<AssertInvalidCommand>(out_command));
+      break;
+
+    case CommandType::AssertUnlinkable:
+      CHECK_RESULT(
+          ReadAssertModuleCommand<AssertUnlinkableCommand>(out_command));
+      break;
+
+    case CommandType::AssertUninstantiable:
+      CHECK_RESULT(
+          ReadAssertModuleCommand<AssertUninstantiableCommand>(out_command));
+      break;
+
+    case CommandType::AssertReturn: {
+      auto command = std::make_unique<AssertReturnCommand>();
+      uint8_t either;
+      CHECK_RESULT(ReadAction(&command->action));
+      CHECK_RESULT(ReadU8(&either, "either"));
+      command->expect_either = either != 0;
+      CHECK_RESULT(ReadExpectedValues(&command->expected));
+      *out_command = std::move(command);
+      break;
+    }
+
+    case CommandType::AssertTrap:
+      CHECK_RESULT(ReadAssertTrapCommand<AssertTrapCommand>(out_command));
+      break;
+
+    case CommandType::AssertExhaustion:
+      CHECK_RESULT(
+          ReadAssertTrapCommand<AssertExhaustionCommand>(out_command));
+      break;
+
+    case CommandType::AssertException: {
+      if (!s_features.exceptions_enabled()) {
+        PrintError("invalid command: exceptions not allowed");
+        return wabt::Result::Error;
+      }
+      auto command = std::make_unique<AssertExceptionCommand>();
+      CHECK_RESULT(ReadAction(&command->action));
+      *out_command = std::move(command);
+      break;
+    }
+
+    default:
+      PrintError("unknown command type: %u", type);
+      return wabt::Result::Error;
+  }
+
+  (*out_command)->line = line;
+  return wabt::Result::Ok;
+}
+
+wabt::Result BundleParser::ParseScript(Script* out_script) {
+  uint32_t version;
+  assert(IsBundle(data_, end_ - data_));
+  p_ = data_ + sizeof(kSpecBundleMagic);
+  if (static_cast<size_t>(end_ - p_) < sizeof(version)) {
+    PrintError("unable to read version");
+    return wabt::Result::Error;
+  }
+  memcpy(&version, p_, sizeof(version));
+  p_ += sizeof(version);
+  if (version != kSpecBundleVersion) {
+    PrintError("unsupported spec bundle version: %u", version);
+    return wabt::Result::Error;
+  }
+
+  CHECK_RESULT(ReadString(&out_script->filename, "source filename"));
+
+  struct ModuleExtent {
+    uint64_t offset;
+    uint64_t size;
+  };
+  std::vector<ModuleExtent> extents;
+  uint32_t num_modules;
+  CHECK_RESULT(ReadU32Leb128(&num_modules, "module count"));
+  for (uint32_t i = 0; i < num_modules; ++i) {
+    std::string filename;
+    ModuleExtent extent;
+    CHECK_RESULT(ReadString(&filename, "module filename"));
+    CHECK_RESULT(ReadU64Leb128(&extent.offset, "module offset"));
+    CHECK_RESULT(ReadU64Leb128(&extent.size, "module size"));
+    module_filenames_.push_back(CreateModulePath(filename_, filename));
+    extents.push_back(extent);
+  }
+
+  uint32_t num_commands;
+  CHECK_RESULT(ReadU32Leb128(&num_commands, "command count"));
+  for (uint32_t i = 0; i < num_commands; ++i) {
+    CommandPtr command;
+    CHECK_RESULT(ReadCommand(&command));
+    out_script->commands.push_back(std::move(command));
+  }
+
+  // The module data follows the commands.
+  uint64_t data_size = end_ - p_;
+  for (uint32_t i = 0; i < num_modules; ++i) {
+    const ModuleExtent& extent = extents[i];
+    if (extent.offset > data_size || extent.size > data_size - extent.offset) {
+      PrintError("module %u extends past the end of the bundle", i);
+      return wabt::Result::Error;
+    }
+    s_bundle_files[module_filenames_[i]] = std::string_view(
+        reinterpret_cast<const char*>(p_ + extent.offset), extent.size);
+  }
+  return wabt::Result::Ok;
+}
+
 struct ActionResult {
   ValueTypes types;
   Values values;
@@ -1256,6 +1785,7 @@ class CommandRunner {
                                     const char* desc);
 
   Store store_;
+  std::unique_ptr<Jit> jit_;
   Registry registry_;   // Used when importing.
   Registry instances_;  // Used when referencing module by name in invoke.
   ExportMap last_instance_;
@@ -1266,6 +1796,13 @@ class CommandRunner {
 };
 
 CommandRunner::CommandRunner() : store_(s_features) {
+  if (s_jit) {
+    JitOptions jit_options;
+    jit_options.log_stream = s_log_stream.get();
+    jit_ = std::make_unique<Jit>(store_, jit_options);
+    store_.set_jit(jit_.get());
+  }
+
   auto&& spectest = registry_["spectest"];
 
   // Initialize print functions for the spec test.
@@ -1433,11 +1970,11 @@ ActionResult CommandRunner::RunAction(int line_number,
 wabt::Result CommandRunner::ReadTextModule(std::string_view module_filename,
                                            const std::string& header,
                                            bool validate) {
-  std::vector<uint8_t> file_data;
-  wabt::Result result = ReadFile(module_filename, &file_data);
+  ModuleData file_data;
+  wabt::Result result = ReadModuleData(module_filename, &file_data);
   Errors errors;
   std::unique_ptr<WastLexer> lexer = WastLexer::CreateBufferLexer(
-      module_filename, file_data.data(), file_data.size(), &errors);
+      module_filename, file_data.data, file_data.size, &errors);
   if (Succeeded(result)) {
     std::unique_ptr<wabt::Module> module;
     WastParseOptions options(s_features);
@@ -1457,9 +1994,9 @@ wabt::Result CommandRunner::ReadTextModule(std::string_view module_filename,
 
 interp::Module::Ptr CommandRunner::ReadModule(std::string_view module_filename,
                                               Errors* errors) {
-  std::vector<uint8_t> file_data;
+  ModuleData file_data;
 
-  if (Failed(ReadFile(module_filename, &file_data))) {
+  if (Failed(ReadModuleData(module_filename, &file_data))) {
     return {};
   }
 
@@ -1469,9 +2006,9 @@ interp::Module::Ptr CommandRunner::ReadModule(std::string_view module_filename,
   ReadBinaryOptions options(s_features, s_log_stream.get(), kReadDebugNames,
                             kStopOnFirstError, kFailOnCustomSectionError);
   ModuleDesc module_desc;
-  if (Failed(ReadBinaryInterp(module_filename, file_data.data(),
-                              file_data.size(), options, errors,
-                              &module_desc))) {
+  if (Failed(ReadBinaryInterp(module_filename, file_data.data, file_data.size,
+                              options, errors, &module_desc,
+                              s_istream_options))) {
     return {};
   }
 
@@ -1513,9 +2050,9 @@ wabt::Result CommandRunner::ReadInvalidModule(int line_number,
 wabt::Result CommandRunner::ReadMalformedBinaryModule(
     std::string_view module_filename,
     Errors* errors) {
-  std::vector<uint8_t> file_data;
+  ModuleData file_data;
 
-  CHECK_RESULT(ReadFile(module_filename, &file_data));
+  CHECK_RESULT(ReadModuleData(module_filename, &file_data));
 
   const bool kReadDebugNames = true;
   const bool kStopOnFirstError = true;
@@ -1536,7 +2073,7 @@ wabt::Result CommandRunner::ReadMalformedBinaryModule(
   };
 
   BinaryReaderErrorLogging reader_delegate{errors};
-  return ReadBinary(file_data.data(), file_data.size(), &reader_delegate,
+  return ReadBinary(file_data.data, file_data.size, &reader_delegate,
                     options);
 }
 
@@ -2030,15 +2567,24 @@ void CommandRunner::TallyCommand(wabt::Result result) {
   total_++;
 }
 
-static int ReadAndRunSpecJSON(std::string_view spec_json_filename) {
-  JSONParser parser;
-  if (parser.ReadFile(spec_json_filename) == wabt::Result::Error) {
+static int ReadAndRunSpecScript(std::string_view filename) {
+  MappedFile file;
+  if (file.Open(filename) == wabt::Result::Error) {
     return 1;
   }
 
   Script script;
-  if (parser.ParseScript(&script) == wabt::Result::Error) {
-    return 1;
+  if (BundleParser::IsBundle(file.data(), file.size())) {
+    BundleParser parser(filename, file.data(), file.size());
+    if (parser.ParseScript(&script) == wabt::Result::Error) {
+      return 1;
+    }
+  } else {
+    JSONParser parser;
+    parser.SetInput(filename, file.data(), file.size());
+    if (parser.ParseScript(&script) == wabt::Result::Error) {
+      return 1;
+    }
   }
 
   CommandRunner runner;
@@ -2058,7 +2604,11 @@ int ProgramMain(int argc, char** argv) {
   s_stdout_stream = FileStream::CreateStdout();
 
   ParseOptions(argc, argv);
-  return spectest::ReadAndRunSpecJSON(s_infile);
+  if (s_jit && !Jit::IsSupported()) {
+    fprintf(stderr, "--jit is not supported on this platform\n");
+    return 1;
+  }
+  return spectest::ReadAndRunSpecScript(s_infile);
 }
 
 int main(int argc, char** argv) {
@@ -0,0 +1,828 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "wabt/apply-names.h"
+#include "wabt/binary-reader-ir.h"
+#include "wabt/binary-reader-nop.h"
+#include "wabt/binary-reader.h"
+#include "wabt/binary-writer.h"
+#include "wabt/c-writer.h"
+#include "wabt/error-formatter.h"
+#include "wabt/feature.h"
+#include "wabt/filenames.h"
+#include "wabt/generate-names.h"
+#include "wabt/interp/binary-reader-interp.h"
+#include "wabt/interp/interp.h"
+#include "wabt/ir.h"
+#include "wabt/option-parser.h"
+#include "wabt/stream.h"
+#include "wabt/validator.h"
+#include "wabt/wast-lexer.h"
+#include "wabt/wast-parser.h"
+#include "wabt/wat-writer.h"
+
+using namespace wabt;
+
+static std::vector<std::string> s_infiles;
+static std::string s_outfile;
+static std::string s_format = "console";
+static std::string s_filter;
+static double s_min_time = 0.5;
+static int s_scale = 1000;
+static bool s_generated = true;
+static bool s_list;
+static Features s_features;
+
+static const char s_description[] =
+    R"(  Benchmark each phase of the wabt tools: parsing text, reading binaries
+  (with no-op, IR and interpreter readers), validation, name generation,
+  writing text, binary and C, and instantiating and running modules in the
+  interpreter.
+
+  The corpus is a set of generated modules plus any .wat or .wasm files given
+  on the command line. A module is instantiated only if it has no imports,
+  and run only if it also exports a function "run" that takes no params.
+
+  Each benchmark is named <phase>/<module> and is repeated until it has run
+  for at least --min-time seconds. Results are printed as a table, or as
+  JSON in the format used by Google Benchmark, so two runs can be compared
+  with its tools/compare.py.
+
+examples:
+  # benchmark the generated corpus and dhrystone, and save the results
+  $ wabt-bench wasm2c/benchmarks/dhrystone/dhrystone.wasm -o before.json
+
+  # only time the interpreter running the generated kernels
+  $ wabt-bench --filter InterpRun/ --format json
+)";
+
+static void ParseOptions(int argc, char** argv) {
+  OptionParser parser("wabt-bench", s_description);
+
+  parser.AddOption('o', "output", "FILENAME",
+                   "Also write the results as JSON to FILENAME",
+                   [](const char* argument) { s_outfile = argument; });
+  parser.AddOption('\0', "format", "FORMAT",
+                   "Format of stdout, either console (the default) or json",
+                   [&parser](const char* argument) {
+                     s_format = argument;
+                     if (s_format != "console" && s_format != "json") {
+                       fprintf(stderr, "unknown format: %s\n", argument);
+                       parser.PrintHelp();
+                       exit(1);
+                     }
+                   });
+  parser.AddOption('f', "filter", "STRING",
+                   "Only run benchmarks whose name contains STRING",
+                   [](const char* argument) { s_filter = argument; });
+  parser.AddOption(
+      '\0', "min-time", "SECONDS",
+      "Minimum time to repeat each benchmark for (default 0.5)",
+      [](const char* argument) { s_min_time = strtod(argument, nullptr); });
+  parser.AddOption(
+      '\0', "scale", "N",
+      "Number of functions in the generated synthetic module (default 1000)",
+      [](const char* argument) { s_scale = std::max(1, atoi(argument)); });
+  parser.AddOption("no-generated", "Don't include the generated modules",
+                   []() { s_generated = false; });
+  parser.AddOption("list", "List the benchmarks instead of running them",
+                   []() { s_list = true; });
+  s_features.AddOptions(&parser);
+  parser.AddArgument("filename", OptionParser::ArgumentCount::ZeroOrMore,
+                     [](const char* argument) {
+                       std::string filename = argument;
+                       ConvertBackslashToSlash(&filename);
+                       s_infiles.push_back(filename);
+                     });
+  parser.Parse(argc, argv);
+}
+
+namespace {
+
+// Kernels for the interpreter. Each exports "run", which does a fixed amount
+// of work and returns a checksum.
+const char kFibWat[] = R"((module
+  (func $fib (param i32) (result i32)
+    (if (result i32) (i32.lt_u (local.get 0) (i32.const 2))
+      (then (local.get 0))
+      (else
+        (i32.add
+          (call $fib (i32.sub (local.get 0) (i32.const 1)))
+          (call $fib (i32.sub (local.get 0) (i32.const 2)))))))
+  (func (export "run") (result i32)
+    (call $fib (i32.const 24))))
+)";
+
+const char kSieveWat[] = R"((module
+  (memory 1)
+  (func (export "run") (result i32)
+    (local $i i32) (local $j i32) (local $count i32)
+    (loop $clear
+      (i64.store (local.get $i) (i64.const 0))
+      (br_if $clear
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 8)))
+                  (i32.const 65536))))
+    (local.set $i (i32.const 2))
+    (loop $outer
+      (if (i32.eqz (i32.load8_u (local.get $i)))
+        (then
+          (local.set $count (i32.add (local.get $count) (i32.const 1)))
+          (local.set $j (i32.mul (local.get $i) (local.get $i)))
+          (block $done
+            (loop $inner
+              (br_if $done (i32.ge_u (local.get $j) (i32.const 65536)))
+              (i32.store8 (local.get $j) (i32.const 1))
+              (local.set $j (i32.add (local.get $j) (local.get $i)))
+              (br $inner)))))
+      (br_if $outer
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 65536))))
+    (local.get $count)))
+)";
+
+const char kMatmulWat[] = R"((module
+  (memory 1)
+  (func $index (param $row i32) (param $col i32) (result i32)
+    (i32.shl (i32.add (i32.shl (local.get $row) (i32.const 5))
+                      (local.get $col))
+             (i32.const 3)))
+  (func (export "run") (result f64)
+    (local $i i32) (local $j i32) (local $k i32) (local $sum f64)
+    (local $total f64)
+    (loop $init
+      (f64.store (i32.shl (local.get $i) (i32.const 3))
+                 (f64.convert_i32_u (local.get $i)))
+      (f64.store offset=8192 (i32.shl (local.get $i) (i32.const 3))
+                 (f64.mul (f64.convert_i32_u (local.get $i)) (f64.const 0.5)))
+      (br_if $init
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 1024))))
+    (local.set $i (i32.const 0))
+    (loop $li
+      (local.set $j (i32.const 0))
+      (loop $lj
+        (local.set $sum (f64.const 0))
+        (local.set $k (i32.const 0))
+        (loop $lk
+          (local.set $sum
+            (f64.add (local.get $sum)
+              (f64.mul
+                (f64.load (call $index (local.get $i) (local.get $k)))
+                (f64.load offset=8192
+                  (call $index (local.get $k) (local.get $j))))))
+          (br_if $lk
+            (i32.lt_u (local.tee $k (i32.add (local.get $k) (i32.const 1)))
+                      (i32.const 32))))
+        (f64.store offset=16384 (call $index (local.get $i) (local.get $j))
+                   (local.get $sum))
+        (local.set $total (f64.add (local.get $total) (local.get $sum)))
+        (br_if $lj
+          (i32.lt_u (local.tee $j (i32.add (local.get $j) (i32.const 1)))
+                    (i32.const 32))))
+      (br_if $li
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 32))))
+    (local.get $total)))
+)";
+
+const char kMemcopyWat[] = R"((module
+  (memory 4)
+  (func (export "run") (result i32)
+    (local $i i32)
+    (loop $bytes
+      (i32.store8 offset=65536 (local.get $i) (i32.load8_u (local.get $i)))
+      (br_if $bytes
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 65536))))
+    (local.set $i (i32.const 0))
+    (loop $words
+      (i64.store offset=131072 (local.get $i)
+                 (i64.load offset=65536 (local.get $i)))
+      (br_if $words
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 8)))
+                  (i32.const 65536))))
+    (i32.load offset=131072 (i32.const 0))))
+)";
+
+// A module with `num_funcs` functions that each use locals of every type,
+// nested control flow, loads and stores, and direct and indirect calls, to
+// give the readers and writers a realistic mix of instructions.
+std::string GenerateSyntheticWat(int num_funcs) {
+  int table_size = std::min(num_funcs, 64);
+  std::string wat = "(module\n";
+  wat += "  (type $sig (func (param i32 i32) (result i32)))\n";
+  wat += "  (memory 1)\n";
+  wat += "  (global $g (mut i32) (i32.const 0))\n";
+  wat += StringPrintf("  (table %d funcref)\n", table_size);
+  wat += "  (elem (i32.const 0) func";
+  for (int i = 0; i < table_size; ++i) {
+    wat += StringPrintf(" $f%d", i);
+  }
+  wat += ")\n";
+  wat += "  (data (i32.const 16) \"synthetic\")\n";
+  for (int i = 0; i < num_funcs; ++i) {
+    std::string call = i == 0 ? "(i32.const 0)"
+                              : StringPrintf(
+                                    "(call $f%d (local.get $x) "
+                                    "(i32.wrap_i64 (local.get $y)))",
+                                    i - 1);
+    wat += StringPrintf(
+        "  (func $f%d (type $sig)\n"
+        "    (local $x i32) (local $y i64) (local $z f64)\n"
+        "    (local.set $x (i32.add (local.get 0) (i32.const %d)))\n"
+        "    (block $exit\n"
+        "      (loop $top\n"
+        "        (local.set $y (i64.add (local.get $y)\n"
+        "                               (i64.extend_i32_u (local.get $x))))\n"
+        "        (local.set $z (f64.add (local.get $z)\n"
+        "                               (f64.convert_i32_s (local.get 1))))\n"
+        "        (i32.store offset=%d (i32.const 0) (local.get $x))\n"
+        "        (br_if $exit (i32.eqz (local.get 1)))\n"
+        "        (local.set 1 (i32.sub (local.get 1) (i32.const 1)))\n"
+        "        (br_table $top $exit $top\n"
+        "          (i32.and (local.get $x) (i32.const 3)))))\n"
+        "    (global.set $g (i32.add (global.get $g) (local.get $x)))\n"
+        "    (if (result i32) (f64.gt (local.get $z) (f64.const 1.5))\n"
+        "      (then %s)\n"
+        "      (else\n"
+        "        (i32.add (i32.load offset=%d (i32.const 0))\n"
+        "          (call_indirect (type $sig) (local.get $x) (local.get 1)\n"
+        "            (i32.rem_u (local.get $x) (i32.const %d)))))))\n",
+        i, i, (i % 1024) * 4, call.c_str(), (i * 7 % 1024) * 4, table_size);
+    if (i % 16 == 0) {
+      wat += StringPrintf("  (export \"f%d\" (func $f%d))\n", i, i);
+    }
+  }
+  wat += ")\n";
+  return wat;
+}
+
+struct CorpusModule {
+  std::string name;
+  std::string text;  // Empty for modules read from a .wasm file.
+  std::vector<uint8_t> binary;
+};
+
+struct Benchmark {
+  std::string name;
+  // Bytes of input handled per iteration, for the reported throughput.
+  size_t bytes = 0;
+  // If set, called once before the benchmark is timed.
+  std::function<Result()> prepare;
+  // If set, called before every iteration without being timed.
+  std::function<Result()> setup;
+  std::function<Result()> run;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  uint64_t iterations = 0;
+  double real_ns = 0;
+  double cpu_ns = 0;
+  double bytes_per_second = 0;
+  std::string error;
+};
+
+ReadBinaryOptions GetReadBinaryOptions() {
+  const bool kReadDebugNames = true;
+  const bool kStopOnFirstError = true;
+  const bool kFailOnCustomSectionError = true;
+  return ReadBinaryOptions(s_features, nullptr, kReadDebugNames,
+                           kStopOnFirstError, kFailOnCustomSectionError);
+}
+
+Result ParseWat(const CorpusModule& corpus,
+                std::unique_ptr<Module>* out_module) {
+  Errors errors;
+  std::unique_ptr<WastLexer> lexer = WastLexer::CreateBufferLexer(
+      corpus.name, corpus.text.data(), corpus.text.size(), &errors);
+  WastParseOptions options(s_features);
+  Result result = ParseWatModule(lexer.get(), out_module, &errors, &options);
+  if (Failed(result)) {
+    auto line_finder = lexer->MakeLineFinder();
+    FormatErrorsToFile(errors, Location::Type::Text, line_finder.get());
+  }
+  return result;
+}
+
+Result ReadModule(const CorpusModule& corpus, Module* out_module) {
+  Errors errors;
+  Result result = ReadBinaryIr(corpus.name.c_str(), corpus.binary.data(),
+                               corpus.binary.size(), GetReadBinaryOptions(),
+                               &errors, out_module);
+  FormatErrorsToFile(errors, Location::Type::Binary);
+  return result;
+}
+
+// Reads a module and prepares it the way wasm2c does before writing C.
+Result ReadModuleForC(const CorpusModule& corpus, Module* out_module) {
+  CHECK_RESULT(ReadModule(corpus, out_module));
+  Errors errors;
+  Result result =
+      ValidateModule(out_module, &errors, ValidateOptions(s_features));
+  FormatErrorsToFile(errors, Location::Type::Binary);
+  CHECK_RESULT(result);
+  CHECK_RESULT(GenerateNames(out_module, NameOpts::LocalNamesOnDemand));
+  return ApplyNames(out_module);
+}
+
+Result LoadCorpusModule(const std::string& name,
+                        std::string text,
+                        std::vector<uint8_t> binary,
+                        std::vector<CorpusModule>* out_corpus) {
+  CorpusModule corpus;
+  corpus.name = name;
+  corpus.text = std::move(text);
+  corpus.binary = std::move(binary);
+  if (!corpus.text.empty()) {
+    std::unique_ptr<Module> module;
+    CHECK_RESULT(ParseWat(corpus, &module));
+    MemoryStream stream;
+    WriteBinaryOptions options;
+    options.features = s_features;
+    CHECK_RESULT(WriteBinaryModule(&stream, module.get(), options));
+    corpus.binary = std::move(stream.output_buffer().data);
+  }
+  out_corpus->push_back(std::move(corpus));
+  return Result::Ok;
+}
+
+void LoadCorpus(std::vector<CorpusModule>* out_corpus) {
+  if (s_generated) {
+    const struct {
+      const char* name;
+      std::string text;
+    } generated[] = {
+        {"fib", kFibWat},
+        {"sieve", kSieveWat},
+        {"matmul", kMatmulWat},
+        {"memcopy", kMemcopyWat},
+        {"synthetic", GenerateSyntheticWat(s_scale)},
+    };
+    for (const auto& module : generated) {
+      if (Failed(LoadCorpusModule(module.name, module.text, {}, out_corpus))) {
+        WABT_FATAL("unable to build generated module %s\n", module.name);
+      }
+    }
+  }
+
+  for (const std::string& filename : s_infiles) {
+    std::vector<uint8_t> file_data;
+    if (Failed(ReadFile(filename, &file_data))) {
+      exit(1);
+    }
+    std::string name(StripExtension(GetBasename(filename)));
+    Result result;
+    if (GetExtension(filename) == ".wat") {
+      std::string text(file_data.begin(), file_data.end());
+      result = LoadCorpusModule(name, std::move(text), {}, out_corpus);
+    } else {
+      result = LoadCorpusModule(name, {}, std::move(file_data), out_corpus);
+    }
+    if (Failed(result)) {
+      WABT_FATAL("unable to load %s\n", filename.c_str());
+    }
+  }
+}
+
+// A module read on first use, and shared by the benchmarks that don't modify
+// it.
+struct SharedModule {
+  Result Prepare(const CorpusModule& corpus,
+                 Result (*read)(const CorpusModule&, Module*)) {
+    if (!module) {
+      auto new_module = std::make_unique<Module>();
+      CHECK_RESULT(read(corpus, new_module.get()));
+      module = std::move(new_module);
+    }
+    return Result::Ok;
+  }
+
+  std::unique_ptr<Module> module;
+};
+
+// State shared by the interpreter benchmarks of one module.
+struct InterpState {
+  interp::Store store{s_features};
+  interp::ModuleDesc desc;
+  interp::Module::Ptr module;
+  interp::Instance::Ptr instance;
+  interp::Func::Ptr run;
+  std::unique_ptr<interp::Thread> thread;
+};
+
+Result InstantiateInterp(InterpState* state) {
+  interp::RefVec imports;
+  interp::Trap::Ptr trap;
+  state->instance = interp::Instance::Instantiate(
+      state->store, state->module.ref(), imports, &trap);
+  return state->instance ? Result::Ok : Result::Error;
+}
+
+void AddInterpBenchmarks(const CorpusModule& corpus,
+                         std::vector<Benchmark>* out) {
+  size_t bytes = corpus.binary.size();
+  out->push_back({"InterpCompile/" + corpus.name, bytes, {}, {}, [&corpus]() {
+                    Errors errors;
+                    interp::ModuleDesc desc;
+                    return interp::ReadBinaryInterp(
+                        corpus.name, corpus.binary.data(),
+                        corpus.binary.size(), GetReadBinaryOptions(), &errors,
+                        &desc);
+                  }});
+
+  auto state = std::make_shared<InterpState>();
+  Errors errors;
+  if (Failed(interp::ReadBinaryInterp(corpus.name, corpus.binary.data(),
+                                      corpus.binary.size(),
+                                      GetReadBinaryOptions(), &errors,
+                                      &state->desc)) ||
+      !state->desc.imports.empty()) {
+    return;
+  }
+  state->module = interp::Module::New(state->store, state->desc);
+
+  // The store only frees the previous instance when collected, so collect
+  // between iterations to keep memory use flat.
+  out->push_back({"InterpInstantiate/" + corpus.name, 0, {},
+                  [state]() {
+                    state->instance.reset();
+                    state->store.Collect();
+                    return Result::Ok;
+                  },
+                  [state]() { return InstantiateInterp(state.get()); }});
+
+  for (const interp::ExportDesc& export_ : state->desc.exports) {
+    if (export_.type.name != "run" ||
+        export_.type.type->kind != ExternalKind::Func ||
+        !cast<interp::FuncType>(export_.type.type.get())->params.empty()) {
+      continue;
+    }
+    Index run_index = export_.index;
+    // Instantiate once, untimed, after collecting the instances that
+    // InterpInstantiate left in the store, so the runs don't share the store
+    // with garbage.
+    out->push_back({"InterpRun/" + corpus.name, 0,
+                    [state, run_index]() {
+                      state->thread.reset();
+                      state->run.reset();
+                      state->instance.reset();
+                      state->store.Collect();
+                      CHECK_RESULT(InstantiateInterp(state.get()));
+                      state->run = state->store.UnsafeGet<interp::Func>(
+                          state->instance->funcs()[run_index]);
+                      state->thread =
+                          std::make_unique<interp::Thread>(state->store);
+                      return Result::Ok;
+                    },
+                    {},
+                    [state]() {
+                      interp::Values params;
+                      interp::Values results;
+                      interp::Trap::Ptr trap;
+                      return state->run->Call(*state->thread, params, results,
+                                              &trap);
+                    }});
+  }
+}
+
+void AddBenchmarks(const CorpusModule& corpus, std::vector<Benchmark>* out) {
+  const std::string& name = corpus.name;
+  size_t bytes = corpus.binary.size();
+
+  if (!corpus.text.empty()) {
+    out->push_back(
+        {"ParseWat/" + name, corpus.text.size(), {}, {}, [&corpus]() {
+           std::unique_ptr<Module> module;
+           return ParseWat(corpus, &module);
+         }});
+  }
+
+  out->push_back({"ReadBinary/" + name, bytes, {}, {}, [&corpus]() {
+                    BinaryReaderNop nop;
+                    return ReadBinary(corpus.binary.data(),
+                                      corpus.binary.size(), &nop,
+                                      GetReadBinaryOptions());
+                  }});
+
+  out->push_back({"ReadBinaryIr/" + name, bytes, {}, {}, [&corpus]() {
+                    Module module;
+                    return ReadModule(corpus, &module);
+                  }});
+
+  auto shared = std::make_shared<SharedModule>();
+  auto prepare_shared = [&corpus, shared]() {
+    return shared->Prepare(corpus, ReadModule);
+  };
+
+  out->push_back({"Validate/" + name, bytes, prepare_shared, {}, [shared]() {
+                    Errors errors;
+                    return ValidateModule(shared->module.get(), &errors,
+                                          ValidateOptions(s_features));
+                  }});
+
+  // GenerateNames modifies the module, so read a fresh one every iteration.
+  auto names_module = std::make_shared<std::unique_ptr<Module>>();
+  out->push_back({"GenerateNames/" + name, bytes, {},
+                  [&corpus, names_module]() {
+                    *names_module = std::make_unique<Module>();
+                    return ReadModule(corpus, names_module->get());
+                  },
+                  [names_module]() {
+                    return GenerateNames(names_module->get(),
+                                         NameOpts::LocalNamesOnDemand);
+                  }});
+
+  out->push_back({"WriteWat/" + name, bytes, prepare_shared, {}, [shared]() {
+                    MemoryStream stream;
+                    return WriteWat(&stream, shared->module.get(),
+                                    WriteWatOptions(s_features));
+                  }});
+
+  out->push_back({"WriteBinary/" + name, bytes, prepare_shared, {},
+                  [shared]() {
+                    MemoryStream stream;
+                    WriteBinaryOptions options;
+                    options.features = s_features;
+                    return WriteBinaryModule(&stream, shared->module.get(),
+                                             options);
+                  }});
+
+  auto c_shared = std::make_shared<SharedModule>();
+  out->push_back({"WriteC/" + name, bytes,
+                  [&corpus, c_shared]() {
+                    return c_shared->Prepare(corpus, ReadModuleForC);
+                  },
+                  {},
+                  [c_shared]() {
+                    MemoryStream c_stream;
+                    MemoryStream h_stream;
+                    WriteCOptions options;
+                    options.module_name = "bench";
+                    options.features = s_features;
+                    return WriteC({&c_stream}, &h_stream, &h_stream, "bench.h",
+                                  "", c_shared->module.get(), options);
+                  }});
+
+  AddInterpBenchmarks(corpus, out);
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+double CpuSecondsSince(std::clock_t start) {
+  return static_cast<double>(std::clock() - start) /
+         static_cast<double>(CLOCKS_PER_SEC);
+}
+
+// Runs `iterations` iterations, and returns the time spent in `run`.
+Result TimeIterations(const Benchmark& benchmark,
+                      uint64_t iterations,
+                      double* out_real,
+                      double* out_cpu) {
+  *out_real = 0;
+  *out_cpu = 0;
+  if (!benchmark.setup) {
+    // Time the whole batch, so cheap benchmarks aren't dominated by reading
+    // the clocks.
+    auto real_start = std::chrono::steady_clock::now();
+    std::clock_t cpu_start = std::clock();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      CHECK_RESULT(benchmark.run());
+    }
+    *out_cpu = CpuSecondsSince(cpu_start);
+    *out_real = SecondsSince(real_start);
+    return Result::Ok;
+  }
+
+  for (uint64_t i = 0; i < iterations; ++i) {
+    CHECK_RESULT(benchmark.setup());
+    auto real_start = std::chrono::steady_clock::now();
+    std::clock_t cpu_start = std::clock();
+    CHECK_RESULT(benchmark.run());
+    *out_cpu += CpuSecondsSince(cpu_start);
+    *out_real += SecondsSince(real_start);
+  }
+  return Result::Ok;
+}
+
+BenchmarkResult RunBenchmark(const Benchmark& benchmark) {
+  const uint64_t kMaxIterations = 1000000000;
+
+  BenchmarkResult result;
+  result.name = benchmark.name;
+  if (benchmark.prepare && Failed(benchmark.prepare())) {
+    result.error = "benchmark failed";
+    return result;
+  }
+
+  // Untimed setup can be much slower than the benchmark itself, so also give
+  // up growing once the runs, setup included, have taken long enough.
+  auto start = std::chrono::steady_clock::now();
+  uint64_t iterations = 1;
+  double real;
+  double cpu;
+  while (true) {
+    if (Failed(TimeIterations(benchmark, iterations, &real, &cpu))) {
+      result.error = "benchmark failed";
+      return result;
+    }
+    if (real >= s_min_time || iterations >= kMaxIterations ||
+        SecondsSince(start) >= 10 * s_min_time) {
+      break;
+    }
+    // As Google Benchmark does, aim a bit past the minimum time, but don't
+    // grow by more than 10x at once since the first runs are noisy.
+    double multiplier = s_min_time * 1.4 / std::max(real, 1e-9);
+    multiplier = std::min(multiplier, 10.0);
+    uint64_t next = static_cast<uint64_t>(iterations * multiplier);
+    iterations = std::min(std::max(next, iterations + 1), kMaxIterations);
+  }
+
+  result.iterations = iterations;
+  result.real_ns = real * 1e9 / iterations;
+  result.cpu_ns = cpu * 1e9 / iterations;
+  if (benchmark.bytes != 0 && real > 0) {
+    result.bytes_per_second = benchmark.bytes * iterations / real;
+  }
+  return result;
+}
+
+void WriteConsoleHeader(Stream* stream, size_t name_width) {
+  stream->Writef("%-*s %14s %14s %12s %14s\n", static_cast<int>(name_width),
+                 "Benchmark", "Time (ns)", "CPU (ns)", "Iterations",
+                 "Throughput");
+  stream->Writef("%s\n", std::string(name_width + 58, '-').c_str());
+}
+
+void WriteConsoleResult(Stream* stream,
+                        size_t name_width,
+                        const BenchmarkResult& result) {
+  if (!result.error.empty()) {
+    stream->Writef("%-*s ERROR: %s\n", static_cast<int>(name_width),
+                   result.name.c_str(), result.error.c_str());
+    return;
+  }
+  stream->Writef("%-*s %14.0f %14.0f %12" PRIu64,
+                 static_cast<int>(name_width), result.name.c_str(),
+                 result.real_ns, result.cpu_ns, result.iterations);
+  if (result.bytes_per_second != 0) {
+    stream->Writef(" %9.2f MB/s", result.bytes_per_second / (1024 * 1024));
+  }
+  stream->Writef("\n");
+}
+
+void WriteJsonString(Stream* stream, std::string_view s) {
+  stream->WriteChar('"');
+  for (char c : s) {
+    if (static_cast<uint8_t>(c) < 0x20 || c == '\\' || c == '"') {
+      stream->Writef("\\u%04x", static_cast<uint8_t>(c));
+    } else {
+      stream->WriteChar(c);
+    }
+  }
+  stream->WriteChar('"');
+}
+
+void WriteJson(Stream* stream,
+               const char* executable,
+               const std::vector<BenchmarkResult>& results) {
+  char date[64];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z",
+                std::localtime(&now));
+
+  stream->Writef("{\n  \"context\": {\n    \"date\": ");
+  WriteJsonString(stream, date);
+  stream->Writef(",\n    \"executable\": ");
+  WriteJsonString(stream, executable);
+  stream->Writef(",\n    \"num_cpus\": %u",
+                 std::thread::hardware_concurrency());
+  stream->Writef(",\n    \"library_build_type\": ");
+#ifdef NDEBUG
+  WriteJsonString(stream, "release");
+#else
+  WriteJsonString(stream, "debug");
+#endif
+  stream->Writef(",\n    \"wabt_version\": ");
+  WriteJsonString(stream, WABT_VERSION_STRING);
+  stream->Writef(",\n    \"min_time\": %g", s_min_time);
+  stream->Writef(",\n    \"scale\": %d\n  },\n  \"benchmarks\": [", s_scale);
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    stream->Writef("%s\n    {\n      \"name\": ", i == 0 ? "" : ",");
+    WriteJsonString(stream, result.name);
+    stream->Writef(",\n      \"run_name\": ");
+    WriteJsonString(stream, result.name);
+    stream->Writef(",\n      \"run_type\": \"iteration\"");
+    if (!result.error.empty()) {
+      stream->Writef(",\n      \"error_occurred\": true");
+      stream->Writef(",\n      \"error_message\": ");
+      WriteJsonString(stream, result.error);
+    } else {
+      stream->Writef(",\n      \"iterations\": %" PRIu64, result.iterations);
+      stream->Writef(",\n      \"real_time\": %.10g", result.real_ns);
+      stream->Writef(",\n      \"cpu_time\": %.10g", result.cpu_ns);
+      stream->Writef(",\n      \"time_unit\": \"ns\"");
+      if (result.bytes_per_second != 0) {
+        stream->Writef(",\n      \"bytes_per_second\": %.10g",
+                       result.bytes_per_second);
+      }
+    }
+    stream->Writef("\n    }");
+  }
+  stream->Writef("\n  ]\n}\n");
+}
+
+}  // end anonymous namespace
+
+int ProgramMain(int argc, char** argv) {
+  InitStdio();
+  ParseOptions(argc, argv);
+
+  std::vector<CorpusModule> corpus;
+  LoadCorpus(&corpus);
+
+  std::vector<Benchmark> benchmarks;
+  for (const CorpusModule& module : corpus) {
+    AddBenchmarks(module, &benchmarks);
+  }
+  benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(),
+                                  [&](const Benchmark& benchmark) {
+                                    return benchmark.name.find(s_filter) ==
+                                           std::string::npos;
+                                  }),
+                   benchmarks.end());
+
+  FileStream stdout_stream(stdout);
+  if (s_list) {
+    for (const Benchmark& benchmark : benchmarks) {
+      stdout_stream.Writef("%s\n", benchmark.name.c_str());
+    }
+    return 0;
+  }
+
+  size_t name_width = 9;
+  for (const Benchmark& benchmark : benchmarks) {
+    name_width = std::max(name_width, benchmark.name.size());
+  }
+  bool console = s_format == "console";
+  if (console) {
+    WriteConsoleHeader(&stdout_stream, name_width);
+  }
+
+  std::vector<BenchmarkResult> results;
+  bool failed = false;
+  for (const Benchmark& benchmark : benchmarks) {
+    results.push_back(RunBenchmark(benchmark));
+    failed |= !results.back().error.empty();
+    if (console) {
+      WriteConsoleResult(&stdout_stream, name_width, results.back());
+      fflush(stdout);
+    }
+  }
+
+  if (!console) {
+    WriteJson(&stdout_stream, argv[0], results);
+  }
+  if (!s_outfile.empty()) {
+    FileStream file_stream(s_outfile);
+    WriteJson(&file_stream, argv[0], results);
+  }
+  return failed;
+}
+
+int main(int argc, char** argv) {
+  WABT_TRY
+  return ProgramMain(argc, argv);
+  WABT_CATCH_BAD_ALLOC_AND_EXIT
+}
@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <memory>
@@ -26,11 +28,16 @@
 #include "wabt/error-formatter.h"
 #include "wabt/feature.h"
 #include "wabt/interp/binary-reader-interp.h"
+#include "wabt/interp/interp-jit.h"
+#include "wabt/interp/interp-tier-up.h"
 #include "wabt/interp/interp-util.h"
 #include "wabt/interp/interp-wasi.h"
 #include "wabt/interp/interp.h"
+#include "wabt/interp/istream-cache.h"
 #include "wabt/literal.h"
+#include "wabt/memory-stats.h"
 #include "wabt/option-parser.h"
+#include "wabt/pass-timer.h"
 #include "wabt/stream.h"
 
 #ifdef WITH_WASI
@@ -66,12 +73,30 @@ static std::vector<FunctionCall> s_run_exports;
 static std::vector<std::string> s_wasi_env;
 static std::vector<std::string> s_wasi_argv;
 static std::vector<std::string> s_wasi_dirs;
+static bool s_stats;
+static std::unique_ptr<MemoryStats> s_mem_stats;
+static bool s_tier_up;
+static TierUpOptions s_tier_up_options;
+static bool s_jit;
+static IstreamOptions s_istream_options;
+static std::unique_ptr<IstreamCache> s_istream_cache;
+
+// Totals for --stats.
+static bool s_istream_cache_hit;
+static double s_load_seconds;
+static Istream::Offset s_istream_size;
+static u64 s_instruction_count;
+static u64 s_tos_hit_count;
+static double s_run_seconds;
 
 static std::unique_ptr<FileStream> s_log_stream;
 static std::unique_ptr<FileStream> s_stdout_stream;
 static std::unique_ptr<FileStream> s_stderr_stream;
 
 static Store s_store;
+// Destroyed before s_store, since it keeps instances in the store alive.
+static std::unique_ptr<TierUp> s_tier_up_compiler;
+static std::unique_ptr<Jit> s_jit_compiler;
 
 static const char s_description[] =
     R"(  read a file in the wasm binary format, and run in it a stack-based
@@ -93,6 +118,9 @@ examples:
 
   # parse test.wasm, run specific exported function by name with argument
   $ wasm-interp test.wasm -r "func_sum" -a "i32:8" -a "i32:5"
+
+  # run the export "run", and print how many instructions it executed
+  $ wasm-interp test.wasm -r run --stats
 )";
 
 Result ParseWasmValue(std::string argument, Value& val) {
@@ -194,6 +222,66 @@ static void ParseOptions(int argc, char** argv) {
                    "Include an importable function named \"host.print\" for "
                    "printing to stdout",
                    []() { s_host_print = true; });
+  parser.AddOption("stats",
+                   "Print the module load time, whether --cache-dir had the "
+                   "module, the istream size, the number of instructions "
+                   "executed by --run-export and --run-all-exports, the run "
+                   "time and the peak memory use to stderr",
+                   []() { s_stats = true; });
+  parser.AddOption("mem-stats",
+                   "Print the memory used by the store and the interpreter "
+                   "stacks, by category, and the peak memory use to stderr",
+                   []() { s_mem_stats = std::make_unique<MemoryStats>(); });
+  parser.AddOption("tier-up",
+                   "Compile hot functions to native code with wasm2c and the "
+                   "system C compiler, and run them from then on",
+                   []() { s_tier_up = true; });
+  parser.AddOption('\0', "tier-up-threshold", "N",
+                   "Calls plus loop iterations after which a function is "
+                   "compiled (default: 10000)",
+                   [](const std::string& argument) {
+                     s_tier_up_options.threshold = atoi(argument.c_str());
+                   });
+  parser.AddOption('\0', "tier-up-cc", "CMD",
+                   "C compiler command used by --tier-up, including any "
+                   "flags such as the ggt include path (default: \"cc -O2\")",
+                   [](const std::string& argument) {
+                     s_tier_up_options.cc = argument;
+                   });
+  parser.AddOption('\0', "tier-up-ggt-thread", "EXPR",
+                   "C expression for the ggt_thread_t* that native code runs "
+                   "on, evaluated on each call into it; required by --tier-up",
+                   [](const std::string& argument) {
+                     s_tier_up_options.ggt_thread = argument;
+                   });
+  parser.AddOption('\0', "tier-up-runtime", "DIR",
+                   "Directory with the wasm2c runtime sources used by "
+                   "--tier-up",
+                   [](const std::string& argument) {
+                     s_tier_up_options.runtime_dir = argument;
+                   });
+  parser.AddOption("jit",
+                   "Compile functions to x86-64 machine code when they are "
+                   "first called, leaving calls and the instructions the JIT "
+                   "doesn't handle to the interpreter",
+                   []() { s_jit = true; });
+  s_istream_options.optimize = true;
+  parser.AddOption("no-optimize",
+                   "Run each function's istream as it was read, without "
+                   "folding constants or combining local and drop "
+                   "instructions",
+                   []() { s_istream_options.optimize = false; });
+  parser.AddOption("tos-cache",
+                   "Keep the top of the value stack in a register across "
+                   "runs of arithmetic, constant and local instructions",
+                   []() { s_istream_options.cache_top_of_stack = true; });
+  parser.AddOption('\0', "cache-dir", "DIR",
+                   "Keep compiled modules in DIR, keyed by a hash of the "
+                   "module and the options that affect compilation, and "
+                   "reuse them instead of reading the module again",
+                   [](const std::string& argument) {
+                     s_istream_cache = std::make_unique<IstreamCache>(argument);
+                   });
   parser.AddOption(
       "dummy-import-func",
       "Provide a dummy implementation of all imported functions. The function "
@@ -208,6 +296,22 @@ static void ParseOptions(int argc, char** argv) {
   parser.Parse(argc, argv);
 }
 
+static Result CallFunc(const Func::Ptr& func,
+                       const Values& params,
+                       Values& results,
+                       Trap::Ptr* trap) {
+  Thread thread(s_store, s_trace_stream);
+  Result result = func->Call(thread, params, results, trap);
+  s_instruction_count += thread.instruction_count();
+  s_tos_hit_count += thread.tos_hit_count();
+  // Every thread is created with the same options and they run one at a
+  // time, so the stacks of one are representative.
+  if (s_mem_stats && !s_mem_stats->Find("interp.value_stacks")) {
+    thread.AccountMemory(s_mem_stats.get());
+  }
+  return result;
+}
+
 Result RunSpecificExports(const Instance::Ptr& instance,
                           Errors* errors,
                           std::vector<FunctionCall>& calls) {
@@ -238,8 +342,7 @@ Result RunSpecificExports(const Instance::Ptr& instance,
         auto func = s_store.UnsafeGet<Func>(instance->funcs()[export_.index]);
         Values results;
         Trap::Ptr trap;
-        result |=
-            func->Call(s_store, call_.args, results, &trap, s_trace_stream);
+        result |= CallFunc(func, call_.args, results, &trap);
         WriteCall(s_stdout_stream.get(), export_.type.name, *func_type,
                   call_.args, results, trap);
       }
@@ -269,7 +372,7 @@ Result RunAllExports(const Instance::Ptr& instance, Errors* errors) {
       Values params;
       Values results;
       Trap::Ptr trap;
-      result |= func->Call(s_store, params, results, &trap, s_trace_stream);
+      result |= CallFunc(func, params, results, &trap);
       WriteCall(s_stdout_stream.get(), export_.type.name, *func_type, params,
                 results, trap);
     }
@@ -315,21 +418,46 @@ static Result ReadModule(const char* module_filename,
   std::vector<uint8_t> file_data;
   CHECK_RESULT(ReadFile(module_filename, &file_data));
 
+  auto load_start = std::chrono::steady_clock::now();
   ModuleDesc module_desc;
-  const bool kReadDebugNames = true;
-  const bool kStopOnFirstError = true;
-  const bool kFailOnCustomSectionError = true;
-  ReadBinaryOptions options(s_features, s_log_stream.get(), kReadDebugNames,
-                            kStopOnFirstError, kFailOnCustomSectionError);
-  CHECK_RESULT(ReadBinaryInterp(module_filename, file_data.data(),
-                                file_data.size(), options, errors,
-                                &module_desc));
+  std::string cache_key;
+  if (s_istream_cache) {
+    cache_key = IstreamCache::GetKey(file_data.data(), file_data.size(),
+                                     s_features, s_istream_options);
+    s_istream_cache_hit =
+        Succeeded(s_istream_cache->Load(cache_key, &module_desc));
+  }
+  if (!s_istream_cache_hit) {
+    const bool kReadDebugNames = true;
+    const bool kStopOnFirstError = true;
+    const bool kFailOnCustomSectionError = true;
+    ReadBinaryOptions options(s_features, s_log_stream.get(), kReadDebugNames,
+                              kStopOnFirstError, kFailOnCustomSectionError);
+    CHECK_RESULT(ReadBinaryInterp(module_filename, file_data.data(),
+                                  file_data.size(), options, errors,
+                                  &module_desc, s_istream_options));
+    // A module that can't be cached is still run; it is just read again next
+    // time.
+    if (s_istream_cache) {
+      s_istream_cache->Save(cache_key, module_desc);
+    }
+  }
+  s_load_seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - load_start)
+                       .count();
 
   if (s_verbose) {
     module_desc.istream.Disassemble(stream);
   }
+  s_istream_size = module_desc.istream.end();
+  if (s_mem_stats) {
+    s_mem_stats->Add("input", MemoryStats::HeapBytes(file_data));
+  }
 
   *out_module = Module::New(s_store, module_desc);
+  if (s_tier_up_compiler) {
+    s_tier_up_compiler->AddModule(*out_module, std::move(file_data));
+  }
   return Result::Ok;
 }
 
@@ -422,6 +550,7 @@ static Result ReadAndRunModule(const char* module_filename) {
   Instance::Ptr instance;
   CHECK_RESULT(InstantiateModule(imports, module, &instance));
 
+  auto run_start = std::chrono::steady_clock::now();
   if (s_run_all_exports) {
     RunAllExports(instance, &errors);
   }
@@ -435,10 +564,41 @@ static Result ReadAndRunModule(const char* module_filename) {
         WasiRunStart(instance, &uvwasi, s_stderr_stream.get(), s_trace_stream));
   }
 #endif
+  s_run_seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - run_start)
+                      .count();
 
   return Result::Ok;
 }
 
+static void WriteStats(Stream* stream) {
+  if (s_istream_cache) {
+    stream->Writef("istream cache: %s\n", s_istream_cache_hit ? "hit" : "miss");
+  }
+  stream->Writef("load time: %.6f s\n", s_load_seconds);
+  stream->Writef("istream size: %u bytes\n", s_istream_size);
+  stream->Writef("instructions executed: %" PRIu64 "\n", s_instruction_count);
+  // Each TOS hit saves a push and a pop.
+  stream->Writef("value stack accesses avoided: %" PRIu64 "\n",
+                 2 * s_tos_hit_count);
+  stream->Writef("run time: %.6f s\n", s_run_seconds);
+  if (s_run_seconds > 0) {
+    stream->Writef("instructions/s: %.0f\n",
+                   s_instruction_count / s_run_seconds);
+  }
+  if (s_tier_up_compiler) {
+    stream->Writef("native functions: %u\n",
+                   s_tier_up_compiler->native_func_count());
+  }
+  if (s_jit_compiler) {
+    stream->Writef("jit functions: %u compiled, %u interpreted\n",
+                   s_jit_compiler->compiled_func_count(),
+                   s_jit_compiler->rejected_func_count());
+  }
+  stream->Writef("peak RSS: %" PRIu64 " KB\n",
+                 PassTimer::GetPeakRss() / 1024);
+}
+
 int ProgramMain(int argc, char** argv) {
   InitStdio();
   s_stdout_stream = FileStream::CreateStdout();
@@ -446,8 +606,42 @@ int ProgramMain(int argc, char** argv) {
 
   ParseOptions(argc, argv);
   s_store.setFeatures(s_features);
+  if (s_tier_up) {
+    if (!TierUp::IsSupported()) {
+      fprintf(stderr, "--tier-up is not supported on this platform\n");
+      return 1;
+    }
+    if (s_tier_up_options.ggt_thread.empty()) {
+      fprintf(stderr, "--tier-up requires --tier-up-ggt-thread\n");
+      return 1;
+    }
+    s_tier_up_options.log_stream = s_log_stream.get();
+    s_tier_up_compiler = std::make_unique<TierUp>(s_store, s_tier_up_options);
+    s_store.set_tier_up(s_tier_up_compiler.get());
+  }
+  if (s_jit) {
+    if (!Jit::IsSupported()) {
+      fprintf(stderr, "--jit is not supported on this platform\n");
+      return 1;
+    }
+    JitOptions jit_options;
+    jit_options.log_stream = s_log_stream.get();
+    s_jit_compiler = std::make_unique<Jit>(s_store, jit_options);
+    s_store.set_jit(s_jit_compiler.get());
+  }
 
   wabt::Result result = ReadAndRunModule(s_infile);
+  if (s_stats) {
+    WriteStats(s_stderr_stream.get());
+  }
+  if (s_mem_stats) {
+    // Objects stay in the store until it is collected, so this includes the
+    // module and instance even though nothing refers to them any more.
+    s_store.AccountMemory(s_mem_stats.get());
+    s_mem_stats->Print(s_stderr_stream.get());
+    s_stderr_stream->Writef("peak RSS: %" PRIu64 " KB\n",
+                            PassTimer::GetPeakRss() / 1024);
+  }
   return result != wabt::Result::Ok;
 }
 
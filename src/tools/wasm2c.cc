@@ -27,7 +27,9 @@
 #include "wabt/filenames.h"
 #include "wabt/generate-names.h"
 #include "wabt/ir.h"
+#include "wabt/memory-stats.h"
 #include "wabt/option-parser.h"
+#include "wabt/pass-timer.h"
 #include "wabt/result.h"
 #include "wabt/stream.h"
 #include "wabt/validator.h"
@@ -44,6 +46,8 @@ static unsigned int s_num_outputs = 1;
 static WriteCOptions s_write_c_options;
 static bool s_read_debug_names = true;
 static std::unique_ptr<FileStream> s_log_stream;
+static std::unique_ptr<PassTimer> s_timer;
+static std::unique_ptr<MemoryStats> s_mem_stats;
 
 static const char s_description[] =
     R"(  Read a file in the WebAssembly binary format, and convert it to
@@ -91,9 +95,26 @@ static void ParseOptions(int argc, char** argv) {
       "names section is used. If that is not present the name of the input\n"
       "file is used as the default.\n",
       [](const char* argument) { s_write_c_options.module_name = argument; });
+  parser.AddOption("profile",
+                   "Count entries to each function in a per-instance buffer",
+                   []() { s_write_c_options.profile = true; });
+  parser.AddOption("profile-loops",
+                   "Also count executions of each loop header (implies "
+                   "--profile)",
+                   []() {
+                     s_write_c_options.profile = true;
+                     s_write_c_options.profile_loops = true;
+                   });
   s_write_c_options.features.AddOptions(&parser);
   parser.AddOption("no-debug-names", "Ignore debug names in the binary file",
                    []() { s_read_debug_names = false; });
+  parser.AddOption("time-passes",
+                   "Print the time and peak memory use of each phase to stderr",
+                   []() { s_timer = std::make_unique<PassTimer>(); });
+  parser.AddOption("mem-stats",
+                   "Print the memory used by the module and the C writer, by "
+                   "category, and the peak memory use to stderr",
+                   []() { s_mem_stats = std::make_unique<MemoryStats>(); });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) {
                        s_infile = argument;
@@ -124,7 +145,10 @@ Result Wasm2cMain(Errors& errors) {
   }
 
   std::vector<uint8_t> file_data;
-  CHECK_RESULT(ReadFile(s_infile.c_str(), &file_data));
+  {
+    PassTimer::Scope scope(s_timer.get(), "ReadFile");
+    CHECK_RESULT(ReadFile(s_infile.c_str(), &file_data));
+  }
 
   Module module;
   const bool kStopOnFirstError = true;
@@ -132,13 +156,33 @@ Result Wasm2cMain(Errors& errors) {
   ReadBinaryOptions options(s_write_c_options.features, s_log_stream.get(),
                             s_read_debug_names, kStopOnFirstError,
                             kFailOnCustomSectionError);
-  CHECK_RESULT(ReadBinaryIr(s_infile.c_str(), file_data.data(),
-                            file_data.size(), options, &errors, &module));
-  CHECK_RESULT(ValidateModule(&module, &errors, s_write_c_options.features));
-  CHECK_RESULT(GenerateNames(&module));
-  /* TODO(binji): This shouldn't fail; if a name can't be applied
-   * (because the index is invalid, say) it should just be skipped. */
-  ApplyNames(&module);
+  {
+    PassTimer::Scope scope(s_timer.get(), "ReadBinaryIr");
+    CHECK_RESULT(ReadBinaryIr(s_infile.c_str(), file_data.data(),
+                              file_data.size(), options, &errors, &module));
+  }
+  {
+    PassTimer::Scope scope(s_timer.get(), "ValidateModule");
+    CHECK_RESULT(ValidateModule(&module, &errors, s_write_c_options.features));
+  }
+  {
+    PassTimer::Scope scope(s_timer.get(), "GenerateNames");
+    CHECK_RESULT(GenerateNames(&module, NameOpts::LocalNamesOnDemand));
+  }
+  {
+    PassTimer::Scope scope(s_timer.get(), "ApplyNames");
+    /* TODO(binji): This shouldn't fail; if a name can't be applied
+     * (because the index is invalid, say) it should just be skipped. */
+    ApplyNames(&module);
+  }
+
+  if (s_mem_stats) {
+    s_mem_stats->Add("input", MemoryStats::HeapBytes(file_data));
+    AccountMemory(module, s_mem_stats.get());
+  }
+
+  s_write_c_options.timer = s_timer.get();
+  s_write_c_options.mem_stats = s_mem_stats.get();
 
   if (!s_outfile.empty()) {
     std::string header_name_full =
@@ -195,8 +239,20 @@ int ProgramMain(int argc, char** argv) {
   ParseOptions(argc, argv);
 
   Errors errors;
-  result = Wasm2cMain(errors);
+  {
+    PassTimer::Scope scope(s_timer.get(), "total");
+    result = Wasm2cMain(errors);
+  }
   FormatErrorsToFile(errors, Location::Type::Binary);
+  if (s_timer) {
+    s_timer->Print(FileStream::CreateStderr().get());
+  }
+  if (s_mem_stats) {
+    auto stream = FileStream::CreateStderr();
+    s_mem_stats->Print(stream.get());
+    stream->Writef("peak RSS: %" PRIu64 " KB\n",
+                   PassTimer::GetPeakRss() / 1024);
+  }
 
   return result != Result::Ok;
 }
@@ -26,7 +26,9 @@
 #include "wabt/feature.h"
 #include "wabt/generate-names.h"
 #include "wabt/ir.h"
+#include "wabt/memory-stats.h"
 #include "wabt/option-parser.h"
+#include "wabt/pass-timer.h"
 #include "wabt/stream.h"
 #include "wabt/validator.h"
 #include "wabt/wast-lexer.h"
@@ -45,6 +47,8 @@ static bool s_inline_export;
 static bool s_read_debug_names = true;
 static bool s_fail_on_custom_section_error = true;
 static std::unique_ptr<FileStream> s_log_stream;
+static std::unique_ptr<PassTimer> s_timer;
+static bool s_mem_stats;
 static bool s_validate = true;
 
 static const char s_description[] =
@@ -91,6 +95,13 @@ static void ParseOptions(int argc, char** argv) {
       []() { s_generate_names = true; });
   parser.AddOption("no-check", "Don't check for invalid modules",
                    []() { s_validate = false; });
+  parser.AddOption("time-passes",
+                   "Print the time and peak memory use of each phase to stderr",
+                   []() { s_timer = std::make_unique<PassTimer>(); });
+  parser.AddOption("mem-stats",
+                   "Print the memory used by the module, by category, and the "
+                   "peak memory use to stderr",
+                   []() { s_mem_stats = true; });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) {
                        s_infile = argument;
@@ -105,8 +116,12 @@ int ProgramMain(int argc, char** argv) {
   InitStdio();
   ParseOptions(argc, argv);
 
+  PassTimer::Scope total_scope(s_timer.get(), "total");
   std::vector<uint8_t> file_data;
-  result = ReadFile(s_infile.c_str(), &file_data);
+  {
+    PassTimer::Scope scope(s_timer.get(), "ReadFile");
+    result = ReadFile(s_infile.c_str(), &file_data);
+  }
   if (Succeeded(result)) {
     Errors errors;
     Module module;
@@ -114,19 +129,25 @@ int ProgramMain(int argc, char** argv) {
     ReadBinaryOptions options(s_features, s_log_stream.get(),
                               s_read_debug_names, kStopOnFirstError,
                               s_fail_on_custom_section_error);
-    result = ReadBinaryIr(s_infile.c_str(), file_data.data(), file_data.size(),
-                          options, &errors, &module);
+    {
+      PassTimer::Scope scope(s_timer.get(), "ReadBinaryIr");
+      result = ReadBinaryIr(s_infile.c_str(), file_data.data(),
+                            file_data.size(), options, &errors, &module);
+    }
     if (Succeeded(result)) {
       if (Succeeded(result) && s_validate) {
+        PassTimer::Scope scope(s_timer.get(), "ValidateModule");
         ValidateOptions options(s_features);
         result = ValidateModule(&module, &errors, options);
       }
 
       if (s_generate_names) {
-        result = GenerateNames(&module);
+        PassTimer::Scope scope(s_timer.get(), "GenerateNames");
+        result = GenerateNames(&module, NameOpts::LocalNamesOnDemand);
       }
 
       if (Succeeded(result)) {
+        PassTimer::Scope scope(s_timer.get(), "ApplyNames");
         /* TODO(binji): This shouldn't fail; if a name can't be applied
          * (because the index is invalid, say) it should just be skipped. */
         Result dummy_result = ApplyNames(&module);
@@ -134,16 +155,33 @@ int ProgramMain(int argc, char** argv) {
       }
 
       if (Succeeded(result)) {
+        PassTimer::Scope scope(s_timer.get(), "WriteWat");
         WriteWatOptions wat_options(s_features);
         wat_options.fold_exprs = s_fold_exprs;
         wat_options.inline_import = s_inline_import;
         wat_options.inline_export = s_inline_export;
+        wat_options.generate_local_names = s_generate_names;
         FileStream stream(!s_outfile.empty() ? FileStream(s_outfile)
                                              : FileStream(stdout));
         result = WriteWat(&stream, &module, wat_options);
       }
     }
     FormatErrorsToFile(errors, Location::Type::Binary);
+
+    if (s_mem_stats) {
+      MemoryStats stats;
+      stats.Add("input", MemoryStats::HeapBytes(file_data));
+      AccountMemory(module, &stats);
+      auto stream = FileStream::CreateStderr();
+      stats.Print(stream.get());
+      stream->Writef("peak RSS: %" PRIu64 " KB\n",
+                     PassTimer::GetPeakRss() / 1024);
+    }
+  }
+
+  total_scope.Stop();
+  if (s_timer) {
+    s_timer->Print(FileStream::CreateStderr().get());
   }
   return result != Result::Ok;
 }
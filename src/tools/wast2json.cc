@@ -44,6 +44,7 @@ static int s_verbose;
 static WriteBinaryOptions s_write_binary_options;
 static bool s_validate = true;
 static bool s_debug_parsing;
+static bool s_bundle;
 static Features s_features;
 
 static std::unique_ptr<FileStream> s_log_stream;
@@ -56,6 +57,10 @@ examples:
   # parse spec-test.wast, and write files to spec-test.json. Modules are
   # written to spec-test.0.wasm, spec-test.1.wasm, etc.
   $ wast2json spec-test.wast -o spec-test.json
+
+  # parse spec-test.wast, and write the commands and all modules to a single
+  # spec-test.wsb bundle that spectest-interp can run
+  $ wast2json spec-test.wast --bundle -o spec-test.wsb
 )";
 
 static void ParseOptions(int argc, char* argv[]) {
@@ -70,6 +75,10 @@ static void ParseOptions(int argc, char* argv[]) {
   s_features.AddOptions(&parser);
   parser.AddOption('o', "output", "FILE", "output JSON file",
                    [](const char* argument) { s_outfile = argument; });
+  parser.AddOption("bundle",
+                   "Write a single binary spec bundle, including all modules, "
+                   "instead of JSON",
+                   []() { s_bundle = true; });
   parser.AddOption(
       'r', "relocatable",
       "Create a relocatable wasm binary (suitable for linking with e.g. lld)",
@@ -90,9 +99,9 @@ static void ParseOptions(int argc, char* argv[]) {
 }
 
 static std::string DefaultOuputName(std::string_view input_name) {
-  // Strip existing extension and add .json
+  // Strip existing extension and add .json (or .wsb for bundles)
   std::string result(StripExtension(GetBasename(input_name)));
-  result += ".json";
+  result += s_bundle ? ".wsb" : ".json";
 
   return result;
 }
@@ -125,17 +134,23 @@ int ProgramMain(int argc, char** argv) {
       s_outfile = DefaultOuputName(s_infile);
     }
 
-    std::vector<FilenameMemoryStreamPair> module_streams;
-    MemoryStream json_stream;
-
     std::string output_basename(StripExtension(s_outfile));
     s_write_binary_options.features = s_features;
-    result = WriteBinarySpecScript(&json_stream, script.get(), s_infile,
-                                   output_basename, s_write_binary_options,
-                                   &module_streams, s_log_stream.get());
+
+    std::vector<FilenameMemoryStreamPair> module_streams;
+    MemoryStream script_stream;
+    if (s_bundle) {
+      result = WriteBinarySpecBundle(&script_stream, script.get(), s_infile,
+                                     output_basename, s_write_binary_options,
+                                     s_log_stream.get());
+    } else {
+      result = WriteBinarySpecScript(&script_stream, script.get(), s_infile,
+                                     output_basename, s_write_binary_options,
+                                     &module_streams, s_log_stream.get());
+    }
 
     if (Succeeded(result)) {
-      result = json_stream.WriteToFile(s_outfile);
+      result = script_stream.WriteToFile(s_outfile);
     }
 
     if (Succeeded(result)) {
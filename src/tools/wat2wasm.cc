@@ -30,6 +30,7 @@
 #include "wabt/filenames.h"
 #include "wabt/ir.h"
 #include "wabt/option-parser.h"
+#include "wabt/pass-timer.h"
 #include "wabt/resolve-names.h"
 #include "wabt/stream.h"
 #include "wabt/validator.h"
@@ -47,6 +48,7 @@ static bool s_debug_parsing;
 static Features s_features;
 
 static std::unique_ptr<FileStream> s_log_stream;
+static std::unique_ptr<PassTimer> s_timer;
 
 static const char s_description[] =
     R"(  read a file in the wasm text format, check it for errors, and
@@ -93,6 +95,9 @@ static void ParseOptions(int argc, char* argv[]) {
                    []() { s_write_binary_options.write_debug_names = true; });
   parser.AddOption("no-check", "Don't check for invalid modules",
                    []() { s_validate = false; });
+  parser.AddOption("time-passes",
+                   "Print the time and peak memory use of each phase to stderr",
+                   []() { s_timer = std::make_unique<PassTimer>(); });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) { s_infile = argument; });
 
@@ -131,8 +136,13 @@ int ProgramMain(int argc, char** argv) {
 
   ParseOptions(argc, argv);
 
+  PassTimer::Scope total_scope(s_timer.get(), "total");
   std::vector<uint8_t> file_data;
-  Result result = ReadFile(s_infile, &file_data);
+  Result result;
+  {
+    PassTimer::Scope scope(s_timer.get(), "ReadFile");
+    result = ReadFile(s_infile, &file_data);
+  }
   Errors errors;
   std::unique_ptr<WastLexer> lexer = WastLexer::CreateBufferLexer(
       s_infile, file_data.data(), file_data.size(), &errors);
@@ -142,9 +152,13 @@ int ProgramMain(int argc, char** argv) {
 
   std::unique_ptr<Module> module;
   WastParseOptions parse_wast_options(s_features);
-  result = ParseWatModule(lexer.get(), &module, &errors, &parse_wast_options);
+  {
+    PassTimer::Scope scope(s_timer.get(), "ParseWatModule");
+    result = ParseWatModule(lexer.get(), &module, &errors, &parse_wast_options);
+  }
 
   if (Succeeded(result) && s_validate) {
+    PassTimer::Scope scope(s_timer.get(), "ValidateModule");
     ValidateOptions options(s_features);
     result = ValidateModule(module.get(), &errors, options);
   }
@@ -152,9 +166,13 @@ int ProgramMain(int argc, char** argv) {
   if (Succeeded(result)) {
     MemoryStream stream(s_log_stream.get());
     s_write_binary_options.features = s_features;
-    result = WriteBinaryModule(&stream, module.get(), s_write_binary_options);
+    {
+      PassTimer::Scope scope(s_timer.get(), "WriteBinaryModule");
+      result = WriteBinaryModule(&stream, module.get(), s_write_binary_options);
+    }
 
     if (Succeeded(result)) {
+      PassTimer::Scope scope(s_timer.get(), "WriteBufferToFile");
       if (s_outfile.empty()) {
         s_outfile = DefaultOuputName(s_infile);
       }
@@ -165,6 +183,10 @@ int ProgramMain(int argc, char** argv) {
   auto line_finder = lexer->MakeLineFinder();
   FormatErrorsToFile(errors, Location::Type::Text, line_finder.get());
 
+  total_scope.Stop();
+  if (s_timer) {
+    s_timer->Print(FileStream::CreateStderr().get());
+  }
   return result != Result::Ok;
 }
 
@@ -106,12 +106,11 @@ Result TypeChecker::GetCatchCount(Index depth, Index* out_count) {
     return Result::Error;
   }
 
-  Index catch_count = 0;
-  for (Index idx = 0; idx <= depth; idx++) {
-    LabelType type = label_stack_[label_stack_.size() - idx - 1].label_type;
-    if (type == LabelType::Catch) {
-      catch_count++;
-    }
+  // Labels above `depth` minus the labels below it.
+  Index top = label_stack_.size() - 1;
+  Index catch_count = label_stack_[top].catch_count;
+  if (depth < top) {
+    catch_count -= label_stack_[top - depth - 1].catch_count;
   }
   *out_count = catch_count;
 
@@ -145,8 +144,12 @@ Result TypeChecker::SetUnreachable() {
 void TypeChecker::PushLabel(LabelType label_type,
                             const TypeVector& param_types,
                             const TypeVector& result_types) {
+  Index catch_count =
+      label_stack_.empty() ? 0 : label_stack_.back().catch_count;
   label_stack_.emplace_back(label_type, param_types, result_types,
                             type_stack_.size());
+  label_stack_.back().catch_count =
+      catch_count + (label_type == LabelType::Catch);
 }
 
 Result TypeChecker::PopLabel() {
@@ -571,7 +574,10 @@ Result TypeChecker::OnCatch(const TypeVector& sig) {
   result |= PopAndCheckSignature(label->result_types, "try block");
   result |= CheckTypeStackEnd("try block");
   ResetTypeStackToLabel(label);
-  label->label_type = LabelType::Catch;
+  if (label->label_type != LabelType::Catch) {
+    label->catch_count++;
+    label->label_type = LabelType::Catch;
+  }
   label->unreachable = false;
   PushTypes(sig);
   return result;
@@ -17,6 +17,7 @@
 #include "wabt/utf8.h"
 
 #include <cstdint>
+#include <cstring>
 
 namespace wabt {
 
@@ -49,12 +50,31 @@ bool IsCont(uint8_t c) {
   return (c & 0xc0) == 0x80;
 }
 
+// Returns the first byte at or after |p| that isn't ASCII, or |end|. Names are
+// almost always ASCII, so this checks a word at a time.
+const uint8_t* SkipAscii(const uint8_t* p, const uint8_t* end) {
+  const uint64_t kHighBits = 0x8080808080808080ull;
+  while (end - p >= 16) {
+    uint64_t lo, hi;
+    memcpy(&lo, p, sizeof(lo));
+    memcpy(&hi, p + 8, sizeof(hi));
+    if ((lo | hi) & kHighBits) {
+      break;
+    }
+    p += 16;
+  }
+  while (p < end && *p < 0x80) {
+    p++;
+  }
+  return p;
+}
+
 }  // end anonymous namespace
 
 bool IsValidUtf8(const char* s, size_t s_length) {
   const uint8_t* p = reinterpret_cast<const uint8_t*>(s);
   const uint8_t* end = p + s_length;
-  while (p < end) {
+  while ((p = SkipAscii(p, end)) < end) {
     uint8_t cu0 = *p;
     int length = s_utf8_length[cu0];
     if (p + length > end) {
@@ -30,6 +30,7 @@
 #include "wabt/cast.h"
 #include "wabt/common.h"
 #include "wabt/expr-visitor.h"
+#include "wabt/generate-names.h"
 #include "wabt/ir-util.h"
 #include "wabt/ir.h"
 #include "wabt/literal.h"
@@ -128,6 +129,10 @@ class WatWriter : ModuleContext {
                                         const Var& destmemidx,
                                         NextChar next_char);
   void WriteBrVar(const Var& var, NextChar next_char);
+  void WriteLocalVar(const Var& var, NextChar next_char);
+  void WriteDelegateVar(const Var& var, Index skip, NextChar next_char);
+  const std::string* GetGeneratedLabelName(const Var& var,
+                                           Index skip = 0) const;
   void WriteRefKind(Type type, NextChar next_char);
   void WriteType(Type type, NextChar next_char);
   void WriteTypes(const TypeVector& types, const char* name);
@@ -191,6 +196,11 @@ class WatWriter : ModuleContext {
       inline_export_map_;
   std::vector<const Import*> inline_import_map_[kExternalKindCount];
 
+  // With options_.generate_local_names, the names of the current function's
+  // params and locals, and of its unnamed labels.
+  std::vector<std::string> local_names_;
+  LabelNameMap label_names_;
+
   Index func_index_ = 0;
   Index global_index_ = 0;
   Index table_index_ = 0;
@@ -404,8 +414,21 @@ void WatWriter::WriteTwoMemoryVarsUnlessBothZero(const Var& srcmemidx,
   }
 }
 
+const std::string* WatWriter::GetGeneratedLabelName(const Var& var,
+                                                    Index skip) const {
+  if (!options_.generate_local_names || !var.is_index()) {
+    return nullptr;
+  }
+  // ApplyNames left the var as an index since the label had no name; the
+  // implicit function label has none to give it.
+  const Label* label = GetLabel(Var(var.index() + skip, var.loc));
+  return label && !label->name.empty() ? &label->name : nullptr;
+}
+
 void WatWriter::WriteBrVar(const Var& var, NextChar next_char) {
-  if (var.is_index()) {
+  if (const std::string* name = GetGeneratedLabelName(var)) {
+    WriteString(*name, next_char);
+  } else if (var.is_index()) {
     if (var.index() < GetLabelStackSize()) {
       Writef("%" PRIindex " (;@%" PRIindex ";)", var.index(),
              GetLabelStackSize() - var.index() - 1);
@@ -418,6 +441,27 @@ void WatWriter::WriteBrVar(const Var& var, NextChar next_char) {
   }
 }
 
+void WatWriter::WriteLocalVar(const Var& var, NextChar next_char) {
+  if (options_.generate_local_names && var.is_index() &&
+      var.index() < local_names_.size()) {
+    WriteString(local_names_[var.index()], next_char);
+  } else {
+    WriteVar(var, next_char);
+  }
+}
+
+// |skip| is the number of labels on top of the stack that the delegate can't
+// target, i.e. its own try's if that is still on the stack.
+void WatWriter::WriteDelegateVar(const Var& var,
+                                 Index skip,
+                                 NextChar next_char) {
+  if (const std::string* name = GetGeneratedLabelName(var, skip)) {
+    WriteString(*name, next_char);
+  } else {
+    WriteVar(var, next_char);
+  }
+}
+
 void WatWriter::WriteRefKind(Type type, NextChar next_char) {
   WritePuts(type.GetRefKindName(), next_char);
 }
@@ -449,9 +493,16 @@ void WatWriter::WriteBeginBlock(LabelType label_type,
                                 const Block& block,
                                 const char* text) {
   WritePutsSpace(text);
-  bool has_label = !block.label.empty();
+  const std::string* label = &block.label;
+  if (label->empty() && options_.generate_local_names) {
+    auto iter = label_names_.find(&block);
+    if (iter != label_names_.end()) {
+      label = &iter->second;
+    }
+  }
+  bool has_label = !label->empty();
   if (has_label) {
-    WriteString(block.label, NextChar::Space);
+    WriteString(*label, NextChar::Space);
   }
   WriteTypes(block.decl.sig.param_types, "param");
   WriteTypes(block.decl.sig.result_types, "result");
@@ -459,7 +510,7 @@ void WatWriter::WriteBeginBlock(LabelType label_type,
     Writef(" ;; label = @%" PRIindex, GetLabelStackSize());
   }
   WriteNewline(FORCE_NEWLINE);
-  BeginBlock(label_type, block);
+  BeginBlock(label_type, block, *label);
   Indent();
 }
 
@@ -488,7 +539,8 @@ void WatWriter::WriteConst(const Const& const_) {
       char buffer[128];
       WriteFloatHex(buffer, 128, const_.f32_bits());
       WritePutsSpace(buffer);
-      Writef("(;=%g;)", Bitcast<float>(const_.f32_bits()));
+      WriteFloatDecimal(buffer, 128, const_.f32_bits());
+      Writef("(;=%s;)", buffer);
       WriteNewline(NO_FORCE_NEWLINE);
       break;
     }
@@ -498,7 +550,8 @@ void WatWriter::WriteConst(const Const& const_) {
       char buffer[128];
       WriteDoubleHex(buffer, 128, const_.f64_bits());
       WritePutsSpace(buffer);
-      Writef("(;=%g;)", Bitcast<double>(const_.f64_bits()));
+      WriteDoubleDecimal(buffer, 128, const_.f64_bits());
+      Writef("(;=%s;)", buffer);
       WriteNewline(NO_FORCE_NEWLINE);
       break;
     }
@@ -756,19 +809,19 @@ Result WatWriter::ExprVisitorDelegate::OnLoadExpr(LoadExpr* expr) {
 
 Result WatWriter::ExprVisitorDelegate::OnLocalGetExpr(LocalGetExpr* expr) {
   writer_->WritePutsSpace(Opcode::LocalGet_Opcode.GetName());
-  writer_->WriteVar(expr->var, NextChar::Newline);
+  writer_->WriteLocalVar(expr->var, NextChar::Newline);
   return Result::Ok;
 }
 
 Result WatWriter::ExprVisitorDelegate::OnLocalSetExpr(LocalSetExpr* expr) {
   writer_->WritePutsSpace(Opcode::LocalSet_Opcode.GetName());
-  writer_->WriteVar(expr->var, NextChar::Newline);
+  writer_->WriteLocalVar(expr->var, NextChar::Newline);
   return Result::Ok;
 }
 
 Result WatWriter::ExprVisitorDelegate::OnLocalTeeExpr(LocalTeeExpr* expr) {
   writer_->WritePutsSpace(Opcode::LocalTee_Opcode.GetName());
-  writer_->WriteVar(expr->var, NextChar::Newline);
+  writer_->WriteLocalVar(expr->var, NextChar::Newline);
   return Result::Ok;
 }
 
@@ -974,7 +1027,7 @@ Result WatWriter::ExprVisitorDelegate::OnDelegateExpr(TryExpr* expr) {
   writer_->Dedent();
   writer_->EndBlock();
   writer_->WritePutsSpace(Opcode::Delegate_Opcode.GetName());
-  writer_->WriteVar(expr->delegate_target, NextChar::Newline);
+  writer_->WriteDelegateVar(expr->delegate_target, 0, NextChar::Newline);
   return Result::Ok;
 }
 
@@ -1248,7 +1301,7 @@ void WatWriter::FlushExprTree(const ExprTree& expr_tree) {
         case TryKind::Delegate:
           WritePuts("(", NextChar::None);
           WritePutsSpace(Opcode::Delegate_Opcode.GetName());
-          WriteVar(try_expr->delegate_target, NextChar::None);
+          WriteDelegateVar(try_expr->delegate_target, 1, NextChar::None);
           WritePuts(")", NextChar::Newline);
           break;
         case TryKind::Plain:
@@ -1360,14 +1413,21 @@ void WatWriter::WriteBeginFunc(const Func& func) {
 
 void WatWriter::WriteFunc(const Func& func) {
   WriteBeginFunc(func);
-  std::vector<std::string> index_to_name;
   MakeTypeBindingReverseMapping(func.GetNumParamsAndLocals(), func.bindings,
-                                &index_to_name);
-  WriteTypeBindings("param", func.decl.sig.param_types, index_to_name);
+                                &local_names_);
+  if (options_.generate_local_names) {
+    for (Index i = 0; i < local_names_.size(); ++i) {
+      if (local_names_[i].empty()) {
+        local_names_[i] = GenerateLocalName(func, i);
+      }
+    }
+    GenerateLabelNames(func, &label_names_);
+  }
+  WriteTypeBindings("param", func.decl.sig.param_types, local_names_);
   WriteTypes(func.decl.sig.result_types, "result");
   WriteNewline(NO_FORCE_NEWLINE);
   if (func.local_types.size()) {
-    WriteTypeBindings("local", func.local_types, index_to_name,
+    WriteTypeBindings("local", func.local_types, local_names_,
                       func.GetNumParams());
   }
   WriteNewline(NO_FORCE_NEWLINE);
@@ -1379,6 +1439,8 @@ void WatWriter::WriteFunc(const Func& func) {
     WriteExprList(func.exprs);
   }
   EndFunc();
+  local_names_.clear();
+  label_names_.clear();
   WriteCloseNewline();
 }
 
@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Corrupts every entry in a wasm-interp --cache-dir directory.
+
+Entries end with the istream, so flipping a bit near the end changes an
+instruction's immediate without changing the entry's layout. wasm-interp must
+notice this and compile the module again.
+"""
+
+import argparse
+import os
+import sys
+
+
+def main(args):
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('cache_dir', help='the --cache-dir directory')
+    parser.add_argument('--offset', type=int, default=12,
+                        help='offset of the byte to change, from the end')
+    options = parser.parse_args(args)
+
+    entries = sorted(os.listdir(options.cache_dir))
+    if not entries:
+        parser.error('no entries in %s' % options.cache_dir)
+    for entry in entries:
+        path = os.path.join(options.cache_dir, entry)
+        with open(path, 'r+b') as f:
+            f.seek(-options.offset, os.SEEK_END)
+            byte = f.read(1)[0]
+            f.seek(-options.offset, os.SEEK_END)
+            f.write(bytes([byte ^ 1]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A stand-in for the ggt green-thread library, for testing wasm2c output
+ * without it. Every GGT function runs to completion on the C stack, so a
+ * GGT_CALL is a plain call and threads never switch.
+ *
+ * GGT(name, (params), { fields }, { init }) { body } defines |name|, which
+ * copies its parameters into a frame of |fields| called |l| and then runs
+ * |body|. The ggt thread must not be null, as with the real library.
+ */
+
+#ifndef GGT_BEST_H_
+#define GGT_BEST_H_
+
+#include <stdlib.h>
+
+typedef struct ggt_thread {
+  int unused;
+} ggt_thread_t;
+
+typedef int ggt_ret_t;
+
+/* A thread for embedders that run everything on one. */
+static ggt_thread_t ggt_stub_thread __attribute__((unused));
+
+#define GGT(name, params, fields, init)                                 \
+  struct name##_frame fields;                                           \
+  static ggt_ret_t name##_body(ggt_thread_t* thr,                       \
+                               struct name##_frame* l);                 \
+  ggt_ret_t name params {                                               \
+    struct name##_frame frame;                                          \
+    struct name##_frame* l = &frame;                                    \
+    if (!thr) {                                                         \
+      abort();                                                          \
+    }                                                                   \
+    init return name##_body(thr, l);                                    \
+  }                                                                     \
+  static ggt_ret_t name##_body(ggt_thread_t* thr, struct name##_frame* l)
+
+#define GGT_END() return 0
+
+#define GGT_CALL(func, args) func args
+
+#endif /* GGT_BEST_H_ */
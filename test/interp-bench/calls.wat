@@ -0,0 +1,64 @@
+;;; RESULT: run() => i32:2641000745
+;; Call-heavy code: naive recursive fib, the Ackermann function, and a loop
+;; that dispatches through a table with call_indirect.
+(module
+  (type $binary (func (param i32 i32) (result i32)))
+
+  (table funcref (elem $add $sub $mul $xor $rotl $min_u $max_u $mix))
+
+  (func $fib (param $n i32) (result i32)
+    (if (result i32) (i32.lt_u (local.get $n) (i32.const 2))
+      (then (local.get $n))
+      (else
+        (i32.add (call $fib (i32.sub (local.get $n) (i32.const 1)))
+                 (call $fib (i32.sub (local.get $n) (i32.const 2)))))))
+
+  (func $ackermann (param $m i32) (param $n i32) (result i32)
+    (if (i32.eqz (local.get $m))
+      (then (return (i32.add (local.get $n) (i32.const 1)))))
+    (if (i32.eqz (local.get $n))
+      (then
+        (return (call $ackermann (i32.sub (local.get $m) (i32.const 1))
+                                 (i32.const 1)))))
+    (call $ackermann
+      (i32.sub (local.get $m) (i32.const 1))
+      (call $ackermann (local.get $m)
+                       (i32.sub (local.get $n) (i32.const 1)))))
+
+  (func $add (type $binary) (i32.add (local.get 0) (local.get 1)))
+  (func $sub (type $binary) (i32.sub (local.get 0) (local.get 1)))
+  (func $mul (type $binary) (i32.mul (local.get 0) (i32.or (local.get 1)
+                                                           (i32.const 1))))
+  (func $xor (type $binary) (i32.xor (local.get 0) (local.get 1)))
+  (func $rotl (type $binary) (i32.rotl (local.get 0) (local.get 1)))
+  (func $min_u (type $binary)
+    (select (local.get 0) (local.get 1)
+            (i32.lt_u (local.get 0) (local.get 1))))
+  (func $max_u (type $binary)
+    (select (local.get 0) (local.get 1)
+            (i32.gt_u (local.get 0) (local.get 1))))
+  (func $mix (type $binary)
+    (i32.add (i32.mul (local.get 0) (i32.const 31)) (local.get 1)))
+
+  (func $dispatch (param $count i32) (result i32)
+    (local $i i32) (local $acc i32)
+    (local.set $acc (i32.const 1))
+    (loop $calls
+      (local.set $acc
+        (call_indirect (type $binary)
+          (local.get $acc)
+          (local.get $i)
+          (i32.and (i32.xor (local.get $i) (i32.shr_u (local.get $acc)
+                                                      (i32.const 7)))
+                   (i32.const 7))))
+      (br_if $calls
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (local.get $count))))
+    (local.get $acc))
+
+  (func (export "run") (result i32)
+    (i32.xor
+      (i32.add (call $fib (i32.const 25))
+               (i32.mul (call $ackermann (i32.const 2) (i32.const 300))
+                        (i32.const 65536)))
+      (call $dispatch (i32.const 400000)))))
@@ -0,0 +1,274 @@
+;;; RESULT: run() => i32:19120
+;; Integer kernels modelled on CoreMark's: linked list reversal, a 16x16
+;; integer matrix multiply, a state machine that classifies numbers in a
+;; string, and a bitwise CRC16 that folds every result together.
+(module
+  (memory 1)
+
+  ;; Tokens for the state machine, each followed by a comma.
+  (data (i32.const 0)
+    "5012,1234,-874,+122,35.54,-0.5e3,x1x,12e+7,.5,--9,7,,3.14e,1.2E-3,"
+    "+.5e+2,99999,-,0.0,4e,12.3.4,-17,6.02e+23,+1,abc,8080,3.,-.25E-1,")
+  (global $tokens_end i32 (i32.const 131))
+
+  (global $A i32 (i32.const 1024))
+  (global $B i32 (i32.const 2048))
+  (global $C i32 (i32.const 3072))
+  ;; 64 list nodes of {next, value}; a next of 0 ends the list.
+  (global $nodes i32 (i32.const 4096))
+  ;; Number of tokens that ended in each state.
+  (global $counts i32 (i32.const 8192))
+
+  (func $crcu8 (param $data i32) (param $crc i32) (result i32)
+    (local $i i32)
+    (loop $bits
+      (if (i32.and (i32.xor (local.get $data) (local.get $crc)) (i32.const 1))
+        (then
+          (local.set $crc
+            (i32.or (i32.shr_u (i32.xor (local.get $crc) (i32.const 0x4002))
+                               (i32.const 1))
+                    (i32.const 0x8000))))
+        (else
+          (local.set $crc
+            (i32.and (i32.shr_u (local.get $crc) (i32.const 1))
+                     (i32.const 0x7fff)))))
+      (local.set $data (i32.shr_u (local.get $data) (i32.const 1)))
+      (br_if $bits
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 8))))
+    (local.get $crc))
+
+  (func $crcu32 (param $value i32) (param $crc i32) (result i32)
+    (call $crcu8 (i32.shr_u (local.get $value) (i32.const 24))
+      (call $crcu8 (i32.and (i32.shr_u (local.get $value) (i32.const 16))
+                            (i32.const 0xff))
+        (call $crcu8 (i32.and (i32.shr_u (local.get $value) (i32.const 8))
+                              (i32.const 0xff))
+          (call $crcu8 (i32.and (local.get $value) (i32.const 0xff))
+                       (local.get $crc))))))
+
+  (func $list_init (result i32)
+    (local $i i32) (local $node i32)
+    (loop $fill
+      (local.set $node (i32.add (global.get $nodes)
+                                (i32.shl (local.get $i) (i32.const 3))))
+      (i32.store (local.get $node)
+                 (select (i32.add (local.get $node) (i32.const 8))
+                         (i32.const 0)
+                         (i32.lt_u (local.get $i) (i32.const 63))))
+      (i32.store offset=4 (local.get $node)
+                 (i32.and (i32.mul (local.get $i) (i32.const 37))
+                          (i32.const 63)))
+      (br_if $fill
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 64))))
+    (global.get $nodes))
+
+  (func $list_reverse (param $head i32) (result i32)
+    (local $prev i32) (local $next i32)
+    (block $done
+      (loop $walk
+        (br_if $done (i32.eqz (local.get $head)))
+        (local.set $next (i32.load (local.get $head)))
+        (i32.store (local.get $head) (local.get $prev))
+        (local.set $prev (local.get $head))
+        (local.set $head (local.get $next))
+        (br $walk)))
+    (local.get $prev))
+
+  ;; Sums value * position, and counts how often the value 17 appears.
+  (func $list_checksum (param $head i32) (result i32)
+    (local $sum i32) (local $position i32) (local $found i32)
+    (block $done
+      (loop $walk
+        (br_if $done (i32.eqz (local.get $head)))
+        (local.set $position (i32.add (local.get $position) (i32.const 1)))
+        (local.set $sum
+          (i32.add (local.get $sum)
+                   (i32.mul (i32.load offset=4 (local.get $head))
+                            (local.get $position))))
+        (local.set $found
+          (i32.add (local.get $found)
+                   (i32.eq (i32.load offset=4 (local.get $head))
+                           (i32.const 17))))
+        (local.set $head (i32.load (local.get $head)))
+        (br $walk)))
+    (i32.xor (local.get $sum) (i32.shl (local.get $found) (i32.const 16))))
+
+  (func $matrix_init
+    (local $i i32)
+    (loop $fill
+      (i32.store (i32.add (global.get $A) (i32.shl (local.get $i) (i32.const 2)))
+                 (i32.sub (i32.rem_u (i32.add (i32.mul (local.get $i)
+                                                       (i32.const 13))
+                                              (i32.const 7))
+                                     (i32.const 97))
+                          (i32.const 48)))
+      (i32.store (i32.add (global.get $B) (i32.shl (local.get $i) (i32.const 2)))
+                 (i32.sub (i32.rem_u (i32.add (i32.mul (local.get $i)
+                                                       (i32.const 31))
+                                              (i32.const 11))
+                                     (i32.const 89))
+                          (i32.const 44)))
+      (br_if $fill
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 256)))))
+
+  ;; C = A * B, and returns the number of elements of C above a threshold
+  ;; mixed with the sum of C, like CoreMark's matrix_sum.
+  (func $matrix_mul (result i32)
+    (local $i i32) (local $j i32) (local $k i32) (local $acc i32)
+    (local $sum i32) (local $above i32)
+    (loop $rows
+      (local.set $j (i32.const 0))
+      (loop $cols
+        (local.set $acc (i32.const 0))
+        (local.set $k (i32.const 0))
+        (loop $dot
+          (local.set $acc
+            (i32.add (local.get $acc)
+              (i32.mul
+                (i32.load (i32.add (global.get $A)
+                  (i32.shl (i32.add (i32.shl (local.get $i) (i32.const 4))
+                                    (local.get $k))
+                           (i32.const 2))))
+                (i32.load (i32.add (global.get $B)
+                  (i32.shl (i32.add (i32.shl (local.get $k) (i32.const 4))
+                                    (local.get $j))
+                           (i32.const 2)))))))
+          (br_if $dot
+            (i32.lt_u (local.tee $k (i32.add (local.get $k) (i32.const 1)))
+                      (i32.const 16))))
+        (i32.store (i32.add (global.get $C)
+                     (i32.shl (i32.add (i32.shl (local.get $i) (i32.const 4))
+                                       (local.get $j))
+                              (i32.const 2)))
+                   (local.get $acc))
+        (local.set $sum (i32.add (local.get $sum) (local.get $acc)))
+        (local.set $above
+          (i32.add (local.get $above)
+                   (i32.gt_s (local.get $acc) (i32.const 1000))))
+        (br_if $cols
+          (i32.lt_u (local.tee $j (i32.add (local.get $j) (i32.const 1)))
+                    (i32.const 16))))
+      (br_if $rows
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 16))))
+    (i32.add (local.get $sum) (i32.shl (local.get $above) (i32.const 20))))
+
+  (func $is_digit (param $c i32) (result i32)
+    (i32.lt_u (i32.sub (local.get $c) (i32.const 48)) (i32.const 10)))
+
+  ;; States: 0 start, 1 invalid, 2 sign, 3 int, 4 float, 5 exponent mark,
+  ;; 6 exponent sign, 7 scientific.
+  (func $next_state (param $state i32) (param $c i32) (result i32)
+    (block $scientific
+      (block $exponent_sign
+        (block $exponent_mark
+          (block $float
+            (block $int
+              (block $sign
+                (block $invalid
+                  (block $start
+                    (br_table $start $invalid $sign $int $float
+                              $exponent_mark $exponent_sign $scientific
+                              (local.get $state)))
+                  ;; start
+                  (if (call $is_digit (local.get $c))
+                    (then (return (i32.const 3))))
+                  (if (i32.or (i32.eq (local.get $c) (i32.const 43))
+                              (i32.eq (local.get $c) (i32.const 45)))
+                    (then (return (i32.const 2))))
+                  (if (i32.eq (local.get $c) (i32.const 46))
+                    (then (return (i32.const 4))))
+                  (return (i32.const 1)))
+                ;; invalid
+                (return (i32.const 1)))
+              ;; sign
+              (if (call $is_digit (local.get $c))
+                (then (return (i32.const 3))))
+              (if (i32.eq (local.get $c) (i32.const 46))
+                (then (return (i32.const 4))))
+              (return (i32.const 1)))
+            ;; int
+            (if (call $is_digit (local.get $c))
+              (then (return (i32.const 3))))
+            (if (i32.eq (local.get $c) (i32.const 46))
+              (then (return (i32.const 4))))
+            (return (i32.const 1)))
+          ;; float
+          (if (call $is_digit (local.get $c))
+            (then (return (i32.const 4))))
+          (if (i32.eq (i32.or (local.get $c) (i32.const 32)) (i32.const 101))
+            (then (return (i32.const 5))))
+          (return (i32.const 1)))
+        ;; exponent mark
+        (if (i32.or (i32.eq (local.get $c) (i32.const 43))
+                    (i32.eq (local.get $c) (i32.const 45)))
+          (then (return (i32.const 6))))
+        (if (call $is_digit (local.get $c))
+          (then (return (i32.const 7))))
+        (return (i32.const 1)))
+      ;; exponent sign
+      (if (call $is_digit (local.get $c))
+        (then (return (i32.const 7))))
+      (return (i32.const 1)))
+    ;; scientific
+    (select (i32.const 7) (i32.const 1) (call $is_digit (local.get $c))))
+
+  (func $scan (result i32)
+    (local $p i32) (local $c i32) (local $state i32) (local $i i32)
+    (local $hash i32)
+    (loop $clear
+      (i32.store (i32.add (global.get $counts)
+                          (i32.shl (local.get $i) (i32.const 2)))
+                 (i32.const 0))
+      (br_if $clear
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 8))))
+    (loop $chars
+      (local.set $c (i32.load8_u (local.get $p)))
+      (if (i32.eq (local.get $c) (i32.const 44))
+        (then
+          (local.set $i (i32.add (global.get $counts)
+                                 (i32.shl (local.get $state) (i32.const 2))))
+          (i32.store (local.get $i)
+                     (i32.add (i32.load (local.get $i)) (i32.const 1)))
+          (local.set $state (i32.const 0)))
+        (else
+          (local.set $state
+            (call $next_state (local.get $state) (local.get $c)))))
+      (br_if $chars
+        (i32.lt_u (local.tee $p (i32.add (local.get $p) (i32.const 1)))
+                  (global.get $tokens_end))))
+    (local.set $i (i32.const 0))
+    (loop $fold
+      (local.set $hash
+        (i32.add (i32.mul (local.get $hash) (i32.const 31))
+                 (i32.load (i32.add (global.get $counts)
+                                    (i32.shl (local.get $i) (i32.const 2))))))
+      (br_if $fold
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 8))))
+    (local.get $hash))
+
+  (func (export "run") (result i32)
+    (local $iter i32) (local $head i32) (local $crc i32) (local $a i32)
+    (local.set $head (call $list_init))
+    (call $matrix_init)
+    (loop $iterations
+      (local.set $head (call $list_reverse (local.get $head)))
+      (local.set $crc
+        (call $crcu32 (call $list_checksum (local.get $head)) (local.get $crc)))
+      ;; Perturb A so every multiply differs.
+      (local.set $a (i32.add (global.get $A)
+                             (i32.shl (i32.and (local.get $iter) (i32.const 255))
+                                      (i32.const 2))))
+      (i32.store (local.get $a)
+                 (i32.add (i32.load (local.get $a)) (i32.const 1)))
+      (local.set $crc (call $crcu32 (call $matrix_mul) (local.get $crc)))
+      (local.set $crc (call $crcu32 (call $scan) (local.get $crc)))
+      (br_if $iterations
+        (i32.lt_u (local.tee $iter (i32.add (local.get $iter) (i32.const 1)))
+                  (i32.const 200))))
+    (local.get $crc)))
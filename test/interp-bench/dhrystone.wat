@@ -0,0 +1,328 @@
+;;; RESULT: run() => i32:20076
+;; A port of the Dhrystone 2.1 main loop, run 20000 times. Records, strings
+;; and the C locals whose address is taken live in linear memory, as they
+;; would when compiled from C.
+;;
+;; The result sums the values Dhrystone itself checks at the end of a run:
+;; Arr_2_Glob[8][7] (runs + 10), Int_1_Loc (5), Int_2_Loc (13), Int_3_Loc (7),
+;; Int_Glob (5), Bool_Glob (1), Ptr_Glob->Int_Comp (17) and
+;; Next_Ptr_Glob->Int_Comp (18).
+(module
+  (memory 1)
+
+  ;; Enumeration values.
+  ;; Ident_1 = 0, Ident_2 = 1, Ident_3 = 2, Ident_4 = 3, Ident_5 = 4
+
+  ;; Record layout: Ptr_Comp @0, Discr @4, Enum_Comp @8, Int_Comp @12,
+  ;; Str_Comp @16 (31 bytes).
+  (global $Ptr_Glob i32 (i32.const 1024))
+  (global $Next_Ptr_Glob i32 (i32.const 1088))
+  (global $Str_1_Loc i32 (i32.const 1152))
+  (global $Str_2_Loc i32 (i32.const 1184))
+  ;; Locals whose address is passed to a procedure.
+  (global $Int_1_Loc i32 (i32.const 1216))
+  (global $Int_3_Loc i32 (i32.const 1220))
+  (global $Enum_Loc i32 (i32.const 1224))
+  (global $Arr_1_Glob i32 (i32.const 2048))
+  (global $Arr_2_Glob i32 (i32.const 4096))
+
+  (global $Int_Glob (mut i32) (i32.const 0))
+  (global $Bool_Glob (mut i32) (i32.const 0))
+  (global $Ch_1_Glob (mut i32) (i32.const 0))
+  (global $Ch_2_Glob (mut i32) (i32.const 0))
+
+  (data (i32.const 0) "DHRYSTONE PROGRAM, SOME STRING\00")
+  (data (i32.const 32) "DHRYSTONE PROGRAM, 1'ST STRING\00")
+  (data (i32.const 64) "DHRYSTONE PROGRAM, 2'ND STRING\00")
+  (data (i32.const 96) "DHRYSTONE PROGRAM, 3'RD STRING\00")
+
+  (func $strcpy (param $dst i32) (param $src i32)
+    (local $c i32)
+    (loop $copy
+      (i32.store8 (local.get $dst)
+                  (local.tee $c (i32.load8_u (local.get $src))))
+      (local.set $dst (i32.add (local.get $dst) (i32.const 1)))
+      (local.set $src (i32.add (local.get $src) (i32.const 1)))
+      (br_if $copy (local.get $c))))
+
+  (func $strcmp (param $a i32) (param $b i32) (result i32)
+    (local $ca i32) (local $cb i32)
+    (loop $compare
+      (local.set $ca (i32.load8_u (local.get $a)))
+      (local.set $cb (i32.load8_u (local.get $b)))
+      (if (i32.and (i32.eq (local.get $ca) (local.get $cb))
+                   (i32.ne (local.get $ca) (i32.const 0)))
+        (then
+          (local.set $a (i32.add (local.get $a) (i32.const 1)))
+          (local.set $b (i32.add (local.get $b) (i32.const 1)))
+          (br $compare))))
+    (i32.sub (local.get $ca) (local.get $cb)))
+
+  ;; *dst = *src for records.
+  (func $copy_record (param $dst i32) (param $src i32)
+    (i64.store (local.get $dst) (i64.load (local.get $src)))
+    (i64.store offset=8 (local.get $dst) (i64.load offset=8 (local.get $src)))
+    (i64.store offset=16 (local.get $dst) (i64.load offset=16 (local.get $src)))
+    (i64.store offset=24 (local.get $dst) (i64.load offset=24 (local.get $src)))
+    (i64.store offset=32 (local.get $dst) (i64.load offset=32 (local.get $src)))
+    (i64.store offset=40 (local.get $dst) (i64.load offset=40 (local.get $src))))
+
+  (func $Proc_1 (param $Ptr_Val_Par i32)
+    (local $Next_Record i32)
+    (local.set $Next_Record (i32.load (local.get $Ptr_Val_Par)))
+    (call $copy_record (local.get $Next_Record) (global.get $Ptr_Glob))
+    (i32.store offset=12 (local.get $Ptr_Val_Par) (i32.const 5))
+    (i32.store offset=12 (local.get $Next_Record)
+               (i32.load offset=12 (local.get $Ptr_Val_Par)))
+    (i32.store (local.get $Next_Record) (i32.load (local.get $Ptr_Val_Par)))
+    (call $Proc_3 (local.get $Next_Record))
+    (if (i32.eqz (i32.load offset=4 (local.get $Next_Record)))
+      (then
+        (i32.store offset=12 (local.get $Next_Record) (i32.const 6))
+        (call $Proc_6 (i32.load offset=8 (local.get $Ptr_Val_Par))
+                      (i32.add (local.get $Next_Record) (i32.const 8)))
+        (i32.store (local.get $Next_Record)
+                   (i32.load (global.get $Ptr_Glob)))
+        (call $Proc_7 (i32.load offset=12 (local.get $Next_Record))
+                      (i32.const 10)
+                      (i32.add (local.get $Next_Record) (i32.const 12))))
+      (else
+        (call $copy_record (local.get $Ptr_Val_Par)
+                           (i32.load (local.get $Ptr_Val_Par))))))
+
+  (func $Proc_2 (param $Int_Par_Ref i32)
+    (local $Int_Loc i32) (local $Enum_Loc i32)
+    (local.set $Int_Loc (i32.add (i32.load (local.get $Int_Par_Ref))
+                                 (i32.const 10)))
+    (local.set $Enum_Loc (i32.const 1))
+    (loop $do
+      (if (i32.eq (global.get $Ch_1_Glob) (i32.const 65))
+        (then
+          (local.set $Int_Loc (i32.sub (local.get $Int_Loc) (i32.const 1)))
+          (i32.store (local.get $Int_Par_Ref)
+                     (i32.sub (local.get $Int_Loc) (global.get $Int_Glob)))
+          (local.set $Enum_Loc (i32.const 0))))
+      (br_if $do (local.get $Enum_Loc))))
+
+  (func $Proc_3 (param $Ptr_Ref_Par i32)
+    (if (global.get $Ptr_Glob)
+      (then
+        (i32.store (local.get $Ptr_Ref_Par)
+                   (i32.load (global.get $Ptr_Glob)))))
+    (call $Proc_7 (i32.const 10) (global.get $Int_Glob)
+                  (i32.add (global.get $Ptr_Glob) (i32.const 12))))
+
+  (func $Proc_4
+    (global.set $Bool_Glob
+      (i32.or (i32.eq (global.get $Ch_1_Glob) (i32.const 65))
+              (global.get $Bool_Glob)))
+    (global.set $Ch_2_Glob (i32.const 66)))
+
+  (func $Proc_5
+    (global.set $Ch_1_Glob (i32.const 65))
+    (global.set $Bool_Glob (i32.const 0)))
+
+  (func $Proc_6 (param $Enum_Val_Par i32) (param $Enum_Ref_Par i32)
+    (i32.store (local.get $Enum_Ref_Par) (local.get $Enum_Val_Par))
+    (if (i32.eqz (call $Func_3 (local.get $Enum_Val_Par)))
+      (then (i32.store (local.get $Enum_Ref_Par) (i32.const 3))))
+    (block $break
+      (block $ident_5
+        (block $ident_4
+          (block $ident_3
+            (block $ident_2
+              (block $ident_1
+                (br_table $ident_1 $ident_2 $ident_3 $ident_4 $ident_5 $break
+                          (local.get $Enum_Val_Par)))
+              (i32.store (local.get $Enum_Ref_Par) (i32.const 0))
+              (br $break))
+            (i32.store (local.get $Enum_Ref_Par)
+                       (select (i32.const 0) (i32.const 3)
+                               (i32.gt_s (global.get $Int_Glob)
+                                         (i32.const 100))))
+            (br $break))
+          (i32.store (local.get $Enum_Ref_Par) (i32.const 1))
+          (br $break))
+        (br $break))
+      (i32.store (local.get $Enum_Ref_Par) (i32.const 2))))
+
+  (func $Proc_7 (param $Int_1_Par_Val i32) (param $Int_2_Par_Val i32)
+                (param $Int_Par_Ref i32)
+    (i32.store (local.get $Int_Par_Ref)
+               (i32.add (local.get $Int_2_Par_Val)
+                        (i32.add (local.get $Int_1_Par_Val) (i32.const 2)))))
+
+  (func $Proc_8 (param $Arr_1_Par_Ref i32) (param $Arr_2_Par_Ref i32)
+                (param $Int_1_Par_Val i32) (param $Int_2_Par_Val i32)
+    (local $Int_Loc i32) (local $Int_Index i32) (local $row i32)
+    (local.set $Int_Loc (i32.add (local.get $Int_1_Par_Val) (i32.const 5)))
+    (i32.store (i32.add (local.get $Arr_1_Par_Ref)
+                        (i32.shl (local.get $Int_Loc) (i32.const 2)))
+               (local.get $Int_2_Par_Val))
+    (i32.store offset=4
+               (i32.add (local.get $Arr_1_Par_Ref)
+                        (i32.shl (local.get $Int_Loc) (i32.const 2)))
+               (i32.load (i32.add (local.get $Arr_1_Par_Ref)
+                                  (i32.shl (local.get $Int_Loc)
+                                           (i32.const 2)))))
+    (i32.store offset=120
+               (i32.add (local.get $Arr_1_Par_Ref)
+                        (i32.shl (local.get $Int_Loc) (i32.const 2)))
+               (local.get $Int_Loc))
+    ;; &Arr_2_Par_Ref[Int_Loc][0], rows are 50 ints.
+    (local.set $row (i32.add (local.get $Arr_2_Par_Ref)
+                             (i32.mul (local.get $Int_Loc) (i32.const 200))))
+    (local.set $Int_Index (local.get $Int_Loc))
+    (loop $for
+      (i32.store (i32.add (local.get $row)
+                          (i32.shl (local.get $Int_Index) (i32.const 2)))
+                 (local.get $Int_Loc))
+      (br_if $for
+        (i32.le_s (local.tee $Int_Index
+                    (i32.add (local.get $Int_Index) (i32.const 1)))
+                  (i32.add (local.get $Int_Loc) (i32.const 1)))))
+    ;; Arr_2_Par_Ref[Int_Loc][Int_Loc - 1] += 1
+    (i32.store (i32.add (local.get $row)
+                        (i32.shl (i32.sub (local.get $Int_Loc) (i32.const 1))
+                                 (i32.const 2)))
+               (i32.add (i32.load
+                          (i32.add (local.get $row)
+                                   (i32.shl (i32.sub (local.get $Int_Loc)
+                                                     (i32.const 1))
+                                            (i32.const 2))))
+                        (i32.const 1)))
+    ;; Arr_2_Par_Ref[Int_Loc + 20][Int_Loc], 20 rows further on.
+    (i32.store offset=4000
+               (i32.add (local.get $row)
+                        (i32.shl (local.get $Int_Loc) (i32.const 2)))
+               (i32.load (i32.add (local.get $Arr_1_Par_Ref)
+                                  (i32.shl (local.get $Int_Loc)
+                                           (i32.const 2)))))
+    (global.set $Int_Glob (i32.const 5)))
+
+  (func $Func_1 (param $Ch_1_Par_Val i32) (param $Ch_2_Par_Val i32)
+                (result i32)
+    (if (i32.ne (local.get $Ch_1_Par_Val) (local.get $Ch_2_Par_Val))
+      (then (return (i32.const 0))))
+    (global.set $Ch_1_Glob (local.get $Ch_1_Par_Val))
+    (i32.const 1))
+
+  (func $Func_2 (param $Str_1_Par_Ref i32) (param $Str_2_Par_Ref i32)
+                (result i32)
+    (local $Int_Loc i32) (local $Ch_Loc i32)
+    (local.set $Int_Loc (i32.const 2))
+    (loop $while
+      (if (i32.le_s (local.get $Int_Loc) (i32.const 2))
+        (then
+          (if (i32.eqz
+                (call $Func_1
+                  (i32.load8_u (i32.add (local.get $Str_1_Par_Ref)
+                                        (local.get $Int_Loc)))
+                  (i32.load8_u offset=1
+                    (i32.add (local.get $Str_2_Par_Ref)
+                             (local.get $Int_Loc)))))
+            (then
+              (local.set $Ch_Loc (i32.const 65))
+              (local.set $Int_Loc
+                (i32.add (local.get $Int_Loc) (i32.const 1)))))
+          (br $while))))
+    (if (i32.and (i32.ge_s (local.get $Ch_Loc) (i32.const 87))
+                 (i32.lt_s (local.get $Ch_Loc) (i32.const 90)))
+      (then (local.set $Int_Loc (i32.const 7))))
+    (if (i32.eq (local.get $Ch_Loc) (i32.const 82))
+      (then (return (i32.const 1))))
+    (if (i32.gt_s (call $strcmp (local.get $Str_1_Par_Ref)
+                                (local.get $Str_2_Par_Ref))
+                  (i32.const 0))
+      (then
+        (local.set $Int_Loc (i32.add (local.get $Int_Loc) (i32.const 7)))
+        (global.set $Int_Glob (local.get $Int_Loc))
+        (return (i32.const 1))))
+    (i32.const 0))
+
+  (func $Func_3 (param $Enum_Par_Val i32) (result i32)
+    (i32.eq (local.get $Enum_Par_Val) (i32.const 2)))
+
+  (func (export "run") (result i32)
+    (local $Run_Index i32) (local $Int_2_Loc i32) (local $Ch_Index i32)
+
+    (i32.store (global.get $Ptr_Glob) (global.get $Next_Ptr_Glob))
+    (i32.store offset=4 (global.get $Ptr_Glob) (i32.const 0))
+    (i32.store offset=8 (global.get $Ptr_Glob) (i32.const 2))
+    (i32.store offset=12 (global.get $Ptr_Glob) (i32.const 40))
+    (call $strcpy (i32.add (global.get $Ptr_Glob) (i32.const 16))
+                  (i32.const 0))
+    (call $strcpy (global.get $Str_1_Loc) (i32.const 32))
+    ;; Arr_2_Glob[8][7] = 10
+    (i32.store offset=1628 (global.get $Arr_2_Glob) (i32.const 10))
+
+    (local.set $Run_Index (i32.const 1))
+    (loop $runs
+      (call $Proc_5)
+      (call $Proc_4)
+      (i32.store (global.get $Int_1_Loc) (i32.const 2))
+      (local.set $Int_2_Loc (i32.const 3))
+      (call $strcpy (global.get $Str_2_Loc) (i32.const 64))
+      (i32.store (global.get $Enum_Loc) (i32.const 1))
+      (global.set $Bool_Glob
+        (i32.eqz (call $Func_2 (global.get $Str_1_Loc)
+                               (global.get $Str_2_Loc))))
+      (block $done
+        (loop $while
+          (br_if $done (i32.ge_s (i32.load (global.get $Int_1_Loc))
+                                 (local.get $Int_2_Loc)))
+          (i32.store (global.get $Int_3_Loc)
+                     (i32.sub (i32.mul (i32.const 5)
+                                       (i32.load (global.get $Int_1_Loc)))
+                              (local.get $Int_2_Loc)))
+          (call $Proc_7 (i32.load (global.get $Int_1_Loc))
+                        (local.get $Int_2_Loc)
+                        (global.get $Int_3_Loc))
+          (i32.store (global.get $Int_1_Loc)
+                     (i32.add (i32.load (global.get $Int_1_Loc))
+                              (i32.const 1)))
+          (br $while)))
+      (call $Proc_8 (global.get $Arr_1_Glob) (global.get $Arr_2_Glob)
+                    (i32.load (global.get $Int_1_Loc))
+                    (i32.load (global.get $Int_3_Loc)))
+      (call $Proc_1 (global.get $Ptr_Glob))
+      (local.set $Ch_Index (i32.const 65))
+      (block $done
+        (loop $for
+          (br_if $done (i32.gt_s (local.get $Ch_Index)
+                                 (global.get $Ch_2_Glob)))
+          (if (i32.eq (i32.load (global.get $Enum_Loc))
+                      (call $Func_1 (local.get $Ch_Index) (i32.const 67)))
+            (then
+              (call $Proc_6 (i32.const 0) (global.get $Enum_Loc))
+              (call $strcpy (global.get $Str_2_Loc) (i32.const 96))
+              (local.set $Int_2_Loc (local.get $Run_Index))
+              (global.set $Int_Glob (local.get $Run_Index))))
+          (local.set $Ch_Index (i32.add (local.get $Ch_Index) (i32.const 1)))
+          (br $for)))
+      (local.set $Int_2_Loc
+        (i32.mul (local.get $Int_2_Loc) (i32.load (global.get $Int_1_Loc))))
+      (i32.store (global.get $Int_1_Loc)
+                 (i32.div_s (local.get $Int_2_Loc)
+                            (i32.load (global.get $Int_3_Loc))))
+      (local.set $Int_2_Loc
+        (i32.sub (i32.mul (i32.const 7)
+                          (i32.sub (local.get $Int_2_Loc)
+                                   (i32.load (global.get $Int_3_Loc))))
+                 (i32.load (global.get $Int_1_Loc))))
+      (call $Proc_2 (global.get $Int_1_Loc))
+      (br_if $runs
+        (i32.le_s (local.tee $Run_Index
+                    (i32.add (local.get $Run_Index) (i32.const 1)))
+                  (i32.const 20000))))
+
+    (i32.add
+      (i32.add
+        (i32.add (i32.load offset=1628 (global.get $Arr_2_Glob))
+                 (i32.load (global.get $Int_1_Loc)))
+        (i32.add (local.get $Int_2_Loc)
+                 (i32.load (global.get $Int_3_Loc))))
+      (i32.add
+        (i32.add (global.get $Int_Glob) (global.get $Bool_Glob))
+        (i32.add (i32.load offset=12 (global.get $Ptr_Glob))
+                 (i32.load offset=12 (global.get $Next_Ptr_Glob)))))))
@@ -0,0 +1,51 @@
+;;; ARGS: --enable-exceptions
+;;; RESULT: run() => i32:1966301292
+;; Exception handling: values thrown from a few frames down and caught by tag,
+;; rethrown from a catch_all, and forwarded with delegate.
+(module
+  (tag $small (param i32))
+  (tag $large (param i32))
+
+  ;; Throws $small or $large after recursing $depth frames.
+  (func $thrower (param $depth i32) (param $value i32)
+    (if (local.get $depth)
+      (then
+        (call $thrower (i32.sub (local.get $depth) (i32.const 1))
+                       (local.get $value))
+        (return)))
+    (if (i32.lt_u (i32.and (local.get $value) (i32.const 255)) (i32.const 200))
+      (then (throw $small (local.get $value))))
+    (throw $large (local.get $value)))
+
+  ;; Catches $small itself and rethrows anything else after cleanup.
+  (func $catcher (param $value i32) (result i32)
+    (try (result i32)
+      (do
+        (call $thrower (i32.and (local.get $value) (i32.const 3))
+                       (local.get $value))
+        (i32.const -1))
+      (catch $small
+        (i32.add (i32.const 1)))
+      (catch_all
+        (rethrow 0))))
+
+  (func $forwarder (param $value i32) (result i32)
+    (try (result i32)
+      (do
+        (try (result i32)
+          (do (call $catcher (local.get $value)))
+          (delegate 0)))
+      (catch $large
+        (i32.mul (i32.const 3)))))
+
+  (func (export "run") (result i32)
+    (local $i i32) (local $sum i32)
+    (loop $throws
+      (local.set $sum
+        (i32.add (i32.rotl (local.get $sum) (i32.const 3))
+                 (call $forwarder
+                   (i32.mul (local.get $i) (i32.const 2654435761)))))
+      (br_if $throws
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 100000))))
+    (local.get $sum)))
@@ -0,0 +1,63 @@
+;;; RESULT: run() => i32:2474166881
+;; Memory-bound loops over a 64 KiB buffer: memory.fill and memory.copy, a copy
+;; loop one byte at a time, a copy loop eight bytes at a time, and a checksum
+;; loop that reads back every word.
+(module
+  (memory 4)
+
+  (global $src i32 (i32.const 0))
+  (global $dst i32 (i32.const 65536))
+  (global $size i32 (i32.const 65536))
+
+  (func $copy_bytes (param $dst i32) (param $src i32) (param $n i32)
+    (local $i i32)
+    (loop $bytes
+      (i32.store8 (i32.add (local.get $dst) (local.get $i))
+                  (i32.load8_u (i32.add (local.get $src) (local.get $i))))
+      (br_if $bytes
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (local.get $n)))))
+
+  (func $copy_words (param $dst i32) (param $src i32) (param $n i32)
+    (local $i i32)
+    (loop $words
+      (i64.store (i32.add (local.get $dst) (local.get $i))
+                 (i64.load (i32.add (local.get $src) (local.get $i))))
+      (br_if $words
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 8)))
+                  (local.get $n)))))
+
+  (func $checksum (param $p i32) (param $n i32) (result i32)
+    (local $i i32) (local $sum i32)
+    (loop $words
+      (local.set $sum
+        (i32.add (i32.rotl (local.get $sum) (i32.const 5))
+                 (i32.load (i32.add (local.get $p) (local.get $i)))))
+      (br_if $words
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 4)))
+                  (local.get $n))))
+    (local.get $sum))
+
+  (func (export "run") (result i32)
+    (local $round i32) (local $sum i32)
+    (loop $rounds
+      ;; A new pattern every round, with a byte stored at a different offset
+      ;; so the copies have something to move.
+      (memory.fill (global.get $src) (local.get $round) (global.get $size))
+      (i32.store8 (i32.and (i32.mul (local.get $round) (i32.const 4099))
+                           (i32.const 0xffff))
+                  (i32.xor (local.get $round) (i32.const 0x5a)))
+      (memory.copy (global.get $dst) (global.get $src) (global.get $size))
+      ;; Shift the copy by 3 bytes, overlapping itself.
+      (memory.copy (i32.add (global.get $dst) (i32.const 3)) (global.get $dst)
+                   (i32.sub (global.get $size) (i32.const 3)))
+      (call $copy_bytes (global.get $src) (global.get $dst)
+                        (i32.shr_u (global.get $size) (i32.const 2)))
+      (call $copy_words (global.get $dst) (global.get $src) (global.get $size))
+      (local.set $sum
+        (i32.xor (i32.mul (local.get $sum) (i32.const 31))
+                 (call $checksum (global.get $dst) (global.get $size))))
+      (br_if $rounds
+        (i32.lt_u (local.tee $round (i32.add (local.get $round) (i32.const 1)))
+                  (i32.const 40))))
+    (local.get $sum)))
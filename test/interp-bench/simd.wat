@@ -0,0 +1,117 @@
+;;; RESULT: run() => i32:547182976
+;; SIMD kernels over 4096-element arrays: an i32x4 dot product, an f32x4 saxpy
+;; and saturating i8x16 byte arithmetic with a bitmask count. Every value stays
+;; an integer small enough to be exact in f32, so the result doesn't depend on
+;; rounding.
+(module
+  (memory 1)
+
+  (global $A i32 (i32.const 0))       ;; i32[4096]
+  (global $B i32 (i32.const 16384))   ;; i32[4096]
+  (global $C i32 (i32.const 32768))   ;; u8[16384]
+  (global $Y i32 (i32.const 49152))   ;; f32[4096]
+
+  (func $init
+    (local $i i32)
+    (loop $words
+      (i32.store (i32.add (global.get $A) (i32.shl (local.get $i) (i32.const 2)))
+                 (i32.and (i32.mul (local.get $i) (i32.const 3))
+                          (i32.const 1023)))
+      (i32.store (i32.add (global.get $B) (i32.shl (local.get $i) (i32.const 2)))
+                 (i32.and (i32.add (i32.mul (local.get $i) (i32.const 7))
+                                   (i32.const 1))
+                          (i32.const 511)))
+      (f32.store (i32.add (global.get $Y) (i32.shl (local.get $i) (i32.const 2)))
+                 (f32.const 0))
+      (br_if $words
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 4096))))
+    (local.set $i (i32.const 0))
+    (loop $bytes
+      (i32.store8 (i32.add (global.get $C) (local.get $i))
+                  (i32.mul (local.get $i) (i32.const 13)))
+      (br_if $bytes
+        (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1)))
+                  (i32.const 16384)))))
+
+  (func $dot (result i32)
+    (local $p i32) (local $acc v128)
+    (loop $chunks
+      (local.set $acc
+        (i32x4.add (local.get $acc)
+                   (i32x4.mul (v128.load (i32.add (global.get $A) (local.get $p)))
+                              (v128.load (i32.add (global.get $B)
+                                                  (local.get $p))))))
+      (br_if $chunks
+        (i32.lt_u (local.tee $p (i32.add (local.get $p) (i32.const 16)))
+                  (i32.const 16384))))
+    (i32.add (i32.add (i32x4.extract_lane 0 (local.get $acc))
+                      (i32x4.extract_lane 1 (local.get $acc)))
+             (i32.add (i32x4.extract_lane 2 (local.get $acc))
+                      (i32x4.extract_lane 3 (local.get $acc)))))
+
+  ;; Y = 2 * A + Y
+  (func $saxpy
+    (local $p i32) (local $y i32)
+    (loop $chunks
+      (local.set $y (i32.add (global.get $Y) (local.get $p)))
+      (v128.store (local.get $y)
+        (f32x4.add
+          (f32x4.mul (f32x4.splat (f32.const 2))
+                     (f32x4.convert_i32x4_s
+                       (v128.load (i32.add (global.get $A) (local.get $p)))))
+          (v128.load (local.get $y))))
+      (br_if $chunks
+        (i32.lt_u (local.tee $p (i32.add (local.get $p) (i32.const 16)))
+                  (i32.const 16384)))))
+
+  ;; Adds 1 to every byte of C, saturating, and returns how many are 255.
+  (func $bytes (result i32)
+    (local $p i32) (local $c i32) (local $v v128) (local $count i32)
+    (loop $chunks
+      (local.set $c (i32.add (global.get $C) (local.get $p)))
+      (v128.store (local.get $c)
+        (local.tee $v (i8x16.add_sat_u (v128.load (local.get $c))
+                                       (i8x16.splat (i32.const 1)))))
+      (local.set $count
+        (i32.add (local.get $count)
+                 (i32.popcnt (i8x16.bitmask
+                               (i8x16.eq (local.get $v)
+                                         (i8x16.splat (i32.const 255)))))))
+      (br_if $chunks
+        (i32.lt_u (local.tee $p (i32.add (local.get $p) (i32.const 16)))
+                  (i32.const 16384))))
+    (local.get $count))
+
+  (func $sum_y (result i32)
+    (local $p i32) (local $acc v128)
+    (loop $chunks
+      (local.set $acc
+        (i32x4.add (local.get $acc)
+                   (i32x4.trunc_sat_f32x4_s
+                     (v128.load (i32.add (global.get $Y) (local.get $p))))))
+      (br_if $chunks
+        (i32.lt_u (local.tee $p (i32.add (local.get $p) (i32.const 16)))
+                  (i32.const 16384))))
+    (i32.add (i32.add (i32x4.extract_lane 0 (local.get $acc))
+                      (i32x4.extract_lane 1 (local.get $acc)))
+             (i32.add (i32x4.extract_lane 2 (local.get $acc))
+                      (i32x4.extract_lane 3 (local.get $acc)))))
+
+  (func (export "run") (result i32)
+    (local $round i32) (local $checksum i32)
+    (call $init)
+    (loop $rounds
+      (local.set $checksum
+        (i32.add (i32.mul (local.get $checksum) (i32.const 31))
+                 (i32.xor (call $dot) (call $bytes))))
+      (call $saxpy)
+      ;; Change A so every dot product differs.
+      (i32.store (i32.add (global.get $A)
+                          (i32.shl (i32.and (local.get $round) (i32.const 4095))
+                                   (i32.const 2)))
+                 (local.get $round))
+      (br_if $rounds
+        (i32.lt_u (local.tee $round (i32.add (local.get $round) (i32.const 1)))
+                  (i32.const 320))))
+    (i32.add (local.get $checksum) (call $sum_y))))
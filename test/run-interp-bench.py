@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Runs the interpreter workloads in test/interp-bench and reports their speed.
+
+Each workload is a .wat file that exports a "run" function taking no
+arguments. Its header gives the expected output of `wasm-interp -r run` and
+optionally extra feature flags:
+
+  ;;; ARGS: --enable-exceptions
+  ;;; RESULT: run() => i32:1966301292
+
+Every workload is run --repeat times with `wasm-interp --stats` and the fastest
+run is kept. A workload whose output doesn't match RESULT is reported as
+failed, so a broken interpreter can't look fast.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import find_exe
+from utils import Error
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_DIR = os.path.join(SCRIPT_DIR, 'interp-bench')
+
+STATS = {
+    'istream_bytes': (r'^istream size: (\d+) bytes$', int),
+    'instructions': (r'^instructions executed: (\d+)$', int),
+    'seconds': (r'^run time: ([\d.]+) s$', float),
+    'peak_rss_kb': (r'^peak RSS: (\d+) KB$', int),
+}
+
+
+def ReadHeader(path):
+    header = {'ARGS': [], 'RESULT': None}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'^;;; (\w+): (.*)$', line)
+            if not m:
+                break
+            key, value = m.groups()
+            if key == 'ARGS':
+                header['ARGS'] += value.split()
+            elif key == 'RESULT':
+                header['RESULT'] = value.strip()
+            else:
+                raise Error('%s: unknown key %s' % (path, key))
+    if header['RESULT'] is None:
+        raise Error('%s: missing RESULT' % path)
+    return header
+
+
+def ParseStats(stderr):
+    stats = {}
+    for key, (pattern, convert) in STATS.items():
+        m = re.search(pattern, stderr, re.MULTILINE)
+        if not m:
+            return None
+        stats[key] = convert(m.group(1))
+    return stats
+
+
+def RunWorkload(interp, wasm, header, repeat, interp_args):
+    """Returns the stats of the fastest run, or an error message."""
+    best = None
+    cmd = [interp, wasm, '-r', 'run', '--stats'] + header['ARGS'] + interp_args
+    for _ in range(repeat):
+        proc = subprocess.run(cmd, stdout=subprocess.PIPE,
+                              stderr=subprocess.PIPE, universal_newlines=True)
+        if proc.returncode != 0:
+            return None, 'exited with %d' % proc.returncode
+        output = proc.stdout.strip()
+        if output != header['RESULT']:
+            return None, 'expected "%s", got "%s"' % (header['RESULT'], output)
+        stats = ParseStats(proc.stderr)
+        if stats is None:
+            return None, 'no --stats output'
+        if best is None or stats['seconds'] < best['seconds']:
+            best = stats
+    return best, None
+
+
+def InstructionsPerSecond(stats):
+    return stats['instructions'] / max(stats['seconds'], 1e-9)
+
+
+def main(args):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--bindir', metavar='PATH',
+                        default=find_exe.GetDefaultPath(),
+                        help='directory to search for all executables.')
+    parser.add_argument('--dir', metavar='PATH', default=DEFAULT_DIR,
+                        help='directory containing the .wat workloads.')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per workload; the fastest is kept.')
+    parser.add_argument('--workload', action='append',
+                        help='only run this workload (may be repeated).')
+    parser.add_argument('-o', '--output', metavar='PATH',
+                        help='also write the results as JSON to PATH.')
+    parser.add_argument('--interp-arg', metavar='ARG', action='append',
+                        default=[],
+                        help='additional args to pass to wasm-interp, e.g. '
+                        '--interp-arg=--jit')
+    options = parser.parse_args(args)
+
+    wat2wasm = find_exe.GetWat2WasmExecutable(options.bindir)
+    interp = find_exe.GetWasmInterpExecutable(options.bindir)
+    workloads = sorted(os.path.splitext(name)[0]
+                       for name in os.listdir(options.dir)
+                       if name.endswith('.wat'))
+    if options.workload:
+        unknown = set(options.workload) - set(workloads)
+        if unknown:
+            parser.error('unknown workload(s): %s' %
+                         ', '.join(sorted(unknown)))
+        workloads = [w for w in workloads if w in options.workload]
+
+    temp_dir = tempfile.mkdtemp(prefix='wabt-interp-bench-')
+    results = []
+    failed = []
+    try:
+        print('%-12s %10s %14s %14s %10s %10s' %
+              ('workload', 'time (s)', 'instructions', 'instr/s',
+               'istream', 'RSS (KB)'))
+        for name in workloads:
+            wat = os.path.join(options.dir, name + '.wat')
+            wasm = os.path.join(temp_dir, name + '.wasm')
+            header = ReadHeader(wat)
+            proc = subprocess.run([wat2wasm, wat, '-o', wasm] + header['ARGS'],
+                                  stdout=subprocess.PIPE,
+                                  stderr=subprocess.STDOUT,
+                                  universal_newlines=True)
+            if proc.returncode != 0:
+                stats, error = None, proc.stdout.strip()
+            else:
+                stats, error = RunWorkload(interp, wasm, header,
+                                           options.repeat, options.interp_arg)
+            if error:
+                failed.append((name, error))
+                print('%-12s %10s' % (name, 'FAILED'))
+            else:
+                results.append(dict(name=name, **stats))
+                print('%-12s %10.4f %14d %14.0f %10d %10d' %
+                      (name, stats['seconds'], stats['instructions'],
+                       InstructionsPerSecond(stats), stats['istream_bytes'],
+                       stats['peak_rss_kb']))
+            sys.stdout.flush()
+    finally:
+        shutil.rmtree(temp_dir)
+
+    if options.output:
+        for result in results:
+            result['instructions_per_second'] = InstructionsPerSecond(result)
+        with open(options.output, 'w') as f:
+            json.dump({'interpreter': interp, 'workloads': results}, f,
+                      indent=2)
+            f.write('\n')
+
+    if failed:
+        print('\n%d failure(s):' % len(failed))
+        for name, error in failed:
+            print('  %s: %s' % (name, error))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main(sys.argv[1:]))
+    except Error as e:
+        sys.stderr.write(str(e) + '\n')
+        sys.exit(1)
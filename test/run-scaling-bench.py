@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Times the wabt tools on generated pathological modules of growing size.
+
+Each shape is generated at base * 2**i for i in range(steps). For every tool
+the growth exponent k in time ~ size**k is estimated from the smallest and
+largest inputs, and anything above --threshold is flagged as super-linear.
+Timings below --min-time are too noisy to judge and are never flagged.
+
+Note that deep nesting is inherently quadratic in the size of the text written
+by wasm2wat and wasm2c, since each level is indented further.
+"""
+
+import argparse
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import find_exe
+from utils import Error
+
+
+def LocalsOneGroup(n):
+    body = ''.join('    local.get %d\n    drop\n' % i for i in range(n))
+    return ('(module\n  (func (export "f")\n    (local %s)\n%s  ))\n' %
+            (' '.join(['i32'] * n), body))
+
+
+def LocalDeclGroups(n):
+    # Alternating types keeps the binary writer from merging the decls.
+    locals_ = ' '.join('(local %s)' % ('i32' if i % 2 else 'i64')
+                       for i in range(n))
+    body = ''.join('    local.get %d\n    drop\n' % i for i in range(n))
+    return '(module\n  (func (export "f")\n    %s\n%s  ))\n' % (locals_, body)
+
+
+def DeepNesting(n):
+    opens = '    block\n' * n
+    closes = '    br 0\n    end\n' * n
+    return '(module\n  (func (export "f")\n%s%s  ))\n' % (opens, closes)
+
+
+def DeepTryNesting(n):
+    opens = '    try\n' * n
+    closes = '    br 0\n    catch_all\n    end\n' * n
+    return '(module\n  (func (export "f")\n%s%s  ))\n' % (opens, closes)
+
+
+def HugeBrTable(n):
+    depth = 16
+    targets = ' '.join(str(i % depth) for i in range(n))
+    return ('(module\n  (func (export "f") (param i32)\n%s'
+            '    local.get 0\n    br_table %s\n%s  ))\n' %
+            ('    block\n' * depth, targets, '    end\n' * depth))
+
+
+def ManyTypes(n):
+    # Spell out the bits of i as i32/i64 params so every signature is distinct
+    # and the input stays O(n log n).
+    def Params(i):
+        return ' '.join('i64' if i >> bit & 1 else 'i32'
+                        for bit in range(i.bit_length())) or 'f32'
+    types = ''.join('  (type (func (param f64 %s)))\n' % Params(i)
+                    for i in range(n))
+    return '(module\n%s)\n' % types
+
+
+def ManyImports(n):
+    imports = ''.join('  (import "env" "f%d" (func (param i32)))\n' % i
+                      for i in range(n))
+    return '(module\n%s)\n' % imports
+
+
+def ManyExports(n):
+    # Named, since --relocatable needs a unique symbol name per function.
+    funcs = ''.join(
+        '  (func $f%d (export "f%d") (result i32) i32.const %d)\n' %
+        (i, i, i) for i in range(n))
+    return '(module\n%s)\n' % funcs
+
+
+def ManyCalls(n):
+    # Each function calls its neighbour, so --relocatable emits a reloc per
+    # call and every function body size needs a fixup.
+    funcs = ''.join(
+        '  (func $f%d (export "f%d") (param i32) (result i32)\n%s'
+        '    local.get 0\n    call $f%d)\n' %
+        (i, i, '    local.get 0\n    drop\n' * 64, (i + 1) % n)
+        for i in range(n))
+    return '(module\n%s)\n' % funcs
+
+
+SHAPES = {
+    'locals-one-group': (LocalsOneGroup, []),
+    'local-decl-groups': (LocalDeclGroups, []),
+    'deep-nesting': (DeepNesting, []),
+    'deep-try-nesting': (DeepTryNesting, ['--enable-exceptions']),
+    'huge-br-table': (HugeBrTable, []),
+    'many-types': (ManyTypes, []),
+    'many-imports': (ManyImports, []),
+    'many-exports': (ManyExports, []),
+    'many-calls': (ManyCalls, []),
+}
+
+# name -> (executable, input kind, extra args, output flag, takes features)
+TOOLS = {
+    'wat2wasm': ('wat2wasm', 'wat', [], '-o', True),
+    'wat2wasm-reloc': ('wat2wasm', 'wat', ['--relocatable'], '-o', True),
+    'wasm-validate': ('wasm-validate', 'wasm', [], None, True),
+    'wasm2wat': ('wasm2wat', 'wasm', [], '-o', True),
+    'wasm-objdump': ('wasm-objdump', 'wasm', ['-d'], None, False),
+    'wasm-interp': ('wasm-interp', 'wasm', ['--dummy-import-func'], None, True),
+    'wasm2c': ('wasm2c', 'wasm', [], '-o', True),
+    'wasm-decompile': ('wasm-decompile', 'wasm', [], '-o', True),
+}
+
+
+def TimeCommand(cmd, repeat):
+    """Returns the fastest of `repeat` runs, or None if the command fails."""
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, stdout=subprocess.DEVNULL,
+                              stderr=subprocess.DEVNULL)
+        elapsed = time.perf_counter() - start
+        if proc.returncode != 0:
+            return None
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def FormatTime(t):
+    return '%10.4f' % t if t is not None else '%10s' % 'FAILED'
+
+
+def main(args):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--bindir', metavar='PATH',
+                        default=find_exe.GetDefaultPath(),
+                        help='directory to search for all executables.')
+    parser.add_argument('--base', type=int, default=500,
+                        help='size of the smallest input of each shape.')
+    parser.add_argument('--steps', type=int, default=4,
+                        help='number of sizes, each double the previous.')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per measurement; the fastest is kept.')
+    parser.add_argument('--threshold', type=float, default=1.3,
+                        help='growth exponent above which a tool is flagged.')
+    parser.add_argument('--min-time', type=float, default=0.02,
+                        help='largest timing (in seconds) needed to flag.')
+    parser.add_argument('--shape', action='append', choices=sorted(SHAPES),
+                        help='only run this shape (may be repeated).')
+    parser.add_argument('--tool', action='append', choices=sorted(TOOLS),
+                        help='only run this tool (may be repeated).')
+    parser.add_argument('--keep-temp', action='store_true',
+                        help='keep the generated inputs and print their path.')
+    options = parser.parse_args(args)
+
+    if options.steps < 2:
+        parser.error('--steps must be at least 2')
+
+    shapes = options.shape or sorted(SHAPES)
+    tools = options.tool or sorted(TOOLS)
+    exes = {name: find_exe.FindExecutable(TOOLS[name][0], options.bindir)
+            for name in tools}
+    wat2wasm = find_exe.GetWat2WasmExecutable(options.bindir)
+    sizes = [options.base << i for i in range(options.steps)]
+
+    temp_dir = tempfile.mkdtemp(prefix='wabt-scaling-')
+    flagged = []
+    failed = []
+    try:
+        header = '%-18s %-15s' % ('shape', 'tool')
+        header += ''.join('%10d' % size for size in sizes)
+        print(header + '  exponent')
+        for shape in shapes:
+            generate, features = SHAPES[shape]
+            inputs = []
+            for size in sizes:
+                base = os.path.join(temp_dir, '%s-%d' % (shape, size))
+                with open(base + '.wat', 'w') as f:
+                    f.write(generate(size))
+                if subprocess.call([wat2wasm, base + '.wat', '-o',
+                                    base + '.wasm'] + features,
+                                   stderr=subprocess.DEVNULL) != 0:
+                    # The .wasm input is missing; the wasm tools will fail.
+                    failed.append((shape, 'generate %d' % size))
+                inputs.append(base)
+
+            for name in tools:
+                exe, kind, extra, output, takes_features = TOOLS[name]
+                times = []
+                for base in inputs:
+                    cmd = [exes[name], '%s.%s' % (base, kind)] + extra
+                    if takes_features:
+                        cmd += features
+                    if output:
+                        cmd += [output, '%s.%s.out' % (base, name)]
+                    times.append(TimeCommand(cmd, options.repeat))
+                line = '%-18s %-15s' % (shape, name)
+                line += ''.join(FormatTime(t) for t in times)
+                if None in times:
+                    failed.append((shape, name))
+                    print(line)
+                    sys.stdout.flush()
+                    continue
+                exponent = (math.log(max(times[-1], 1e-6) /
+                                     max(times[0], 1e-6)) /
+                            math.log(sizes[-1] / sizes[0]))
+                mark = ''
+                if (exponent > options.threshold and
+                        times[-1] >= options.min_time):
+                    mark = '  SUPER-LINEAR'
+                    flagged.append((shape, name))
+                print('%s  %8.2f%s' % (line, exponent, mark))
+                sys.stdout.flush()
+    finally:
+        if options.keep_temp:
+            print('inputs kept in %s' % temp_dir)
+        else:
+            shutil.rmtree(temp_dir)
+
+    if failed:
+        print('\n%d failure(s):' % len(failed))
+        for shape, name in failed:
+            print('  %s: %s' % (shape, name))
+    if flagged:
+        print('\n%d super-linear case(s):' % len(flagged))
+        for shape, name in flagged:
+            print('  %s: %s' % (shape, name))
+    return 1 if failed or flagged else 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main(sys.argv[1:]))
+    except Error as e:
+        sys.stderr.write(str(e) + '\n')
+        sys.exit(1)
@@ -88,6 +88,17 @@ TOOLS = {
         ('RUN', '%(wasm-interp)s %(temp_file)s.wasm --run-all-exports'),
         ('VERBOSE-ARGS', ['--print-cmd', '-v']),
     ],
+    'run-interp-cache': [
+        ('RUN', '%(wat2wasm)s %(in_file)s -o %(temp_file)s.wasm'),
+        ('RUN', '%(wasm-interp)s %(temp_file)s.wasm --run-all-exports '
+                '--cache-dir=%(out_dir)s/cache'),
+        ('RUN', '%(wasm-interp)s %(temp_file)s.wasm --run-all-exports '
+                '--cache-dir=%(out_dir)s/cache'),
+        ('RUN', 'test/corrupt-istream-cache.py %(out_dir)s/cache'),
+        ('RUN', '%(wasm-interp)s %(temp_file)s.wasm --run-all-exports '
+                '--cache-dir=%(out_dir)s/cache'),
+        ('VERBOSE-ARGS', ['--print-cmd', '-v']),
+    ],
     'run-interp-wasi': [
         ('RUN', '%(wat2wasm)s %(in_file)s -o %(temp_file)s.wasm'),
         ('RUN', '%(wasm-interp)s --wasi %(temp_file)s.wasm'),
@@ -98,6 +109,11 @@ TOOLS = {
         ('RUN', '%(spectest-interp)s %(temp_file)s.json'),
         ('VERBOSE-ARGS', ['--print-cmd', '-v']),
     ],
+    'run-interp-spec-bundle': [
+        ('RUN', '%(wast2json)s --bundle %(in_file)s -o %(temp_file)s.wsb'),
+        ('RUN', '%(spectest-interp)s %(temp_file)s.wsb'),
+        ('VERBOSE-ARGS', ['--print-cmd', '-v']),
+    ],
     'run-gen-wasm': [
         ('RUN', '%(gen_wasm_py)s %(in_file)s -o %(temp_file)s.wasm'),
         ('RUN', '%(wasm-validate)s %(temp_file)s.wasm'),
@@ -154,6 +170,12 @@ TOOLS = {
         ('RUN', '%(wat2wasm)s %(in_file)s -o %(temp_file)s.wasm'),
         ('RUN', '%(wasm2c)s -n test %(temp_file)s.wasm'),
     ],
+    'run-wasm2c-profile': [
+        ('RUN', '%(wat2wasm)s %(in_file)s -o %(temp_file)s.wasm'),
+        ('RUN', '%(wasm2c)s -n test --profile %(temp_file)s.wasm'),
+        ('RUN', 'test/run-wasm2c-profile.py %(temp_file)s.wasm '
+                '--bindir=%(bindir)s -o %(out_dir)s'),
+    ],
     'run-wasm-decompile': [
         ('RUN', '%(wat2wasm)s --enable-all %(in_file)s -o %(temp_file)s.wasm'),
         ('RUN', '%(wasm-decompile)s --enable-all %(temp_file)s.wasm'),
@@ -162,6 +184,9 @@ TOOLS = {
 
 ROUNDTRIP_TOOLS = ('wat2wasm',)
 
+# Tools that --interp-arg applies to.
+INTERP_EXES = ('%(wasm-interp)s', '%(spectest-interp)s')
+
 
 class NoRoundtripError(Error):
     pass
@@ -753,7 +778,10 @@ def RunTest(info, options, variables, verbose_level=0):
     test_result = TestResult()
 
     for cmd_template in info.cmds:
-        cmd = cmd_template.GetCommand(variables, options.arg, verbose_level)
+        extra_args = options.arg
+        if options.interp_arg and cmd_template.args[0] in INTERP_EXES:
+            extra_args = (extra_args or []) + options.interp_arg
+        cmd = cmd_template.GetCommand(variables, extra_args, verbose_level)
         if options.print_cmd:
             print(cmd)
 
@@ -900,6 +928,10 @@ def main(args):
     parser.add_argument('-a', '--arg',
                         help='additional args to pass to executable',
                         action='append')
+    parser.add_argument('--interp-arg', metavar='ARG',
+                        help='additional args to pass to wasm-interp and '
+                        'spectest-interp only, e.g. --interp-arg=--jit',
+                        action='append')
     parser.add_argument('--bindir', metavar='PATH',
                         default=find_exe.GetDefaultPath(),
                         help='directory to search for all executables.')
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Runs a module built by wasm2c --profile and prints its collapsed stacks.
+
+The module must export a function "run" of type [] -> [i32], which is called
+twice. The generated code and the runtime are built with WASM_RT_FRAME_CHAIN,
+on the ggt stub, so the profile records the call stack of every entry.
+"""
+
+import argparse
+import os
+import shlex
+import subprocess
+import sys
+
+import find_exe
+import utils
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+WASM2C_DIR = os.path.join(find_exe.REPO_ROOT_DIR, 'wasm2c')
+GGT_STUB_DIR = os.path.join(SCRIPT_DIR, 'ggt-stub')
+SKIPPED = 3
+
+MAIN = '''#include <stdio.h>
+
+#include "test.h"
+
+int main(void) {
+  w2c_test instance;
+  wasm_rt_profile_t profile;
+  u32 result;
+
+  wasm_rt_init();
+  wasm2c_test_instantiate(&instance);
+  w2c_test_run(&ggt_stub_thread, &result, &instance);
+  w2c_test_run(&ggt_stub_thread, &result, &instance);
+  wasm2c_test_get_profile(&instance, &profile);
+  wasm_rt_profile_dump_collapsed(&profile, stdout);
+  wasm2c_test_free(&instance);
+  wasm_rt_free();
+  return 0;
+}
+'''
+
+
+def main(args):
+    default_compiler = os.getenv('WASM2C_CC', os.getenv('CC', 'cc'))
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('-o', '--out-dir', metavar='PATH', required=True,
+                        help='output directory for files.')
+    parser.add_argument('--bindir', metavar='PATH',
+                        default=find_exe.GetDefaultPath(),
+                        help='directory to search for all executables.')
+    parser.add_argument('--cc', metavar='PATH', default=default_compiler,
+                        help='the path to the C compiler')
+    parser.add_argument('file', help='wasm file.')
+    options = parser.parse_args(args)
+
+    if sys.platform == 'win32':
+        sys.stderr.write('skipping: the ggt stub needs a GNU C compiler\n')
+        return SKIPPED
+
+    wasm2c = utils.Executable(find_exe.GetWasm2CExecutable(options.bindir))
+    c_filename = os.path.join(options.out_dir, 'test.c')
+    wasm2c.RunWithArgs(options.file, '-n', 'test', '--profile',
+                       '-o', c_filename)
+
+    main_filename = os.path.join(options.out_dir, 'main.c')
+    with open(main_filename, 'w') as main_file:
+        main_file.write(MAIN)
+
+    cc = utils.Executable(options.cc, forward_stderr=True,
+                          forward_stdout=False)
+    main_exe = os.path.join(options.out_dir, 'main')
+    cflags = shlex.split(os.environ.get('WASM2C_CFLAGS', ''))
+    cc.RunWithArgsForStdout(
+        *cflags, '-I%s' % WASM2C_DIR, '-I%s' % GGT_STUB_DIR,
+        '-Wall', '-Werror', '-Wno-unused', '-DWASM_RT_FRAME_CHAIN=1',
+        '-DWASM_RT_NONCONFORMING_MEMCHECK_NONE=0', '-D_DEFAULT_SOURCE',
+        c_filename, main_filename,
+        os.path.join(WASM2C_DIR, 'wasm-rt-impl.c'),
+        os.path.join(WASM2C_DIR, 'wasm-rt-mem-impl.c'),
+        os.path.join(WASM2C_DIR, 'wasm-rt-profile-impl.c'),
+        '-lm', '-o', main_exe)
+    return subprocess.run([main_exe]).returncode
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main(sys.argv[1:]))
+    except utils.Error as e:
+        sys.stderr.write(str(e) + '\n')
+        sys.exit(1)
@@ -0,0 +1,126 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "wasm-rt.h"
+
+/*
+ * Compares the copy kernels used by the wasm2c memory.copy helpers:
+ *   - libc memmove (the default path for memory_copy),
+ *   - wasm_rt_memmove_large (used at or above
+ *     WASM_RT_NONTEMPORAL_COPY_THRESHOLD),
+ *   - a fixed-size bounce-buffer copy (the shape of memory_copy_const, used
+ *     when the length is a small constant).
+ * Each size is copied repeatedly within a 64 MiB buffer so that large sizes
+ * stream through memory rather than staying cache resident.
+ */
+
+#define BUFFER_SIZE (64u << 20)
+#define MIN_BYTES_PER_SIZE (1ull << 30)
+#define MIN_ITERATIONS 16
+
+static uint8_t* buffer;
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t iterations_for(size_t n) {
+  uint64_t iters = MIN_BYTES_PER_SIZE / n;
+  return iters < MIN_ITERATIONS ? MIN_ITERATIONS : iters;
+}
+
+/* Offsets walk through the buffer; dest and src never overlap. */
+static size_t offset_for(uint64_t i, size_t n) {
+  size_t slots = (BUFFER_SIZE / 2) / n;
+  return (size_t)(i % slots) * n;
+}
+
+static double bench_memmove(size_t n) {
+  uint64_t iters = iterations_for(n);
+  double start = now();
+  for (uint64_t i = 0; i < iters; i++) {
+    size_t off = offset_for(i, n);
+    memmove(buffer + off, buffer + BUFFER_SIZE / 2 + off, n);
+  }
+  return (double)n * iters / (now() - start);
+}
+
+static double bench_large(size_t n) {
+  uint64_t iters = iterations_for(n);
+  double start = now();
+  for (uint64_t i = 0; i < iters; i++) {
+    size_t off = offset_for(i, n);
+    wasm_rt_memmove_large(buffer + off, buffer + BUFFER_SIZE / 2 + off, n);
+  }
+  return (double)n * iters / (now() - start);
+}
+
+#define DEFINE_BENCH_CONST(N)                                      \
+  static double bench_const_##N(void) {                            \
+    uint64_t iters = iterations_for(N);                            \
+    double start = now();                                          \
+    for (uint64_t i = 0; i < iters; i++) {                         \
+      size_t off = offset_for(i, N);                               \
+      uint8_t tmp[N];                                              \
+      memcpy(tmp, buffer + BUFFER_SIZE / 2 + off, N);              \
+      memcpy(buffer + off, tmp, N);                                \
+    }                                                              \
+    return (double)N * iters / (now() - start);                    \
+  }
+
+DEFINE_BENCH_CONST(1)
+DEFINE_BENCH_CONST(4)
+DEFINE_BENCH_CONST(8)
+DEFINE_BENCH_CONST(16)
+DEFINE_BENCH_CONST(32)
+DEFINE_BENCH_CONST(64)
+
+static double bench_const(size_t n) {
+  switch (n) {
+    case 1: return bench_const_1();
+    case 4: return bench_const_4();
+    case 8: return bench_const_8();
+    case 16: return bench_const_16();
+    case 32: return bench_const_32();
+    case 64: return bench_const_64();
+    default: return 0;
+  }
+}
+
+int main(int argc, char** argv) {
+  static const size_t sizes[] = {
+      1,        4,         8,         16,        32,       64,
+      256,      4 << 10,   64 << 10,  1 << 20,   4 << 20,  16 << 20,
+  };
+
+  buffer = malloc(BUFFER_SIZE);
+  if (!buffer) {
+    perror("malloc");
+    return 1;
+  }
+  memset(buffer, 0xa5, BUFFER_SIZE);
+
+  printf("%10s %14s %14s %14s\n", "bytes", "memmove MB/s", "large MB/s",
+         "const MB/s");
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    size_t n = sizes[i];
+    double mm = bench_memmove(n) / 1e6;
+    double large = bench_large(n) / 1e6;
+    double cst = bench_const(n) / 1e6;
+    if (cst) {
+      printf("%10zu %14.0f %14.0f %14.0f\n", n, mm, large, cst);
+    } else {
+      printf("%10zu %14.0f %14.0f %14s\n", n, mm, large, "-");
+    }
+  }
+  printf("(WASM_RT_NONTEMPORAL_COPY_THRESHOLD = %u bytes)\n",
+         (unsigned)WASM_RT_NONTEMPORAL_COPY_THRESHOLD);
+
+  free(buffer);
+  return 0;
+}
@@ -70,6 +70,36 @@ static WASM_RT_THREAD_LOCAL void* g_alt_stack = NULL;
 
 WASM_RT_THREAD_LOCAL wasm_rt_jmp_buf g_wasm_rt_jmp_buf;
 
+#if WASM_RT_FRAME_CHAIN
+WASM_RT_THREAD_LOCAL wasm_rt_frame_t* wasm_rt_frame_chain;
+WASM_RT_THREAD_LOCAL wasm_rt_frame_t* wasm_rt_saved_frame_chain;
+static WASM_RT_THREAD_LOCAL wasm_rt_frame_t
+    g_trap_backtrace[WASM_RT_TRAP_BACKTRACE_DEPTH];
+static WASM_RT_THREAD_LOCAL size_t g_trap_backtrace_size;
+
+wasm_rt_frame_t* wasm_rt_swap_frame_chain(wasm_rt_frame_t* chain) {
+  wasm_rt_frame_t* prev = wasm_rt_frame_chain;
+  wasm_rt_frame_chain = chain;
+  return prev;
+}
+
+size_t wasm_rt_walk_frames(const wasm_rt_frame_t* chain,
+                           wasm_rt_frame_t* out,
+                           size_t max) {
+  size_t n = 0;
+  for (; chain && n < max; chain = chain->parent, n++) {
+    out[n] = *chain;
+    out[n].parent = NULL;
+  }
+  return n;
+}
+
+size_t wasm_rt_trap_backtrace(const wasm_rt_frame_t** frames) {
+  *frames = g_trap_backtrace;
+  return g_trap_backtrace_size;
+}
+#endif
+
 #ifdef WASM_RT_TRAP_HANDLER
 extern void WASM_RT_TRAP_HANDLER(wasm_rt_trap_t code);
 #endif
@@ -79,6 +109,11 @@ void wasm_rt_trap(wasm_rt_trap_t code) {
 #if WASM_RT_STACK_DEPTH_COUNT
   wasm_rt_call_stack_depth = wasm_rt_saved_call_stack_depth;
 #endif
+#if WASM_RT_FRAME_CHAIN
+  g_trap_backtrace_size = wasm_rt_walk_frames(
+      wasm_rt_frame_chain, g_trap_backtrace, WASM_RT_TRAP_BACKTRACE_DEPTH);
+  wasm_rt_frame_chain = wasm_rt_saved_frame_chain;
+#endif
 
 #ifdef WASM_RT_TRAP_HANDLER
   WASM_RT_TRAP_HANDLER(code);
@@ -39,6 +39,15 @@ extern WASM_RT_THREAD_LOCAL uint32_t wasm_rt_saved_call_stack_depth;
 #define WASM_RT_SAVE_STACK_DEPTH() (void)0
 #endif
 
+#if WASM_RT_FRAME_CHAIN
+/** Saved frame chain that will be restored in case a trap occurs. */
+extern WASM_RT_THREAD_LOCAL wasm_rt_frame_t* wasm_rt_saved_frame_chain;
+#define WASM_RT_SAVE_FRAME_CHAIN() \
+  wasm_rt_saved_frame_chain = wasm_rt_frame_chain
+#else
+#define WASM_RT_SAVE_FRAME_CHAIN() (void)0
+#endif
+
 /**
  * Convenience macro to use before calling a wasm function. On first execution
  * it will return `WASM_RT_TRAP_NONE` (i.e. 0). If the function traps, it will
@@ -55,8 +64,9 @@ extern WASM_RT_THREAD_LOCAL uint32_t wasm_rt_saved_call_stack_depth;
  *   my_wasm_func();
  * ```
  */
-#define wasm_rt_impl_try()                                                    \
-  (WASM_RT_SAVE_STACK_DEPTH(), wasm_rt_set_unwind_target(&g_wasm_rt_jmp_buf), \
+#define wasm_rt_impl_try()                                             \
+  (WASM_RT_SAVE_STACK_DEPTH(), WASM_RT_SAVE_FRAME_CHAIN(),             \
+   wasm_rt_set_unwind_target(&g_wasm_rt_jmp_buf),                      \
    WASM_RT_SETJMP(g_wasm_rt_jmp_buf))
 
 #ifdef __cplusplus
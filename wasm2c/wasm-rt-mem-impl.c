@@ -18,6 +18,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -27,6 +28,14 @@
 #include <malloc.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WASM_RT_HAS_NONTEMPORAL_STORES 1
+#else
+#define WASM_RT_HAS_NONTEMPORAL_STORES 0
+#endif
+
 #define WASM_PAGE_SIZE 65536
 
 #ifdef WASM_RT_GROW_FAILED_HANDLER
@@ -158,6 +167,41 @@ static uint64_t get_alloc_size_for_mmap(uint64_t max_pages, bool is64) {
 
 #endif
 
+void wasm_rt_memmove_large(void* dest, const void* src, size_t n) {
+#if WASM_RT_HAS_NONTEMPORAL_STORES
+  uint8_t* d = dest;
+  const uint8_t* s = src;
+  if (d + n <= s || s + n <= d) {
+    // Align the destination so that every streaming store is aligned.
+    size_t head = (size_t)(-(uintptr_t)d & 15);
+    if (head > n) {
+      head = n;
+    }
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    for (; n >= 64; n -= 64, d += 64, s += 64) {
+      __m128i a = _mm_loadu_si128((const __m128i*)(s + 0));
+      __m128i b = _mm_loadu_si128((const __m128i*)(s + 16));
+      __m128i c = _mm_loadu_si128((const __m128i*)(s + 32));
+      __m128i e = _mm_loadu_si128((const __m128i*)(s + 48));
+      _mm_stream_si128((__m128i*)(d + 0), a);
+      _mm_stream_si128((__m128i*)(d + 16), b);
+      _mm_stream_si128((__m128i*)(d + 32), c);
+      _mm_stream_si128((__m128i*)(d + 48), e);
+    }
+    // Streaming stores are weakly ordered; fence before anything else can
+    // observe the destination.
+    _mm_sfence();
+    memcpy(d, s, n);
+    return;
+  }
+#endif
+  memmove(dest, src, n);
+}
+
 // Include operations for memory
 #define WASM_RT_MEM_OPS
 #include "wasm-rt-mem-impl-helper.inc"
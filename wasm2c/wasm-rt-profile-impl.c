@@ -0,0 +1,329 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wasm-rt.h"
+
+#include "wasm-rt-profile.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* One call stack of wasm_rt_profile_stacks_t. */
+struct wasm_rt_profile_stack_t {
+  struct wasm_rt_profile_stack_t* next;
+  uint64_t hash;
+  uint64_t count;
+  /* The defined function entered through this stack. */
+  uint32_t func;
+  uint32_t depth;
+  /*
+   * The module and function name of each frame, innermost first. Frames are
+   * told apart by these pointers, which wasm2c emits as string literals.
+   */
+  const char* names[];
+};
+
+static void* checked_malloc(size_t size) {
+  void* p = malloc(size);
+  if (!p) {
+    perror("malloc failed");
+    abort();
+  }
+  return p;
+}
+
+static void write_json_string(const char* s, FILE* out) {
+  fputc('"', out);
+  for (; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') {
+      fputc('\\', out);
+      fputc(c, out);
+    } else if (c < 0x20) {
+      fprintf(out, "\\u%04x", c);
+    } else {
+      fputc(c, out);
+    }
+  }
+  fputc('"', out);
+}
+
+/*
+ * Collapsed-stack frames are separated by ';' and terminated by the space
+ * before the count, and both formats are line based, so none of these may
+ * appear inside a name.
+ */
+static void write_symbol_name(const char* s, FILE* out) {
+  for (; *s; s++) {
+    fputc((*s == ';' || *s == ' ' || *s == '\n') ? '_' : *s, out);
+  }
+}
+
+void wasm_rt_profile_dump_json(const wasm_rt_profile_t* profile, FILE* out) {
+  uint32_t i;
+  uint32_t loop_index = 0;
+
+  fputs("{\"module\": ", out);
+  write_json_string(profile->module_name, out);
+  fputs(",\n \"functions\": [", out);
+  for (i = 0; i < profile->num_funcs; i++) {
+    fputs(i ? ",\n   {\"name\": " : "\n   {\"name\": ", out);
+    write_json_string(profile->func_names[i], out);
+    fprintf(out, ", \"count\": %" PRIu64 "}", profile->func_counts[i]);
+  }
+  fputs("],\n \"loops\": [", out);
+  for (i = 0; i < profile->num_loops; i++) {
+    if (i && profile->loop_funcs[i] == profile->loop_funcs[i - 1]) {
+      loop_index++;
+    } else {
+      loop_index = 0;
+    }
+    fputs(i ? ",\n   {\"function\": " : "\n   {\"function\": ", out);
+    write_json_string(profile->func_names[profile->loop_funcs[i]], out);
+    fprintf(out, ", \"index\": %" PRIu32 ", \"count\": %" PRIu64 "}",
+            loop_index, profile->loop_counts[i]);
+  }
+  fputs("]}\n", out);
+}
+
+static void write_stack(const wasm_rt_profile_t* profile,
+                        const struct wasm_rt_profile_stack_t* stack,
+                        FILE* out) {
+  uint32_t i;
+
+  write_symbol_name(profile->module_name, out);
+  for (i = stack->depth; i-- > 0;) {
+    const char* module_name = stack->names[2 * i];
+    fputc(';', out);
+    if (strcmp(module_name, profile->module_name) != 0) {
+      write_symbol_name(module_name, out);
+      fputc('!', out);
+    }
+    write_symbol_name(stack->names[2 * i + 1], out);
+  }
+  fprintf(out, " %" PRIu64 "\n", stack->count);
+}
+
+void wasm_rt_profile_dump_collapsed(const wasm_rt_profile_t* profile,
+                                    FILE* out) {
+  uint32_t i;
+  uint32_t loop_index = 0;
+  uint64_t* unstacked = NULL;
+  const struct wasm_rt_profile_stack_t* stack;
+
+  /*
+   * Entries that were counted without a stack (tail calls, or all of them
+   * without WASM_RT_FRAME_CHAIN) are reported without their callers.
+   */
+  if (profile->num_funcs) {
+    unstacked = checked_malloc(profile->num_funcs * sizeof(uint64_t));
+    memcpy(unstacked, profile->func_counts,
+           profile->num_funcs * sizeof(uint64_t));
+  }
+  for (stack = profile->stacks ? profile->stacks->first : NULL; stack;
+       stack = stack->next) {
+    write_stack(profile, stack, out);
+    unstacked[stack->func] -= stack->count;
+  }
+
+  for (i = 0; i < profile->num_funcs; i++) {
+    if (!unstacked[i]) {
+      continue;
+    }
+    write_symbol_name(profile->module_name, out);
+    fputc(';', out);
+    write_symbol_name(profile->func_names[i], out);
+    fprintf(out, " %" PRIu64 "\n", unstacked[i]);
+  }
+  free(unstacked);
+
+  for (i = 0; i < profile->num_loops; i++) {
+    if (i && profile->loop_funcs[i] == profile->loop_funcs[i - 1]) {
+      loop_index++;
+    } else {
+      loop_index = 0;
+    }
+    if (!profile->loop_counts[i]) {
+      continue;
+    }
+    write_symbol_name(profile->module_name, out);
+    fputc(';', out);
+    write_symbol_name(profile->func_names[profile->loop_funcs[i]], out);
+    fprintf(out, ";loop%" PRIu32 " %" PRIu64 "\n", loop_index,
+            profile->loop_counts[i]);
+  }
+}
+
+void wasm_rt_profile_reset(const wasm_rt_profile_t* profile) {
+  if (profile->num_funcs) {
+    memset(profile->func_counts, 0, profile->num_funcs * sizeof(uint64_t));
+  }
+  if (profile->num_loops) {
+    memset(profile->loop_counts, 0, profile->num_loops * sizeof(uint64_t));
+  }
+  if (profile->stacks) {
+    wasm_rt_profile_free_stacks(profile->stacks);
+  }
+}
+
+void wasm_rt_profile_free_stacks(wasm_rt_profile_stacks_t* stacks) {
+  struct wasm_rt_profile_stack_t* stack = stacks->first;
+  while (stack) {
+    struct wasm_rt_profile_stack_t* next = stack->next;
+    free(stack);
+    stack = next;
+  }
+  free(stacks->slots);
+  memset(stacks, 0, sizeof(*stacks));
+}
+
+#if WASM_RT_FRAME_CHAIN
+static uint64_t hash_stack(uint32_t func,
+                           const wasm_rt_frame_t* frames,
+                           size_t depth) {
+  /* FNV-1a over the function and the name pointers of the frames. */
+  uint64_t hash = 0xcbf29ce484222325ull;
+  size_t i;
+
+  hash = (hash ^ func) * 0x100000001b3ull;
+  for (i = 0; i < depth; i++) {
+    hash = (hash ^ (uintptr_t)frames[i].module_name) * 0x100000001b3ull;
+    hash = (hash ^ (uintptr_t)frames[i].func_name) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static bool is_same_stack(const struct wasm_rt_profile_stack_t* stack,
+                          uint64_t hash,
+                          uint32_t func,
+                          const wasm_rt_frame_t* frames,
+                          size_t depth) {
+  size_t i;
+
+  if (stack->hash != hash || stack->func != func || stack->depth != depth) {
+    return false;
+  }
+  for (i = 0; i < depth; i++) {
+    if (stack->names[2 * i] != frames[i].module_name ||
+        stack->names[2 * i + 1] != frames[i].func_name) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Double the capacity of the table, which is kept at most 3/4 full. */
+static void grow_stacks(wasm_rt_profile_stacks_t* stacks) {
+  size_t capacity = stacks->capacity ? stacks->capacity * 2 : 64;
+  struct wasm_rt_profile_stack_t** slots =
+      checked_malloc(capacity * sizeof(*slots));
+  struct wasm_rt_profile_stack_t* stack;
+
+  memset(slots, 0, capacity * sizeof(*slots));
+  for (stack = stacks->first; stack; stack = stack->next) {
+    size_t i = (size_t)stack->hash & (capacity - 1);
+    while (slots[i]) {
+      i = (i + 1) & (capacity - 1);
+    }
+    slots[i] = stack;
+  }
+  free(stacks->slots);
+  stacks->slots = slots;
+  stacks->capacity = capacity;
+}
+
+void wasm_rt_profile_count_stack(wasm_rt_profile_stacks_t* stacks,
+                                 uint32_t func) {
+  wasm_rt_frame_t frames[WASM_RT_PROFILE_STACK_DEPTH];
+  size_t depth = wasm_rt_walk_frames(wasm_rt_frame_chain, frames,
+                                     WASM_RT_PROFILE_STACK_DEPTH);
+  uint64_t hash = hash_stack(func, frames, depth);
+  struct wasm_rt_profile_stack_t* stack;
+  size_t slot;
+  size_t i;
+
+  if ((stacks->size + 1) * 4 > stacks->capacity * 3) {
+    grow_stacks(stacks);
+  }
+  for (slot = (size_t)hash & (stacks->capacity - 1); stacks->slots[slot];
+       slot = (slot + 1) & (stacks->capacity - 1)) {
+    if (is_same_stack(stacks->slots[slot], hash, func, frames, depth)) {
+      stacks->slots[slot]->count++;
+      return;
+    }
+  }
+
+  stack = checked_malloc(sizeof(*stack) + 2 * depth * sizeof(const char*));
+  stack->next = NULL;
+  stack->hash = hash;
+  stack->count = 1;
+  stack->func = func;
+  stack->depth = (uint32_t)depth;
+  for (i = 0; i < depth; i++) {
+    stack->names[2 * i] = frames[i].module_name;
+    stack->names[2 * i + 1] = frames[i].func_name;
+  }
+  if (stacks->last) {
+    stacks->last->next = stack;
+  } else {
+    stacks->first = stack;
+  }
+  stacks->last = stack;
+  stacks->slots[slot] = stack;
+  stacks->size++;
+}
+#endif
+
+#if WASM_RT_FRAME_CHAIN
+static int compare_symbols(const void* a, const void* b) {
+  uintptr_t x = (uintptr_t)((const wasm_rt_func_symbol_t*)a)->code;
+  uintptr_t y = (uintptr_t)((const wasm_rt_func_symbol_t*)b)->code;
+  return x < y ? -1 : x > y;
+}
+
+void wasm_rt_write_perf_map(FILE* out,
+                            const wasm_rt_func_symbol_t* symbols,
+                            size_t count) {
+  wasm_rt_func_symbol_t* sorted;
+  size_t i;
+
+  if (!count) {
+    return;
+  }
+  sorted = malloc(count * sizeof(*sorted));
+  if (!sorted) {
+    return;
+  }
+  memcpy(sorted, symbols, count * sizeof(*sorted));
+  qsort(sorted, count, sizeof(*sorted), compare_symbols);
+
+  for (i = 0; i < count; i++) {
+    uintptr_t start = (uintptr_t)sorted[i].code;
+    uintptr_t size = i + 1 < count ? (uintptr_t)sorted[i + 1].code - start
+                                   : WASM_RT_PERF_MAP_LAST_SIZE;
+    if (!size) {
+      continue;
+    }
+    fprintf(out, "%" PRIxPTR " %" PRIxPTR " ", start, size);
+    write_symbol_name(sorted[i].module_name, out);
+    fputc('!', out);
+    write_symbol_name(sorted[i].func_name, out);
+    fputc('\n', out);
+  }
+  free(sorted);
+}
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2024 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WASM_RT_PROFILE_H_
+#define WASM_RT_PROFILE_H_
+
+#include <stdio.h>
+
+#include "wasm-rt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wasm_rt_profile_stack_t;
+
+/**
+ * The call stacks through which the functions of one instance were entered,
+ * each with the number of entries. Stacks are recorded only if the generated
+ * code and the runtime are built with WASM_RT_FRAME_CHAIN, and the set is
+ * empty otherwise. The fields are private to the runtime.
+ */
+typedef struct {
+  struct wasm_rt_profile_stack_t** slots;
+  size_t capacity;
+  size_t size;
+  struct wasm_rt_profile_stack_t* first;
+  struct wasm_rt_profile_stack_t* last;
+} wasm_rt_profile_stacks_t;
+
+/**
+ * A view of the execution counters of one module instance, as filled in by
+ * the generated `wasm2c_<module>_get_profile` function when wasm2c is run
+ * with `--profile`. The counters are owned by the instance and are live; the
+ * view stays valid until the instance is freed.
+ */
+typedef struct {
+  /** The module name passed to (or inferred by) wasm2c. */
+  const char* module_name;
+  /** The number of functions defined (not imported) by the module. */
+  uint32_t num_funcs;
+  /** The wasm-level name of each defined function. */
+  const char* const* func_names;
+  /** The number of times each defined function has been entered. */
+  uint64_t* func_counts;
+  /**
+   * The number of loops instrumented by `--profile-loops`, or 0 if loop
+   * counters were not emitted.
+   */
+  uint32_t num_loops;
+  /** For each loop, the index (into `func_names`) of the enclosing function. */
+  const uint32_t* loop_funcs;
+  /** The number of times each loop header has been executed. */
+  uint64_t* loop_counts;
+  /** The call stacks of the function entries. */
+  wasm_rt_profile_stacks_t* stacks;
+} wasm_rt_profile_t;
+
+/**
+ * Write the counters as a single JSON object of the form:
+ *
+ *   {"module": "...",
+ *    "functions": [{"name": "...", "count": N}, ...],
+ *    "loops": [{"function": "...", "index": I, "count": N}, ...]}
+ *
+ * `index` numbers the loops of each function in the order they appear.
+ */
+void wasm_rt_profile_dump_json(const wasm_rt_profile_t* profile, FILE* out);
+
+/**
+ * Write the counters in the "collapsed stack" format consumed by
+ * flamegraph.pl and compatible tools, one `frame;frame count` line per
+ * non-zero counter. Each recorded call stack is reported as
+ * `module;outer;...;inner`, outermost frame first; a frame of another module
+ * is named `module!function`. Function entries without a recorded stack are
+ * reported as `module;function`, and each loop as `module;function;loop<I>`.
+ */
+void wasm_rt_profile_dump_collapsed(const wasm_rt_profile_t* profile,
+                                    FILE* out);
+
+/** Reset all counters of the instance to zero, and forget its call stacks. */
+void wasm_rt_profile_reset(const wasm_rt_profile_t* profile);
+
+/** Free the call stacks. The generated `_free` function calls this. */
+void wasm_rt_profile_free_stacks(wasm_rt_profile_stacks_t* stacks);
+
+#if WASM_RT_FRAME_CHAIN
+/**
+ * The number of innermost frames recorded for each call stack. Deeper stacks
+ * lose their outermost frames.
+ */
+#ifndef WASM_RT_PROFILE_STACK_DEPTH
+#define WASM_RT_PROFILE_STACK_DEPTH 64
+#endif
+
+/**
+ * Count an entry of the defined function `func` (an index into `func_names`)
+ * through the current `wasm_rt_frame_chain`. The generated code calls this
+ * after linking the function's frame. Like the counters, `stacks` must not be
+ * updated by two threads at once.
+ */
+void wasm_rt_profile_count_stack(wasm_rt_profile_stacks_t* stacks,
+                                 uint32_t func);
+
+/**
+ * Append a line per symbol to `out` in the /tmp/perf-<pid>.map format read by
+ * `perf report` and similar tools, naming each function `module!function`.
+ * C does not expose function sizes, so each function is assumed to extend to
+ * the next symbol in address order; the last one is given
+ * WASM_RT_PERF_MAP_LAST_SIZE bytes.
+ */
+#ifndef WASM_RT_PERF_MAP_LAST_SIZE
+#define WASM_RT_PERF_MAP_LAST_SIZE 4096
+#endif
+
+void wasm_rt_write_perf_map(FILE* out,
+                            const wasm_rt_func_symbol_t* symbols,
+                            size_t count);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
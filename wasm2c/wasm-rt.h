@@ -302,6 +302,88 @@ extern WASM_RT_THREAD_LOCAL uint32_t wasm_rt_call_stack_depth;
 
 #endif
 
+/**
+ * If enabled, every wasm2c-generated function links a `wasm_rt_frame_t` into a
+ * per-thread chain on entry and unlinks it on exit. Function state lives in
+ * heap-allocated green-thread frames rather than on the C stack, so native
+ * unwinders cannot see wasm callers; the chain lets profilers and crash
+ * handlers recover the wasm call stack instead. The generated code and the
+ * runtime must be built with the same setting.
+ */
+#ifndef WASM_RT_FRAME_CHAIN
+#define WASM_RT_FRAME_CHAIN 0
+#endif
+
+#if WASM_RT_FRAME_CHAIN
+
+/** One wasm function activation in the frame chain. */
+typedef struct wasm_rt_frame_t {
+  /** The calling frame, or NULL for the outermost wasm frame. */
+  struct wasm_rt_frame_t* parent;
+  /** The module name the function was generated with. */
+  const char* module_name;
+  /** The function's name in the wasm module (or a generated one). */
+  const char* func_name;
+  /** The function's index in the module's function index space. */
+  uint32_t func_index;
+  /**
+   * The module offset of the call this frame is currently executing, or 0 if
+   * it has not made one yet. Offsets are those shown by `wasm-objdump -d`.
+   */
+  uint32_t offset;
+} wasm_rt_frame_t;
+
+/** The innermost frame of the wasm code running on this thread. */
+extern WASM_RT_THREAD_LOCAL wasm_rt_frame_t* wasm_rt_frame_chain;
+
+/**
+ * Install `chain` as this thread's frame chain and return the previous chain.
+ * A green-thread scheduler must call this on every switch, saving the chain of
+ * the outgoing thread alongside its other per-thread state and installing the
+ * chain of the incoming one.
+ */
+wasm_rt_frame_t* wasm_rt_swap_frame_chain(wasm_rt_frame_t* chain);
+
+/**
+ * Copy up to `max` frames of `chain`, innermost first, into `out`, and return
+ * the number copied. The `parent` fields of the copies are set to NULL.
+ *
+ * This function is async-signal-safe: it neither allocates nor locks, so a
+ * sampling profiler or crash handler may call it from a signal handler that
+ * interrupted the thread owning `chain`.
+ */
+size_t wasm_rt_walk_frames(const wasm_rt_frame_t* chain,
+                           wasm_rt_frame_t* out,
+                           size_t max);
+
+/**
+ * The number of frames `wasm_rt_trap` captures before it unwinds, which can
+ * be retrieved with `wasm_rt_trap_backtrace`.
+ */
+#ifndef WASM_RT_TRAP_BACKTRACE_DEPTH
+#define WASM_RT_TRAP_BACKTRACE_DEPTH 32
+#endif
+
+/**
+ * Set `*frames` to the frames that were live when the most recent trap on
+ * this thread occurred, innermost first, and return their number.
+ */
+size_t wasm_rt_trap_backtrace(const wasm_rt_frame_t** frames);
+
+/**
+ * The code address and name of a generated function, as returned by the
+ * generated `wasm2c_<module>_get_func_symbols`. See `wasm_rt_write_perf_map`
+ * in wasm-rt-profile.h.
+ */
+typedef struct {
+  const void* code;
+  const char* module_name;
+  const char* func_name;
+  uint32_t func_index;
+} wasm_rt_func_symbol_t;
+
+#endif
+
 #if WASM_RT_USE_SEGUE || WASM_RT_ALLOW_SEGUE
 /**
  * The segue optimization uses x86 segments to point to a linear memory. If
@@ -602,6 +684,23 @@ uint64_t wasm_rt_grow_memory(wasm_rt_memory_t*, uint64_t pages);
 /** Free a Memory object. */
 void wasm_rt_free_memory(wasm_rt_memory_t*);
 
+/**
+ * `memory.copy` operations of at least this many bytes are performed by
+ * `wasm_rt_memmove_large` instead of `memmove`. This can be tuned for the
+ * target's cache sizes by defining this symbol when building the generated c
+ * files, e.g. with wasm2c/benchmarks/memcopy.
+ */
+#ifndef WASM_RT_NONTEMPORAL_COPY_THRESHOLD
+#define WASM_RT_NONTEMPORAL_COPY_THRESHOLD (4u << 20)
+#endif
+
+/**
+ * Copy `n` bytes from `src` to `dest`, which may overlap. Where the platform
+ * supports it, non-overlapping copies use non-temporal stores so that large
+ * copies do not evict the rest of the working set from the cache.
+ */
+void wasm_rt_memmove_large(void* dest, const void* src, size_t n);
+
 #ifdef WASM_RT_C11_AVAILABLE
 /** Shared memory version of wasm_rt_allocate_memory */
 void wasm_rt_allocate_memory_shared(wasm_rt_shared_memory_t*,